@@ -18,7 +18,10 @@
  */
 
 #include "EEG.h"
+#include "LongEEG.h"
 #include "Sound_and_Spectrum.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "EEG_def.h"
@@ -97,314 +100,8 @@ long EEG_getChannelNumber (EEG me, const wchar_t *channelName) {
 
 EEG EEG_readFromBdfFile (MelderFile file) {
 	try {
-		autofile f = Melder_fopen (file, "rb");
-		char buffer [81];
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		bool is24bit = buffer [0] == (char) 255;
-		fread (buffer, 1, 80, f); buffer [80] = '\0';
-		trace ("Local subject identification: \"%s\"", buffer);
-		fread (buffer, 1, 80, f); buffer [80] = '\0';
-		trace ("Local recording identification: \"%s\"", buffer);
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		trace ("Start date of recording: \"%s\"", buffer);
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		trace ("Start time of recording: \"%s\"", buffer);
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		long numberOfBytesInHeaderRecord = atol (buffer);
-		trace ("Number of bytes in header record: %ld", numberOfBytesInHeaderRecord);
-		fread (buffer, 1, 44, f); buffer [44] = '\0';
-		trace ("Version of data format: \"%s\"", buffer);
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		long numberOfDataRecords = strtol (buffer, NULL, 10);
-		trace ("Number of data records: %ld", numberOfDataRecords);
-		fread (buffer, 1, 8, f); buffer [8] = '\0';
-		double durationOfDataRecord = atof (buffer);
-		trace ("Duration of a data record: \"%f\"", durationOfDataRecord);
-		fread (buffer, 1, 4, f); buffer [4] = '\0';
-		long numberOfChannels = atol (buffer);
-		trace ("Number of channels in data record: %ld", numberOfChannels);
-		if (numberOfBytesInHeaderRecord != (numberOfChannels + 1) * 256)
-			Melder_throw ("Number of bytes in header record (", numberOfBytesInHeaderRecord,
-				") doesn't match number of channels (", numberOfChannels, ").");
-		autostringvector channelNames (1, numberOfChannels);
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			fread (buffer, 1, 16, f); buffer [16] = '\0';   // labels of the channels
-			/*
-			 * Strip all final spaces.
-			 */
-			for (int i = 15; i >= 0; i --) {
-				if (buffer [i] == ' ') {
-					buffer [i] = '\0';
-				} else {
-					break;
-				}
-			}
-			channelNames [ichannel] = Melder_wcsdup (Melder_peekUtf8ToWcs (buffer));
-			trace ("Channel <<%ls>>", channelNames [ichannel]);
-		}
-		bool hasLetters = wcsequ (channelNames [numberOfChannels], L"EDF Annotations");
-		double samplingFrequency = NUMundefined;
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			fread (buffer, 1, 80, f); buffer [80] = '\0';   // transducer type
-		}
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';   // physical dimension of channels
-		}
-		autoNUMvector <double> physicalMinimum (1, numberOfChannels);
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';
-			physicalMinimum [ichannel] = atof (buffer);
-		}
-		autoNUMvector <double> physicalMaximum (1, numberOfChannels);
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';
-			physicalMaximum [ichannel] = atof (buffer);
-		}
-		autoNUMvector <double> digitalMinimum (1, numberOfChannels);
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';
-			digitalMinimum [ichannel] = atof (buffer);
-		}
-		autoNUMvector <double> digitalMaximum (1, numberOfChannels);
-		for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';
-			digitalMaximum [ichannel] = atof (buffer);
-		}
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			fread (buffer, 1, 80, f); buffer [80] = '\0';   // prefiltering
-		}
-		long numberOfSamplesPerDataRecord = 0;
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			fread (buffer, 1, 8, f); buffer [8] = '\0';   // number of samples in each data record
-			long numberOfSamplesInThisDataRecord = atol (buffer);
-			if (samplingFrequency == NUMundefined) {
-				numberOfSamplesPerDataRecord = numberOfSamplesInThisDataRecord;
-				samplingFrequency = numberOfSamplesInThisDataRecord / durationOfDataRecord;
-			}
-			if (numberOfSamplesInThisDataRecord / durationOfDataRecord != samplingFrequency)
-				Melder_throw (L"Number of samples per data record in channel ", channel,
-					" (", numberOfSamplesInThisDataRecord,
-					") doesn't match sampling frequency of channel 1 (", samplingFrequency, ").");
-		}
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			fread (buffer, 1, 32, f); buffer [32] = '\0';   // reserved
-		}
-		double duration = numberOfDataRecords * durationOfDataRecord;
-		autoEEG him = EEG_create (0, duration);
-		his numberOfChannels = numberOfChannels;
-		autoSound me = Sound_createSimple (numberOfChannels, duration, samplingFrequency);
-		Melder_assert (my nx == numberOfSamplesPerDataRecord * numberOfDataRecords);
-		autoNUMvector <unsigned char> dataBuffer (0L, 3 * numberOfSamplesPerDataRecord - 1);
-		for (long record = 1; record <= numberOfDataRecords; record ++) {
-			for (long channel = 1; channel <= numberOfChannels; channel ++) {
-				double factor = channel == numberOfChannels ? 1.0 : physicalMinimum [channel] / digitalMinimum [channel];
-				if (channel < numberOfChannels - EEG_getNumberOfExtraSensors (him.peek())) factor /= 1000000.0;
-				if (is24bit) {
-					fread (& dataBuffer [0], 3, numberOfSamplesPerDataRecord, f);
-					unsigned char *p = & dataBuffer [0];
-					for (long i = 1; i <= numberOfSamplesPerDataRecord; i ++) {
-						long sample = i + (record - 1) * numberOfSamplesPerDataRecord;
-						Melder_assert (sample <= my nx);
-						uint8_t lowByte = *p ++, midByte = *p ++, highByte = *p ++;
-						uint32_t externalValue = ((uint32_t) highByte << 16) | ((uint32_t) midByte << 8) | (uint32_t) lowByte;
-						if ((highByte & 128) != 0)   // is the 24-bit sign bit on?
-							externalValue |= 0xFF000000;   // extend negative sign to 32 bits
-						my z [channel] [sample] = (int32_t) externalValue * factor;
-					}
-				} else {
-					fread (& dataBuffer [0], 2, numberOfSamplesPerDataRecord, f);
-					unsigned char *p = & dataBuffer [0];
-					for (long i = 1; i <= numberOfSamplesPerDataRecord; i ++) {
-						long sample = i + (record - 1) * numberOfSamplesPerDataRecord;
-						Melder_assert (sample <= my nx);
-						uint8_t lowByte = *p ++, highByte = *p ++;
-						uint16_t externalValue = ((uint16_t) highByte << 8) | (uint16_t) lowByte;
-						my z [channel] [sample] = (int16_t) externalValue * factor;
-					}
-				}
-			}
-		}
-		int numberOfStatusBits = 8;
-		for (long i = 1; i <= my nx; i ++) {
-			unsigned long value = (long) my z [numberOfChannels] [i];
-			if (value & 0x0000FF00) {
-				numberOfStatusBits = 16;
-			}
-		}
-		autoTextGrid thee;
-		if (hasLetters) {
-			thee.reset (TextGrid_create (0, duration, L"Mark Trigger", L"Mark Trigger"));
-			autoMelderString letters;
-			double time = NUMundefined;
-			for (long i = 1; i <= my nx; i ++) {
-				unsigned long value = (long) my z [numberOfChannels] [i];
-				for (int byte = 1; byte <= numberOfStatusBits / 8; byte ++) {
-					unsigned long mask = byte == 1 ? 0x000000ff : 0x0000ff00;
-					wchar_t kar = byte == 1 ? (value & mask) : (value & mask) >> 8;
-					if (kar != '\0' && kar != 20) {
-						MelderString_appendCharacter (& letters, kar);
-					} else if (letters. string [0] != '\0') {
-						if (letters. string [0] == '+') {
-							if (NUMdefined (time)) {
-								try {
-									TextGrid_insertPoint (thee.peek(), 1, time, L"");
-								} catch (MelderError) {
-									Melder_throw ("Did not insert empty mark (", letters. string, ") on Mark tier.");
-								}
-								time = NUMundefined;   // defensive
-							}
-							time = Melder_atof (& letters. string [1]);
-							MelderString_empty (& letters);
-						} else {
-							if (! NUMdefined (time)) {
-								Melder_throw ("Undefined time for label at sample ", i, ".");
-							}
-							try {
-								if (Melder_wcsnequ (letters. string, L"Trigger-", 8)) {
-									try {
-										TextGrid_insertPoint (thee.peek(), 2, time, & letters. string [8]);
-									} catch (MelderError) {
-										Melder_clearError ();
-										trace ("Duplicate trigger at %f seconds: %ls", time, & letters. string [8]);
-									}
-								} else {
-									TextGrid_insertPoint (thee.peek(), 1, time, & letters. string [0]);
-								}
-							} catch (MelderError) {
-								Melder_throw ("Did not insert mark (", letters. string, ") on Trigger tier.");
-							}
-							time = NUMundefined;   // crucial
-							MelderString_empty (& letters);
-						}
-					}
-				}
-			}
-			if (NUMdefined (time)) {
-				TextGrid_insertPoint (thee.peek(), 1, time, L"");
-				time = NUMundefined;   // defensive
-			}
-		} else {
-			thee.reset (TextGrid_create (0, duration,
-				numberOfStatusBits == 8 ? L"S1 S2 S3 S4 S5 S6 S7 S8" : L"S1 S2 S3 S4 S5 S6 S7 S8 S9 S10 S11 S12 S13 S14 S15 S16", L""));
-			for (int bit = 1; bit <= numberOfStatusBits; bit ++) {
-				unsigned long bitValue = 1 << (bit - 1);
-				IntervalTier tier = (IntervalTier) thy tiers -> item [bit];
-				for (long i = 1; i <= my nx; i ++) {
-					unsigned long previousValue = i == 1 ? 0 : (long) my z [numberOfChannels] [i - 1];
-					unsigned long thisValue = (long) my z [numberOfChannels] [i];
-					if ((thisValue & bitValue) != (previousValue & bitValue)) {
-						double time = i == 1 ? 0.0 : my x1 + (i - 1.5) * my dx;
-						if (time != 0.0)
-							TextGrid_insertBoundary (thee.peek(), bit, time);
-						if ((thisValue & bitValue) != 0)
-							TextGrid_setIntervalText (thee.peek(), bit, tier -> intervals -> size, L"1");
-					}
-				}
-			}
-		}
-		f.close (file);
-		his channelNames = channelNames.transfer();
-		his sound = me.transfer();
-		his textgrid = thee.transfer();
-		if (EEG_getNumberOfCapElectrodes (him.peek()) == 32) {
-			EEG_setChannelName (him.peek(), 1, L"Fp1");
-			EEG_setChannelName (him.peek(), 2, L"AF3");
-			EEG_setChannelName (him.peek(), 3, L"F7");
-			EEG_setChannelName (him.peek(), 4, L"F3");
-			EEG_setChannelName (him.peek(), 5, L"FC1");
-			EEG_setChannelName (him.peek(), 6, L"FC5");
-			EEG_setChannelName (him.peek(), 7, L"T7");
-			EEG_setChannelName (him.peek(), 8, L"C3");
-			EEG_setChannelName (him.peek(), 9, L"CP1");
-			EEG_setChannelName (him.peek(), 10, L"CP5");
-			EEG_setChannelName (him.peek(), 11, L"P7");
-			EEG_setChannelName (him.peek(), 12, L"P3");
-			EEG_setChannelName (him.peek(), 13, L"Pz");
-			EEG_setChannelName (him.peek(), 14, L"PO3");
-			EEG_setChannelName (him.peek(), 15, L"O1");
-			EEG_setChannelName (him.peek(), 16, L"Oz");
-			EEG_setChannelName (him.peek(), 17, L"O2");
-			EEG_setChannelName (him.peek(), 18, L"PO4");
-			EEG_setChannelName (him.peek(), 19, L"P4");
-			EEG_setChannelName (him.peek(), 20, L"P8");
-			EEG_setChannelName (him.peek(), 21, L"CP6");
-			EEG_setChannelName (him.peek(), 22, L"CP2");
-			EEG_setChannelName (him.peek(), 23, L"C4");
-			EEG_setChannelName (him.peek(), 24, L"T8");
-			EEG_setChannelName (him.peek(), 25, L"FC6");
-			EEG_setChannelName (him.peek(), 26, L"FC2");
-			EEG_setChannelName (him.peek(), 27, L"F4");
-			EEG_setChannelName (him.peek(), 28, L"F8");
-			EEG_setChannelName (him.peek(), 29, L"AF4");
-			EEG_setChannelName (him.peek(), 30, L"Fp2");
-			EEG_setChannelName (him.peek(), 31, L"Fz");
-			EEG_setChannelName (him.peek(), 32, L"Cz");
-		} else if (EEG_getNumberOfCapElectrodes (him.peek()) == 64) {
-			EEG_setChannelName (him.peek(), 1, L"Fp1");
-			EEG_setChannelName (him.peek(), 2, L"AF7");
-			EEG_setChannelName (him.peek(), 3, L"AF3");
-			EEG_setChannelName (him.peek(), 4, L"F1");
-			EEG_setChannelName (him.peek(), 5, L"F3");
-			EEG_setChannelName (him.peek(), 6, L"F5");
-			EEG_setChannelName (him.peek(), 7, L"F7");
-			EEG_setChannelName (him.peek(), 8, L"FT7");
-			EEG_setChannelName (him.peek(), 9, L"FC5");
-			EEG_setChannelName (him.peek(), 10, L"FC3");
-			EEG_setChannelName (him.peek(), 11, L"FC1");
-			EEG_setChannelName (him.peek(), 12, L"C1");
-			EEG_setChannelName (him.peek(), 13, L"C3");
-			EEG_setChannelName (him.peek(), 14, L"C5");
-			EEG_setChannelName (him.peek(), 15, L"T7");
-			EEG_setChannelName (him.peek(), 16, L"TP7");
-			EEG_setChannelName (him.peek(), 17, L"CP5");
-			EEG_setChannelName (him.peek(), 18, L"CP3");
-			EEG_setChannelName (him.peek(), 19, L"CP1");
-			EEG_setChannelName (him.peek(), 20, L"P1");
-			EEG_setChannelName (him.peek(), 21, L"P3");
-			EEG_setChannelName (him.peek(), 22, L"P5");
-			EEG_setChannelName (him.peek(), 23, L"P7");
-			EEG_setChannelName (him.peek(), 24, L"P9");
-			EEG_setChannelName (him.peek(), 25, L"PO7");
-			EEG_setChannelName (him.peek(), 26, L"PO3");
-			EEG_setChannelName (him.peek(), 27, L"O1");
-			EEG_setChannelName (him.peek(), 28, L"Iz");
-			EEG_setChannelName (him.peek(), 29, L"Oz");
-			EEG_setChannelName (him.peek(), 30, L"POz");
-			EEG_setChannelName (him.peek(), 31, L"Pz");
-			EEG_setChannelName (him.peek(), 32, L"CPz");
-			EEG_setChannelName (him.peek(), 33, L"Fpz");
-			EEG_setChannelName (him.peek(), 34, L"Fp2");
-			EEG_setChannelName (him.peek(), 35, L"AF8");
-			EEG_setChannelName (him.peek(), 36, L"AF4");
-			EEG_setChannelName (him.peek(), 37, L"AFz");
-			EEG_setChannelName (him.peek(), 38, L"Fz");
-			EEG_setChannelName (him.peek(), 39, L"F2");
-			EEG_setChannelName (him.peek(), 40, L"F4");
-			EEG_setChannelName (him.peek(), 41, L"F6");
-			EEG_setChannelName (him.peek(), 42, L"F8");
-			EEG_setChannelName (him.peek(), 43, L"FT8");
-			EEG_setChannelName (him.peek(), 44, L"FC6");
-			EEG_setChannelName (him.peek(), 45, L"FC4");
-			EEG_setChannelName (him.peek(), 46, L"FC2");
-			EEG_setChannelName (him.peek(), 47, L"FCz");
-			EEG_setChannelName (him.peek(), 48, L"Cz");
-			EEG_setChannelName (him.peek(), 49, L"C2");
-			EEG_setChannelName (him.peek(), 50, L"C4");
-			EEG_setChannelName (him.peek(), 51, L"C6");
-			EEG_setChannelName (him.peek(), 52, L"T8");
-			EEG_setChannelName (him.peek(), 53, L"TP8");
-			EEG_setChannelName (him.peek(), 54, L"CP6");
-			EEG_setChannelName (him.peek(), 55, L"CP4");
-			EEG_setChannelName (him.peek(), 56, L"CP2");
-			EEG_setChannelName (him.peek(), 57, L"P2");
-			EEG_setChannelName (him.peek(), 58, L"P4");
-			EEG_setChannelName (him.peek(), 59, L"P6");
-			EEG_setChannelName (him.peek(), 60, L"P8");
-			EEG_setChannelName (him.peek(), 61, L"P10");
-			EEG_setChannelName (him.peek(), 62, L"PO8");
-			EEG_setChannelName (him.peek(), 63, L"PO4");
-			EEG_setChannelName (him.peek(), 64, L"O2");
-		}
+		autoLongEEG me = LongEEG_open (file);
+		autoEEG him = LongEEG_to_EEG (me.peek());
 		return him.transfer();
 	} catch (MelderError) {
 		Melder_throw ("BDF file not read.");
@@ -425,26 +122,180 @@ void EEG_detrend (EEG me) {
 	}
 }
 
-void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz) {
-	try {
 /*
-	long nsampFFT = 1;
-	while (nsampFFT < my sound -> nx)
-		nsampFFT *= 2;
+ * EEG_filter multiplies the spectrum of every channel by the frequency response
+ * of Spectrum_passHannBand (low and high) and Spectrum_stopHannBand (notch),
+ * but instead of transforming whole channels it convolves them with the equivalent zero-phase FIR filter,
+ * by the overlap-add method: blocks of a few seconds are transformed, filtered, transformed back, and added.
+ * The channels are filtered in parallel, into a copy that replaces the original only when all channels are done.
+ */
+
+#define EEG_FILTER_KERNEL_DECAY  8.0   /* half-length of the kernel in periods of the narrowest transition width */
+
+Thing_define (EEG_filter_Args, Thing) { public:
+	double **from, **to;
+	long numberOfChannels, nx;
+	long nfft, halfKernelLength;
+	double *kernelSpectrum;
+	bool isMainThread;
+	volatile long *nextChannel, *numberOfChannelsDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (EEG_filter_Args, Thing, 0);
+
+MelderThread_MUTEX (filterMutex);
+static bool filterMutex_inited;
+
+static MelderThread_RETURN_TYPE EEG_filter_channels (EEG_filter_Args me) {
+	const long nfft = my nfft, halfKernelLength = my halfKernelLength;
+	const long blockLength = nfft - 2 * halfKernelLength;   // the number of new samples per block
+	const long nx = my nx;
+	const double *kernelSpectrum = my kernelSpectrum;
 	autoNUMfft_Table fftTable;
-	NUMfft_Table_init (& fftTable, nsampFFT);
-*/
-		for (long ichan = 1; ichan <= my numberOfChannels - EEG_getNumberOfExtraSensors (me); ichan ++) {
-			autoSound channel = Sound_extractChannel (my sound, ichan);
-			autoSpectrum spec = Sound_to_Spectrum (channel.peek(), TRUE);
-			Spectrum_passHannBand (spec.peek(), lowFrequency, 0.0, lowWidth);
-			Spectrum_passHannBand (spec.peek(), 0.0, highFrequency, highWidth);
-			if (doNotch50Hz) {
-				Spectrum_stopHannBand (spec.peek(), 48.0, 52.0, 1.0);
+	autoNUMvector <double> block, sum;
+	MelderThread_LOCK (filterMutex);
+	NUMfft_Table_init (& fftTable, nfft);
+	block.reset (1, nfft);
+	sum.reset (1, nfft);   // sum [1..nfft] accumulates the output samples firstSample - halfKernelLength + (0..nfft-1)
+	MelderThread_UNLOCK (filterMutex);
+	for (;;) {
+		MelderThread_LOCK (filterMutex);
+		long ichan = ++ *my nextChannel;
+		MelderThread_UNLOCK (filterMutex);
+		if (ichan > my numberOfChannels || *my cancelled) break;
+		const double *from = my from [ichan];
+		double *to = my to [ichan];
+		for (long i = 1; i <= nfft; i ++) sum [i] = 0.0;
+		for (long firstSample = 1; firstSample <= nx; firstSample += blockLength) {
+			long numberOfSamples = nx - firstSample + 1;
+			if (numberOfSamples > blockLength) numberOfSamples = blockLength;
+			for (long i = 1; i <= numberOfSamples; i ++) block [i] = from [firstSample + i - 1];
+			for (long i = numberOfSamples + 1; i <= nfft; i ++) block [i] = 0.0;
+			NUMfft_forward (& fftTable, block.peek());
+			block [1] *= kernelSpectrum [1];
+			for (long i = 2; i < nfft; i += 2) {
+				double re = block [i], im = block [i + 1];
+				block [i] = re * kernelSpectrum [i] - im * kernelSpectrum [i + 1];
+				block [i + 1] = re * kernelSpectrum [i + 1] + im * kernelSpectrum [i];
+			}
+			block [nfft] *= kernelSpectrum [nfft];
+			NUMfft_backward (& fftTable, block.peek());   // the kernel spectrum includes the factor 1 / nfft
+			for (long i = 1; i <= nfft; i ++) sum [i] += block [i];
+			/*
+			 * The first blockLength output samples are now complete, because the next block
+			 * contributes only from firstSample + blockLength - halfKernelLength on.
+			 */
+			long firstOutputSample = firstSample - halfKernelLength;
+			for (long i = 1; i <= blockLength; i ++) {
+				long isamp = firstOutputSample + i - 1;
+				if (isamp >= 1 && isamp <= nx) to [isamp] = sum [i];
+			}
+			for (long i = 1; i <= nfft - blockLength; i ++) sum [i] = sum [i + blockLength];
+			for (long i = nfft - blockLength + 1; i <= nfft; i ++) sum [i] = 0.0;
+			if (firstSample + blockLength > nx) {   // last block: flush the tail
+				for (long i = 1; i <= nfft - blockLength; i ++) {
+					long isamp = firstOutputSample + blockLength + i - 1;
+					if (isamp >= 1 && isamp <= nx) to [isamp] = sum [i];
+				}
 			}
-			autoSound him = Spectrum_to_Sound (spec.peek());
-			NUMvector_copyElements (his z [1], my sound -> z [ichan], 1, my sound -> nx);
 		}
+		MelderThread_LOCK (filterMutex);
+		long numberOfChannelsDone = ++ *my numberOfChannelsDone;
+		MelderThread_UNLOCK (filterMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress ((double) numberOfChannelsDone / my numberOfChannels,
+					L"Filtered ", Melder_integer (numberOfChannelsDone), L" out of ", Melder_integer (my numberOfChannels), L" channels");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+void EEG_filter (EEG me, double lowFrequency, double lowWidth, double highFrequency, double highWidth, bool doNotch50Hz) {
+	try {
+		const long numberOfChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
+		const long nx = my sound -> nx;
+		const double samplingFrequency = 1.0 / my sound -> dx, nyquistFrequency = 0.5 * samplingFrequency;
+		if (numberOfChannels < 1 || nx < 1) return;
+
+		/*
+		 * The length of the kernel follows from the narrowest transition band;
+		 * a response without transitions needs no filtering at all.
+		 */
+		double narrowestWidth = NUMundefined;
+		if (lowFrequency > 0.0)
+			narrowestWidth = lowWidth;
+		if (highFrequency > 0.0 && highFrequency < nyquistFrequency && (narrowestWidth == NUMundefined || highWidth < narrowestWidth))
+			narrowestWidth = highWidth;
+		if (doNotch50Hz && (narrowestWidth == NUMundefined || 1.0 < narrowestWidth))
+			narrowestWidth = 1.0;
+		if (narrowestWidth == NUMundefined) return;
+		long halfKernelLength = narrowestWidth > 0.0 ?
+			(long) ceil (EEG_FILTER_KERNEL_DECAY * samplingFrequency / narrowestWidth) : nx;
+		if (halfKernelLength > nx) halfKernelLength = nx;   // enough for every output sample
+		long nfft = 2;
+		while (nfft < 4 * halfKernelLength + 2) nfft *= 2;   // blocks of at least half the FFT length
+
+		/*
+		 * The kernel: sample the frequency response, transform to a zero-phase impulse response,
+		 * keep its central 2 * halfKernelLength + 1 samples (delayed by halfKernelLength), and transform back.
+		 */
+		autoNUMfft_Table fftTable;
+		NUMfft_Table_init (& fftTable, nfft);
+		autoNUMvector <double> response (1, nfft), kernelSpectrum (1, nfft);
+		for (long k = 0; k <= nfft / 2; k ++) {
+			double frequency = k * samplingFrequency / nfft;
+			double factor = Spectrum_passHannBand_factor (frequency, lowFrequency, 0.0, lowWidth, nyquistFrequency) *
+				Spectrum_passHannBand_factor (frequency, 0.0, highFrequency, highWidth, nyquistFrequency);
+			if (doNotch50Hz)
+				factor *= Spectrum_stopHannBand_factor (frequency, 48.0, 52.0, 1.0, nyquistFrequency);
+			if (k == 0) response [1] = factor;
+			else if (k == nfft / 2) response [nfft] = factor;
+			else response [2 * k] = factor, response [2 * k + 1] = 0.0;
+		}
+		NUMfft_backward (& fftTable, response.peek());   // response [1 + n] = nfft * h [n], n circular
+		const double scale = 1.0 / ((double) nfft * (double) nfft);   // 1 / nfft for this transform, 1 / nfft for every block
+		for (long n = - halfKernelLength; n <= halfKernelLength; n ++)
+			kernelSpectrum [1 + halfKernelLength + n] = response [1 + (n + nfft) % nfft] * scale;
+		NUMfft_forward (& fftTable, kernelSpectrum.peek());
+
+		autoNUMmatrix <double> filtered (1, numberOfChannels, 1, nx);
+		autoMelderProgress progress (L"Filtering EEG channels...");
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfChannels) numberOfThreads = numberOfChannels;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+
+		if (! filterMutex_inited) { MelderThread_MUTEX_INIT (filterMutex); filterMutex_inited = true; }
+		autoEEG_filter_Args args [16];
+		volatile long nextChannel = 0, numberOfChannelsDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoEEG_filter_Args arg = Thing_new (EEG_filter_Args);
+			arg -> from = my sound -> z;
+			arg -> to = filtered.peek();
+			arg -> numberOfChannels = numberOfChannels;
+			arg -> nx = nx;
+			arg -> nfft = nfft;
+			arg -> halfKernelLength = halfKernelLength;
+			arg -> kernelSpectrum = kernelSpectrum.peek();
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> nextChannel = & nextChannel;
+			arg -> numberOfChannelsDone = & numberOfChannelsDone;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
+		}
+		MelderThread_run (EEG_filter_channels, args, numberOfThreads);
+		/*
+		 * Only now that every channel has been filtered do the new samples replace the old ones,
+		 * so that cancelling leaves the EEG untouched.
+		 */
+		NUMmatrix_copyElements <double> (filtered.peek(), my sound -> z, 1, numberOfChannels, 1, nx);
 	} catch (MelderError) {
 		Melder_throw (me, ": not filtered.");
 	}
@@ -18,6 +18,7 @@
  */
 
 #include "ERPTier.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "ERPTier_def.h"
@@ -78,44 +79,89 @@ double ERPTier_getMean (ERPTier me, long pointNumber, const wchar_t *channelName
 	return ERPTier_getMean (me, pointNumber, ERPTier_getChannelNumber (me, channelName), tmin, tmax);
 }
 
+/*
+ * The epochs are read through a callback, so that the EEG data can be in memory (EEG) or on disk (LongEEG).
+ * The callback has to fill to [1..numberOfChannels] [1..numberOfSamples] with the samples
+ * firstSample .. firstSample + numberOfSamples - 1, and with zeroes outside the recording.
+ */
+typedef void (*ERPTier_readSamples) (Any source, long numberOfChannels, long firstSample, long numberOfSamples, double **to);
+
+static void getEpochSampling (double fromTime, double toTime, double samplingPeriod, long *numberOfSamples, double *firstTime) {
+	double soundDuration = toTime - fromTime;
+	*numberOfSamples = floor (soundDuration / samplingPeriod) + 1;
+	if (*numberOfSamples < 1)
+		Melder_throw (L"Time window too short.");
+	double midTime = 0.5 * (fromTime + toTime);
+	double soundPhysicalDuration = *numberOfSamples * samplingPeriod;
+	*firstTime = midTime - 0.5 * soundPhysicalDuration + 0.5 * samplingPeriod;   // distribute the samples evenly over the time domain
+}
+
+static long getFirstEpochSample (double eegEventTime, double x1, double samplingPeriod, double firstTime) {
+	double erpEventTime = 0.0;
+	double eegSample = 1 + (eegEventTime - x1) / samplingPeriod;
+	double erpSample = 1 + (erpEventTime - firstTime) / samplingPeriod;
+	long sampleDifference = round (eegSample - erpSample);
+	return 1 + sampleDifference;
+}
+
+static ERPTier PointProcess_to_ERPTier (PointProcess events, double fromTime, double toTime,
+	long numberOfChannels, wchar_t **channelNames, double x1, double samplingPeriod,
+	ERPTier_readSamples readSamples, Any source)
+{
+	autoERPTier thee = Thing_new (ERPTier);
+	Function_init (thee.peek(), fromTime, toTime);
+	thy numberOfChannels = numberOfChannels;
+	Melder_assert (thy numberOfChannels > 0);
+	thy channelNames = NUMvector <wchar_t *> (1, thy numberOfChannels);
+	for (long ichan = 1; ichan <= thy numberOfChannels; ichan ++) {
+		thy channelNames [ichan] = Melder_wcsdup (channelNames [ichan]);
+	}
+	long numberOfEvents = events -> nt;
+	thy events = SortedSetOfDouble_create ();
+	long numberOfSamples;
+	double firstTime;
+	getEpochSampling (fromTime, toTime, samplingPeriod, & numberOfSamples, & firstTime);
+	for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
+		double eegEventTime = events -> t [ievent];
+		autoERPPoint event = Thing_new (ERPPoint);
+		event -> number = eegEventTime;
+		event -> erp = Sound_create (thy numberOfChannels, fromTime, toTime, numberOfSamples, samplingPeriod, firstTime);
+		readSamples (source, thy numberOfChannels, getFirstEpochSample (eegEventTime, x1, samplingPeriod, firstTime),
+			numberOfSamples, event -> erp -> z);
+		Collection_addItem (thy events, event.transfer());
+	}
+	return thee.transfer();
+}
+
+static void EEG_readSamples (Any void_me, long numberOfChannels, long firstSample, long numberOfSamples, double **to) {
+	EEG me = (EEG) void_me;
+	for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+		for (long isample = 1; isample <= numberOfSamples; isample ++) {
+			long jsample = firstSample + isample - 1;
+			to [ichannel] [isample] = jsample < 1 || jsample > my sound -> nx ? 0.0 : my sound -> z [ichannel] [jsample];
+		}
+	}
+}
+
 static ERPTier EEG_PointProcess_to_ERPTier (EEG me, PointProcess events, double fromTime, double toTime) {
 	try {
-		autoERPTier thee = Thing_new (ERPTier);
-		Function_init (thee.peek(), fromTime, toTime);
-		thy numberOfChannels = my numberOfChannels - EEG_getNumberOfExtraSensors (me);
-		Melder_assert (thy numberOfChannels > 0);
-		thy channelNames = NUMvector <wchar_t *> (1, thy numberOfChannels);
-		for (long ichan = 1; ichan <= thy numberOfChannels; ichan ++) {
-			thy channelNames [ichan] = Melder_wcsdup (my channelNames [ichan]);
-		}
-		long numberOfEvents = events -> nt;
-		thy events = SortedSetOfDouble_create ();
-		double soundDuration = toTime - fromTime;
-		double samplingPeriod = my sound -> dx;
-		long numberOfSamples = floor (soundDuration / samplingPeriod) + 1;
-		if (numberOfSamples < 1)
-			Melder_throw (L"Time window too short.");
-		double midTime = 0.5 * (fromTime + toTime);
-		double soundPhysicalDuration = numberOfSamples * samplingPeriod;
-		double firstTime = midTime - 0.5 * soundPhysicalDuration + 0.5 * samplingPeriod;   // distribute the samples evenly over the time domain
-		for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
-			double eegEventTime = events -> t [ievent];
-			autoERPPoint event = Thing_new (ERPPoint);
-			event -> number = eegEventTime;
-			event -> erp = Sound_create (thy numberOfChannels, fromTime, toTime, numberOfSamples, samplingPeriod, firstTime);
-			double erpEventTime = 0.0;
-			double eegSample = 1 + (eegEventTime - my sound -> x1) / samplingPeriod;
-			double erpSample = 1 + (erpEventTime - firstTime) / samplingPeriod;
-			long sampleDifference = round (eegSample - erpSample);
-			for (long ichannel = 1; ichannel <= thy numberOfChannels; ichannel ++) {
-				for (long isample = 1; isample <= numberOfSamples; isample ++) {
-					long jsample = isample + sampleDifference;
-					event -> erp -> z [ichannel] [isample] = jsample < 1 || jsample > my sound -> nx ? 0.0 : my sound -> z [ichannel] [jsample];
-				}
-			}
-			Collection_addItem (thy events, event.transfer());
-		}
-		return thee.transfer();
+		return PointProcess_to_ERPTier (events, fromTime, toTime,
+			my numberOfChannels - EEG_getNumberOfExtraSensors (me), my channelNames, my sound -> x1, my sound -> dx,
+			EEG_readSamples, me);
+	} catch (MelderError) {
+		Melder_throw (me, ": ERP analysis not performed.");
+	}
+}
+
+static void LongEEG_readSamples (Any void_me, long numberOfChannels, long firstSample, long numberOfSamples, double **to) {
+	LongEEG_readChannels ((LongEEG) void_me, 1, numberOfChannels, firstSample, numberOfSamples, to);
+}
+
+static ERPTier LongEEG_PointProcess_to_ERPTier (LongEEG me, PointProcess events, double fromTime, double toTime) {
+	try {
+		return PointProcess_to_ERPTier (events, fromTime, toTime,
+			my numberOfChannels - LongEEG_getNumberOfExtraSensors (me), my channelNames, my x1, my dx,
+			LongEEG_readSamples, me);
 	} catch (MelderError) {
 		Melder_throw (me, ": ERP analysis not performed.");
 	}
@@ -201,6 +247,304 @@ ERPTier EEG_to_ERPTier_triggers_preceded (EEG me, double fromTime, double toTime
 	}
 }
 
+ERPTier LongEEG_to_ERPTier_bit (LongEEG me, double fromTime, double toTime, int markerBit) {
+	try {
+		autoPointProcess events = TextGrid_getStartingPoints (my textgrid, markerBit, kMelder_string_EQUAL_TO, L"1");
+		autoERPTier thee = LongEEG_PointProcess_to_ERPTier (me, events.peek(), fromTime, toTime);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERPTier not created.");
+	}
+}
+
+ERPTier LongEEG_to_ERPTier_marker (LongEEG me, double fromTime, double toTime, uint16_t marker) {
+	try {
+		autoPointProcess events = TextGrid_getStartingPoints_multiNumeric (my textgrid, marker);
+		autoERPTier thee = LongEEG_PointProcess_to_ERPTier (me, events.peek(), fromTime, toTime);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERPTier not created.");
+	}
+}
+
+ERPTier LongEEG_to_ERPTier_triggers (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion)
+{
+	try {
+		autoPointProcess events = TextGrid_getPoints (my textgrid, 2, which_Melder_STRING, criterion);
+		autoERPTier thee = LongEEG_PointProcess_to_ERPTier (me, events.peek(), fromTime, toTime);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERPTier not created.");
+	}
+}
+
+ERPTier LongEEG_to_ERPTier_triggers_preceded (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	int which_Melder_STRING_precededBy, const wchar_t *criterion_precededBy)
+{
+	try {
+		autoPointProcess events = TextGrid_getPoints_preceded (my textgrid, 2,
+			which_Melder_STRING, criterion,
+			which_Melder_STRING_precededBy, criterion_precededBy);
+		autoERPTier thee = LongEEG_PointProcess_to_ERPTier (me, events.peek(), fromTime, toTime);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERPTier not created.");
+	}
+}
+
+/*
+ * The epoch store: all epochs of all events in a single Sound with one channel per event and electrode,
+ * so that channel (ievent - 1) * numberOfChannels + ichannel is electrode ichannel of event ievent.
+ * Because the rows of a matrix are contiguous, this is one event-by-channel-by-sample buffer,
+ * and extraction, baseline subtraction, artefact rejection and averaging need no allocation per event.
+ * The results are identical to those of To ERPTier, Subtract baseline, Reject artefacts and To ERP (mean).
+ */
+Thing_define (ERPEpochs_Args, Thing) { public:
+	Sound epochs;
+	long numberOfEvents, numberOfChannels;
+	long *firstSamples;
+	ERPTier_readSamples readSamples;   // NULL if the epochs have already been read
+	Any source;
+	bool subtractBaseline;
+	double baselineFrom, baselineTo, rejectionThreshold;
+	bool *accepted;
+	double **mean;
+	long numberOfAcceptedEvents;
+	long *acceptedEvents;
+	bool isMainThread;
+	volatile long *next, *numberDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (ERPEpochs_Args, Thing, 0);
+
+MelderThread_MUTEX (epochsMutex);
+static bool epochsMutex_inited;
+
+static MelderThread_RETURN_TYPE ERPEpochs_processEvents (ERPEpochs_Args me) {
+	const long numberOfChannels = my numberOfChannels, numberOfSamples = my epochs -> nx;
+	for (;;) {
+		MelderThread_LOCK (epochsMutex);
+		long ievent = ++ *my next;
+		MelderThread_UNLOCK (epochsMutex);
+		if (ievent > my numberOfEvents || *my cancelled) break;
+		long offset = (ievent - 1) * numberOfChannels;
+		double **epoch = & my epochs -> z [offset];   // epoch [1..numberOfChannels] [1..numberOfSamples]
+		if (my readSamples)
+			my readSamples (my source, numberOfChannels, my firstSamples [ievent], numberOfSamples, epoch);
+		if (my subtractBaseline) {
+			for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+				double mean = Vector_getMean (my epochs, my baselineFrom, my baselineTo, offset + ichannel);
+				double *channel = epoch [ichannel];
+				for (long isample = 1; isample <= numberOfSamples; isample ++) {
+					channel [isample] -= mean;
+				}
+			}
+		}
+		my accepted [ievent] = true;
+		if (my rejectionThreshold > 0.0 && numberOfSamples >= 1) {
+			double minimum = epoch [1] [1];
+			double maximum = minimum;
+			for (long ichannel = 1; ichannel <= (numberOfChannels & ~ 15); ichannel ++) {
+				double *channel = epoch [ichannel];
+				for (long isample = 1; isample <= numberOfSamples; isample ++) {
+					double value = channel [isample];
+					if (value < minimum) minimum = value;
+					if (value > maximum) maximum = value;
+				}
+			}
+			if (minimum < - my rejectionThreshold || maximum > my rejectionThreshold)
+				my accepted [ievent] = false;
+		}
+		MelderThread_LOCK (epochsMutex);
+		long numberOfEventsDone = ++ *my numberDone;
+		MelderThread_UNLOCK (epochsMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress (0.9 * numberOfEventsDone / my numberOfEvents,
+					L"Processed ", Melder_integer (numberOfEventsDone), L" out of ", Melder_integer (my numberOfEvents), L" events");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+/*
+ * Averaging is parallel over electrodes; every electrode is summed in event order, as in ERPTier_to_ERP_mean.
+ */
+static MelderThread_RETURN_TYPE ERPEpochs_average (ERPEpochs_Args me) {
+	const long numberOfChannels = my numberOfChannels, numberOfSamples = my epochs -> nx;
+	const double factor = 1.0 / my numberOfAcceptedEvents;
+	for (;;) {
+		MelderThread_LOCK (epochsMutex);
+		long ichannel = ++ *my next;
+		MelderThread_UNLOCK (epochsMutex);
+		if (ichannel > numberOfChannels) break;
+		double *meanChannel = my mean [ichannel];
+		const double *firstChannel = my epochs -> z [(my acceptedEvents [1] - 1) * numberOfChannels + ichannel];
+		for (long isample = 1; isample <= numberOfSamples; isample ++) {
+			meanChannel [isample] = firstChannel [isample];
+		}
+		for (long ievent = 2; ievent <= my numberOfAcceptedEvents; ievent ++) {
+			const double *erpChannel = my epochs -> z [(my acceptedEvents [ievent] - 1) * numberOfChannels + ichannel];
+			for (long isample = 1; isample <= numberOfSamples; isample ++) {
+				meanChannel [isample] += erpChannel [isample];
+			}
+		}
+		for (long isample = 1; isample <= numberOfSamples; isample ++) {
+			meanChannel [isample] *= factor;
+		}
+	}
+	MelderThread_RETURN;
+}
+
+static ERP PointProcess_to_ERP_mean (PointProcess events, double fromTime, double toTime,
+	long numberOfChannels, wchar_t **channelNames, double x1, double samplingPeriod,
+	ERPTier_readSamples readSamples, Any source, bool readSamplesIsThreadSafe,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold)
+{
+	Melder_assert (numberOfChannels > 0);
+	long numberOfEvents = events -> nt;
+	if (numberOfEvents < 1)
+		Melder_throw ("No events.");
+	long numberOfSamples;
+	double firstTime;
+	getEpochSampling (fromTime, toTime, samplingPeriod, & numberOfSamples, & firstTime);
+	autoSound epochs = Sound_create (numberOfEvents * numberOfChannels, fromTime, toTime, numberOfSamples, samplingPeriod, firstTime);
+	autoNUMvector <long> firstSamples (1, numberOfEvents);
+	for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
+		firstSamples [ievent] = getFirstEpochSample (events -> t [ievent], x1, samplingPeriod, firstTime);
+	}
+	autoMelderProgress progress (L"Averaging epochs...");
+	if (! readSamplesIsThreadSafe) {
+		/*
+		 * The source cannot be read from several threads at a time (e.g. a file),
+		 * so the epochs are read here; the rest of the work is still parallel.
+		 */
+		for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
+			readSamples (source, numberOfChannels, firstSamples [ievent], numberOfSamples,
+				& epochs -> z [(ievent - 1) * numberOfChannels]);
+		}
+		readSamples = NULL;
+	}
+	autoNUMvector <bool> accepted (1, numberOfEvents);
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfEvents) numberOfThreads = numberOfEvents;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! epochsMutex_inited) { MelderThread_MUTEX_INIT (epochsMutex); epochsMutex_inited = true; }
+	autoERPEpochs_Args args [16];
+	volatile long next = 0, numberDone = 0;
+	volatile int cancelled = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoERPEpochs_Args arg = Thing_new (ERPEpochs_Args);
+		arg -> epochs = epochs.peek();
+		arg -> numberOfEvents = numberOfEvents;
+		arg -> numberOfChannels = numberOfChannels;
+		arg -> firstSamples = firstSamples.peek();
+		arg -> readSamples = readSamples;
+		arg -> source = source;
+		arg -> subtractBaseline = subtractBaseline;
+		arg -> baselineFrom = baselineFrom;
+		arg -> baselineTo = baselineTo;
+		arg -> rejectionThreshold = rejectionThreshold;
+		arg -> accepted = accepted.peek();
+		arg -> isMainThread = ithread == numberOfThreads;
+		arg -> next = & next;
+		arg -> numberDone = & numberDone;
+		arg -> cancelled = & cancelled;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (ERPEpochs_processEvents, args, numberOfThreads);
+
+	autoNUMvector <long> acceptedEvents (1, numberOfEvents);
+	long numberOfAcceptedEvents = 0;
+	for (long ievent = 1; ievent <= numberOfEvents; ievent ++) {
+		if (accepted [ievent]) acceptedEvents [++ numberOfAcceptedEvents] = ievent;
+	}
+	if (numberOfAcceptedEvents == 0)
+		Melder_throw ("All ", numberOfEvents, " events were rejected as artefacts.");
+	autoERP mean = Thing_new (ERP);
+	Matrix_init (mean.peek(), fromTime, toTime, numberOfSamples, samplingPeriod, firstTime, 1, numberOfChannels, numberOfChannels, 1, 1);
+	mean -> channelNames = NUMvector <wchar_t *> (1, numberOfChannels);
+	for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
+		mean -> channelNames [ichan] = Melder_wcsdup (channelNames [ichan]);
+	}
+	Melder_progress (0.95, L"Averaging ", Melder_integer (numberOfAcceptedEvents), L" events");
+	int numberOfAveragingThreads = numberOfThreads < numberOfChannels ? numberOfThreads : numberOfChannels;
+	next = 0;
+	for (int ithread = 1; ithread <= numberOfAveragingThreads; ithread ++) {
+		args [ithread - 1] -> mean = mean -> z;
+		args [ithread - 1] -> numberOfAcceptedEvents = numberOfAcceptedEvents;
+		args [ithread - 1] -> acceptedEvents = acceptedEvents.peek();
+	}
+	MelderThread_run (ERPEpochs_average, args, numberOfAveragingThreads);
+	return mean.transfer();
+}
+
+ERP EEG_to_ERP_mean_bit (EEG me, double fromTime, double toTime, int markerBit,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold)
+{
+	try {
+		autoPointProcess events = TextGrid_getStartingPoints (my textgrid, markerBit, kMelder_string_EQUAL_TO, L"1");
+		autoERP thee = PointProcess_to_ERP_mean (events.peek(), fromTime, toTime,
+			my numberOfChannels - EEG_getNumberOfExtraSensors (me), my channelNames, my sound -> x1, my sound -> dx,
+			EEG_readSamples, me, true, subtractBaseline, baselineFrom, baselineTo, rejectionThreshold);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERP not computed.");
+	}
+}
+
+ERP EEG_to_ERP_mean_triggers (EEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold)
+{
+	try {
+		autoPointProcess events = TextGrid_getPoints (my textgrid, 2, which_Melder_STRING, criterion);
+		autoERP thee = PointProcess_to_ERP_mean (events.peek(), fromTime, toTime,
+			my numberOfChannels - EEG_getNumberOfExtraSensors (me), my channelNames, my sound -> x1, my sound -> dx,
+			EEG_readSamples, me, true, subtractBaseline, baselineFrom, baselineTo, rejectionThreshold);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERP not computed.");
+	}
+}
+
+ERP LongEEG_to_ERP_mean_bit (LongEEG me, double fromTime, double toTime, int markerBit,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold)
+{
+	try {
+		autoPointProcess events = TextGrid_getStartingPoints (my textgrid, markerBit, kMelder_string_EQUAL_TO, L"1");
+		autoERP thee = PointProcess_to_ERP_mean (events.peek(), fromTime, toTime,
+			my numberOfChannels - LongEEG_getNumberOfExtraSensors (me), my channelNames, my x1, my dx,
+			LongEEG_readSamples, me, false, subtractBaseline, baselineFrom, baselineTo, rejectionThreshold);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERP not computed.");
+	}
+}
+
+ERP LongEEG_to_ERP_mean_triggers (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold)
+{
+	try {
+		autoPointProcess events = TextGrid_getPoints (my textgrid, 2, which_Melder_STRING, criterion);
+		autoERP thee = PointProcess_to_ERP_mean (events.peek(), fromTime, toTime,
+			my numberOfChannels - LongEEG_getNumberOfExtraSensors (me), my channelNames, my x1, my dx,
+			LongEEG_readSamples, me, false, subtractBaseline, baselineFrom, baselineTo, rejectionThreshold);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": ERP not computed.");
+	}
+}
+
 void ERPTier_subtractBaseline (ERPTier me, double tmin, double tmax) {
 	long numberOfEvents = my events -> size;
 	if (numberOfEvents < 1)
@@ -20,6 +20,7 @@
  */
 
 #include "EEG.h"
+#include "LongEEG.h"
 #include "ERP.h"
 
 #include "ERPTier_def.h"
@@ -51,5 +52,29 @@ ERPTier EEG_to_ERPTier_triggers_preceded (EEG me, double fromTime, double toTime
 	int which_Melder_STRING, const wchar_t *criterion,
 	int which_Melder_STRING_precededBy, const wchar_t *criterion_precededBy);
 
+ERPTier LongEEG_to_ERPTier_bit (LongEEG me, double fromTime, double toTime, int markerBit);
+ERPTier LongEEG_to_ERPTier_marker (LongEEG me, double fromTime, double toTime, uint16_t marker);
+ERPTier LongEEG_to_ERPTier_triggers (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion);
+ERPTier LongEEG_to_ERPTier_triggers_preceded (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	int which_Melder_STRING_precededBy, const wchar_t *criterion_precededBy);
+
+/*
+	To ERP (mean) in a single pass, without creating an ERPTier:
+	extract the epochs of all events into one buffer, optionally subtract the baseline (baselineFrom..baselineTo)
+	and reject the events whose cap electrodes exceed rejectionThreshold (if positive), then average.
+*/
+ERP EEG_to_ERP_mean_bit (EEG me, double fromTime, double toTime, int markerBit,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold);
+ERP EEG_to_ERP_mean_triggers (EEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold);
+ERP LongEEG_to_ERP_mean_bit (LongEEG me, double fromTime, double toTime, int markerBit,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold);
+ERP LongEEG_to_ERP_mean_triggers (LongEEG me, double fromTime, double toTime,
+	int which_Melder_STRING, const wchar_t *criterion,
+	bool subtractBaseline, double baselineFrom, double baselineTo, double rejectionThreshold);
+
 /* End of file ERPTier.h */
 #endif
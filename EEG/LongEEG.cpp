@@ -0,0 +1,499 @@
+/* LongEEG.cpp
+ *
+ * Copyright (C) 2011-2012,2014,2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LongEEG.h"
+
+#if ! defined (_WIN32)
+	#include <sys/mman.h>
+	#include <unistd.h>
+	#define LongEEG_USE_MMAP  1
+#else
+	#include <io.h>
+	#define LongEEG_USE_MMAP  0
+#endif
+
+Thing_implement (LongEEG, Sampled, 0);
+
+#define LongEEG_MAXIMUM_VIEW_SIZE  (64L * 1024 * 1024)   // bytes of data records mapped at the same time
+
+static void LongEEG_unmapView (LongEEG me) {
+	#if LongEEG_USE_MMAP
+		if (my mappedView) {
+			munmap (my mappedView, my mappedSize);
+			my mappedView = NULL;
+		}
+	#endif
+	my view = NULL;
+	my firstRecordInView = my lastRecordInView = 0;
+}
+
+void structLongEEG :: v_destroy () {
+	LongEEG_unmapView (this);
+	if (f) fclose (f);
+	NUMvector_free <unsigned char> (buffer, 0);
+	NUMvector_free <double> (factor, 1);
+	if (channelNames) {
+		for (long ichan = 1; ichan <= numberOfChannels; ichan ++)
+			Melder_free (channelNames [ichan]);
+		NUMvector_free <wchar_t *> (channelNames, 1);
+	}
+	forget (textgrid);
+	LongEEG_Parent :: v_destroy ();
+}
+
+void structLongEEG :: v_info () {
+	structData :: v_info ();
+	MelderInfo_writeLine (L"Duration: ", Melder_double (xmax - xmin), L" seconds");
+	MelderInfo_writeLine (L"File name: ", Melder_fileToPath (& file));
+	MelderInfo_writeLine (L"File type: ", is24bit ? L"BDF (24 bit)" : L"EDF (16 bit)");
+	MelderInfo_writeLine (L"Number of channels: ", Melder_integer (numberOfChannels));
+	MelderInfo_writeLine (L"Sampling frequency: ", Melder_double (1.0 / dx), L" Hz");
+	MelderInfo_writeLine (L"Size: ", Melder_integer (nx), L" samples");
+	MelderInfo_writeLine (L"Number of data records: ", Melder_integer (numberOfDataRecords));
+	MelderInfo_writeLine (L"Number of samples per data record: ", Melder_integer (numberOfSamplesPerDataRecord));
+}
+
+/*
+ * The standard electrode positions of the BioSemi 32-channel and 64-channel caps.
+ */
+static const wchar_t *biosemi32 [1+32] = { NULL,
+	L"Fp1", L"AF3", L"F7", L"F3", L"FC1", L"FC5", L"T7", L"C3", L"CP1", L"CP5", L"P7", L"P3", L"Pz", L"PO3", L"O1", L"Oz",
+	L"O2", L"PO4", L"P4", L"P8", L"CP6", L"CP2", L"C4", L"T8", L"FC6", L"FC2", L"F4", L"F8", L"AF4", L"Fp2", L"Fz", L"Cz" };
+static const wchar_t *biosemi64 [1+64] = { NULL,
+	L"Fp1", L"AF7", L"AF3", L"F1", L"F3", L"F5", L"F7", L"FT7", L"FC5", L"FC3", L"FC1", L"C1", L"C3", L"C5", L"T7", L"TP7",
+	L"CP5", L"CP3", L"CP1", L"P1", L"P3", L"P5", L"P7", L"P9", L"PO7", L"PO3", L"O1", L"Iz", L"Oz", L"POz", L"Pz", L"CPz",
+	L"Fpz", L"Fp2", L"AF8", L"AF4", L"AFz", L"Fz", L"F2", L"F4", L"F6", L"F8", L"FT8", L"FC6", L"FC4", L"FC2", L"FCz", L"Cz",
+	L"C2", L"C4", L"C6", L"T8", L"TP8", L"CP6", L"CP4", L"CP2", L"P2", L"P4", L"P6", L"P8", L"P10", L"PO8", L"PO4", L"O2" };
+
+static const char *headerField (const char *header, long offset, int length, char *buffer) {
+	memcpy (buffer, header + offset, length);
+	buffer [length] = '\0';
+	return buffer;
+}
+
+/*
+ * Returns a pointer to the bytes of the channels fromChannel .. toChannel in data record `record`.
+ * With memory mapping, a window of whole data records is mapped and the pointer points into it;
+ * otherwise, only the requested channels of the one record are read into a buffer.
+ */
+static const unsigned char * LongEEG_peekRecord (LongEEG me, long record, long fromChannel, long toChannel) {
+	long numberOfBytesPerChannel = my numberOfBytesPerDataRecord / my numberOfChannels;
+	#if LongEEG_USE_MMAP
+		if (my view == NULL || record < my firstRecordInView || record > my lastRecordInView) {
+			LongEEG_unmapView (me);
+			long lastRecord = record + my maximumNumberOfRecordsInView - 1;
+			if (lastRecord > my numberOfDataRecords) lastRecord = my numberOfDataRecords;
+			static long pageSize = 0;
+			if (pageSize == 0) pageSize = sysconf (_SC_PAGESIZE);
+			int64_t offset = my startOfData + (int64_t) (record - 1) * my numberOfBytesPerDataRecord;
+			int64_t alignedOffset = offset - offset % pageSize;
+			size_t size = (size_t) (offset - alignedOffset) + (size_t) (lastRecord - record + 1) * my numberOfBytesPerDataRecord;
+			void *mapping = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fileno (my f), (off_t) alignedOffset);
+			if (mapping != MAP_FAILED) {
+				my mappedView = (unsigned char *) mapping;
+				my mappedSize = size;
+				my view = my mappedView + (offset - alignedOffset);
+				my firstRecordInView = record;
+				my lastRecordInView = lastRecord;
+			}
+		}
+		if (my view)
+			return my view + (record - my firstRecordInView) * my numberOfBytesPerDataRecord + (fromChannel - 1) * numberOfBytesPerChannel;
+	#endif
+	/*
+	 * No mapping available: read.
+	 */
+	if (my buffer == NULL)
+		my buffer = NUMvector <unsigned char> (0, my numberOfBytesPerDataRecord - 1);
+	size_t numberOfBytes = (toChannel - fromChannel + 1) * numberOfBytesPerChannel;
+	if (fseeko (my f, my startOfData + (int64_t) (record - 1) * my numberOfBytesPerDataRecord + (fromChannel - 1) * numberOfBytesPerChannel, SEEK_SET) ||
+	    fread (& my buffer [0], 1, numberOfBytes, my f) < numberOfBytes)
+		Melder_throw ("Cannot read data record ", record, " from EEG file ", & my file, ".");
+	return & my buffer [0];
+}
+
+static void decode24 (const unsigned char *p, long numberOfSamples, double factor, double *to) {
+	for (long i = 0; i < numberOfSamples; i ++, p += 3) {
+		int32_t value = (int32_t) (((uint32_t) p [0] << 8) | ((uint32_t) p [1] << 16) | ((uint32_t) p [2] << 24)) >> 8;   // sign-extended
+		to [i] = value * factor;
+	}
+}
+
+static void decode16 (const unsigned char *p, long numberOfSamples, double factor, double *to) {
+	for (long i = 0; i < numberOfSamples; i ++, p += 2) {
+		int16_t value = (int16_t) (uint16_t) (((uint16_t) p [1] << 8) | (uint16_t) p [0]);
+		to [i] = value * factor;
+	}
+}
+
+void LongEEG_readChannels (LongEEG me, long fromChannel, long toChannel, long firstSample, long numberOfSamples, double **to) {
+	Melder_assert (fromChannel >= 1 && fromChannel <= toChannel && toChannel <= my numberOfChannels);
+	long lastSample = firstSample + numberOfSamples - 1;
+	long imin = firstSample < 1 ? 1 : firstSample, imax = lastSample > my nx ? my nx : lastSample;
+	/*
+	 * Samples outside the file are zero.
+	 */
+	for (long ichan = 1; ichan <= toChannel - fromChannel + 1; ichan ++) {
+		for (long isamp = firstSample; isamp < imin && isamp <= lastSample; isamp ++)
+			to [ichan] [isamp - firstSample + 1] = 0.0;
+		for (long isamp = imax + 1 > firstSample ? imax + 1 : firstSample; isamp <= lastSample; isamp ++)
+			to [ichan] [isamp - firstSample + 1] = 0.0;
+	}
+	if (imin > imax) return;
+	long numberOfSamplesPerDataRecord = my numberOfSamplesPerDataRecord;
+	long numberOfBytesPerChannel = my numberOfBytesPerDataRecord / my numberOfChannels;
+	int numberOfBytesPerSample = my is24bit ? 3 : 2;
+	long firstRecord = (imin - 1) / numberOfSamplesPerDataRecord + 1, lastRecord = (imax - 1) / numberOfSamplesPerDataRecord + 1;
+	for (long irecord = firstRecord; irecord <= lastRecord; irecord ++) {
+		long offset = (irecord - 1) * numberOfSamplesPerDataRecord;   // number of samples before this record
+		long i1 = imin > offset + 1 ? imin - offset : 1;
+		long i2 = imax < offset + numberOfSamplesPerDataRecord ? imax - offset : numberOfSamplesPerDataRecord;
+		const unsigned char *record = LongEEG_peekRecord (me, irecord, fromChannel, toChannel);
+		for (long ichan = fromChannel; ichan <= toChannel; ichan ++) {
+			const unsigned char *p = record + (ichan - fromChannel) * numberOfBytesPerChannel + (i1 - 1) * numberOfBytesPerSample;
+			double *q = & to [ichan - fromChannel + 1] [offset + i1 - firstSample + 1];
+			if (my is24bit)
+				decode24 (p, i2 - i1 + 1, my factor [ichan], q);
+			else
+				decode16 (p, i2 - i1 + 1, my factor [ichan], q);
+		}
+	}
+}
+
+/*
+ * The marks are in the status channel (the last one).
+ * It is decoded only once, record by record, into integers;
+ * these take 4 / (3 * numberOfChannels) of the size of a BDF file.
+ */
+static TextGrid LongEEG_readMarks (LongEEG me, bool hasLetters) {
+	long numberOfSamplesPerDataRecord = my numberOfSamplesPerDataRecord;
+	autoNUMvector <double> record (1, numberOfSamplesPerDataRecord);
+	double *statusChannel [1+1] = { NULL, record.peek() };
+	autoNUMvector <int32_t> status (1, my nx);
+	int numberOfStatusBits = 8;
+	for (long irecord = 1; irecord <= my numberOfDataRecords; irecord ++) {
+		long offset = (irecord - 1) * numberOfSamplesPerDataRecord;
+		LongEEG_readChannels (me, my numberOfChannels, my numberOfChannels, offset + 1, numberOfSamplesPerDataRecord, statusChannel);
+		for (long isamp = 1; isamp <= numberOfSamplesPerDataRecord; isamp ++) {
+			status [offset + isamp] = (int32_t) record [isamp];
+			if (status [offset + isamp] & 0x0000FF00) {
+				numberOfStatusBits = 16;
+			}
+		}
+	}
+	autoTextGrid thee;
+	if (hasLetters) {
+		thee.reset (TextGrid_create (my xmin, my xmax, L"Mark Trigger", L"Mark Trigger"));
+		autoMelderString letters;
+		double time = NUMundefined;
+		for (long i = 1; i <= my nx; i ++) {
+			unsigned long value = (long) status [i];
+			for (int byte = 1; byte <= numberOfStatusBits / 8; byte ++) {
+				unsigned long mask = byte == 1 ? 0x000000ff : 0x0000ff00;
+				wchar_t kar = byte == 1 ? (value & mask) : (value & mask) >> 8;
+				if (kar != '\0' && kar != 20) {
+					MelderString_appendCharacter (& letters, kar);
+				} else if (letters. string [0] != '\0') {
+					if (letters. string [0] == '+') {
+						if (NUMdefined (time)) {
+							try {
+								TextGrid_insertPoint (thee.peek(), 1, time, L"");
+							} catch (MelderError) {
+								Melder_throw ("Did not insert empty mark (", letters. string, ") on Mark tier.");
+							}
+							time = NUMundefined;   // defensive
+						}
+						time = Melder_atof (& letters. string [1]);
+						MelderString_empty (& letters);
+					} else {
+						if (! NUMdefined (time)) {
+							Melder_throw ("Undefined time for label at sample ", i, ".");
+						}
+						try {
+							if (Melder_wcsnequ (letters. string, L"Trigger-", 8)) {
+								try {
+									TextGrid_insertPoint (thee.peek(), 2, time, & letters. string [8]);
+								} catch (MelderError) {
+									Melder_clearError ();
+									trace ("Duplicate trigger at %f seconds: %ls", time, & letters. string [8]);
+								}
+							} else {
+								TextGrid_insertPoint (thee.peek(), 1, time, & letters. string [0]);
+							}
+						} catch (MelderError) {
+							Melder_throw ("Did not insert mark (", letters. string, ") on Trigger tier.");
+						}
+						time = NUMundefined;   // crucial
+						MelderString_empty (& letters);
+					}
+				}
+			}
+		}
+		if (NUMdefined (time)) {
+			TextGrid_insertPoint (thee.peek(), 1, time, L"");
+			time = NUMundefined;   // defensive
+		}
+	} else {
+		thee.reset (TextGrid_create (my xmin, my xmax,
+			numberOfStatusBits == 8 ? L"S1 S2 S3 S4 S5 S6 S7 S8" : L"S1 S2 S3 S4 S5 S6 S7 S8 S9 S10 S11 S12 S13 S14 S15 S16", L""));
+		unsigned long previousValue = 0;
+		for (long i = 1; i <= my nx; i ++) {
+			unsigned long thisValue = (long) status [i];
+			if (thisValue != previousValue) {
+				for (int bit = 1; bit <= numberOfStatusBits; bit ++) {
+					unsigned long bitValue = 1 << (bit - 1);
+					if ((thisValue & bitValue) != (previousValue & bitValue)) {
+						IntervalTier tier = (IntervalTier) thy tiers -> item [bit];
+						double time = i == 1 ? 0.0 : my x1 + (i - 1.5) * my dx;
+						if (time != 0.0)
+							TextGrid_insertBoundary (thee.peek(), bit, time);
+						if ((thisValue & bitValue) != 0)
+							TextGrid_setIntervalText (thee.peek(), bit, tier -> intervals -> size, L"1");
+					}
+				}
+			}
+			previousValue = thisValue;
+		}
+	}
+	return thee.transfer();
+}
+
+static void LongEEG_init (LongEEG me, MelderFile file) {
+	MelderFile_copy (file, & my file);
+	my f = Melder_fopen (file, "rb");
+	char header [256], buffer [81];
+	if (fread (header, 1, 256, my f) < 256)
+		Melder_throw ("File too short for a BDF or EDF header.");
+	my is24bit = header [0] == (char) 255;
+	trace ("Local subject identification: \"%s\"", headerField (header, 8, 80, buffer));
+	trace ("Local recording identification: \"%s\"", headerField (header, 88, 80, buffer));
+	trace ("Start date of recording: \"%s\"", headerField (header, 168, 8, buffer));
+	trace ("Start time of recording: \"%s\"", headerField (header, 176, 8, buffer));
+	long numberOfBytesInHeaderRecord = atol (headerField (header, 184, 8, buffer));
+	trace ("Number of bytes in header record: %ld", numberOfBytesInHeaderRecord);
+	trace ("Version of data format: \"%s\"", headerField (header, 192, 44, buffer));
+	my numberOfDataRecords = strtol (headerField (header, 236, 8, buffer), NULL, 10);
+	trace ("Number of data records: %ld", my numberOfDataRecords);
+	double durationOfDataRecord = atof (headerField (header, 244, 8, buffer));
+	trace ("Duration of a data record: \"%f\"", durationOfDataRecord);
+	long numberOfChannels = atol (headerField (header, 252, 4, buffer));
+	trace ("Number of channels in data record: %ld", numberOfChannels);
+	if (numberOfBytesInHeaderRecord != (numberOfChannels + 1) * 256)
+		Melder_throw ("Number of bytes in header record (", numberOfBytesInHeaderRecord,
+			") doesn't match number of channels (", numberOfChannels, ").");
+	if (numberOfChannels < 1)
+		Melder_throw ("No channels.");
+	/*
+	 * The channel headers are stored field by field: first all labels, then all transducer types, and so on.
+	 */
+	autoNUMvector <char> channelHeader (0L, numberOfChannels * 256 - 1);
+	if (fread (& channelHeader [0], 1, numberOfChannels * 256, my f) < (size_t) numberOfChannels * 256)
+		Melder_throw ("File too short for the channel headers.");
+	const char *labels = & channelHeader [0];
+	const char *physicalMinima = labels + numberOfChannels * (16 + 80 + 8);
+	const char *digitalMinima = physicalMinima + numberOfChannels * (8 + 8);
+	const char *numbersOfSamples = digitalMinima + numberOfChannels * (8 + 8 + 80);
+	my channelNames = NUMvector <wchar_t *> (1, numberOfChannels);
+	my numberOfChannels = numberOfChannels;
+	for (long ichannel = 1; ichannel <= numberOfChannels; ichannel ++) {
+		headerField (labels, (ichannel - 1) * 16, 16, buffer);
+		/*
+		 * Strip all final spaces.
+		 */
+		for (int i = 15; i >= 0; i --) {
+			if (buffer [i] == ' ') {
+				buffer [i] = '\0';
+			} else {
+				break;
+			}
+		}
+		my channelNames [ichannel] = Melder_wcsdup (Melder_peekUtf8ToWcs (buffer));
+		trace ("Channel <<%ls>>", my channelNames [ichannel]);
+	}
+	bool hasLetters = wcsequ (my channelNames [numberOfChannels], L"EDF Annotations");
+	double samplingFrequency = NUMundefined;
+	long numberOfSamplesPerDataRecord = 0;
+	for (long channel = 1; channel <= numberOfChannels; channel ++) {
+		long numberOfSamplesInThisDataRecord = atol (headerField (numbersOfSamples, (channel - 1) * 8, 8, buffer));
+		if (samplingFrequency == NUMundefined) {
+			numberOfSamplesPerDataRecord = numberOfSamplesInThisDataRecord;
+			samplingFrequency = numberOfSamplesInThisDataRecord / durationOfDataRecord;
+		}
+		if (numberOfSamplesInThisDataRecord / durationOfDataRecord != samplingFrequency)
+			Melder_throw (L"Number of samples per data record in channel ", channel,
+				" (", numberOfSamplesInThisDataRecord,
+				") doesn't match sampling frequency of channel 1 (", samplingFrequency, ").");
+	}
+	if (numberOfSamplesPerDataRecord < 1 || my numberOfDataRecords < 1)
+		Melder_throw ("No data records.");
+	my factor = NUMvector <double> (1, numberOfChannels);
+	for (long channel = 1; channel <= numberOfChannels; channel ++) {
+		double physicalMinimum = atof (headerField (physicalMinima, (channel - 1) * 8, 8, buffer));
+		double digitalMinimum = atof (headerField (digitalMinima, (channel - 1) * 8, 8, buffer));
+		my factor [channel] = channel == numberOfChannels ? 1.0 : physicalMinimum / digitalMinimum;
+		if (channel < numberOfChannels - LongEEG_getNumberOfExtraSensors (me)) my factor [channel] /= 1000000.0;
+	}
+	my numberOfSamplesPerDataRecord = numberOfSamplesPerDataRecord;
+	my numberOfBytesPerDataRecord = numberOfChannels * numberOfSamplesPerDataRecord * (my is24bit ? 3 : 2);
+	my startOfData = numberOfBytesInHeaderRecord;
+	if (fseeko (my f, 0, SEEK_END) < 0)
+		Melder_throw ("Cannot count the bytes in the file.");
+	int64_t fileSize = ftello (my f);
+	if (fileSize < my startOfData + (int64_t) my numberOfDataRecords * my numberOfBytesPerDataRecord)
+		Melder_throw ("File too short: expected ", my numberOfDataRecords, " data records of ", my numberOfBytesPerDataRecord, " bytes.");
+	my maximumNumberOfRecordsInView = LongEEG_MAXIMUM_VIEW_SIZE / my numberOfBytesPerDataRecord;
+	if (my maximumNumberOfRecordsInView < 1) my maximumNumberOfRecordsInView = 1;
+	/*
+	 * Time domain, as in Sound_createSimple.
+	 */
+	double duration = my numberOfDataRecords * durationOfDataRecord;
+	Sampled_init (me, 0.0, duration, my numberOfDataRecords * numberOfSamplesPerDataRecord,
+		1 / samplingFrequency, 0.5 / samplingFrequency);
+	my textgrid = LongEEG_readMarks (me, hasLetters);
+	if (LongEEG_getNumberOfCapElectrodes (me) == 32 || LongEEG_getNumberOfCapElectrodes (me) == 64) {
+		const wchar_t **names = LongEEG_getNumberOfCapElectrodes (me) == 32 ? biosemi32 : biosemi64;
+		for (long ichannel = 1; ichannel <= LongEEG_getNumberOfCapElectrodes (me); ichannel ++) {
+			Melder_free (my channelNames [ichannel]);
+			my channelNames [ichannel] = Melder_wcsdup (names [ichannel]);
+		}
+	}
+}
+
+void structLongEEG :: v_copy (thou) {
+	thouart (LongEEG);
+	/*
+	 * The header and the marks are copied rather than read again.
+	 * The copy reads the same open file, through a descriptor of its own
+	 * (the view into the file is not shared: each LongEEG maps its own window).
+	 */
+	LongEEG_Parent :: v_copy (thee);
+	MelderFile_copy (& file, & thy file);
+	#if defined (_WIN32)
+		int descriptor = _dup (_fileno (f));
+		thy f = descriptor == -1 ? NULL : _fdopen (descriptor, "rb");
+	#else
+		int descriptor = dup (fileno (f));
+		thy f = descriptor == -1 ? NULL : fdopen (descriptor, "rb");
+	#endif
+	if (thy f == NULL)
+		Melder_throw ("Cannot read EEG file ", & file, " a second time.");
+	thy numberOfChannels = numberOfChannels;
+	thy channelNames = NUMvector <wchar_t *> (1, numberOfChannels);
+	for (long ichan = 1; ichan <= numberOfChannels; ichan ++)
+		thy channelNames [ichan] = Melder_wcsdup (channelNames [ichan]);
+	thy textgrid = Data_copy (textgrid);
+	thy is24bit = is24bit;
+	thy numberOfDataRecords = numberOfDataRecords;
+	thy numberOfSamplesPerDataRecord = numberOfSamplesPerDataRecord;
+	thy numberOfBytesPerDataRecord = numberOfBytesPerDataRecord;
+	thy startOfData = startOfData;
+	thy factor = NUMvector_copy <double> (factor, 1, numberOfChannels);
+	thy maximumNumberOfRecordsInView = maximumNumberOfRecordsInView;
+}
+
+LongEEG LongEEG_open (MelderFile file) {
+	try {
+		autoLongEEG me = Thing_new (LongEEG);
+		LongEEG_init (me.peek(), file);
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw ("LongEEG not created from ", file, ".");
+	}
+}
+
+long LongEEG_getChannelNumber (LongEEG me, const wchar_t *channelName) {
+	for (long ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+		if (Melder_wcsequ (my channelNames [ichan], channelName)) {
+			return ichan;
+		}
+	}
+	return 0;
+}
+
+static EEG LongEEG_createEEG (LongEEG me, double tmin, double tmax, long fromChannel, long toChannel) {
+	autoEEG thee = EEG_create (tmin, tmax);
+	thy numberOfChannels = toChannel - fromChannel + 1;
+	thy channelNames = NUMvector <wchar_t *> (1, thy numberOfChannels);
+	for (long ichan = 1; ichan <= thy numberOfChannels; ichan ++) {
+		thy channelNames [ichan] = Melder_wcsdup (my channelNames [fromChannel + ichan - 1]);
+	}
+	return thee.transfer();
+}
+
+EEG LongEEG_to_EEG (LongEEG me) {
+	try {
+		autoEEG thee = LongEEG_createEEG (me, my xmin, my xmax, 1, my numberOfChannels);
+		thy sound = Sound_create (my numberOfChannels, my xmin, my xmax, my nx, my dx, my x1);
+		LongEEG_readChannels (me, 1, my numberOfChannels, 1, my nx, thy sound -> z);
+		thy textgrid = Data_copy (my textgrid);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": not converted to EEG.");
+	}
+}
+
+EEG LongEEG_extractChannel (LongEEG me, long channelNumber) {
+	try {
+		if (channelNumber < 1 || channelNumber > my numberOfChannels)
+			Melder_throw ("No channel ", channelNumber, ".");
+		autoEEG thee = LongEEG_createEEG (me, my xmin, my xmax, channelNumber, channelNumber);
+		thy sound = Sound_create (1, my xmin, my xmax, my nx, my dx, my x1);
+		LongEEG_readChannels (me, channelNumber, channelNumber, 1, my nx, thy sound -> z);
+		thy textgrid = Data_copy (my textgrid);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": channel ", channelNumber, " not extracted.");
+	}
+}
+
+EEG LongEEG_extractChannel (LongEEG me, const wchar_t *channelName) {
+	try {
+		long channelNumber = LongEEG_getChannelNumber (me, channelName);
+		if (channelNumber == 0)
+			Melder_throw ("No channel named \"", channelName, "\".");
+		return LongEEG_extractChannel (me, channelNumber);
+	} catch (MelderError) {
+		Melder_throw (me, ": channel ", channelName, " not extracted.");
+	}
+}
+
+EEG LongEEG_extractPart (LongEEG me, double tmin, double tmax, bool preserveTimes) {
+	try {
+		/*
+		 * Select the samples as Sound_extractPart does with a rectangular window.
+		 */
+		double t1 = tmin, t2 = tmax;
+		if (t1 == t2) { t1 = my xmin; t2 = my xmax; };
+		long ix1 = 1 + (long) ceil ((t1 - my x1) / my dx);
+		long ix2 = 1 + (long) floor ((t2 - my x1) / my dx);
+		if (ix2 < ix1) Melder_throw ("Extracted Sound would contain no samples.");
+		autoEEG thee = LongEEG_createEEG (me, my xmin, my xmax, 1, my numberOfChannels);
+		thy sound = Sound_create (my numberOfChannels, t1, t2, ix2 - ix1 + 1, my dx, my x1 + (ix1 - 1) * my dx);
+		if (! preserveTimes) { thy sound -> xmin = 0.0; thy sound -> xmax -= t1; thy sound -> x1 -= t1; }
+		LongEEG_readChannels (me, 1, my numberOfChannels, ix1, ix2 - ix1 + 1, thy sound -> z);
+		thy textgrid = TextGrid_extractPart (my textgrid, tmin, tmax, preserveTimes);
+		thy xmin = thy textgrid -> xmin;
+		thy xmax = thy textgrid -> xmax;
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": part not extracted.");
+	}
+}
+
+/* End of file LongEEG.cpp */
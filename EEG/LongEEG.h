@@ -0,0 +1,79 @@
+#ifndef _LongEEG_h_
+#define _LongEEG_h_
+/* LongEEG.h
+ *
+ * Copyright (C) 2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "EEG.h"
+
+/*
+ * A LongEEG is a BDF or EDF file that stays on disk.
+ * Only the header and the marks (status channel) are read when the file is opened;
+ * the data records are mapped into memory (or read, if mapping is not available) one window at a time,
+ * and only the requested channels and samples are decoded.
+ */
+Thing_define (LongEEG, Sampled) {
+	structMelderFile file;
+	FILE *f;
+	long numberOfChannels;
+	wchar_t **channelNames;
+	TextGrid textgrid;
+	bool is24bit;
+	long numberOfDataRecords, numberOfSamplesPerDataRecord, numberOfBytesPerDataRecord;
+	int64_t startOfData;
+	double *factor;
+	long firstRecordInView, lastRecordInView, maximumNumberOfRecordsInView;
+	unsigned char *view, *mappedView, *buffer;
+	size_t mappedSize;
+
+	void v_destroy ()
+		override;
+	void v_info ()
+		override;
+	void v_copy (Any data_to)
+		override;
+	bool v_writable ()
+		override { return false; }
+	int v_domainQuantity ()
+		override { return MelderQuantity_TIME_SECONDS; }
+};
+
+LongEEG LongEEG_open (MelderFile file);
+
+static inline long LongEEG_getNumberOfCapElectrodes (LongEEG me) {
+	return (my numberOfChannels - 1) & ~ 15L;   // BUG, as in EEG
+}
+static inline long LongEEG_getNumberOfExtraSensors (LongEEG me) {
+	return my numberOfChannels == 1 ? 0 : my numberOfChannels & 1 ? 1 : 8;   // BUG, as in EEG
+}
+long LongEEG_getChannelNumber (LongEEG me, const wchar_t *channelName);
+
+void LongEEG_readChannels (LongEEG me, long fromChannel, long toChannel, long firstSample, long numberOfSamples, double **to);
+/*
+	Decodes the samples firstSample .. firstSample + numberOfSamples - 1 of the channels fromChannel .. toChannel
+	into to [1 .. toChannel - fromChannel + 1] [1 .. numberOfSamples].
+	Samples outside 1 .. my nx are set to zero.
+*/
+
+EEG LongEEG_extractPart (LongEEG me, double tmin, double tmax, bool preserveTimes);
+EEG LongEEG_extractChannel (LongEEG me, long channelNumber);
+EEG LongEEG_extractChannel (LongEEG me, const wchar_t *channelName);
+EEG LongEEG_to_EEG (LongEEG me);
+
+/* End of file LongEEG.h */
+#endif
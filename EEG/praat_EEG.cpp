@@ -221,6 +221,49 @@ DO
 	}
 END
 
+FORM (EEG_to_ERP_mean_bit, L"To ERP (mean, bit)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	NATURAL (L"Marker bit", L"8")
+	BOOLEAN (L"Subtract baseline", 1)
+	REAL (L"left Baseline range (s)", L"-0.11")
+	REAL (L"right Baseline range (s)", L"0.0")
+	REAL (L"Rejection threshold (V)", L"75e-6")
+	LABEL (L"", L"(0 = no artefact rejection)")
+	OK
+DO
+	LOOP {
+		iam (EEG);
+		int markerBit = GET_INTEGER (L"Marker bit");
+		autoERP thee = EEG_to_ERP_mean_bit (me, GET_REAL (L"From time"), GET_REAL (L"To time"), markerBit,
+			GET_INTEGER (L"Subtract baseline"), GET_REAL (L"left Baseline range"), GET_REAL (L"right Baseline range"),
+			GET_REAL (L"Rejection threshold"));
+		praat_new (thee.transfer(), my name, L"_bit", Melder_integer (markerBit));
+	}
+END
+
+FORM (EEG_to_ERP_mean_triggers, L"To ERP (mean, triggers)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	OPTIONMENU_ENUM (L"Get every event with a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (L"...the text", L"1")
+	BOOLEAN (L"Subtract baseline", 1)
+	REAL (L"left Baseline range (s)", L"-0.11")
+	REAL (L"right Baseline range (s)", L"0.0")
+	REAL (L"Rejection threshold (V)", L"75e-6")
+	LABEL (L"", L"(0 = no artefact rejection)")
+	OK
+DO
+	LOOP {
+		iam (EEG);
+		autoERP thee = EEG_to_ERP_mean_triggers (me, GET_REAL (L"From time"), GET_REAL (L"To time"),
+			GET_ENUM (kMelder_string, L"Get every event with a trigger that"), GET_STRING (L"...the text"),
+			GET_INTEGER (L"Subtract baseline"), GET_REAL (L"left Baseline range"), GET_REAL (L"right Baseline range"),
+			GET_REAL (L"Rejection threshold"));
+		praat_new (thee.transfer(), my name, L"_trigger", GET_STRING (L"...the text"));
+	}
+END
+
 FORM (EEG_to_ERPTier_bit, L"To ERPTier (bit)", 0)
 	REAL (L"From time (s)", L"-0.11")
 	REAL (L"To time (s)", L"0.39")
@@ -769,6 +812,150 @@ DO
 	praat_new (thee.transfer(), erpTier -> name);
 END
 
+/***** LongEEG *****/
+
+FORM (LongEEG_extractChannel, L"LongEEG: Extract channel", 0)
+	SENTENCE (L"Channel name", L"Cz")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		const wchar_t *channelName = GET_STRING (L"Channel name");
+		autoEEG thee = LongEEG_extractChannel (me, channelName);
+		praat_new (thee.transfer(), my name, L"_", channelName);
+	}
+END
+
+FORM (LongEEG_extractPart, L"LongEEG: Extract part", 0)
+	REAL (L"left Time range (s)", L"0.0")
+	REAL (L"right Time range (s)", L"1.0")
+	BOOLEAN (L"Preserve times", 0)
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		autoEEG thee = LongEEG_extractPart (me, GET_REAL (L"left Time range"), GET_REAL (L"right Time range"), GET_INTEGER (L"Preserve times"));
+		praat_new (thee.transfer(), my name, L"_part");
+	}
+END
+
+FORM_READ (LongEEG_open, L"Open long EEG file", 0, true)
+	autoLongEEG me = LongEEG_open (file);
+	praat_new (me.transfer(), MelderFile_name (file));
+END
+
+DIRECT (LongEEG_to_EEG)
+	LOOP {
+		iam (LongEEG);
+		autoEEG thee = LongEEG_to_EEG (me);
+		praat_new (thee.transfer(), my name);
+	}
+END
+
+FORM (LongEEG_to_ERP_mean_bit, L"To ERP (mean, bit)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	NATURAL (L"Marker bit", L"8")
+	BOOLEAN (L"Subtract baseline", 1)
+	REAL (L"left Baseline range (s)", L"-0.11")
+	REAL (L"right Baseline range (s)", L"0.0")
+	REAL (L"Rejection threshold (V)", L"75e-6")
+	LABEL (L"", L"(0 = no artefact rejection)")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		int markerBit = GET_INTEGER (L"Marker bit");
+		autoERP thee = LongEEG_to_ERP_mean_bit (me, GET_REAL (L"From time"), GET_REAL (L"To time"), markerBit,
+			GET_INTEGER (L"Subtract baseline"), GET_REAL (L"left Baseline range"), GET_REAL (L"right Baseline range"),
+			GET_REAL (L"Rejection threshold"));
+		praat_new (thee.transfer(), my name, L"_bit", Melder_integer (markerBit));
+	}
+END
+
+FORM (LongEEG_to_ERP_mean_triggers, L"To ERP (mean, triggers)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	OPTIONMENU_ENUM (L"Get every event with a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (L"...the text", L"1")
+	BOOLEAN (L"Subtract baseline", 1)
+	REAL (L"left Baseline range (s)", L"-0.11")
+	REAL (L"right Baseline range (s)", L"0.0")
+	REAL (L"Rejection threshold (V)", L"75e-6")
+	LABEL (L"", L"(0 = no artefact rejection)")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		autoERP thee = LongEEG_to_ERP_mean_triggers (me, GET_REAL (L"From time"), GET_REAL (L"To time"),
+			GET_ENUM (kMelder_string, L"Get every event with a trigger that"), GET_STRING (L"...the text"),
+			GET_INTEGER (L"Subtract baseline"), GET_REAL (L"left Baseline range"), GET_REAL (L"right Baseline range"),
+			GET_REAL (L"Rejection threshold"));
+		praat_new (thee.transfer(), my name, L"_trigger", GET_STRING (L"...the text"));
+	}
+END
+
+FORM (LongEEG_to_ERPTier_bit, L"To ERPTier (bit)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	NATURAL (L"Marker bit", L"8")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		int markerBit = GET_INTEGER (L"Marker bit");
+		autoERPTier thee = LongEEG_to_ERPTier_bit (me, GET_REAL (L"From time"), GET_REAL (L"To time"), markerBit);
+		praat_new (thee.transfer(), my name, L"_bit", Melder_integer (markerBit));
+	}
+END
+
+FORM (LongEEG_to_ERPTier_marker, L"To ERPTier (marker)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	NATURAL (L"Marker number", L"12")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		uint16_t markerNumber = GET_INTEGER (L"Marker number");
+		autoERPTier thee = LongEEG_to_ERPTier_marker (me, GET_REAL (L"From time"), GET_REAL (L"To time"), markerNumber);
+		praat_new (thee.transfer(), my name, L"_", Melder_integer (markerNumber));
+	}
+END
+
+FORM (LongEEG_to_ERPTier_triggers, L"To ERPTier (triggers)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	OPTIONMENU_ENUM (L"Get every event with a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (L"...the text", L"1")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		autoERPTier thee = LongEEG_to_ERPTier_triggers (me, GET_REAL (L"From time"), GET_REAL (L"To time"),
+			GET_ENUM (kMelder_string, L"Get every event with a trigger that"), GET_STRING (L"...the text"));
+		praat_new (thee.transfer(), my name, L"_trigger", GET_STRING (L"...the text"));
+	}
+END
+
+FORM (LongEEG_to_ERPTier_triggers_preceded, L"To ERPTier (triggers, preceded)", 0)
+	REAL (L"From time (s)", L"-0.11")
+	REAL (L"To time (s)", L"0.39")
+	OPTIONMENU_ENUM (L"Get every event with a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (L"...the text", L"1")
+	OPTIONMENU_ENUM (L"and is preceded by a trigger that", kMelder_string, DEFAULT)
+	SENTENCE (L" ...the text", L"4")
+	OK
+DO
+	LOOP {
+		iam (LongEEG);
+		autoERPTier thee = LongEEG_to_ERPTier_triggers_preceded (me, GET_REAL (L"From time"), GET_REAL (L"To time"),
+			GET_ENUM (kMelder_string, L"Get every event with a trigger that"), GET_STRING (L"...the text"),
+			GET_ENUM (kMelder_string, L"and is preceded by a trigger that"), GET_STRING (L" ...the text"));
+		praat_new (thee.transfer(), my name, L"_trigger", GET_STRING (L" ...the text"));
+	}
+END
+
 /***** Help menus *****/
 
 DIRECT (EEG_help)     Melder_help (L"EEG");     END
@@ -794,10 +981,12 @@ void praat_TimeTier_query_init (ClassInfo klas);   // Query buttons for time-bas
 void praat_EEG_init (void);
 void praat_EEG_init (void) {
 
-	Thing_recognizeClassesByName (classEEG, classERPTier, classERP, NULL);
+	Thing_recognizeClassesByName (classEEG, classERPTier, classERP, classLongEEG, NULL);
 
 	Data_recognizeFileType (bdfFileRecognizer);
 
+	praat_addMenuCommand (L"Objects", L"Open", L"Open long EEG file...", 0, 0, DO_LongEEG_open);
+
 	praat_addAction1 (classEEG, 0, L"EEG help", 0, 0, DO_EEG_help);
 	praat_addAction1 (classEEG, 1, L"View & Edit", 0, praat_ATTRACTIVE, DO_EEG_viewAndEdit);
 	praat_addAction1 (classEEG, 0, L"Query -", 0, 0, 0);
@@ -822,6 +1011,9 @@ void praat_EEG_init (void) {
 		praat_addAction1 (classEEG, 0, L"To ERPTier (triggers)...", 0, 1, DO_EEG_to_ERPTier_triggers);
 		praat_addAction1 (classEEG, 0, L"To ERPTier (triggers, preceded)...", 0, 1, DO_EEG_to_ERPTier_triggers_preceded);
 		praat_addAction1 (classEEG, 0, L"To ERPTier...", 0, praat_DEPTH_1 + praat_HIDDEN, DO_EEG_to_ERPTier_bit);
+		praat_addAction1 (classEEG, 0, L"To ERP (mean) -", 0, 0, 0);
+		praat_addAction1 (classEEG, 0, L"To ERP (mean, bit)...", 0, 1, DO_EEG_to_ERP_mean_bit);
+		praat_addAction1 (classEEG, 0, L"To ERP (mean, triggers)...", 0, 1, DO_EEG_to_ERP_mean_triggers);
 		praat_addAction1 (classEEG, 0, L"To MixingMatrix...", 0, 0, DO_EEG_to_MixingMatrix);
 	praat_addAction1 (classEEG, 0, L"Synthesize", 0, 0, 0);
 		praat_addAction1 (classEEG, 0, L"Concatenate", 0, 0, DO_EEGs_concatenate);
@@ -829,6 +1021,20 @@ void praat_EEG_init (void) {
 		praat_addAction1 (classEEG, 0, L"Extract waveforms as Sound", 0, 1, DO_EEG_extractSound);
 		praat_addAction1 (classEEG, 0, L"Extract marks as TextGrid", 0, 1, DO_EEG_extractTextGrid);
 
+	praat_addAction1 (classLongEEG, 0, L"Analyse", 0, 0, 0);
+		praat_addAction1 (classLongEEG, 0, L"Extract channel...", 0, 0, DO_LongEEG_extractChannel);
+		praat_addAction1 (classLongEEG, 1, L"Extract part...", 0, 0, DO_LongEEG_extractPart);
+		praat_addAction1 (classLongEEG, 0, L"To ERPTier -", 0, 0, 0);
+		praat_addAction1 (classLongEEG, 0, L"To ERPTier (bit)...", 0, 1, DO_LongEEG_to_ERPTier_bit);
+		praat_addAction1 (classLongEEG, 0, L"To ERPTier (marker)...", 0, 1, DO_LongEEG_to_ERPTier_marker);
+		praat_addAction1 (classLongEEG, 0, L"To ERPTier (triggers)...", 0, 1, DO_LongEEG_to_ERPTier_triggers);
+		praat_addAction1 (classLongEEG, 0, L"To ERPTier (triggers, preceded)...", 0, 1, DO_LongEEG_to_ERPTier_triggers_preceded);
+		praat_addAction1 (classLongEEG, 0, L"To ERP (mean) -", 0, 0, 0);
+		praat_addAction1 (classLongEEG, 0, L"To ERP (mean, bit)...", 0, 1, DO_LongEEG_to_ERP_mean_bit);
+		praat_addAction1 (classLongEEG, 0, L"To ERP (mean, triggers)...", 0, 1, DO_LongEEG_to_ERP_mean_triggers);
+	praat_addAction1 (classLongEEG, 0, L"Convert", 0, 0, 0);
+		praat_addAction1 (classLongEEG, 0, L"To EEG", 0, 0, DO_LongEEG_to_EEG);
+
 	praat_addAction1 (classERP, 1, L"View & Edit", 0, praat_ATTRACTIVE, DO_ERP_viewAndEdit);
 	praat_addAction1 (classERP, 0, L"Draw -", 0, 0, 0);
 		praat_addAction1 (classERP, 0, L"Draw...", 0, 1, DO_ERP_draw);
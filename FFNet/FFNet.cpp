@@ -40,6 +40,7 @@
 #include "Pattern.h"
 #include "Collection.h"
 #include "Categories.h"
+#include "MelderThread.h"
 
 static void bookkeeping (FFNet me);
 
@@ -423,21 +424,319 @@ void FFNet_computeDerivative (FFNet me) {
 
 /******* end operation ******************************************************/
 
+/***** BATCH OPERATION: *****************************************************/
+/*
+ * The weights that connect to the units of one layer form a dense matrix, stored row by row in my w:
+ * the row of node i is w[wFirst[i]..wLast[i]], the bias weight being the last element.
+ * Instead of one pattern at a time, we propagate a block of at most FFNET_BLOCK_SIZE patterns:
+ * activity[node][1..numberOfRows] holds the activities of a node for all patterns in the block,
+ * so that every weight is loaded once per block and the inner loops run over the patterns.
+ * Per pattern all sums are accumulated in the same order as in FFNet_propagate,
+ * FFNet_computeError and FFNet_computeDerivative, so the results are the same.
+ */
+
+#define FFNET_BLOCK_SIZE  64
+#define FFNET_ROWS_PER_PARTITION  1024
+#define FFNET_MAXIMUM_NUMBER_OF_PARTITIONS  16
+
+static void FFNet_propagateBlock (FFNet me, double **input, long firstRow, long numberOfRows, double **activity, double **deriv) {
+	for (long j = 1; j <= my nInputs; j++) {
+		double *a = activity[j];
+		for (long irow = 1; irow <= numberOfRows; irow++) {
+			a[irow] = input[firstRow + irow - 1][j];
+		}
+	}
+	long firstLinearNode = my outputsAreLinear ? my nNodes - my nOutputs + 1 : my nNodes + 1;
+	for (long i = my nInputs + 2; i <= my nNodes; i++) {
+		if (my isbias[i]) {
+			continue;
+		}
+		double *act = activity[i], *der = deriv[i];
+		const double *w = & my w[my wFirst[i]];
+		for (long irow = 1; irow <= numberOfRows; irow++) {
+			act[irow] = 0.0;
+		}
+		for (long j = my nodeFirst[i], k = 0; j <= my nodeLast[i]; j++, k++) {
+			const double wk = w[k], *a = activity[j];
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				act[irow] += wk * a[irow];
+			}
+		}
+		if (i < firstLinearNode) {
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				act[irow] = my nonLinearity (me, act[irow], & der[irow]);
+			}
+		} else {
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				der[irow] = 1.0;
+			}
+		}
+	}
+}
+
+/* Adds the costs of the patterns in the block to *costs, and their derivatives to dw (if not NULL). */
+static void FFNet_computeBlockCosts (FFNet me, double **target, long firstRow, long numberOfRows,
+	double **activity, double **deriv, double **error, double *rowCosts, double *costs, double dw[])
+{
+	long firstOutputNode = my nNodes - my nOutputs + 1;
+	for (long irow = 1; irow <= numberOfRows; irow++) {
+		rowCosts[irow] = 0.0;
+	}
+	for (long i = 1, k = firstOutputNode; i <= my nOutputs; i++, k++) {
+		const double *act = activity[k];
+		double *err = error[k];
+		if (my costFunctionType == 2) {   // minimum cross entropy
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				double t = target[firstRow + irow - 1][i], t1 = 1.0 - t, o1 = 1.0 - act[irow];
+				rowCosts[irow] -= t * log (act[irow]) + t1 * log (o1);
+				err[irow] = -t1 / o1 + t / act[irow];
+			}
+		} else {   // minimum squared error
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				double e = err[irow] = target[firstRow + irow - 1][i] - act[irow];
+				rowCosts[irow] += e * e;
+			}
+		}
+	}
+	for (long irow = 1; irow <= numberOfRows; irow++) {
+		*costs += my costFunctionType == 2 ? rowCosts[irow] : 0.5 * rowCosts[irow];
+	}
+	if (dw == NULL) {
+		return;
+	}
+
+	// backpropagation of errors from output to first hidden layer
+
+	for (long i = 1; i < firstOutputNode; i++) {
+		double *err = error[i];
+		for (long irow = 1; irow <= numberOfRows; irow++) {
+			err[irow] = 0.0;
+		}
+	}
+	for (long i = my nNodes; i > my nInputs + 1; i--) {
+		if (my isbias[i]) {
+			continue;
+		}
+		double *err = error[i];
+		const double *der = deriv[i];
+		for (long irow = 1; irow <= numberOfRows; irow++) {
+			err[irow] *= der[irow];
+		}
+		if (my nodeFirst[i] > my nInputs + 1) {
+			const double *w = & my w[my wFirst[i]];
+			for (long j = my nodeFirst[i], k = 0; j <= my nodeLast[i] - 1; j++, k++) {
+				const double wk = w[k];
+				double *errj = error[j];
+				for (long irow = 1; irow <= numberOfRows; irow++) {
+					errj[irow] += err[irow] * wk;
+				}
+			}
+		}
+	}
+
+	// the derivative, summed over the patterns in the block
+
+	for (long i = my nInputs + 2; i <= my nNodes; i++) {
+		if (my isbias[i]) {
+			continue;
+		}
+		const double *err = error[i];
+		for (long j = my nodeFirst[i], k = my wFirst[i]; j <= my nodeLast[i]; j++, k++) {
+			const double *a = activity[j];
+			double sum = dw[k];
+			for (long irow = 1; irow <= numberOfRows; irow++) {
+				sum += - err[irow] * a[irow];
+			}
+			dw[k] = sum;
+		}
+	}
+}
+
+Thing_define (FFNet_batch_Args, Thing) { public:
+	FFNet ffnet;
+	double **input, **target, **output;
+	long numberOfRows, layer;
+	long numberOfPartitions, rowsPerPartition;
+	double *costs, **dw;   // one per partition
+	volatile long *nextPartition;
+};
+
+Thing_implement (FFNet_batch_Args, Thing, 0);
+
+MelderThread_MUTEX (batchMutex);
+static bool batchMutex_inited;
+
+static MelderThread_RETURN_TYPE FFNet_batch (FFNet_batch_Args me) {
+	FFNet net = my ffnet;
+	autoNUMmatrix<double> activity, deriv, error;
+	autoNUMvector<double> rowCosts;
+	MelderThread_LOCK (batchMutex);
+	activity.reset (1, net -> nNodes, 1, FFNET_BLOCK_SIZE);
+	deriv.reset (1, net -> nNodes, 1, FFNET_BLOCK_SIZE);
+	if (my target) {
+		error.reset (1, net -> nNodes, 1, FFNET_BLOCK_SIZE);
+		rowCosts.reset (1, FFNET_BLOCK_SIZE);
+	}
+	MelderThread_UNLOCK (batchMutex);
+	for (long i = 1; i <= net -> nNodes; i++) {
+		if (net -> isbias[i]) {
+			for (long irow = 1; irow <= FFNET_BLOCK_SIZE; irow++) {
+				activity[i][irow] = 1.0;
+			}
+		}
+	}
+	long firstNodeInLayer = 1;
+	for (long i = 0; i < my layer; i++) {
+		firstNodeInLayer += net -> nUnitsInLayer[i] + 1;
+	}
+	for (;;) {
+		MelderThread_LOCK (batchMutex);
+		long ipartition = ++ *my nextPartition;
+		MelderThread_UNLOCK (batchMutex);
+		if (ipartition > my numberOfPartitions) {
+			break;
+		}
+		long lastRowOfPartition = ipartition * my rowsPerPartition;
+		if (lastRowOfPartition > my numberOfRows) {
+			lastRowOfPartition = my numberOfRows;
+		}
+		double costs = 0.0;
+		for (long firstRow = (ipartition - 1) * my rowsPerPartition + 1; firstRow <= lastRowOfPartition; firstRow += FFNET_BLOCK_SIZE) {
+			long numberOfRows = lastRowOfPartition - firstRow + 1;
+			if (numberOfRows > FFNET_BLOCK_SIZE) {
+				numberOfRows = FFNET_BLOCK_SIZE;
+			}
+			FFNet_propagateBlock (net, my input, firstRow, numberOfRows, activity.peek(), deriv.peek());
+			if (my output) {
+				for (long i = 1; i <= net -> nUnitsInLayer[my layer]; i++) {
+					const double *act = activity[firstNodeInLayer + i - 1];
+					for (long irow = 1; irow <= numberOfRows; irow++) {
+						my output[firstRow + irow - 1][i] = act[irow];
+					}
+				}
+			}
+			if (my target) {
+				FFNet_computeBlockCosts (net, my target, firstRow, numberOfRows, activity.peek(), deriv.peek(),
+					error.peek(), rowCosts.peek(), & costs, my dw ? my dw[ipartition] : NULL);
+			}
+		}
+		my costs[ipartition] = costs;
+	}
+	MelderThread_RETURN;
+}
+
+static double FFNet_doBatch (FFNet me, double **input, double **target, long numberOfRows, double **output, long layer, double dw[]) {
+	/*
+	 * The rows are divided into partitions whose number does not depend on the number of processors,
+	 * and the partial sums are added in the order of the partitions,
+	 * so that the results are the same on every computer.
+	 * With a single partition the sums are the same as in the pattern-by-pattern computation.
+	 */
+	long numberOfPartitions = (numberOfRows - 1) / FFNET_ROWS_PER_PARTITION + 1;
+	if (numberOfPartitions > FFNET_MAXIMUM_NUMBER_OF_PARTITIONS) {
+		numberOfPartitions = FFNET_MAXIMUM_NUMBER_OF_PARTITIONS;
+	}
+	long rowsPerPartition = (numberOfRows - 1) / numberOfPartitions + 1;
+	autoNUMvector<double> costs (1, numberOfPartitions);
+	autoNUMmatrix<double> partialDerivatives;
+	autoNUMvector<double *> dwPerPartition;
+	if (dw) {
+		for (long k = 1; k <= my nWeights; k++) {
+			dw[k] = 0.0;
+		}
+		dwPerPartition.reset (1, numberOfPartitions);
+		if (numberOfPartitions > 1) {
+			partialDerivatives.reset (1, numberOfPartitions, 1, my nWeights);
+			for (long ipartition = 1; ipartition <= numberOfPartitions; ipartition++) {
+				dwPerPartition[ipartition] = partialDerivatives[ipartition];
+			}
+		} else {
+			dwPerPartition[1] = dw;   // accumulate directly
+		}
+	}
+
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfPartitions) numberOfThreads = numberOfPartitions;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+
+	if (! batchMutex_inited) { MelderThread_MUTEX_INIT (batchMutex); batchMutex_inited = true; }
+	autoFFNet_batch_Args args [16];
+	volatile long nextPartition = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+		autoFFNet_batch_Args arg = Thing_new (FFNet_batch_Args);
+		arg -> ffnet = me;
+		arg -> input = input;
+		arg -> target = target;
+		arg -> output = output;
+		arg -> numberOfRows = numberOfRows;
+		arg -> layer = layer;
+		arg -> numberOfPartitions = numberOfPartitions;
+		arg -> rowsPerPartition = rowsPerPartition;
+		arg -> costs = costs.peek();
+		arg -> dw = dwPerPartition.peek();
+		arg -> nextPartition = & nextPartition;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (FFNet_batch, args, numberOfThreads);
+
+	double totalCosts = 0.0;
+	for (long ipartition = 1; ipartition <= numberOfPartitions; ipartition++) {
+		totalCosts += costs[ipartition];
+	}
+	if (dw && numberOfPartitions > 1) {
+		for (long ipartition = 1; ipartition <= numberOfPartitions; ipartition++) {
+			for (long k = 1; k <= my nWeights; k++) {
+				dw[k] += dwPerPartition[ipartition][k];
+			}
+		}
+	}
+	return totalCosts;
+}
+
+void FFNet_propagateRows (FFNet me, double **input, long numberOfRows, double **output, long layer) {
+	if (numberOfRows < 1) {
+		return;
+	}
+	if (layer < 1 || layer > my nLayers) {
+		layer = my nLayers;
+	}
+	FFNet_doBatch (me, input, NULL, numberOfRows, output, layer, NULL);
+}
+
+double FFNet_computeCostsAndDerivative (FFNet me, double **input, double **target, long numberOfRows, double dw[]) {
+	if (numberOfRows < 1) {
+		if (dw) {
+			for (long k = 1; k <= my nWeights; k++) {
+				dw[k] = 0.0;
+			}
+		}
+		return 0.0;
+	}
+	return FFNet_doBatch (me, input, target, numberOfRows, NULL, my nLayers, dw);
+}
+
+/******* end batch operation ************************************************/
+
 long FFNet_getWinningUnit (FFNet me, int labeling) {
-	long pos = 1, k = my nNodes - my nOutputs;
+	return FFNet_getWinningUnitFromOutput (me, my activity + my nNodes - my nOutputs, labeling);
+}
+
+long FFNet_getWinningUnitFromOutput (FFNet me, const double output[], int labeling) {
+	long pos = 1;
 	if (labeling == 2) { /* stochastic */
 		double sum = 0;
 		for (long i = 1; i <= my nOutputs; i++) {
-			sum += my activity[k + i];
+			sum += output[i];
 		}
 		double random = NUMrandomUniform (0, sum);
-		for (pos = my nOutputs; pos >= 2; pos--) if (random > (sum -= my activity[k + pos])) {
+		for (pos = my nOutputs; pos >= 2; pos--) if (random > (sum -= output[pos])) {
 				break;
 			}
 	} else { /* winner-takes-all */
-		double max = my activity[k + 1];
-		for (long i = 2; i <= my nOutputs; i++) if (my activity[k + i] > max) {
-				max = my activity[k + i];
+		double max = output[1];
+		for (long i = 2; i <= my nOutputs; i++) if (output[i] > max) {
+				max = output[i];
 				pos = i;
 			}
 	}
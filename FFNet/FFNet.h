@@ -172,6 +172,21 @@ long FFNet_getWinningUnit (FFNet me, int labeling);
 /* labeling = 1 : winner-takes-all */
 /* labeling = 2 : stochastic */
 
+long FFNet_getWinningUnitFromOutput (FFNet me, const double output[], int labeling);
+/* as FFNet_getWinningUnit, for the activities output[1..nOutputs] of the output layer */
+
+void FFNet_propagateRows (FFNet me, double **input, long numberOfRows, double **output, long layer);
+/* Feed forward the patterns input[1..numberOfRows][1..nInputs] many at a time;
+ * output[1..numberOfRows][1..nUnitsInLayer[layer]] receives the activities in layer.
+ * my activities are not changed.
+ */
+
+double FFNet_computeCostsAndDerivative (FFNet me, double **input, double **target, long numberOfRows, double dw[]);
+/* Steps (1) to (4) for the patterns input[1..numberOfRows] many at a time:
+ * returns the total costs w.r.t. target[1..numberOfRows][1..nOutputs]
+ * and, if dw != NULL, puts the total derivative in dw[1..nWeights].
+ */
+
 void FFNet_selectAllWeights (FFNet me);
 void FFNet_selectBiasesInLayer (FFNet me, long layer);
 
@@ -34,19 +34,27 @@ static double func (Data object, const double p[]) {
 	double fp = 0;
 
 	for (long j = 1, k = 1; k <= my nWeights; k++) {
-		my dw[k] = 0.0;
 		if (my wSelected[k]) {
 			my w[k] = p[j++];
 		}
 	}
-	for (long i = 1; i <= my nPatterns; i++) {
-		FFNet_propagate (me, my inputPattern[i], NULL);
-		fp += FFNet_computeError (me, my targetActivation[i]);
-		FFNet_computeDerivative (me);
-		/* derivative (cumulative) */
+	if (Melder_debug == 49) {
+		/* one pattern at a time, as a check on the batch computation */
 		for (long k = 1; k <= my nWeights; k++) {
-			my dw[k] += my dwi[k];
+			my dw[k] = 0.0;
 		}
+		for (long i = 1; i <= my nPatterns; i++) {
+			FFNet_propagate (me, my inputPattern[i], NULL);
+			fp += FFNet_computeError (me, my targetActivation[i]);
+			FFNet_computeDerivative (me);
+			/* derivative (cumulative) */
+			for (long k = 1; k <= my nWeights; k++) {
+				my dw[k] += my dwi[k];
+			}
+		}
+	} else {
+		/* costs and derivative (cumulative), many patterns at a time */
+		fp = FFNet_computeCostsAndDerivative (me, my inputPattern, my targetActivation, my nPatterns, my dw);
 	}
 	thy funcCalls++;
 	return fp;
@@ -160,12 +168,7 @@ double FFNet_Pattern_Activation_getCosts_total (FFNet me, Pattern p, Activation
 		_FFNet_Pattern_Activation_checkDimensions (me, p, a);
 		FFNet_setCostFunction (me, costFunctionType);
 
-		double cost = 0;
-		for (long i = 1; i <= p -> ny; i++) {
-			FFNet_propagate (me, p -> z[i], NULL);
-			cost += FFNet_computeError (me, a -> z[i]);
-		}
-		return cost;
+		return FFNet_computeCostsAndDerivative (me, p -> z, a -> z, p -> ny, NULL);
 	} catch (MelderError) {
 		return NUMundefined;
 	}
@@ -192,9 +195,7 @@ Activation FFNet_Pattern_to_Activation (FFNet me, Pattern p, long layer) {
 		long nPatterns = p -> ny;
 		autoActivation thee = Activation_create (nPatterns, my nUnitsInLayer[layer]);
 
-		for (long i = 1; i <= nPatterns; i++) {
-			FFNet_propagateToLayer (me, p -> z[i], thy z[i], layer);
-		}
+		FFNet_propagateRows (me, p -> z, nPatterns, thy z, layer);
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": no Activation created.");
@@ -88,10 +88,11 @@ Categories FFNet_Pattern_to_Categories (FFNet me, Pattern thee, int labeling) {
 
 
 		autoCategories him = Categories_create ();
+		autoNUMmatrix<double> output (1, thy ny, 1, my nOutputs);
+		FFNet_propagateRows (me, thy z, thy ny, output.peek(), my nLayers);
 
 		for (long k = 1; k <= thy ny; k++) {
-			FFNet_propagate (me, thy z[k], 0);
-			long index = FFNet_getWinningUnit (me, labeling);
+			long index = FFNet_getWinningUnitFromOutput (me, output[k], labeling);
 			autoData item = Data_copy ( (Data) my outputCategories -> item[index]);
 			Collection_addItem (him.peek(), item.transfer());
 		}
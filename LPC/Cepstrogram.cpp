@@ -29,6 +29,7 @@
 #include "NUM2.h"
 #include "Sound_and_Spectrum.h"
 #include "Sound_extensions.h"
+#include "MelderThread.h"
 
 #define TOLOG(x) ((1 / NUMln10) * log ((x) + 1e-30))
 #define TO10LOG(x) ((10 / NUMln10) * log ((x) + 1e-30))
@@ -269,6 +270,100 @@ PowerCepstrogram Matrix_to_PowerCepstrogram (Matrix me) {
 	}
 }
 
+/*
+ * The frames of a PowerCepstrogram are independent: blocks of frames are analysed in parallel,
+ * every thread reusing its own FFT table and frame buffer. Per frame this computes exactly what
+ * Sound_to_Spectrum, Spectrum_to_PowerCepstrum and Spectrum_to_Sound would compute in sequence.
+ */
+
+Thing_define (PowerCepstrogram_Args, Thing) { public:
+	Sound sound;   // resampled and pre-emphasized
+	PowerCepstrogram cepstrogram;
+	double windowDuration, sampleDuration;
+	double *window;
+	long windowLength, nfft;
+	bool isMainThread;
+	volatile long *nextBlock, *numberOfFramesDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (PowerCepstrogram_Args, Thing, 0);
+
+MelderThread_MUTEX (cepstrogramMutex);
+static bool cepstrogramMutex_inited;
+
+#define PowerCepstrogram_FRAMES_PER_BLOCK  16
+
+static MelderThread_RETURN_TYPE PowerCepstrogram_computeFrames (PowerCepstrogram_Args me) {
+	Sound sound = my sound;
+	PowerCepstrogram thee = my cepstrogram;
+	const long nfft = my nfft, nq = thy ny, windowLength = my windowLength;
+	const double scaling = my sampleDuration, df = 1.0 / (my sampleDuration * nfft);
+	autoNUMfft_Table fftTable;
+	autoNUMvector <double> frame;
+	MelderThread_LOCK (cepstrogramMutex);
+	NUMfft_Table_init (& fftTable, nfft);
+	frame.reset (1, nfft);
+	MelderThread_UNLOCK (cepstrogramMutex);
+	const long numberOfBlocks = (thy nx - 1) / PowerCepstrogram_FRAMES_PER_BLOCK + 1;
+	for (;;) {
+		MelderThread_LOCK (cepstrogramMutex);
+		long iblock = ++ *my nextBlock;
+		MelderThread_UNLOCK (cepstrogramMutex);
+		if (iblock > numberOfBlocks || *my cancelled) break;
+		long firstFrame = (iblock - 1) * PowerCepstrogram_FRAMES_PER_BLOCK + 1, lastFrame = firstFrame + PowerCepstrogram_FRAMES_PER_BLOCK - 1;
+		if (lastFrame > thy nx) lastFrame = thy nx;
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe++) {
+			double t = Sampled_indexToX (thee, iframe);
+			long index = Sampled_xToNearestIndex (sound, t - my windowDuration / 2);
+			double sum = 0;
+			for (long i = 1; i <= windowLength; i++) {
+				long j = index - 1 + i;
+				frame[i] = j < 1 || j > sound -> nx ? 0 : sound -> z[1][j];
+				sum += frame[i];
+			}
+			double mean = sum / windowLength;
+			for (long i = 1; i <= windowLength; i++) {
+				frame[i] -= mean;
+				frame[i] *= my window[i];
+			}
+			for (long i = windowLength + 1; i <= nfft; i++) {
+				frame[i] = 0;
+			}
+			NUMfft_forward (& fftTable, frame.peek());
+			/*
+			 * The logarithm of the power spectrum, as a real spectrum in the layout of the transform.
+			 */
+			double re = frame[1] * scaling, im = 0.0;
+			frame[1] = log (re * re + im * im + 1e-300) * df;
+			for (long i = 2; i < nq; i++) {
+				re = frame[i + i - 2] * scaling, im = frame[i + i - 1] * scaling;
+				frame[i + i - 2] = log (re * re + im * im + 1e-300) * df;
+				frame[i + i - 1] = 0;
+			}
+			re = frame[nfft] * scaling, im = 0.0;
+			frame[nfft] = log (re * re + im * im + 1e-300) * df;
+			NUMfft_backward (& fftTable, frame.peek());
+			for (long i = 1; i <= nq; i++) {
+				thy z[i][iframe] = frame[i] * frame[i];
+			}
+		}
+		MelderThread_LOCK (cepstrogramMutex);
+		long numberOfFramesDone = (*my numberOfFramesDone += lastFrame - firstFrame + 1);
+		MelderThread_UNLOCK (cepstrogramMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress ((double) numberOfFramesDone / thy nx, L"PowerCepstrogram analysis of frame ",
+					Melder_integer (numberOfFramesDone), L" out of ", Melder_integer (thy nx), L".");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
 PowerCepstrogram Sound_to_PowerCepstrogram (Sound me, double pitchFloor, double dt, double maximumFrequency, double preEmphasisFrequency) {
 	try {
 		// minimum analysis window has 3 periods of lowest pitch
@@ -284,32 +379,41 @@ PowerCepstrogram Sound_to_PowerCepstrogram (Sound me, double pitchFloor, double
 		autoSound sound = Sound_resample (me, samplingFrequency, 50);
 		Sound_preEmphasis (sound.peek(), preEmphasisFrequency);
 		Sampled_shortTermAnalysis (me, windowDuration, dt, & nFrames, & t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		// find out the size of the FFT
 		long nfft = 2;
-		while (nfft < sframe -> nx) nfft *= 2;
+		while (nfft < window -> nx) nfft *= 2;
 		long nq = nfft / 2 + 1;
 		double qmax = 0.5 * nfft / samplingFrequency, dq = qmax / (nq - 1);
 		autoPowerCepstrogram thee = PowerCepstrogram_create (my xmin, my xmax, nFrames, dt, t1, 0, qmax, nq, dq, 0);
 
 		autoMelderProgress progress (L"Cepstrogram analysis");
 
-		for (long iframe = 1; iframe <= nFrames; iframe++) {
-			double t = Sampled_indexToX (thee.peek(), iframe);
-			Sound_into_Sound (sound.peek(), sframe.peek(), t - windowDuration / 2);
-			Vector_subtractMean (sframe.peek());
-			Sounds_multiply (sframe.peek(), window.peek());
-			autoSpectrum spec = Sound_to_Spectrum (sframe.peek(), 1); // FFT yes
-			autoPowerCepstrum cepstrum = Spectrum_to_PowerCepstrum (spec.peek());
-			for (long i = 1; i <= nq; i++) {
-				thy z[i][iframe] = cepstrum -> z[1][i];
-			}
-			if ((iframe % 10) == 1) {
-				Melder_progress ((double) iframe / nFrames, L"PowerCepstrogram analysis of frame ",
-					Melder_integer (iframe), L" out of ", Melder_integer (nFrames), L".");
-			}
+		long numberOfBlocks = (nFrames - 1) / PowerCepstrogram_FRAMES_PER_BLOCK + 1;
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		if (! cepstrogramMutex_inited) { MelderThread_MUTEX_INIT (cepstrogramMutex); cepstrogramMutex_inited = true; }
+		autoPowerCepstrogram_Args args [16];
+		volatile long nextBlock = 0, numberOfFramesDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+			autoPowerCepstrogram_Args arg = Thing_new (PowerCepstrogram_Args);
+			arg -> sound = sound.peek();
+			arg -> cepstrogram = thee.peek();
+			arg -> windowDuration = windowDuration;
+			arg -> sampleDuration = window -> dx;
+			arg -> window = window -> z[1];
+			arg -> windowLength = window -> nx;
+			arg -> nfft = nfft;
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> nextBlock = & nextBlock;
+			arg -> numberOfFramesDone = & numberOfFramesDone;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
 		}
+		MelderThread_run (PowerCepstrogram_computeFrames, args, numberOfThreads);
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": no PowerCepstrogram created.");
@@ -458,16 +562,179 @@ PowerCepstrogram Sound_to_PowerCepstrogram_hillenbrand (Sound me, double minimum
 	}
 }
 
+/*
+ * CPPS in one pass over the frames, without intermediate cepstrograms or tables.
+ * The time averaging keeps a running (compensated) sum per quefrency bin, and if tilt is to be subtracted
+ * before smoothing, the tilt-subtracted frames within the averaging window are kept in a ring buffer.
+ * The frames are divided into blocks that are processed in parallel; each block starts its own running sums.
+ * The results equal those of PowerCepstrogram_subtractTilt, PowerCepstrogram_smooth
+ * and PowerCepstrogram_to_Table_cpp (or _hillenbrand) up to rounding.
+ */
+
+Thing_define (PowerCepstrogram_CPPS_Args, Thing) { public:
+	PowerCepstrogram cepstrogram;
+	bool subtractTiltBeforeSmoothing, hillenbrand;
+	long numberOfFramesToAverage, numberOfQuefrencyBinsToAverage;
+	double pitchFloor, pitchCeiling, qstartFit, qendFit;
+	int interpolation, lineType, fitMethod;
+	double *cpp;   // [1..nx]
+	volatile long *nextBlock;
+};
+
+Thing_implement (PowerCepstrogram_CPPS_Args, Thing, 0);
+
+MelderThread_MUTEX (cppsMutex);
+static bool cppsMutex_inited;
+
+#define PowerCepstrogram_CPPS_FRAMES_PER_BLOCK  64
+
+static MelderThread_RETURN_TYPE PowerCepstrogram_CPPS_computeFrames (PowerCepstrogram_CPPS_Args me) {
+	PowerCepstrogram thee = my cepstrogram;
+	const long nx = thy nx, nq = thy ny;
+	const long left = my numberOfFramesToAverage / 2, right = (my numberOfFramesToAverage % 2) == 0 ? left - 1 : left;
+	const long ringSize = left + right + 1;
+	autoPowerCepstrum work, frame, dB;
+	autoNUMvector<double> sum, compensation, average;
+	autoNUMmatrix<double> ring;
+	MelderThread_LOCK (cppsMutex);
+	work.reset (PowerCepstrum_create (thy ymax, nq));
+	frame.reset (PowerCepstrum_create (thy ymax, nq));
+	dB.reset (PowerCepstrum_create (thy ymax, nq));
+	sum.reset (1, nq);
+	compensation.reset (1, nq);
+	average.reset (1, nq);
+	if (my subtractTiltBeforeSmoothing) {
+		ring.reset (0, ringSize - 1, 1, nq);
+	}
+	MelderThread_UNLOCK (cppsMutex);
+	const long numberOfBlocks = (nx - 1) / PowerCepstrogram_CPPS_FRAMES_PER_BLOCK + 1;
+	for (;;) {
+		MelderThread_LOCK (cppsMutex);
+		long iblock = ++ *my nextBlock;
+		MelderThread_UNLOCK (cppsMutex);
+		if (iblock > numberOfBlocks) break;
+		long firstFrame = (iblock - 1) * PowerCepstrogram_CPPS_FRAMES_PER_BLOCK + 1, lastFrame = firstFrame + PowerCepstrogram_CPPS_FRAMES_PER_BLOCK - 1;
+		if (lastFrame > nx) lastFrame = nx;
+		for (long iq = 1; iq <= nq; iq++) {
+			sum[iq] = compensation[iq] = 0;
+		}
+		long jfrom = firstFrame - left < 1 ? 1 : firstFrame - left, jto = jfrom - 1;   // the frames in the running sums
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe++) {
+			long newFrom = iframe - left < 1 ? 1 : iframe - left, newTo = iframe + right > nx ? nx : iframe + right;
+			while (jfrom < newFrom) {   // a frame leaves the averaging window (before another can take its place in the ring)
+				for (long iq = 1; iq <= nq; iq++) {
+					double value = my subtractTiltBeforeSmoothing ? ring[jfrom % ringSize][iq] : thy z[iq][jfrom];
+					NUM_addCompensated (- value, & sum[iq], & compensation[iq]);
+				}
+				jfrom++;
+			}
+			while (jto < newTo) {   // a frame enters the averaging window
+				jto++;
+				double *column = work -> z[1];
+				for (long iq = 1; iq <= nq; iq++) {
+					column[iq] = thy z[iq][jto];
+				}
+				if (my subtractTiltBeforeSmoothing) {
+					if (my hillenbrand) {
+						PowerCepstrum_subtractTilt_inline (work.peek(), 0.001, 0, 1, 1);
+					} else {
+						PowerCepstrum_subtractTilt_inline (work.peek(), my qstartFit, my qendFit, my lineType, my fitMethod);
+					}
+					NUMvector_copyElements (column, ring[jto % ringSize], 1, nq);
+				}
+				for (long iq = 1; iq <= nq; iq++) {
+					NUM_addCompensated (column[iq], & sum[iq], & compensation[iq]);
+				}
+			}
+			long numberOfFrames = jto - jfrom + 1;
+			for (long iq = 1; iq <= nq; iq++) {
+				average[iq] = (sum[iq] + compensation[iq]) / numberOfFrames;
+			}
+			if (my numberOfQuefrencyBinsToAverage > 1) {
+				NUMvector_smoothByMovingAverage (average.peek(), nq, my numberOfQuefrencyBinsToAverage, frame -> z[1]);
+			} else {
+				NUMvector_copyElements (average.peek(), frame -> z[1], 1, nq);
+			}
+			/*
+			 * The peak prominence, as in PowerCepstrum_getPeakProminence (_hillenbrand).
+			 */
+			double slope, intercept, peakdB, quefrency;
+			if (my hillenbrand) {
+				PowerCepstrum_fitTiltLine (frame.peek(), 0.001, 0, & slope, & intercept, 1, 1);
+				PowerCepstrum_subtractTiltLine_inline (frame.peek(), slope, intercept, 1);
+			} else {
+				PowerCepstrum_fitTiltLine (frame.peek(), my qstartFit, my qendFit, & slope, & intercept, my lineType, my fitMethod);
+			}
+			for (long iq = 1; iq <= nq; iq++) {
+				dB -> z[1][iq] = frame -> v_getValueAtSample (iq, 1, 0);
+			}
+			Vector_getMaximumAndX ((Vector) dB.peek(), 1 / my pitchCeiling, 1 / my pitchFloor, 1,
+				my hillenbrand ? 0 : my interpolation, & peakdB, & quefrency);
+			if (my hillenbrand) {
+				my cpp[iframe] = peakdB;
+			} else {
+				double xq = my lineType == 2 ? log (quefrency) : quefrency;
+				my cpp[iframe] = peakdB - (slope * xq + intercept);
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+static double PowerCepstrogram_getCPPS_any (PowerCepstrogram me, bool hillenbrand, bool subtractTiltBeforeSmoothing, double timeAveragingWindow, double quefrencyAveragingWindow, double pitchFloor, double pitchCeiling, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod) {
+	/*
+	 * Let the fit complain (if it must) in this thread rather than in a worker.
+	 */
+	{
+		autoPowerCepstrum probe = PowerCepstrogram_to_PowerCepstrum_slice (me, Sampled_indexToX (me, (long) 1));
+		double slope, intercept;
+		PowerCepstrum_fitTiltLine (probe.peek(), hillenbrand ? 0.001 : qstartFit, hillenbrand ? 0 : qendFit, & slope, & intercept,
+			hillenbrand ? 1 : lineType, hillenbrand ? 1 : fitMethod);
+	}
+	autoNUMvector<double> cpp (1, my nx);
+	long numberOfFrames = timeAveragingWindow / my dx, numberOfQuefrencyBins = quefrencyAveragingWindow / my dy;
+	long numberOfBlocks = (my nx - 1) / PowerCepstrogram_CPPS_FRAMES_PER_BLOCK + 1;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! cppsMutex_inited) { MelderThread_MUTEX_INIT (cppsMutex); cppsMutex_inited = true; }
+	autoPowerCepstrogram_CPPS_Args args [16];
+	volatile long nextBlock = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+		autoPowerCepstrogram_CPPS_Args arg = Thing_new (PowerCepstrogram_CPPS_Args);
+		arg -> cepstrogram = me;
+		arg -> hillenbrand = hillenbrand;
+		arg -> subtractTiltBeforeSmoothing = subtractTiltBeforeSmoothing;
+		arg -> numberOfFramesToAverage = numberOfFrames > 1 ? numberOfFrames : 1;
+		arg -> numberOfQuefrencyBinsToAverage = numberOfQuefrencyBins;
+		arg -> pitchFloor = pitchFloor;
+		arg -> pitchCeiling = pitchCeiling;
+		arg -> qstartFit = qstartFit;
+		arg -> qendFit = qendFit;
+		arg -> interpolation = interpolation;
+		arg -> lineType = lineType;
+		arg -> fitMethod = fitMethod;
+		arg -> cpp = cpp.peek();
+		arg -> nextBlock = & nextBlock;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (PowerCepstrogram_CPPS_computeFrames, args, numberOfThreads);
+	double sum = 0;
+	for (long iframe = 1; iframe <= my nx; iframe++) {
+		if (cpp[iframe] == NUMundefined) {
+			return NUMundefined;
+		}
+		sum += cpp[iframe];
+	}
+	return sum / my nx;
+}
+
 double PowerCepstrogram_getCPPS (PowerCepstrogram me, bool subtractTiltBeforeSmoothing, double timeAveragingWindow, double quefrencyAveragingWindow, double pitchFloor, double pitchCeiling, double deltaF0, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod) {
 	try {
-		autoPowerCepstrogram him;
-		if (subtractTiltBeforeSmoothing) {
-			him.reset(PowerCepstrogram_subtractTilt (me, qstartFit, qendFit, lineType, fitMethod));
-		}
-		autoPowerCepstrogram smooth = PowerCepstrogram_smooth (subtractTiltBeforeSmoothing ? him.peek() : me, timeAveragingWindow, quefrencyAveragingWindow);
-		autoTable table = PowerCepstrogram_to_Table_cpp (smooth.peek(), pitchFloor, pitchCeiling, deltaF0, interpolation, qstartFit, qendFit, lineType, fitMethod);
-		double cpps = Table_getMean (table.peek(), 3);
-		return cpps;
+		(void) deltaF0;   // only for the rahmonics-to-noise ratio, which CPPS does not use
+		return PowerCepstrogram_getCPPS_any (me, false, subtractTiltBeforeSmoothing, timeAveragingWindow, quefrencyAveragingWindow,
+			pitchFloor, pitchCeiling, interpolation, qstartFit, qendFit, lineType, fitMethod);
 	} catch (MelderError) {
 		Melder_throw (me, ": no CPPS value calculated.");
 	}
@@ -475,14 +742,8 @@ double PowerCepstrogram_getCPPS (PowerCepstrogram me, bool subtractTiltBeforeSmo
 
 double PowerCepstrogram_getCPPS_hillenbrand (PowerCepstrogram me, bool subtractTiltBeforeSmoothing, double timeAveragingWindow, double quefrencyAveragingWindow, double pitchFloor, double pitchCeiling) {
 	try {
-		autoPowerCepstrogram him;
-		if (subtractTiltBeforeSmoothing) {
-			him.reset(PowerCepstrogram_subtractTilt (me, 0.001, 0, 1, 1));
-		}
-		autoPowerCepstrogram smooth = PowerCepstrogram_smooth (subtractTiltBeforeSmoothing ? him.peek() : me, timeAveragingWindow, quefrencyAveragingWindow);
-		autoTable table = PowerCepstrogram_to_Table_hillenbrand (smooth.peek(), pitchFloor, pitchCeiling);
-		double cpps = Table_getMean (table.peek(), 3);
-		return cpps;
+		return PowerCepstrogram_getCPPS_any (me, true, subtractTiltBeforeSmoothing, timeAveragingWindow, quefrencyAveragingWindow,
+			pitchFloor, pitchCeiling, 0, 0.001, 0, 1, 1);
 	} catch (MelderError) {
 		Melder_throw (me, ": no CPPS value calculated.");
 	}
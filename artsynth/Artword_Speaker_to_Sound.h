@@ -27,4 +27,19 @@ Sound Artword_Speaker_to_Sound (Artword artword, Speaker speaker,
    Sound *p1, int ip1, Sound *p2, int ip2, Sound *p3, int ip3,
    Sound *v1, int iv1, Sound *v2, int iv2, Sound *v3, int iv3);
 
+Sound Artword_Speaker_to_Sound_fast (Artword artword, Speaker speaker,
+   double samplingFrequency, int oversampling);
+/*
+	Same waveform as Artword_Speaker_to_Sound, but with the tube model stored as contiguous arrays;
+	no monitor window and no width, pressure or velocity recordings.
+*/
+
+void Artwords_Speakers_to_Sounds (long numberOfPairs, Artword *artwords, Speaker *speakers,
+   double samplingFrequency, int oversampling, Sound *sounds);
+/*
+	Synthesizes the pairs (artwords [1..numberOfPairs], speakers [1..numberOfPairs]) concurrently
+	into the new Sounds sounds [1..numberOfPairs].
+	Every thread has its own random generator for the turbulence noise.
+*/
+
 /* End of file Artword_Speaker_to_Sound.h */
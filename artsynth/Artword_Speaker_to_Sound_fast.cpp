@@ -0,0 +1,569 @@
+/* Artword_Speaker_to_Sound_fast.cpp
+ *
+ * Copyright (C) 2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ * The same aerodynamic model as in Artword_Speaker_to_Sound.cpp,
+ * with the same equation numbers and with the same order of floating-point operations,
+ * so that the two routines produce identical waveforms.
+ * The difference is in the storage: instead of an array of big Delta_Tube structs
+ * that are connected with pointers, every tube property lives in its own contiguous array,
+ * indexed by the rank of the tube among the tubes that are connected at all,
+ * and the connections are integer indexes into these arrays (0 means "not connected").
+ * The per-tube update then becomes a loop without pointer chasing that the compiler can vectorize;
+ * only the boundary conditions, which depend on the topology, are handled tube by tube.
+ *
+ * Only the production configuration of the model is implemented
+ * (constant tube lengths, moving walls, turbulence, radiation damping and Bernoulli effect).
+ */
+
+#include "Speaker_to_Delta.h"
+#include "Art_Speaker_Delta.h"
+#include "Artword_Speaker_to_Sound.h"
+#include "MelderThread.h"
+
+#define Dymin 0.00001
+#define criticalVelocity 10.0
+
+#define noiseFactor 0.1
+
+#define PROGRESS_SAMPLES 1000
+
+struct structDelta_Arrays {
+	long numberOfTubes;   // only the connected tubes of the Delta
+	autoNUMvector <long> tubeNumber;   // [1..numberOfTubes]: the index of each tube in the Delta
+	autoNUMvector <long> left1, left2, right1, right2;   // [1..numberOfTubes]: 0 if not connected
+	autoNUMvector <long> threeWay;   // the tubes whose left neighbour splits into two streams
+	long numberOfThreeWayTubes;
+	autoNUMvector <long> coupled;   // the tubes whose walls are coupled by springs to those of a neighbour
+	long numberOfCoupledTubes;
+	autoNUMmatrix <double> storage;
+	/* Static. */
+	double *parallel;
+	/* Quasistatic: copied from the Delta after every articulation update. */
+	double *Dxeq, *Dyeq, *Dzeq, *mass, *k1, *k3, *Brel, *s1, *s3, *dy;
+	double *k1left1, *k1left2, *k1right1, *k1right2;
+	/* Dynamic. */
+	double *Jhalf, *Jleft, *Jleftnew, *Jright, *Jrightnew;
+	double *Qhalf, *Qleft, *Qleftnew, *Qright, *Qrightnew;
+	double *Dx, *Dxnew, *Dxhalf;
+	double *Dy, *Dynew, *dDydt, *dDydtnew;
+	double *Dz, *A, *Ahalf, *Anew, *V, *Vnew;
+	double *eleft, *eright;
+	double *pleft, *pleftnew, *pright, *prightnew;
+	double *Kleft, *Kleftnew, *Kright, *Krightnew, *Pturbright, *Pturbrightnew;
+	double *r, *v;
+	/* Intermediate results of the per-tube update. */
+	double *e, *p, *DeltaP, *dDy, *tension, *B;
+};
+typedef struct structDelta_Arrays *Delta_Arrays;
+
+#define Delta_Arrays_NUMBER_OF_FIELDS  58
+
+static void Delta_Arrays_init (Delta_Arrays me, Delta delta) {
+	long numberOfConnectedTubes = 0;
+	autoNUMvector <long> rank (1, delta -> numberOfTubes);
+	for (long itube = 1; itube <= delta -> numberOfTubes; itube ++) {
+		Delta_Tube t = & delta -> tube [itube];
+		if (t -> left1 || t -> right1)
+			rank [itube] = ++ numberOfConnectedTubes;
+	}
+	Melder_assert (numberOfConnectedTubes > 0);
+	my numberOfTubes = numberOfConnectedTubes;
+	my tubeNumber.reset (1, numberOfConnectedTubes);
+	my left1.reset (1, numberOfConnectedTubes);
+	my left2.reset (1, numberOfConnectedTubes);
+	my right1.reset (1, numberOfConnectedTubes);
+	my right2.reset (1, numberOfConnectedTubes);
+	my threeWay.reset (1, numberOfConnectedTubes);
+	my numberOfThreeWayTubes = 0;
+	my coupled.reset (1, numberOfConnectedTubes);
+	my numberOfCoupledTubes = 0;
+	for (long itube = 1; itube <= delta -> numberOfTubes; itube ++) {
+		Delta_Tube t = & delta -> tube [itube];
+		long m = rank [itube];
+		if (m == 0) continue;
+		my tubeNumber [m] = itube;
+		my left1 [m] = t -> left1 ? rank [t -> left1 - delta -> tube] : 0;
+		my left2 [m] = t -> left2 ? rank [t -> left2 - delta -> tube] : 0;
+		my right1 [m] = t -> right1 ? rank [t -> right1 - delta -> tube] : 0;
+		my right2 [m] = t -> right2 ? rank [t -> right2 - delta -> tube] : 0;
+		if (t -> left1 && t -> left1 -> right2)
+			my threeWay [++ my numberOfThreeWayTubes] = m;   // in ascending order, i.e. left tubes before right tubes
+		if ((t -> k1left1 && t -> left1) || (t -> k1left2 && t -> left2) || (t -> k1right1 && t -> right1) || (t -> k1right2 && t -> right2))
+			my coupled [++ my numberOfCoupledTubes] = m;
+	}
+	/*
+	 * One contiguous block, one row per property.
+	 * Element 0 of every row belongs to a dummy tube that stands in for missing neighbours.
+	 */
+	my storage.reset (1, Delta_Arrays_NUMBER_OF_FIELDS, 0, numberOfConnectedTubes);
+	double **row = my storage.peek();
+	int ifield = 0;
+	my parallel = row [++ ifield];
+	my Dxeq = row [++ ifield]; my Dyeq = row [++ ifield]; my Dzeq = row [++ ifield];
+	my mass = row [++ ifield]; my k1 = row [++ ifield]; my k3 = row [++ ifield]; my Brel = row [++ ifield];
+	my s1 = row [++ ifield]; my s3 = row [++ ifield]; my dy = row [++ ifield];
+	my k1left1 = row [++ ifield]; my k1left2 = row [++ ifield]; my k1right1 = row [++ ifield]; my k1right2 = row [++ ifield];
+	my Jhalf = row [++ ifield]; my Jleft = row [++ ifield]; my Jleftnew = row [++ ifield]; my Jright = row [++ ifield]; my Jrightnew = row [++ ifield];
+	my Qhalf = row [++ ifield]; my Qleft = row [++ ifield]; my Qleftnew = row [++ ifield]; my Qright = row [++ ifield]; my Qrightnew = row [++ ifield];
+	my Dx = row [++ ifield]; my Dxnew = row [++ ifield]; my Dxhalf = row [++ ifield];
+	my Dy = row [++ ifield]; my Dynew = row [++ ifield]; my dDydt = row [++ ifield]; my dDydtnew = row [++ ifield];
+	my Dz = row [++ ifield]; my A = row [++ ifield]; my Ahalf = row [++ ifield]; my Anew = row [++ ifield]; my V = row [++ ifield]; my Vnew = row [++ ifield];
+	my eleft = row [++ ifield]; my eright = row [++ ifield];
+	my pleft = row [++ ifield]; my pleftnew = row [++ ifield]; my pright = row [++ ifield]; my prightnew = row [++ ifield];
+	my Kleft = row [++ ifield]; my Kleftnew = row [++ ifield]; my Kright = row [++ ifield]; my Krightnew = row [++ ifield];
+	my Pturbright = row [++ ifield]; my Pturbrightnew = row [++ ifield];
+	my r = row [++ ifield]; my v = row [++ ifield];
+	my e = row [++ ifield]; my p = row [++ ifield]; my DeltaP = row [++ ifield];
+	my dDy = row [++ ifield]; my tension = row [++ ifield]; my B = row [++ ifield];
+	Melder_assert (ifield == Delta_Arrays_NUMBER_OF_FIELDS);
+	for (long m = 1; m <= my numberOfTubes; m ++)
+		my parallel [m] = delta -> tube [my tubeNumber [m]]. parallel;
+}
+
+static void Delta_Arrays_getQuasistatics (Delta_Arrays me, Delta delta) {
+	for (long m = 1; m <= my numberOfTubes; m ++) {
+		Delta_Tube t = & delta -> tube [my tubeNumber [m]];
+		my Dxeq [m] = t -> Dxeq;
+		my Dyeq [m] = t -> Dyeq;
+		my Dzeq [m] = t -> Dzeq;
+		my mass [m] = t -> mass;
+		my k1 [m] = t -> k1;
+		my k3 [m] = t -> k3;
+		my Brel [m] = t -> Brel;
+		my s1 [m] = t -> s1;
+		my s3 [m] = t -> s3;
+		my dy [m] = t -> dy;
+		my k1left1 [m] = t -> k1left1;
+		my k1left2 [m] = t -> k1left2;
+		my k1right1 [m] = t -> k1right1;
+		my k1right2 [m] = t -> k1right2;
+	}
+}
+
+static inline void swapArrays (double **a, double **b) {
+	double *help = *a;
+	*a = *b;
+	*b = help;
+}
+
+static void Artword_Speaker_into_Sound_fast (Artword artword, Speaker speaker, Art art, Delta delta, Delta_Arrays me,
+	Sound thee, double fsamp, int oversampling,
+	int threadNumber, volatile long *numberOfSamplesDone, long totalNumberOfSamples, volatile int *cancelled)
+{
+	long numberOfSamples = thy nx;
+	double Dt = 1 / fsamp / oversampling,
+		rho0 = 1.14,
+		c = 353,
+		onebyc2 = 1.0 / (c * c),
+		rho0c2 = rho0 * c * c,
+		halfDt = 0.5 * Dt,
+		twoDt = 2 * Dt,
+		halfc2Dt = 0.5 * c * c * Dt,
+		twoc2Dt = 2 * c * c * Dt,
+		onebytworho0 = 1.0 / (2.0 * rho0),
+		Dtbytworho0 = Dt / (2.0 * rho0);
+	double rrad = 1 - c * Dt / 0.02;   /* Radiation resistance, 5.135. */
+	double onebygrad = 1 / (1 + c * Dt / 0.02);   /* Radiation conductance, 5.135. */
+	Artword_intoArt (artword, art, 0.0);
+	Art_Speaker_intoDelta (art, speaker, delta);
+	long M = my numberOfTubes;
+	/*
+	 * Local copies of the array pointers, so that the compiler need not reload them after every store.
+	 */
+	const long *left1 = my left1.peek(), *left2 = my left2.peek(), *right1 = my right1.peek(), *right2 = my right2.peek();
+	const long *threeWay = my threeWay.peek(), *coupled = my coupled.peek();
+	const double *parallel = my parallel;
+	const double *Dxeq = my Dxeq, *Dyeq = my Dyeq, *Dzeq = my Dzeq, *mass = my mass, *k1 = my k1, *k3 = my k3,
+		*Brel = my Brel, *s1 = my s1, *s3 = my s3, *dy = my dy;
+	const double *k1left1 = my k1left1, *k1left2 = my k1left2, *k1right1 = my k1right1, *k1right2 = my k1right2;
+	double *Jhalf = my Jhalf, *Jleft = my Jleft, *Jleftnew = my Jleftnew, *Jright = my Jright, *Jrightnew = my Jrightnew;
+	double *Qhalf = my Qhalf, *Qleft = my Qleft, *Qleftnew = my Qleftnew, *Qright = my Qright, *Qrightnew = my Qrightnew;
+	double *Dx = my Dx, *Dxnew = my Dxnew, *Dxhalf = my Dxhalf;
+	double *Dy = my Dy, *Dynew = my Dynew, *dDydt = my dDydt, *dDydtnew = my dDydtnew;
+	double *Dz = my Dz, *A = my A, *Ahalf = my Ahalf, *Anew = my Anew, *V = my V, *Vnew = my Vnew;
+	double *eleft = my eleft, *eright = my eright;
+	double *pleft = my pleft, *pleftnew = my pleftnew, *pright = my pright, *prightnew = my prightnew;
+	double *Kleft = my Kleft, *Kleftnew = my Kleftnew, *Kright = my Kright, *Krightnew = my Krightnew;
+	double *Pturbright = my Pturbright, *Pturbrightnew = my Pturbrightnew;
+	double *r = my r, *v = my v;
+	double *e = my e, *p = my p, *DeltaP = my DeltaP, *dDy = my dDy, *tension = my tension, *B = my B;
+	Delta_Arrays_getQuasistatics (me, delta);
+	for (long m = 1; m <= M; m ++) {
+		Dx [m] = Dxeq [m];   /* 5.113 */
+		Dy [m] = Dyeq [m]; dDydt [m] = 0;   /* 5.113 */
+		Dz [m] = Dzeq [m];   /* 5.113 */
+		A [m] = Dz [m] * ( Dy [m] >= dy [m] ? Dy [m] + Dymin :
+			Dy [m] <= - dy [m] ? Dymin :
+			(dy [m] + Dy [m]) * (dy [m] + Dy [m]) / (4 * dy [m]) + Dymin );   /* 4.4, 4.5 */
+		Jleft [m] = Jright [m] = 0;   /* 5.113 */
+		Qleft [m] = Qright [m] = rho0c2;   /* 5.113 */
+		pleft [m] = pright [m] = 0;   /* 5.114 */
+		Kleft [m] = Kright [m] = 0;   /* 5.114 */
+		V [m] = A [m] * Dx [m];   /* 5.114 */
+	}
+	for (long sample = 1; sample <= numberOfSamples; sample ++) {
+		double time = (sample - 1) / fsamp;
+		Artword_intoArt (artword, art, time);
+		Art_Speaker_intoDelta (art, speaker, delta);
+		Delta_Arrays_getQuasistatics (me, delta);
+		if (sample % PROGRESS_SAMPLES == 0) {
+			if (numberOfSamplesDone) *numberOfSamplesDone += PROGRESS_SAMPLES;   // only an estimate if several threads write
+			if (threadNumber <= 1) {   // the main thread
+				try {
+					Melder_progress ((double) *numberOfSamplesDone / totalNumberOfSamples,
+						L"Articulatory synthesis: ", Melder_half (time), L" seconds");
+				} catch (MelderError) {
+					if (cancelled) *cancelled = 1;
+					throw;
+				}
+			} else if (cancelled && *cancelled) {
+				return;
+			}
+		}
+		for (int n = 1; n <= oversampling; n ++) {
+
+			/* New geometry. */
+
+			for (long m = 1; m <= M; m ++)
+				Dxnew [m] = Dx [m];
+			/* 3-way: equal lengths. */
+			/* This requires left tubes to be processed before right tubes. */
+			for (long i = 1; i <= my numberOfThreeWayTubes; i ++) {
+				long m = threeWay [i];
+				Dxnew [m] = Dxnew [left1 [m]];
+			}
+
+			/*
+			 * The per-tube update, in four passes.
+			 * The first and the last pass have no branches and no dependencies between tubes,
+			 * so that the compiler can vectorize them;
+			 * the middle passes add the few spring couplings between neighbouring tubes
+			 * and the wall contact forces of the few tubes that are (nearly) closed.
+			 */
+			for (long m = 1; m <= M; m ++) {
+				Dz [m] = Dzeq [m];   /* immediate... */
+				const double Vm = V [m];
+				const double eleftm = (Qleft [m] - Kleft [m]) * Vm;   /* 5.115 */
+				const double erightm = (Qright [m] - Kright [m]) * Vm;   /* 5.115 */
+				eleft [m] = eleftm;
+				eright [m] = erightm;
+				const double em = e [m] = 0.5 * (eleftm + erightm);   /* 5.116 */
+				const double pm = p [m] = 0.5 * (pleft [m] + pright [m]);   /* 5.116 */
+				const double DeltaPm = DeltaP [m] = em / Vm - rho0c2;   /* 5.117 */
+				v [m] = pm / (rho0 + onebyc2 * DeltaPm);   /* 5.118 */
+				const double dDym = dDy [m] = Dyeq [m] - Dy [m];
+				const double cubic = k3 [m] * dDym * dDym;
+				tension [m] = dDym * (k1 [m] + cubic);
+				B [m] = 2 * Brel [m] * sqrt (mass [m] * (k1 [m] + 3 * cubic));
+			}
+			for (long i = 1; i <= my numberOfCoupledTubes; i ++) {
+				long m = coupled [i], l1 = left1 [m], l2 = left2 [m], r1 = right1 [m], r2 = right2 [m];
+				if (k1left1 [m] && l1)
+					tension [m] += k1left1 [m] * k1 [m] * (dDy [m] - dDy [l1]);
+				if (k1left2 [m] && l2)
+					tension [m] += k1left2 [m] * k1 [m] * (dDy [m] - dDy [l2]);
+				if (k1right1 [m] && r1)
+					tension [m] += k1right1 [m] * k1 [m] * (dDy [m] - dDy [r1]);
+				if (k1right2 [m] && r2)
+					tension [m] += k1right2 [m] * k1 [m] * (dDy [m] - dDy [r2]);
+			}
+			for (long m = 1; m <= M; m ++) {   /* Wall contact: only for the few tubes that are (nearly) closed. */
+				const double Dym = Dy [m], dym = dy [m];
+				if (Dym < dym) {
+					const double massm = mass [m], s1m = s1 [m], s3m = s3 [m];
+					if (Dym >= - dym) {
+						const double dDyContact = dym - Dym, dDyContact2 = dDyContact * dDyContact;
+						tension [m] += dDyContact2 / (4 * dym) * (s1m + 0.5 * s3m * dDyContact2);
+						B [m] += 2 * dDyContact / (2 * dym) * sqrt (massm * (s1m + s3m * dDyContact2));
+					} else {
+						tension [m] -= Dym * (s1m + s3m * (Dym * Dym + dym * dym));
+						B [m] += 2 * sqrt (massm * (s1m + s3m * (3 * Dym * Dym + dym * dym)));
+					}
+				}
+			}
+			for (long m = 1; m <= M; m ++) {
+				const double Dxm = Dx [m], Dym = Dy [m], Dzm = Dz [m], dym = dy [m], massm = mass [m];
+				const double Dxnewm = Dxnew [m], Am = A [m];
+				const double dDydtnewm = (dDydt [m] + Dt / massm * (tension [m] + 2 * DeltaP [m] * Dzm * Dxm)) /
+					(1 + B [m] * Dt / massm);   /* 5.119 */
+				dDydtnew [m] = dDydtnewm;
+				const double Dynewm = Dym + dDydtnewm * Dt;   /* 5.119 */
+				Dynew [m] = Dynewm;
+				const double Wpartial = (dym + Dynewm) * (dym + Dynewm) / (4 * dym) + Dymin;   // computed in all cases, for vectorization
+				const double Anewm = Dzm * ( Dynewm >= dym ? Dynewm + Dymin :
+					Dynewm <= - dym ? Dymin : Wpartial );   /* 4.4, 4.5 */
+				Anew [m] = Anewm;
+				const double Ahalfm = 0.5 * (Am + Anewm);   /* 5.120 */
+				Ahalf [m] = Ahalfm;
+				const double Dxhalfm = 0.5 * (Dxnewm + Dxm);   /* 5.121 */
+				Dxhalf [m] = Dxhalfm;
+				Vnew [m] = Anewm * Dxnewm;   /* 5.128 */
+				const double oneByDyav = Dzm / Am;
+				const double parallelm = parallel [m];
+				double R = ( Dym < 0 ? 12 * 1.86e-5 : 12 * 1.86e-5 * parallelm * parallelm ) /
+					( Dym < 0 ? Dymin * Dymin + dym * dym : (Dym + Dymin) * (Dym + Dymin) + dym * dym );
+				R += 0.3 * parallelm * oneByDyav;   /* 5.23 */
+				r [m] = (1 + R * Dt / rho0) * Dxhalfm / Anewm;   /* 5.122 */
+				const double ehalf = e [m] + halfc2Dt * (Jleft [m] - Jright [m]);   /* 5.123 */
+				const double phalf = (p [m] + halfDt * (Qleft [m] - Qright [m]) / Dxm) / (1 + Dtbytworho0 * R);   /* 5.123 */
+				Jhalf [m] = phalf * Ahalfm;   /* 5.124 */
+				Qhalf [m] = ehalf / (Ahalfm * Dxhalfm) + onebytworho0 * phalf * phalf;   /* 5.124 */
+			}
+
+			/*
+			 * The boundary conditions: compute Jleftnew and Qleftnew.
+			 * The tube indexes are ranks into the arrays; 0 stands for "no tube".
+			 */
+			for (long il = 1; il <= M; il ++) {
+				long ir1 = right1 [il], ir2 = right2 [il], ir = ir1;
+				long il1 = il, il2 = ir ? left2 [ir] : 0;
+				if (left1 [il] == 0) {   /* Closed boundary at the left side (diaphragm)? */
+					if (ir == 0) continue;   /* Tube not connected at all. */
+					Jleftnew [il] = 0;   /* 5.132. */
+					Qleftnew [il] = (eleft [il] - twoc2Dt * Jhalf [il]) / Vnew [il];   /* 5.132. */
+				}
+				if (ir == 0) {   /* Open boundary at the right side (lips, nostrils)? */
+					prightnew [il] = ((Dxhalf [il] / Dt + c * onebygrad) * pright [il] +
+						 2 * ((Qhalf [il] - rho0c2) - (Qright [il] - rho0c2) * onebygrad)) /
+						(r [il] * Anew [il] / Dt + c * onebygrad);   /* 5.136 */
+					Jrightnew [il] = prightnew [il] * Anew [il];   /* 5.136 */
+					Qrightnew [il] = (rrad * (Qright [il] - rho0c2) +
+						c * (prightnew [il] - pright [il])) * onebygrad + rho0c2;   /* 5.136 */
+				} else if (il2 == 0 && ir2 == 0) {   /* Two-way boundary. */
+					const double vl = v [il], vr = v [ir], Al = A [il], Ar = A [ir];
+					if (vl > criticalVelocity && Al < Ar) {
+						Pturbrightnew [il] = -0.5 * rho0 * (vl - criticalVelocity) *
+							(1 - Al / Ar) * (1 - Al / Ar) * vl;
+						if (Pturbrightnew [il] != 0.0)
+							Pturbrightnew [il] *= 1 + NUMrandomGauss_mt (threadNumber, 0, noiseFactor);
+					}
+					if (vr < - criticalVelocity && Ar < Al) {
+						Pturbrightnew [il] = 0.5 * rho0 * (vr + criticalVelocity) *
+							(1 - Ar / Al) * (1 - Ar / Al) * vr;
+						if (Pturbrightnew [il] != 0.0)
+							Pturbrightnew [il] *= 1 + NUMrandomGauss_mt (threadNumber, 0, noiseFactor);
+					}
+					Jrightnew [il] = Jleftnew [ir] =
+						(Dxhalf [il] * pright [il] + Dxhalf [ir] * pleft [ir] +
+						 twoDt * (Qhalf [il] - Qhalf [ir] + Pturbright [il])) /
+						(r [il] + r [ir]);   /* 5.127 */
+					prightnew [il] = Jrightnew [il] / Anew [il];   /* 5.128 */
+					pleftnew [ir] = Jleftnew [ir] / Anew [ir];   /* 5.128 */
+					Krightnew [il] = onebytworho0 * prightnew [il] * prightnew [il];   /* 5.128 */
+					Kleftnew [ir] = onebytworho0 * pleftnew [ir] * pleftnew [ir];   /* 5.128 */
+					Qrightnew [il] =
+						(eright [il] + eleft [ir] + twoc2Dt * (Jhalf [il] - Jhalf [ir])
+						 + Krightnew [il] * Vnew [il] + (Kleftnew [ir] - Pturbrightnew [il]) * Vnew [ir]) /
+						(Vnew [il] + Vnew [ir]);   /* 5.131 */
+					Qleftnew [ir] = Qrightnew [il] + Pturbrightnew [il];   /* 5.131 */
+				} else if (ir2) {   /* Two adjacent tubes at the right side (velic). */
+					Jleftnew [ir1] =
+						(Jleft [ir1] * Dxhalf [ir1] * (1 / (A [il] + A [ir2]) + 1 / A [ir1]) +
+						 twoDt * ((Ahalf [il] * Qhalf [il] + Ahalf [ir2] * Qhalf [ir2] ) / (Ahalf [il]  + Ahalf [ir2]) - Qhalf [ir1])) /
+						(1 / (1 / r [il] + 1 / r [ir2]) + r [ir1]);   /* 5.138 */
+					Jleftnew [ir2] =
+						(Jleft [ir2] * Dxhalf [ir2] * (1 / (A [il] + A [ir1]) + 1 / A [ir2]) +
+						 twoDt * ((Ahalf [il] * Qhalf [il] + Ahalf [ir1] * Qhalf [ir1] ) / (Ahalf [il]  + Ahalf [ir1]) - Qhalf [ir2])) /
+						(1 / (1 / r [il] + 1 / r [ir1]) + r [ir2]);   /* 5.138 */
+					Jrightnew [il] = Jleftnew [ir1] + Jleftnew [ir2];   /* 5.139 */
+					prightnew [il] = Jrightnew [il] / Anew [il];   /* 5.128 */
+					pleftnew [ir1] = Jleftnew [ir1] / Anew [ir1];   /* 5.128 */
+					pleftnew [ir2] = Jleftnew [ir2] / Anew [ir2];   /* 5.128 */
+					Krightnew [il] = onebytworho0 * prightnew [il] * prightnew [il];   /* 5.128 */
+					Kleftnew [ir1] = onebytworho0 * pleftnew [ir1] * pleftnew [ir1];   /* 5.128 */
+					Kleftnew [ir2] = onebytworho0 * pleftnew [ir2] * pleftnew [ir2];   /* 5.128 */
+					Qrightnew [il] = Qleftnew [ir1] = Qleftnew [ir2] =
+						(eright [il] + eleft [ir1] + eleft [ir2] + twoc2Dt * (Jhalf [il] - Jhalf [ir1] - Jhalf [ir2]) +
+						 Krightnew [il] * Vnew [il] + Kleftnew [ir1] * Vnew [ir1] + Kleftnew [ir2] * Vnew [ir2]) /
+						(Vnew [il] + Vnew [ir1] + Vnew [ir2]);   /* 5.137 */
+				} else {
+					Melder_assert (il2 != 0);
+					Jrightnew [il1] =
+						(Jright [il1] * Dxhalf [il1] * (1 / (A [ir] + A [il2]) + 1 / A [il1]) -
+						 twoDt * ((Ahalf [ir] * Qhalf [ir] + Ahalf [il2] * Qhalf [il2] ) / (Ahalf [ir]  + Ahalf [il2]) - Qhalf [il1])) /
+						(1 / (1 / r [ir] + 1 / r [il2]) + r [il1]);   /* 5.138 */
+					Jrightnew [il2] =
+						(Jright [il2] * Dxhalf [il2] * (1 / (A [ir] + A [il1]) + 1 / A [il2]) -
+						 twoDt * ((Ahalf [ir] * Qhalf [ir] + Ahalf [il1]  * Qhalf [il1] ) / (Ahalf [ir]  + Ahalf [il1]) - Qhalf [il2])) /
+						(1 / (1 / r [ir] + 1 / r [il1]) + r [il2]);   /* 5.138 */
+					Jleftnew [ir] = Jrightnew [il1] + Jrightnew [il2];   /* 5.139 */
+					pleftnew [ir] = Jleftnew [ir] / Anew [ir];   /* 5.128 */
+					prightnew [il1] = Jrightnew [il1] / Anew [il1];   /* 5.128 */
+					prightnew [il2] = Jrightnew [il2] / Anew [il2];   /* 5.128 */
+					Kleftnew [ir] = onebytworho0 * pleftnew [ir] * pleftnew [ir];   /* 5.128 */
+					Krightnew [il1] = onebytworho0 * prightnew [il1] * prightnew [il1];   /* 5.128 */
+					Krightnew [il2] = onebytworho0 * prightnew [il2] * prightnew [il2];   /* 5.128 */
+					Qleftnew [ir] = Qrightnew [il1] = Qrightnew [il2] =
+						(eleft [ir] + eright [il1] + eright [il2] + twoc2Dt * (Jhalf [il1] + Jhalf [il2] - Jhalf [ir]) +
+						 Kleftnew [ir] * Vnew [ir] + Krightnew [il1] * Vnew [il1] + Krightnew [il2] * Vnew [il2]) /
+						(Vnew [ir] + Vnew [il1] + Vnew [il2]);   /* 5.137 */
+				}
+			}
+
+			/* Save the result. */
+
+			if (n == (oversampling + 1) / 2) {
+				double out = 0.0;
+				for (long m = 1; m <= M; m ++) {
+					out += rho0 * Dx [m] * Dz [m] * dDydt [m] * Dt * 1000;   /* Radiation of wall movement, 5.140. */
+					if (right1 [m] == 0)
+						out += Jrightnew [m] - Jright [m];   /* Radiation of open tube end. */
+				}
+				thy z [1] [sample] = out /= 4 * NUMpi * 0.4 * Dt;   /* At 0.4 metres. */
+			}
+
+			/*
+			 * Advance the state.
+			 * Every "new" array is completely rewritten in each step, so that we can simply exchange the old and new arrays;
+			 * the turbulence pressure is the exception, because it is only set when the flow is fast enough.
+			 */
+			swapArrays (& Jleft, & Jleftnew);
+			swapArrays (& Jright, & Jrightnew);
+			swapArrays (& Qleft, & Qleftnew);
+			swapArrays (& Qright, & Qrightnew);
+			swapArrays (& Dy, & Dynew);
+			swapArrays (& dDydt, & dDydtnew);
+			swapArrays (& A, & Anew);
+			swapArrays (& Dx, & Dxnew);
+			swapArrays (& pleft, & pleftnew);
+			swapArrays (& pright, & prightnew);
+			swapArrays (& Kleft, & Kleftnew);
+			swapArrays (& Kright, & Krightnew);
+			swapArrays (& V, & Vnew);
+			for (long m = 1; m <= M; m ++)
+				Pturbright [m] = Pturbrightnew [m];
+		}
+	}
+}
+
+Sound Artword_Speaker_to_Sound_fast (Artword artword, Speaker speaker, double samplingFrequency, int oversampling) {
+	try {
+		autoSound result = Sound_createSimple (1, artword -> totalTime, samplingFrequency);
+		autoArt art = Art_create ();
+		autoDelta delta = Speaker_to_Delta (speaker);
+		struct structDelta_Arrays arrays;
+		Delta_Arrays_init (& arrays, delta.peek());
+		autoMelderProgress progress (L"Articulatory synthesis");
+		volatile long numberOfSamplesDone = 0;
+		Artword_Speaker_into_Sound_fast (artword, speaker, art.peek(), delta.peek(), & arrays,
+			result.peek(), samplingFrequency, oversampling, 0, & numberOfSamplesDone, result -> nx, NULL);
+		return result.transfer();
+	} catch (MelderError) {
+		Melder_throw (artword, " & ", speaker, ": articulatory synthesis not performed.");
+	}
+}
+
+Thing_define (Artword_Speaker_to_Sound_Args, Thing) { public:
+	long numberOfPairs;
+	Artword *artwords;
+	Speaker *speakers;
+	Sound *sounds;
+	double samplingFrequency;
+	int oversampling;
+	int threadNumber;
+	volatile long *nextPair, *numberOfSamplesDone;
+	long totalNumberOfSamples;
+	volatile int *cancelled;
+};
+
+Thing_implement (Artword_Speaker_to_Sound_Args, Thing, 0);
+
+MelderThread_MUTEX (batchMutex);
+static bool batchMutex_inited;
+
+static MelderThread_RETURN_TYPE Artword_Speaker_to_Sound_batch (Artword_Speaker_to_Sound_Args me) {
+	for (;;) {
+		long ipair;
+		MelderThread_LOCK (batchMutex);
+		ipair = ++ *my nextPair;   // dynamic scheduling, because utterances can differ in duration
+		MelderThread_UNLOCK (batchMutex);
+		if (ipair > my numberOfPairs || *my cancelled) break;
+		autoArt art;
+		autoDelta delta;
+		struct structDelta_Arrays arrays;
+		MelderThread_LOCK (batchMutex);
+		art.reset (Art_create ());
+		delta.reset (Speaker_to_Delta (my speakers [ipair]));
+		Delta_Arrays_init (& arrays, delta.peek());
+		MelderThread_UNLOCK (batchMutex);
+		Artword_Speaker_into_Sound_fast (my artwords [ipair], my speakers [ipair], art.peek(), delta.peek(), & arrays,
+			my sounds [ipair], my samplingFrequency, my oversampling, my threadNumber, my numberOfSamplesDone, my totalNumberOfSamples, my cancelled);
+		MelderThread_LOCK (batchMutex);
+		art.reset (NULL);
+		delta.reset (NULL);
+		MelderThread_UNLOCK (batchMutex);
+	}
+	MelderThread_RETURN;
+}
+
+void Artwords_Speakers_to_Sounds (long numberOfPairs, Artword *artwords, Speaker *speakers,
+	double samplingFrequency, int oversampling, Sound *sounds)
+{
+	autoNUMvector <Sound> results (1, numberOfPairs);
+	try {
+		long totalNumberOfSamples = 0;
+		for (long ipair = 1; ipair <= numberOfPairs; ipair ++) {
+			results [ipair] = Sound_createSimple (1, artwords [ipair] -> totalTime, samplingFrequency);
+			totalNumberOfSamples += results [ipair] -> nx;
+		}
+		autoMelderProgress progress (L"Articulatory synthesis");
+
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfPairs) numberOfThreads = numberOfPairs;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+
+		if (! batchMutex_inited) { MelderThread_MUTEX_INIT (batchMutex); batchMutex_inited = true; }
+		autoArtword_Speaker_to_Sound_Args args [16];
+		volatile long nextPair = 0, numberOfSamplesDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoArtword_Speaker_to_Sound_Args arg = Thing_new (Artword_Speaker_to_Sound_Args);
+			arg -> numberOfPairs = numberOfPairs;
+			arg -> artwords = artwords;
+			arg -> speakers = speakers;
+			arg -> sounds = results.peek();
+			arg -> samplingFrequency = samplingFrequency;
+			arg -> oversampling = oversampling;
+			/*
+			 * Every thread draws its turbulence noise from its own random generator.
+			 * The last thread runs in the main thread and reports progress (thread number 1 or lower).
+			 */
+			arg -> threadNumber = ithread == numberOfThreads ? 1 : ithread + 1;
+			arg -> nextPair = & nextPair;
+			arg -> numberOfSamplesDone = & numberOfSamplesDone;
+			arg -> totalNumberOfSamples = totalNumberOfSamples;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
+		}
+		MelderThread_run (Artword_Speaker_to_Sound_batch, args, numberOfThreads);
+
+		for (long ipair = 1; ipair <= numberOfPairs; ipair ++) {
+			sounds [ipair] = results [ipair];
+			results [ipair] = NULL;
+		}
+	} catch (MelderError) {
+		for (long ipair = 1; ipair <= numberOfPairs; ipair ++)
+			forget (results [ipair]);
+		Melder_throw ("Articulatory synthesis of ", numberOfPairs, " utterances not performed.");
+	}
+}
+
+/* End of file Artword_Speaker_to_Sound_fast.cpp */
@@ -223,6 +223,32 @@ DO
 	if (iv3) praat_new (v3, L"velocity", Melder_integer (iv3));
 END
 
+FORM (Artwords_Speaker_to_Sounds, L"Articulatory synthesizer (batch)", L"Artword & Speaker: To Sound...")
+	POSITIVE (L"Sampling frequency (Hz)", L"22050")
+	NATURAL (L"Oversampling factor", L"25")
+	OK
+DO
+	Speaker speaker = FIRST (Speaker);
+	long numberOfArtwords = 0;
+	LOOP if (CLASS == classArtword) numberOfArtwords ++;
+	autoNUMvector <Artword> artwords (1, numberOfArtwords);
+	autoNUMvector <Speaker> speakers (1, numberOfArtwords);
+	autoNUMvector <Sound> sounds (1, numberOfArtwords);
+	long iartword = 0;
+	LOOP if (CLASS == classArtword) {
+		iartword ++;
+		artwords [iartword] = (Artword) OBJECT;
+		speakers [iartword] = speaker;
+	}
+	Artwords_Speakers_to_Sounds (numberOfArtwords, artwords.peek(), speakers.peek(),
+		GET_REAL (L"Sampling frequency"), GET_INTEGER (L"Oversampling factor"), sounds.peek());
+	for (iartword = 1; iartword <= numberOfArtwords; iartword ++) {
+		autoSound him = sounds [iartword];
+		sounds [iartword] = NULL;
+		praat_new (him.transfer(), artwords [iartword] -> name, L"_", speaker -> name);
+	}
+END
+
 /***** ARTWORD & SPEAKER [ & SOUND ] *****/
 
 DIRECT (Artword_Speaker_movie)
@@ -383,6 +409,7 @@ void praat_uvafon_Artsynth_init (void) {
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, L"Draw...", 0, 0, DO_Artword_Speaker_draw);
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, L"Synthesize", 0, 0, 0);
 	praat_addAction2 (classArtword, 1, classSpeaker, 1, L"To Sound...", 0, 0, DO_Artword_Speaker_to_Sound);
+	praat_addAction2 (classArtword, 0, classSpeaker, 1, L"To Sounds (batch)...", 0, 0, DO_Artwords_Speaker_to_Sounds);
 
 	praat_addAction3 (classArtword, 1, classSpeaker, 1, classSound, 1, L"Movie", 0, 0, DO_Artword_Speaker_movie);
 
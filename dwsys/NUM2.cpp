@@ -68,12 +68,14 @@
 #include "SVD.h"
 #include "Eigen.h"
 #include "NUMclapack.h"
+#include "NUMcblas.h"
 #ifndef _NUM_h_
 #include "NUM.h"
 #endif
 #include "NUM2.h"
 #include "NUMmachar.h"
 #include "melder.h"
+#include "MelderThread.h"
 
 #include "gsl_randist.h"
 
@@ -439,20 +441,31 @@ void NUMcolumn2_avevar (double **a, long nr, long nc, long icol1, long icol2,
 	}
 }
 
+void NUM_addCompensated (double x, double *sum, double *compensation) {
+	double t = *sum + x;
+	if (fabs (*sum) >= fabs (x)) {
+		*compensation += (*sum - t) + x;
+	} else {
+		*compensation += (x - t) + *sum;
+	}
+	*sum = t;
+}
+
 void NUMvector_smoothByMovingAverage (double *xin, long n, long nwindow, double *xout) {
 // simple averaging, out of bound values are zero
+// The window sum is kept as a running sum, compensated for rounding (Neumaier), so the cost does not grow with nwindow.
+	long left = nwindow / 2, right = (nwindow % 2) == 0 ? left - 1 : left;
+	long jfrom = 1, jto = 0;
+	double sum = 0, compensation = 0;
 	for (long i = 1; i <= n; i++) {
-		long jfrom = i - nwindow / 2, jto = i + nwindow / 2;
-		if ((nwindow % 2) == 0) {
-			jto--;
+		long newFrom = i - left < 1 ? 1 : i - left, newTo = i + right > n ? n : i + right;
+		while (jto < newTo) {
+			NUM_addCompensated (xin[++jto], & sum, & compensation);
 		}
-		jfrom = jfrom < 1 ? 1 : jfrom;
-		jto = jto > n ? n : jto;
-		xout[i] = 0;
-		for (long j = jfrom; j <= jto; j++) {
-			xout[i] += xin[j];
+		while (jfrom < newFrom) {
+			NUM_addCompensated (- xin[jfrom++], & sum, & compensation);
 		}
-		xout[i] /= jto - jfrom + 1;
+		xout[i] = (sum + compensation) / (jto - jfrom + 1);
 	}
 }
 
@@ -460,6 +473,27 @@ void NUMcovarianceFromColumnCentredMatrix (double **x, long nrows, long ncols, l
 	if (ndf < 0 || nrows - ndf < 1 || covar == 0) {
 		Melder_throw ("Invalid arguments.");
 	}
+	/*
+		If the rows of x are equally spaced in memory (as in every NUMmatrix),
+		x is a column-major ncols x nrows matrix, and x'x is a symmetric rank-k update.
+	*/
+	long rowStride = nrows > 1 ? x[2] - x[1] : ncols;
+	bool equallySpacedRows = rowStride >= ncols;
+	for (long k = 3; equallySpacedRows && k <= nrows; k++) {
+		equallySpacedRows = x[k] - x[k - 1] == rowStride;
+	}
+	if (equallySpacedRows) {
+		autoNUMmatrix<double> xtx (1, ncols, 1, ncols);
+		double alpha = 1.0 / (nrows - ndf), beta = 0.0;
+		long n = ncols, k = nrows, ldc = ncols;
+		(void) NUMblas_dsyrk ("U", "N", &n, &k, &alpha, &x[1][1], &rowStride, &beta, &xtx[1][1], &ldc);
+		for (long i = 1; i <= ncols; i++) {
+			for (long j = i; j <= ncols; j++) {
+				covar[i][j] = covar[j][i] = xtx[j][i];
+			}
+		}
+		return;
+	}
 	for (long i = 1; i <= ncols; i++) {
 		for (long j = i; j <= ncols; j++) {
 			double sum = 0;
@@ -597,27 +631,29 @@ void NUMlocate (double *xx, long n, double x, long *index) {
 	Regression is ascending
 */
 void NUMmonotoneRegression (const double x[], long n, double xs[]) {
-	double xt = NUMundefined; // Only to stop gcc complaining "may be used unitialized"
-
+	/*
+		Pool adjacent violators, keeping the pools on a stack: order n instead of n^2.
+		A new value is merged with the pools before it as long as their mean is larger.
+	*/
+	autoNUMvector<double> poolSum (1, n);
+	autoNUMvector<long> poolSize (1, n);
+	long numberOfPools = 0;
 	for (long i = 1; i <= n; i++) {
-		xs[i] = x[i];
-	}
-
-	for (long i = 2; i <= n; i++) {
-		if (xs[i] >= xs[i - 1]) {
-			continue;
+		numberOfPools++;
+		poolSum[numberOfPools] = x[i];
+		poolSize[numberOfPools] = 1;
+		while (numberOfPools > 1 && poolSum[numberOfPools - 1] / poolSize[numberOfPools - 1] >
+		        poolSum[numberOfPools] / poolSize[numberOfPools]) {
+			poolSum[numberOfPools - 1] += poolSum[numberOfPools];
+			poolSize[numberOfPools - 1] += poolSize[numberOfPools];
+			numberOfPools--;
 		}
-		double sum = xs[i];
-		long nt = 1;
-		for (long j = 1; j <= i - 1; j++) {
-			sum += xs[i - j]; nt++;
-			xt = sum / nt; // i >= 2 -> xt always gets a value
-			if (j < i - 1 && xt >= xs[i - j - 1]) {
-				break;
-			}
-		}
-		for (long j = i - nt + 1; j <= i; j++) {
-			xs[j] = xt;
+	}
+	long i = 1;
+	for (long ipool = 1; ipool <= numberOfPools; ipool++) {
+		double xt = poolSum[ipool] / poolSize[ipool];
+		for (long j = 1; j <= poolSize[ipool]; j++) {
+			xs[i++] = xt;
 		}
 	}
 }
@@ -787,6 +823,141 @@ double NUMmahalanobisDistance_chi (double **linv, double *v, double *m, long nr,
 	return chisq;
 }
 
+#define NUMmahalanobis_BLOCK_SIZE  64
+
+/*
+	One block of rows against one group. The differences x - m are computed once per row (diff [r] [1..n]),
+	and four rows at a time share every element of linv, each row with its own accumulator;
+	every row therefore sums in the same order as NUMmahalanobisDistance_chi.
+*/
+static void NUMmahalanobisDistances_chi_block (double **linv, long nr, double *m, long n,
+	double **x, long numberOfRowsInBlock, double **diff, double *chisq)
+{
+	const long nb = numberOfRowsInBlock;
+	for (long r = 0; r < nb; r ++) {
+		const double *xr = x [r];
+		double *diffr = diff [r];
+		for (long j = 1; j <= n; j ++) {
+			diffr [j] = xr [j] - m [j];
+		}
+	}
+	if (nr == 1) {
+		const double *l = linv [1];
+		for (long r = 0; r < nb; r ++) {
+			const double *diffr = diff [r];
+			double sum = 0.0;
+			for (long j = 1; j <= n; j ++) {
+				double t = l [j] * diffr [j];
+				sum += t * t;
+			}
+			chisq [r] = sum;
+		}
+		return;
+	}
+	long r = 0;
+	for (; r + 3 < nb; r += 4) {
+		const double *d0 = diff [r], *d1 = diff [r + 1], *d2 = diff [r + 2], *d3 = diff [r + 3];
+		double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+		for (long i = n; i > 0; i --) {
+			const double *li = linv [i];
+			double t0 = 0.0, t1 = 0.0, t2 = 0.0, t3 = 0.0;
+			for (long j = 1; j <= i; j ++) {
+				double lij = li [j];
+				t0 += lij * d0 [j];
+				t1 += lij * d1 [j];
+				t2 += lij * d2 [j];
+				t3 += lij * d3 [j];
+			}
+			sum0 += t0 * t0;
+			sum1 += t1 * t1;
+			sum2 += t2 * t2;
+			sum3 += t3 * t3;
+		}
+		chisq [r] = sum0;
+		chisq [r + 1] = sum1;
+		chisq [r + 2] = sum2;
+		chisq [r + 3] = sum3;
+	}
+	for (; r < nb; r ++) {
+		const double *d0 = diff [r];
+		double sum0 = 0.0;
+		for (long i = n; i > 0; i --) {
+			const double *li = linv [i];
+			double t0 = 0.0;
+			for (long j = 1; j <= i; j ++) {
+				t0 += li [j] * d0 [j];
+			}
+			sum0 += t0 * t0;
+		}
+		chisq [r] = sum0;
+	}
+}
+
+Thing_define (NUMmahalanobisDistances_Args, Thing) { public:
+	double ***linv, **m, **x, **chisq;
+	long *nr, numberOfGroups, n, numberOfRows;
+	double **diff, *block;   // per thread: diff [0..BLOCK_SIZE-1] [1..n], block [0..BLOCK_SIZE-1]
+	volatile long *nextBlock;
+};
+
+Thing_implement (NUMmahalanobisDistances_Args, Thing, 0);
+
+MelderThread_MUTEX (mahalanobisMutex);
+static bool mahalanobisMutex_inited;
+
+static MelderThread_RETURN_TYPE NUMmahalanobisDistances_chi_blocks (NUMmahalanobisDistances_Args me) {
+	const long numberOfBlocks = (my numberOfRows - 1) / NUMmahalanobis_BLOCK_SIZE + 1;
+	for (;;) {
+		MelderThread_LOCK (mahalanobisMutex);
+		long iblock = ++ *my nextBlock;
+		MelderThread_UNLOCK (mahalanobisMutex);
+		if (iblock > numberOfBlocks) break;
+		long firstRow = (iblock - 1) * NUMmahalanobis_BLOCK_SIZE + 1;
+		long numberOfRowsInBlock = my numberOfRows - firstRow + 1;
+		if (numberOfRowsInBlock > NUMmahalanobis_BLOCK_SIZE) numberOfRowsInBlock = NUMmahalanobis_BLOCK_SIZE;
+		for (long g = 1; g <= my numberOfGroups; g ++) {
+			NUMmahalanobisDistances_chi_block (my linv [g], my nr [g], my m [g], my n,
+				& my x [firstRow], numberOfRowsInBlock, my diff, my block);
+			for (long r = 0; r < numberOfRowsInBlock; r ++) {
+				my chisq [firstRow + r] [g] = my block [r];
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+void NUMmahalanobisDistances_chi (double ***linv, long *nr, double **m, long numberOfGroups, long n,
+	double **x, long numberOfRows, double **chisq)
+{
+	if (numberOfRows < 1 || numberOfGroups < 1) return;
+	const long numberOfBlocks = (numberOfRows - 1) / NUMmahalanobis_BLOCK_SIZE + 1;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! mahalanobisMutex_inited) { MelderThread_MUTEX_INIT (mahalanobisMutex); mahalanobisMutex_inited = true; }
+	autoNUMmatrix <double> diff ((long) 0, numberOfThreads * NUMmahalanobis_BLOCK_SIZE - 1, 1, n);
+	autoNUMmatrix <double> block (1, numberOfThreads, 0, NUMmahalanobis_BLOCK_SIZE - 1);
+	autoNUMmahalanobisDistances_Args args [16];
+	volatile long nextBlock = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoNUMmahalanobisDistances_Args arg = Thing_new (NUMmahalanobisDistances_Args);
+		arg -> linv = linv;
+		arg -> nr = nr;
+		arg -> m = m;
+		arg -> numberOfGroups = numberOfGroups;
+		arg -> n = n;
+		arg -> x = x;
+		arg -> numberOfRows = numberOfRows;
+		arg -> chisq = chisq;
+		arg -> diff = & diff [(ithread - 1) * NUMmahalanobis_BLOCK_SIZE];
+		arg -> block = block [ithread];
+		arg -> nextBlock = & nextBlock;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (NUMmahalanobisDistances_chi_blocks, args, numberOfThreads);
+}
+
 double NUMtrace (double **a, long n) {
 	double trace = 0;
 	for (long i = 1; i <= n; i++) {
@@ -1290,12 +1461,70 @@ void NUMsolveWeaklyConstrainedLinearRegression (double **f, long n, long m, doub
 	}
 }
 
-void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, double **t, double *v, double *s) {
+/*
+	The translated LAPACK routines keep their local variables in static storage,
+	so workspaces that are used in different threads take turns for the SVD.
+*/
+MelderThread_MUTEX (procrustesMutex);
+static bool procrustesMutex_inited;
+
+struct structNUMProcrustesWorkspace {
+	long nPoints, nDimensions;
+	double **c, **xc, **yc, **yt;
+	SVD svd;
+	double *work;   // for NUMlapack_dgesvd, so that running the workspace does not allocate or throw
+	long lwork;
+};
+
+void NUMProcrustesWorkspace_delete (NUMProcrustesWorkspace me) {
+	if (me == NULL) return;
+	NUMmatrix_free<double> (my c, 1, 1);
+	NUMmatrix_free<double> (my xc, 1, 1);
+	NUMmatrix_free<double> (my yc, 1, 1);
+	NUMmatrix_free<double> (my yt, 1, 1);
+	forget (my svd);
+	NUMvector_free<double> (my work, 0);
+	Melder_free (me);
+}
+
+NUMProcrustesWorkspace NUMProcrustesWorkspace_new (long nPoints, long nDimensions) {
+	NUMProcrustesWorkspace me = NULL;
+	if (! procrustesMutex_inited) { MelderThread_MUTEX_INIT (procrustesMutex); procrustesMutex_inited = true; }
+	try {
+		me = Melder_calloc (structNUMProcrustesWorkspace, 1);
+		my nPoints = nPoints;
+		my nDimensions = nDimensions;
+		my c = NUMmatrix<double> (1, nDimensions, 1, nDimensions);
+		my xc = NUMmatrix<double> (1, nPoints, 1, nDimensions);
+		my yc = NUMmatrix<double> (1, nPoints, 1, nDimensions);
+		my yt = NUMmatrix<double> (1, nPoints, 1, nDimensions);
+		my svd = SVD_create (nDimensions, nDimensions);
+		/*
+			The workspace query of SVD_compute.
+		*/
+		char jobu = 'S', jobvt = 'O';
+		long n = nDimensions, info, lwork = -1;
+		double wt [2];
+		(void) NUMlapack_dgesvd (& jobu, & jobvt, & n, & n, & my svd -> u [1] [1], & n, & my svd -> d [1], & my svd -> v [1] [1], & n,
+			NULL, & n, wt, & lwork, & info);
+		if (info != 0) {
+			Melder_throw ("SVD not precomputed.");
+		}
+		my lwork = wt [0];
+		my work = NUMvector<double> (0, my lwork);
+		return me;
+	} catch (MelderError) {
+		NUMProcrustesWorkspace_delete (me);
+		Melder_throw ("Procrustes workspace not created.");
+	}
+}
+
+bool NUMProcrustesWorkspace_run (NUMProcrustesWorkspace me, double **x, double **y, double **t, double *v, double *s) {
 	int orthogonal = v == 0 || s == 0; /* else similarity transform */
+	long nPoints = my nPoints, nDimensions = my nDimensions;
+	double **c = my c, **yc = my yc;
 
-	autoNUMmatrix<double> c (1, nDimensions, 1, nDimensions);
-	autoNUMmatrix<double> yc (1, nPoints, 1, nDimensions);
-	NUMmatrix_copyElements (y, yc.peek(), 1, nPoints, 1, nDimensions);
+	NUMmatrix_copyElements (y, yc, 1, nPoints, 1, nDimensions);
 
 	/*
 		Reference: Borg & Groenen (1997), Modern multidimensional scaling,
@@ -1306,10 +1535,11 @@ void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, doub
 	*/
 
 	if (! orthogonal) {
-		NUMcentreColumns (yc.peek(), 1, nPoints, 1, nDimensions, NULL);
+		NUMcentreColumns (yc, 1, nPoints, 1, nDimensions, NULL);
 	}
 	for (long i = 1; i <= nDimensions; i++) {
 		for (long j = 1; j <= nDimensions; j++) {
+			c[i][j] = 0;
 			for (long k = 1; k <= nPoints; k++) {
 				c[i][j] += x[k][i] * yc[k][j];
 			}
@@ -1317,15 +1547,33 @@ void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, doub
 	}
 
 	// 2. Decompose C by SVD:  C = PDQ' (SVD attribute is Q instead of Q'!)
-
-	autoSVD svd = SVD_create_d (c.peek(), nDimensions, nDimensions);
+	// As SVD_svd_d, but with the work vector of the workspace, and without throwing.
+
+	SVD svd = my svd;
+	NUMmatrix_copyElements (c, svd -> u, 1, nDimensions, 1, nDimensions);
+	char jobu = 'S', jobvt = 'O';
+	long n = nDimensions, lwork = my lwork, info;
+	MelderThread_LOCK (procrustesMutex);
+	(void) NUMlapack_dgesvd (& jobu, & jobvt, & n, & n, & svd -> u [1] [1], & n, & svd -> d [1], & svd -> v [1] [1], & n,
+		NULL, & n, my work, & lwork, & info);
+	MelderThread_UNLOCK (procrustesMutex);
+	if (info != 0) {
+		return false;
+	}
+	for (long i = 1; i < nDimensions; i++) {
+		for (long j = i + 1; j <= nDimensions; j++) {
+			double tmp = svd -> v[i][j];
+			svd -> v[i][j] = svd -> v[j][i];
+			svd -> v[j][i] = tmp;
+		}
+	}
 	double trace = 0;
 	for (long i = 1; i <= nDimensions; i++) {
 		trace += svd -> d[i];
 	}
 
 	if (trace == 0) {
-		Melder_throw ("NUMProcrustes: degenerate configuration(s).");
+		return false;
 	}
 
 	// 3. T = QP'
@@ -1340,15 +1588,15 @@ void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, doub
 	}
 
 	if (! orthogonal) {
-		autoNUMmatrix<double> xc (1, nPoints, 1, nDimensions);
-		NUMmatrix_copyElements (x, xc.peek(), 1, nPoints, 1, nDimensions);
-		autoNUMmatrix<double> yt (1, nPoints, 1, nDimensions);
+		double **xc = my xc, **yt = my yt;
+		NUMmatrix_copyElements (x, xc, 1, nPoints, 1, nDimensions);
 
 		// 4. Dilation factor s = (tr X'JYT) / (tr Y'JY)
 		// First we need YT.
 
 		for (long i = 1; i <= nPoints; i++) {
 			for (long j = 1; j <= nDimensions; j++) {
+				yt[i][j] = 0;
 				for (long k = 1; k <= nDimensions; k++) {
 					yt[i][j] += y[i][k] * t[k][j];
 				}
@@ -1357,7 +1605,7 @@ void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, doub
 
 		// X'J amount to centering the columns of X
 
-		NUMcentreColumns (xc.peek(), 1, nPoints, 1, nDimensions, NULL);
+		NUMcentreColumns (xc, 1, nPoints, 1, nDimensions, NULL);
 
 		// tr X'J YT == tr xc' yt
 
@@ -1379,12 +1627,23 @@ void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, doub
 		// 5. Translation vector tr = (X - sYT)'1 / nPoints
 
 		for (long i = 1; i <= nDimensions; i++) {
+			v[i] = 0;
 			for (long j = 1; j <= nPoints; j++) {
 				v[i] += x[j][i] - *s * yt[j][i];
 			}
 			v[i] /= nPoints;
 		}
 	}
+	return true;
+}
+
+void NUMProcrustes (double **x, double **y, long nPoints, long nDimensions, double **t, double *v, double *s) {
+	NUMProcrustesWorkspace workspace = NUMProcrustesWorkspace_new (nPoints, nDimensions);
+	bool fitted = NUMProcrustesWorkspace_run (workspace, x, y, t, v, s);
+	NUMProcrustesWorkspace_delete (workspace);
+	if (! fitted) {
+		Melder_throw ("NUMProcrustes: degenerate configuration(s), or the SVD could not be computed.");
+	}
 }
 
 
@@ -2070,6 +2329,245 @@ double NUMformantfilter_amplitude (double fc, double bw, double f) {
 	return 1.0 / (dq * dq + 1.0);
 }
 
+/*
+	With the analytic gammatone
+		g [m] = amplitude * tau_m^(order-1) * exp ((- decayRate + i omega) tau_m),   tau_m = (delay + m + 0.5) / samplingFrequency - latency,
+	so that h [delay + 1 + m] = Re g [m], the sequence g [0], g [1], ... has the z-transform
+		B (z) / (1 - pole z^-1)^order,   pole = exp ((- decayRate + i omega) / samplingFrequency),
+	with the numerator b [k] = sum (j = 0 .. k, binomial (order, j) (- pole)^j g [k - j]), k = 0 .. order - 1,
+	because the order-th difference of a polynomial of degree order-1 vanishes.
+	The sequence g [length], g [length + 1], ... has the numerator 'tail' in the same way,
+	so that B (z) - z^-length Tail (z) describes the truncated gammatone exactly.
+*/
+static void NUMgammatone_analytic (long order, double amplitude, double decayRate, double omega, double tau, double *re, double *im) {
+	double envelope = amplitude * pow (tau, order - 1) * exp (- decayRate * tau);
+	*re = envelope * cos (omega * tau);
+	*im = envelope * sin (omega * tau);
+}
+
+void NUMgammatone_init (NUMgammatone me, long order, double amplitude, double decayRate, double frequency,
+	double latency, long numberOfTaps, double samplingFrequency)
+{
+	Melder_assert (order >= 1 && order <= NUMgammatone_MAXIMUM_ORDER);
+	Melder_assert (samplingFrequency > 0.0);
+	double omega = NUM2pi * frequency;
+	my order = order;
+	my delay = 0;
+	while (my delay < numberOfTaps && (my delay + 0.5) / samplingFrequency <= latency) my delay ++;
+	my length = numberOfTaps > my delay ? numberOfTaps - my delay : 0;
+	double decay = exp (- decayRate / samplingFrequency);
+	my pole_re = decay * cos (omega / samplingFrequency);
+	my pole_im = decay * sin (omega / samplingFrequency);
+	double weight_re [NUMgammatone_MAXIMUM_ORDER], weight_im [NUMgammatone_MAXIMUM_ORDER];   // binomial (order, j) (- pole)^j
+	double power_re = 1.0, power_im = 0.0, binomial = 1.0;
+	for (long j = 0; j < order; j ++) {
+		weight_re [j] = binomial * power_re;
+		weight_im [j] = binomial * power_im;
+		double re = - (power_re * my pole_re - power_im * my pole_im);
+		power_im = - (power_re * my pole_im + power_im * my pole_re);
+		power_re = re;
+		binomial = binomial * (order - j) / (j + 1);
+	}
+	for (int part = 0; part <= 1; part ++) {
+		long offset = part == 0 ? 0 : my length;
+		double *numerator_re = part == 0 ? my head_re : my tail_re, *numerator_im = part == 0 ? my head_im : my tail_im;
+		for (long k = 0; k < order; k ++) {
+			double sum_re = 0.0, sum_im = 0.0;
+			if (my length > 0) {
+				for (long j = 0; j <= k; j ++) {
+					double tau = (my delay + offset + k - j + 0.5) / samplingFrequency - latency, g_re, g_im;
+					NUMgammatone_analytic (order, amplitude, decayRate, omega, tau, & g_re, & g_im);
+					sum_re += weight_re [j] * g_re - weight_im [j] * g_im;
+					sum_im += weight_re [j] * g_im + weight_im [j] * g_re;
+				}
+			}
+			numerator_re [k] = sum_re;
+			numerator_im [k] = sum_im;
+		}
+	}
+}
+
+void NUMgammatone_filter (NUMgammatone me, const double x [], long nx, double y [], long ny) {
+	const long order = my order, delay = my delay, length = my length;
+	const double pole_re = my pole_re, pole_im = my pole_im;
+	double state_re [NUMgammatone_MAXIMUM_ORDER], state_im [NUMgammatone_MAXIMUM_ORDER];
+	for (long k = 0; k < order; k ++) {
+		state_re [k] = state_im [k] = 0.0;
+	}
+	for (long i = 1; i <= ny; i ++) {
+		double u_re = 0.0, u_im = 0.0;
+		for (long k = 0, j = i - delay; k < order && j >= 1; k ++, j --) {
+			if (j <= nx) {
+				u_re += my head_re [k] * x [j];
+				u_im += my head_im [k] * x [j];
+			}
+		}
+		for (long k = 0, j = i - delay - length; k < order && j >= 1; k ++, j --) {
+			if (j <= nx) {
+				u_re -= my tail_re [k] * x [j];
+				u_im -= my tail_im [k] * x [j];
+			}
+		}
+		for (long k = 0; k < order; k ++) {
+			double re = u_re + pole_re * state_re [k] - pole_im * state_im [k];
+			double im = u_im + pole_re * state_im [k] + pole_im * state_re [k];
+			state_re [k] = u_re = re;
+			state_im [k] = u_im = im;
+		}
+		y [i] = u_re;
+	}
+}
+
+#define NUMresampler_MAXIMUM_NUMBER_OF_PHASES  2048
+#define NUMresampler_MAXIMUM_TABLE_SIZE  2000000
+
+/*
+ * Weights w [0..2*halfWidth-1] for the input samples n - halfWidth + 1 .. n + halfWidth
+ * around an output sample at input position n + phase (0 <= phase < 1).
+ * They are normalized to sum to one, so that a constant signal remains constant.
+ */
+static void NUMresampler_computeWeights (NUMresampler me, double phase, double *w) {
+	const long numberOfTaps = 2 * my halfWidth;
+	/*
+	 * The sines and cosines are advanced tap by tap by rotation, as in NUM_interpolate_sinc.
+	 */
+	double d = 1 - my halfWidth - phase;
+	double x = NUMpi * my cutoff * d, dx = NUMpi * my cutoff;
+	double sinx = sin (x), cosx = cos (x), sindx = sin (dx), cosdx = cos (dx);
+	double a = NUMpi * d / my windowHalfWidth, da = NUMpi / my windowHalfWidth;
+	double cosa = cos (a), sina = sin (a), cosda = cos (da), sinda = sin (da);
+	double sum = 0.0;
+	for (long k = 0; k < numberOfTaps; k ++) {
+		if (fabs (d) >= my windowHalfWidth) {
+			w [k] = 0.0;
+		} else {
+			x = NUMpi * my cutoff * d;
+			w [k] = my cutoff * (fabs (x) < 1e-5 ? 1.0 - x * x / 6.0 : sinx / x) * 0.5 * (1.0 + cosa);
+		}
+		sum += w [k];
+		d += 1.0;
+		double help = sinx * cosdx + cosx * sindx;
+		cosx = cosx * cosdx - sinx * sindx;
+		sinx = help;
+		help = sina * cosda + cosa * sinda;
+		cosa = cosa * cosda - sina * sinda;
+		sina = help;
+	}
+	for (long k = 0; k < numberOfTaps; k ++) {
+		w [k] /= sum;
+	}
+}
+
+void NUMresampler_init (NUMresampler me, long inputLength, double inputSamplingPeriod, double inputFirstTime,
+	long outputLength, double outputSamplingPeriod, double outputFirstTime, long depth)
+{
+	Melder_assert (inputSamplingPeriod > 0.0 && outputSamplingPeriod > 0.0 && depth >= 1);
+	if (my phaseWeights) NUMmatrix_free (my phaseWeights, 0, 0);
+	my phaseWeights = NULL;
+	my inputLength = inputLength;
+	my inputStep = outputSamplingPeriod / inputSamplingPeriod;
+	my firstPosition = (outputFirstTime - inputFirstTime) / inputSamplingPeriod + 1.0;
+	my cutoff = my inputStep > 1.0 ? 1.0 / my inputStep : 1.0;
+	my windowHalfWidth = depth / my cutoff;
+	my halfWidth = (long) ceil (my windowHalfWidth);
+	my firstIndex = (long) floor (my firstPosition);
+	/*
+	 * Look for a rational approximation phaseStep / numberOfPhases of the input step
+	 * (by continued fractions) that is exact to well within a sample over the whole output.
+	 */
+	my numberOfPhases = 0;
+	double x = my inputStep;
+	long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+	for (int iteration = 1; iteration <= 30; iteration ++) {
+		double a = floor (x);
+		if (a > 1e6) break;
+		long p2 = (long) a * p1 + p0, q2 = (long) a * q1 + q0;
+		if (q2 > NUMresampler_MAXIMUM_NUMBER_OF_PHASES || (double) p2 * q2 > 1e9) break;
+		if (fabs ((double) p2 / q2 - my inputStep) * (outputLength + 1.0) < 1e-9) {
+			my numberOfPhases = q2;
+			my phaseStep = p2;
+			break;
+		}
+		p0 = p1, q0 = q1, p1 = p2, q1 = q2;
+		if (x - a < 1e-12) break;
+		x = 1.0 / (x - a);
+	}
+	if (my numberOfPhases > 0 && my numberOfPhases * 2 * my halfWidth > NUMresampler_MAXIMUM_TABLE_SIZE)
+		my numberOfPhases = 0;
+	if (my numberOfPhases > 0) {
+		double firstPhase = my firstPosition - my firstIndex;
+		my phaseWeights = NUMmatrix <double> (0, my numberOfPhases - 1, 0, 2 * my halfWidth - 1);
+		for (long r = 0; r < my numberOfPhases; r ++) {
+			double phase = firstPhase + (double) r / my numberOfPhases;
+			if (phase >= 1.0) phase -= 1.0;
+			NUMresampler_computeWeights (me, phase, my phaseWeights [r]);
+		}
+	}
+}
+
+/*
+ * The input position of output sample i is n + phase, with n the value returned.
+ * In the rational case, *r is the number of the phase; otherwise *phase is set.
+ */
+static long NUMresampler_getIndex (NUMresampler me, long i, long *r, double *phase) {
+	if (my numberOfPhases > 0) {
+		long a = (i - 1) / my numberOfPhases, b = (i - 1) % my numberOfPhases;
+		long t = b * my phaseStep;
+		*r = t % my numberOfPhases;
+		long n = my firstIndex + a * my phaseStep + t / my numberOfPhases;
+		if (my firstPosition - my firstIndex + (double) *r / my numberOfPhases >= 1.0) n ++;   // as in NUMresampler_init
+		return n;
+	}
+	double position = my firstPosition + (i - 1) * my inputStep;
+	long n = (long) floor (position);
+	*phase = position - n;
+	return n;
+}
+
+void NUMresampler_getInputRange (NUMresampler me, long firstOutput, long lastOutput, long *firstInput, long *lastInput) {
+	long r;
+	double phase;
+	*firstInput = NUMresampler_getIndex (me, firstOutput, & r, & phase) - my halfWidth + 1;
+	*lastInput = NUMresampler_getIndex (me, lastOutput, & r, & phase) + my halfWidth;
+	if (*firstInput < 1) *firstInput = 1;
+	if (*lastInput > my inputLength) *lastInput = my inputLength;
+}
+
+void NUMresampler_resample (NUMresampler me, const double x [], double y [], long firstOutput, long lastOutput, double *weights) {
+	const long numberOfTaps = 2 * my halfWidth;
+	for (long i = firstOutput; i <= lastOutput; i ++) {
+		long r;
+		double phase;
+		long n = NUMresampler_getIndex (me, i, & r, & phase);
+		const double *w;
+		if (my numberOfPhases > 0) {
+			w = my phaseWeights [r];
+		} else {
+			NUMresampler_computeWeights (me, phase, weights);
+			w = weights;
+		}
+		long offset = n - my halfWidth + 1, kmin = 0, kmax = numberOfTaps - 1;
+		if (offset + kmin < 1) kmin = 1 - offset;
+		if (offset + kmax > my inputLength) kmax = my inputLength - offset;
+		const double *xx = x + offset;
+		/*
+		 * Four partial sums, which the processor can keep going in parallel.
+		 */
+		double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+		long k = kmin;
+		for (; k + 3 <= kmax; k += 4) {
+			sum0 += w [k] * xx [k];
+			sum1 += w [k + 1] * xx [k + 1];
+			sum2 += w [k + 2] * xx [k + 2];
+			sum3 += w [k + 3] * xx [k + 3];
+		}
+		for (; k <= kmax; k ++) {
+			sum0 += w [k] * xx [k];
+		}
+		y [i] = (sum0 + sum1) + (sum2 + sum3);
+	}
+}
+
 /* Childers (1978), Modern Spectrum analysis, IEEE Press, 252-255) */
 /* work[1..n+n+n];
 b1 = & work[1];
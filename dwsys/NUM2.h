@@ -255,6 +255,15 @@ void NUMcolumn2_avevar (double **a, long nr, long nc, long icol1, long icol2,
  */
 
 void NUMvector_smoothByMovingAverage (double *xin, long n, long nwindow, double *xout);
+/*
+	xout[i] is the average of xin[i - nwindow / 2 .. i + (nwindow - 1) / 2], as far as these lie within 1..n.
+ */
+
+void NUM_addCompensated (double x, double *sum, double *compensation);
+/*
+	Adds x to a running sum whose rounding errors are collected in *compensation (Neumaier's variant of Kahan summation);
+	the sum is *sum + *compensation. Subtracting by adding -x keeps a moving sum accurate.
+ */
 
 
 void NUMcovarianceFromColumnCentredMatrix (double **x, long nrows, long ncols, long ndf, double **covar);
@@ -543,6 +552,16 @@ double NUMmahalanobisDistance_chi (double **l, double *v, double *m, long nr, lo
 			(L**-1.(x-m))' . (L**-1.(x-m))
 */
 
+void NUMmahalanobisDistances_chi (double ***linv, long *nr, double **m, long numberOfGroups, long n,
+	double **x, long numberOfRows, double **chisq);
+/*
+	chisq[i][g] = NUMmahalanobisDistance_chi (linv[g], x[i], m[g], nr[g], n),
+	for i = 1..numberOfRows and g = 1..numberOfGroups, with identical results.
+	The rows are processed in blocks, group by group, so that every row of linv[g] is used for a whole
+	block of rows at a time; the blocks are divided among threads.
+	chisq must not share storage with x.
+*/
+
 double NUMtrace (double **a, long n);
 double NUMtrace2 (double **a1, double **a2, long n);
 /*
@@ -690,6 +709,18 @@ void NUMProcrustes (double **x, double **y, long nPoints,
 	the orthogonal Procrustes transform.
 */
 
+typedef struct structNUMProcrustesWorkspace *NUMProcrustesWorkspace;
+NUMProcrustesWorkspace NUMProcrustesWorkspace_new (long nPoints, long nDimensions);
+void NUMProcrustesWorkspace_delete (NUMProcrustesWorkspace me);
+bool NUMProcrustesWorkspace_run (NUMProcrustesWorkspace me, double **x, double **y, double **t, double *v, double *s);
+/*
+	As NUMProcrustes, but with the intermediate matrices and the SVD of the workspace,
+	so that many configurations of the same size can be fitted without allocations.
+	A workspace can be used by one thread at a time.
+	Does not allocate or throw, so that it can run in a worker thread;
+	returns false for degenerate configurations and if the SVD could not be computed.
+*/
+
 void NUMnrbis (void (*f)(double x, double *fx, double *dfx, void *closure),
 	double x1, double x2, void *closure, double *root);
 /*
@@ -949,6 +980,80 @@ double NUMformantfilter_amplitude (double fc, double bw, double f);
 	Preconditions: f > 0 && bw > 0
 */
 
+#define NUMgammatone_MAXIMUM_ORDER  16
+
+typedef struct structNUMgammatone {
+	long order, delay, length;
+	double pole_re, pole_im;
+	double head_re [NUMgammatone_MAXIMUM_ORDER], head_im [NUMgammatone_MAXIMUM_ORDER];
+	double tail_re [NUMgammatone_MAXIMUM_ORDER], tail_im [NUMgammatone_MAXIMUM_ORDER];
+} *NUMgammatone;
+
+void NUMgammatone_init (NUMgammatone me, long order, double amplitude, double decayRate, double frequency,
+	double latency, long numberOfTaps, double samplingFrequency);
+/*
+	Sets up a recursive filter whose impulse response is the sampled gammatone
+		h [j] = amplitude * tau^(order-1) * exp (- decayRate * tau) * cos (2 pi frequency tau),
+		tau = (j - 0.5) / samplingFrequency - latency,
+	for j = 1 .. numberOfTaps and tau > 0, and zero elsewhere.
+	The response is that of the finite impulse response h [1..numberOfTaps] up to rounding,
+	but filtering costs 3 * order complex operations per sample instead of numberOfTaps:
+	the envelope tau^(order-1) exp (- decayRate * tau) is generated by order cascaded complex one-pole sections,
+	and the truncation after numberOfTaps by subtracting the same filter's response to the input delayed by numberOfTaps.
+	Preconditions: 1 <= order <= NUMgammatone_MAXIMUM_ORDER, decayRate >= 0, samplingFrequency > 0
+*/
+
+void NUMgammatone_filter (NUMgammatone me, const double x [], long nx, double y [], long ny);
+/*
+	y [i] = sum (j = 1 .. numberOfTaps, h [j] * x [i - j + 1]), i = 1 .. ny,
+	with x [1..nx] and zero outside; for ny = nx + numberOfTaps - 1 this is the whole convolution.
+	The filter keeps only 'order' complex numbers of state, so x and y may be processed in one pass
+	and y may be as long as needed.
+*/
+
+typedef struct structNUMresampler {
+	long inputLength, halfWidth;
+	double inputStep, firstPosition, cutoff, windowHalfWidth;
+	long numberOfPhases, phaseStep, firstIndex;   // rational case: numberOfPhases > 0
+	double **phaseWeights;   // [0..numberOfPhases-1] [0..2*halfWidth-1]
+} *NUMresampler;
+
+void NUMresampler_init (NUMresampler me, long inputLength, double inputSamplingPeriod, double inputFirstTime,
+	long outputLength, double outputSamplingPeriod, double outputFirstTime, long depth);
+/*
+	Sets up a windowed-sinc (Hann window) resampler from an input signal x [1..inputLength], zero elsewhere,
+	to an output signal y [1..outputLength]. The cut-off is at the lower of the two Nyquist frequencies,
+	and the window spans 'depth' zero crossings of the sinc on either side.
+	If the ratio of the sampling periods is rational with a small enough denominator
+	(e.g. 44100 to 16000 Hz: 160 phases), the weights of all phases are computed here once;
+	otherwise they are computed for every output sample.
+	Preconditions: inputSamplingPeriod > 0, outputSamplingPeriod > 0, depth >= 1
+*/
+
+void NUMresampler_getInputRange (NUMresampler me, long firstOutput, long lastOutput, long *firstInput, long *lastInput);
+/*
+	The input samples, clipped to 1..inputLength, needed for the output samples firstOutput..lastOutput.
+*/
+
+void NUMresampler_resample (NUMresampler me, const double x [], double y [], long firstOutput, long lastOutput, double *weights);
+/*
+	y [firstOutput..lastOutput] from x [firstInput..lastInput] as given by NUMresampler_getInputRange,
+	so the signals can be resampled piecewise (streaming), with a result that does not depend on the pieces.
+	'weights' is scratch space [0..2*halfWidth-1], needed only if the weights are not precomputed.
+*/
+
+#ifdef __cplusplus
+struct autoNUMresampler : public structNUMresampler {
+	autoNUMresampler () throw () {
+		numberOfPhases = 0;
+		phaseWeights = NULL;
+	}
+	~autoNUMresampler () {
+		if (phaseWeights) NUMmatrix_free (phaseWeights, 0, 0);
+	}
+};
+#endif
+
 int NUMburg (double x[], long n, double a[], int m, double *xms);
 /*
 	Calculates linear prediction coefficients according to the algorithm
@@ -1118,6 +1223,12 @@ void NUMfft_Table_init (NUMfft_Table table, long n);
 	n : data size
 */
 
+void NUMfft_Table_reinit (NUMfft_Table table, long n);
+/*
+	Prepares an initialised table for data size n, which must not exceed the size it was initialised with.
+	Does not allocate, so worker threads can switch between sizes.
+*/
+
 #ifdef __cplusplus
 
 struct autoNUMfft_Table : public structNUMfft_Table {
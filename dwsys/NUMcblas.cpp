@@ -225,6 +225,101 @@ L60:
 	return ret_val;
 }								/* NUMblas_ddot */
 
+/*
+	The blocked kernel behind NUMblas_dgemm and NUMblas_dsyrk.
+	C [0..m-1] [0..n-1] += alpha * op(A) * op(B), all matrices column-major with zero-based indices.
+	Blocks of op(A) (dgemm_MC by dgemm_KC) and op(B) (dgemm_KC by dgemm_NC) are copied into contiguous panels
+	of four rows of op(A) and four columns of op(B), padded with zeroes,
+	so that the innermost kernel can multiply four by four elements with all operands in registers.
+*/
+#define dgemm_MR  4
+#define dgemm_NR  4
+#define dgemm_MC  128
+#define dgemm_KC  256
+#define dgemm_NC  2048
+
+static void dgemm_packA (bool transa, long mc, long kc, const double *a, long lda, double *ap) {
+	for (long i0 = 0; i0 < mc; i0 += dgemm_MR) {
+		long mr = MIN (dgemm_MR, mc - i0);
+		for (long p = 0; p < kc; p ++) {
+			for (long i = 0; i < mr; i ++)
+				*ap ++ = transa ? a [p + (i0 + i) * lda] : a [(i0 + i) + p * lda];
+			for (long i = mr; i < dgemm_MR; i ++)
+				*ap ++ = 0.0;
+		}
+	}
+}
+
+static void dgemm_packB (bool transb, long kc, long nc, const double *b, long ldb, double *bp) {
+	for (long j0 = 0; j0 < nc; j0 += dgemm_NR) {
+		long nr = MIN (dgemm_NR, nc - j0);
+		for (long p = 0; p < kc; p ++) {
+			for (long j = 0; j < nr; j ++)
+				*bp ++ = transb ? b [(j0 + j) + p * ldb] : b [p + (j0 + j) * ldb];
+			for (long j = nr; j < dgemm_NR; j ++)
+				*bp ++ = 0.0;
+		}
+	}
+}
+
+static void dgemm_kernel (long kc, const double *ap, const double *bp, double alpha, double *c, long ldc, long mr, long nr) {
+	double c00 = 0.0, c01 = 0.0, c02 = 0.0, c03 = 0.0, c10 = 0.0, c11 = 0.0, c12 = 0.0, c13 = 0.0;
+	double c20 = 0.0, c21 = 0.0, c22 = 0.0, c23 = 0.0, c30 = 0.0, c31 = 0.0, c32 = 0.0, c33 = 0.0;
+	for (long p = 0; p < kc; p ++) {
+		double a0 = ap [0], a1 = ap [1], a2 = ap [2], a3 = ap [3];
+		double b0 = bp [0], b1 = bp [1], b2 = bp [2], b3 = bp [3];
+		c00 += a0 * b0; c01 += a0 * b1; c02 += a0 * b2; c03 += a0 * b3;
+		c10 += a1 * b0; c11 += a1 * b1; c12 += a1 * b2; c13 += a1 * b3;
+		c20 += a2 * b0; c21 += a2 * b1; c22 += a2 * b2; c23 += a2 * b3;
+		c30 += a3 * b0; c31 += a3 * b1; c32 += a3 * b2; c33 += a3 * b3;
+		ap += dgemm_MR;
+		bp += dgemm_NR;
+	}
+	if (mr == dgemm_MR && nr == dgemm_NR) {
+		double *c0 = c, *c1 = c + ldc, *c2 = c + 2 * ldc, *c3 = c + 3 * ldc;
+		c0 [0] += alpha * c00; c1 [0] += alpha * c01; c2 [0] += alpha * c02; c3 [0] += alpha * c03;
+		c0 [1] += alpha * c10; c1 [1] += alpha * c11; c2 [1] += alpha * c12; c3 [1] += alpha * c13;
+		c0 [2] += alpha * c20; c1 [2] += alpha * c21; c2 [2] += alpha * c22; c3 [2] += alpha * c23;
+		c0 [3] += alpha * c30; c1 [3] += alpha * c31; c2 [3] += alpha * c32; c3 [3] += alpha * c33;
+	} else {
+		double ab [dgemm_MR] [dgemm_NR] = {
+			{ c00, c01, c02, c03 }, { c10, c11, c12, c13 }, { c20, c21, c22, c23 }, { c30, c31, c32, c33 } };
+		for (long j = 0; j < nr; j ++)
+			for (long i = 0; i < mr; i ++)
+				c [i + j * ldc] += alpha * ab [i] [j];
+	}
+}
+
+static void dgemm_blocked (bool transa, bool transb, long m, long n, long k, double alpha,
+	const double *a, long lda, const double *b, long ldb, double *c, long ldc)
+{
+	long mcmax = MIN (dgemm_MC, m), kcmax = MIN (dgemm_KC, k), ncmax = MIN (dgemm_NC, n);
+	autoNUMvector <double> ap ((long) 0, (mcmax + dgemm_MR) * kcmax);
+	autoNUMvector <double> bp ((long) 0, (ncmax + dgemm_NR) * kcmax);
+	for (long jc = 0; jc < n; jc += dgemm_NC) {
+		long nc = MIN (dgemm_NC, n - jc);
+		for (long pc = 0; pc < k; pc += dgemm_KC) {
+			long kc = MIN (dgemm_KC, k - pc);
+			dgemm_packB (transb, kc, nc, transb ? b + jc + pc * ldb : b + pc + jc * ldb, ldb, bp.peek());
+			for (long ic = 0; ic < m; ic += dgemm_MC) {
+				long mc = MIN (dgemm_MC, m - ic);
+				dgemm_packA (transa, mc, kc, transa ? a + pc + ic * lda : a + ic + pc * lda, lda, ap.peek());
+				for (long jr = 0; jr < nc; jr += dgemm_NR) {
+					for (long ir = 0; ir < mc; ir += dgemm_MR) {
+						dgemm_kernel (kc, & ap [ir * kc], & bp [jr * kc], alpha, c + (ic + ir) + (jc + jr) * ldc, ldc,
+							MIN (dgemm_MR, mc - ir), MIN (dgemm_NR, nc - jr));
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+	Below this number of multiplications, the unblocked reference loops are faster than copying into panels.
+*/
+#define dgemm_BLOCKING_THRESHOLD  32768.0
+
 int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, long *k, double *alpha, double *a, long *lda,
                    double *b, long *ldb, double *beta, double *c__, long *ldc) {
 	/* System generated locals */
@@ -320,6 +415,19 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
 		}
 		return 0;
 	}
+	if ((double) *m * (double) *n * (double) *k >= dgemm_BLOCKING_THRESHOLD) {
+		/* Form C := beta*C, then C := alpha*op(A)*op(B) + C on cache-sized blocks. */
+		if (*beta != 1.) {
+			for (long jj = 1; jj <= *n; jj ++) {
+				for (long ii = 1; ii <= *m; ii ++) {
+					c___ref (ii, jj) = *beta == 0. ? 0. : *beta * c___ref (ii, jj);
+				}
+			}
+		}
+		dgemm_blocked (! nota, ! notb, *m, *n, *k, *alpha, & a_ref (1, 1), a_dim1, & b_ref (1, 1), b_dim1,
+			& c___ref (1, 1), c_dim1);
+		return 0;
+	}
 	/* Start the operations. */
 	if (notb) {
 		if (nota) {
@@ -627,7 +735,22 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 	if (lsame_ (trans, "N")) {
 		/* Form y := alpha*A*x + y. */
 		jx = kx;
-		if (*incy == 1) {
+		if (*incy == 1 && *incx == 1) {
+			/* Four columns at a time, so that y is loaded and stored only once for every four columns. */
+			for (j = 1; j + 3 <= *n; j += 4) {
+				double t0 = *alpha * x[j], t1 = *alpha * x[j + 1], t2 = *alpha * x[j + 2], t3 = *alpha * x[j + 3];
+				const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+				for (i__ = 0; i__ < *m; ++i__) {
+					y[1 + i__] += t0 * a0[i__] + t1 * a1[i__] + t2 * a2[i__] + t3 * a3[i__];
+				}
+			}
+			for (; j <= *n; ++j) {
+				temp = *alpha * x[j];
+				for (i__ = 1; i__ <= *m; ++i__) {
+					y[i__] += temp * a_ref (i__, j);
+				}
+			}
+		} else if (*incy == 1) {
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
 				if (x[jx] != 0.) {
@@ -661,7 +784,31 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 	} else {
 		/* Form y := alpha*A'*x + y. */
 		jy = ky;
-		if (*incx == 1) {
+		if (*incx == 1 && *incy == 1) {
+			/* Four columns at a time, so that x is loaded only once for every four columns. */
+			for (j = 1; j + 3 <= *n; j += 4) {
+				double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+				const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+				for (i__ = 0; i__ < *m; ++i__) {
+					double xi = x[1 + i__];
+					s0 += a0[i__] * xi;
+					s1 += a1[i__] * xi;
+					s2 += a2[i__] * xi;
+					s3 += a3[i__] * xi;
+				}
+				y[j] += *alpha * s0;
+				y[j + 1] += *alpha * s1;
+				y[j + 2] += *alpha * s2;
+				y[j + 3] += *alpha * s3;
+			}
+			for (; j <= *n; ++j) {
+				temp = 0.;
+				for (i__ = 1; i__ <= *m; ++i__) {
+					temp += a_ref (i__, j) * x[i__];
+				}
+				y[j] += *alpha * temp;
+			}
+		} else if (*incx == 1) {
 			i__1 = *n;
 			for (j = 1; j <= i__1; ++j) {
 				temp = 0.;
@@ -2156,6 +2303,75 @@ int NUMblas_dsyr2k (const char *uplo, const char *trans, long *n, long *k, doubl
 #undef b_ref
 #undef a_ref
 
+int NUMblas_dsyrk (const char *uplo, const char *trans, long *n, long *k, double *alpha, double *a, long *lda,
+                   double *beta, double *c, long *ldc) {
+	bool upper = lsame_ (uplo, "U"), notrans = lsame_ (trans, "N");
+	long nrowa = notrans ? *n : *k, info = 0;
+	if (! upper && ! lsame_ (uplo, "L")) {
+		info = 1;
+	} else if (! notrans && ! lsame_ (trans, "T") && ! lsame_ (trans, "C")) {
+		info = 2;
+	} else if (*n < 0) {
+		info = 3;
+	} else if (*k < 0) {
+		info = 4;
+	} else if (*lda < MAX (1, nrowa)) {
+		info = 7;
+	} else if (*ldc < MAX (1, *n)) {
+		info = 10;
+	}
+	if (info != 0) {
+		xerbla_ ("DSYRK ", &info);
+		return 0;
+	}
+	/* Quick return if possible. */
+	if (*n == 0 || (*alpha == 0. || *k == 0) && *beta == 1.) {
+		return 0;
+	}
+	/* Form C := beta*C on the referenced triangle. */
+	if (*beta != 1.) {
+		for (long j = 0; j < *n; j ++) {
+			long ifrom = upper ? 0 : j, ito = upper ? j : *n - 1;
+			for (long i = ifrom; i <= ito; i ++) {
+				c [i + j * *ldc] = *beta == 0. ? 0. : *beta * c [i + j * *ldc];
+			}
+		}
+	}
+	if (*alpha == 0. || *k == 0) {
+		return 0;
+	}
+	/*
+		Form C := alpha*op(A)*op(A)' + C one block of dsyrk_NB columns at a time:
+		the part of the block column outside the diagonal block is a plain matrix product,
+		and the diagonal block is computed in full into a scratch matrix, of which only the referenced triangle is added to C.
+		Row i of op(A) starts at a [i] (trans = 'N', with the columns lda apart) or at a [i * lda] (otherwise, contiguously).
+	*/
+	#define dsyrk_NB  64
+	long nb = MIN (dsyrk_NB, *n);
+	autoNUMvector <double> diagonalBlock ((long) 0, nb * nb - 1);
+	for (long j0 = 0; j0 < *n; j0 += dsyrk_NB) {
+		long jb = MIN (dsyrk_NB, *n - j0);
+		const double *aj = notrans ? a + j0 : a + j0 * *lda;
+		for (long i = 0; i < jb * jb; i ++) {
+			diagonalBlock [i] = 0.;
+		}
+		dgemm_blocked (! notrans, notrans, jb, jb, *k, *alpha, aj, *lda, aj, *lda, diagonalBlock.peek(), jb);
+		for (long j = 0; j < jb; j ++) {
+			long ifrom = upper ? 0 : j, ito = upper ? j : jb - 1;
+			for (long i = ifrom; i <= ito; i ++) {
+				c [(j0 + i) + (j0 + j) * *ldc] += diagonalBlock [i + j * jb];
+			}
+		}
+		long i0 = upper ? 0 : j0 + jb, ib = upper ? j0 : *n - j0 - jb;
+		if (ib > 0) {
+			const double *ai = notrans ? a + i0 : a + i0 * *lda;
+			dgemm_blocked (! notrans, notrans, ib, jb, *k, *alpha, ai, *lda, aj, *lda, c + i0 + j0 * *ldc, *ldc);
+		}
+	}
+	#undef dsyrk_NB
+	return 0;
+}								/* NUMblas_dsyrk */
+
 int NUMblas_dtrmm (const char *side, const char *uplo, const char *transa, const char *diag, long *m, long *n, double *alpha, double *a,
                    long *lda, double *b, long *ldb) {
 	/* System generated locals */
@@ -3011,6 +3227,136 @@ L30:
 	return ret_val;
 }								/* NUMblas_idamax */
 
+/*
+	NUMblas_testBlockedKernels: the blocked and four-column paths against plain sums.
+	All matrices are column-major with a leading dimension larger than their number of rows,
+	so that the kernels have to respect the strides.
+*/
+
+static void testKernels_fillRandom (double *a, long size) {
+	for (long i = 0; i < size; i ++)
+		a [i] = NUMrandomUniform (-1.0, 1.0);
+}
+
+static void testKernels_compare (const char *routine, const char *options, long m, long n, long k,
+	double computed, double expected, double magnitude)
+{
+	if (fabs (computed - expected) > 1e-12 * (magnitude + 1.0))
+		Melder_throw (routine, " (", options, ") with m = ", m, ", n = ", n, ", k = ", k,
+			": ", computed, " instead of ", expected, ".");
+}
+
+static void testKernels_dgemm (const char *transa, const char *transb, long m, long n, long k, double beta) {
+	bool ta = transa [0] == 'T', tb = transb [0] == 'T';
+	long lda = (ta ? k : m) + 3, ldb = (tb ? n : k) + 2, ldc = m + 1;
+	autoNUMvector <double> a ((long) 0, lda * (ta ? m : k) - 1), b ((long) 0, ldb * (tb ? k : n) - 1), c ((long) 0, ldc * n - 1);
+	testKernels_fillRandom (a.peek(), lda * (ta ? m : k));
+	testKernels_fillRandom (b.peek(), ldb * (tb ? k : n));
+	testKernels_fillRandom (c.peek(), ldc * n);
+	autoNUMvector <double> c0 ((long) 0, ldc * n - 1);
+	for (long i = 0; i < ldc * n; i ++) c0 [i] = c [i];
+	double alpha = 1.3;
+	(void) NUMblas_dgemm (transa, transb, & m, & n, & k, & alpha, a.peek(), & lda, b.peek(), & ldb, & beta, c.peek(), & ldc);
+	char options [3] = { transa [0], transb [0], '\0' };
+	for (long j = 0; j < n; j ++) {
+		for (long i = 0; i < ldc; i ++) {
+			if (i >= m) {   // outside C
+				testKernels_compare ("NUMblas_dgemm", options, m, n, k, c [i + j * ldc], c0 [i + j * ldc], 0.0);
+				continue;
+			}
+			double sum = 0.0, magnitude = fabs (beta * c0 [i + j * ldc]);
+			for (long p = 0; p < k; p ++) {
+				double product = alpha * (ta ? a [p + i * lda] : a [i + p * lda]) * (tb ? b [j + p * ldb] : b [p + j * ldb]);
+				sum += product;
+				magnitude += fabs (product);
+			}
+			testKernels_compare ("NUMblas_dgemm", options, m, n, k, c [i + j * ldc], sum + beta * c0 [i + j * ldc], magnitude);
+		}
+	}
+}
+
+static void testKernels_dsyrk (const char *uplo, const char *trans, long n, long k, double beta) {
+	bool upper = uplo [0] == 'U', t = trans [0] == 'T';
+	long lda = (t ? k : n) + 3, ldc = n + 2;
+	autoNUMvector <double> a ((long) 0, lda * (t ? n : k) - 1), c ((long) 0, ldc * n - 1), c0 ((long) 0, ldc * n - 1);
+	testKernels_fillRandom (a.peek(), lda * (t ? n : k));
+	testKernels_fillRandom (c.peek(), ldc * n);
+	for (long i = 0; i < ldc * n; i ++) c0 [i] = c [i];
+	double alpha = -0.7;
+	(void) NUMblas_dsyrk (uplo, trans, & n, & k, & alpha, a.peek(), & lda, & beta, c.peek(), & ldc);
+	char options [3] = { uplo [0], trans [0], '\0' };
+	for (long j = 0; j < n; j ++) {
+		for (long i = 0; i < ldc; i ++) {
+			if (i >= n || (upper ? i > j : i < j)) {   // the other triangle, and outside C, stay as they were
+				testKernels_compare ("NUMblas_dsyrk", options, n, n, k, c [i + j * ldc], c0 [i + j * ldc], 0.0);
+				continue;
+			}
+			double sum = 0.0, magnitude = fabs (beta * c0 [i + j * ldc]);
+			for (long p = 0; p < k; p ++) {
+				double product = alpha * (t ? a [p + i * lda] * a [p + j * lda] : a [i + p * lda] * a [j + p * lda]);
+				sum += product;
+				magnitude += fabs (product);
+			}
+			testKernels_compare ("NUMblas_dsyrk", options, n, n, k, c [i + j * ldc], sum + beta * c0 [i + j * ldc], magnitude);
+		}
+	}
+}
+
+static void testKernels_dgemv (const char *trans, long m, long n, long inc) {
+	bool t = trans [0] == 'T';
+	long lda = m + 3, nx = t ? m : n, ny = t ? n : m;
+	autoNUMvector <double> a ((long) 0, lda * n - 1), x ((long) 0, nx * inc - 1), y ((long) 0, ny * inc - 1), y0 ((long) 0, ny * inc - 1);
+	testKernels_fillRandom (a.peek(), lda * n);
+	testKernels_fillRandom (x.peek(), nx * inc);
+	testKernels_fillRandom (y.peek(), ny * inc);
+	for (long i = 0; i < ny * inc; i ++) y0 [i] = y [i];
+	double alpha = 0.9, beta = 0.4;
+	(void) NUMblas_dgemv (trans, & m, & n, & alpha, a.peek(), & lda, x.peek(), & inc, & beta, y.peek(), & inc);
+	for (long i = 0; i < ny * inc; i ++) {
+		if (i % inc != 0) {   // between the elements of y
+			testKernels_compare ("NUMblas_dgemv", trans, m, n, 1, y [i], y0 [i], 0.0);
+			continue;
+		}
+		long iy = i / inc;
+		double sum = 0.0, magnitude = fabs (beta * y0 [i]);
+		for (long p = 0; p < nx; p ++) {
+			double product = alpha * (t ? a [p + iy * lda] : a [iy + p * lda]) * x [p * inc];
+			sum += product;
+			magnitude += fabs (product);
+		}
+		testKernels_compare ("NUMblas_dgemv", trans, m, n, 1, y [i], sum + beta * y0 [i], magnitude);
+	}
+}
+
+void NUMblas_testBlockedKernels () {
+	const char *transposes [2] = { "N", "T" }, *triangles [2] = { "U", "L" };
+	double betas [3] = { 0.0, 1.0, -0.5 };
+	/*
+		Sizes below and above the blocking threshold, sizes that are not multiples of the four-by-four kernel,
+		exact multiples of the block sizes (dgemm_MC = 128, dgemm_KC = 256, dgemm_NC = 2048, dsyrk_NB = 64),
+		and sizes that need several blocks with a fringe in every dimension.
+	*/
+	long gemmSizes [] [3] = { { 1, 1, 1 }, { 3, 5, 7 }, { 31, 33, 35 }, { 33, 34, 35 }, { 4, 4, 2048 }, { 128, 8, 256 },
+		{ 129, 9, 257 }, { 5, 2049, 6 }, { 130, 2050, 3 }, { 257, 70, 513 } };
+	for (unsigned isize = 0; isize < sizeof gemmSizes / sizeof gemmSizes [0]; isize ++)
+		for (int ia = 0; ia < 2; ia ++)
+			for (int ib = 0; ib < 2; ib ++)
+				for (int ibeta = 0; ibeta < 3; ibeta ++)
+					testKernels_dgemm (transposes [ia], transposes [ib],
+						gemmSizes [isize] [0], gemmSizes [isize] [1], gemmSizes [isize] [2], betas [ibeta]);
+	long syrkSizes [] [2] = { { 1, 1 }, { 5, 3 }, { 63, 9 }, { 64, 64 }, { 65, 257 }, { 130, 7 }, { 200, 300 } };
+	for (unsigned isize = 0; isize < sizeof syrkSizes / sizeof syrkSizes [0]; isize ++)
+		for (int iuplo = 0; iuplo < 2; iuplo ++)
+			for (int itrans = 0; itrans < 2; itrans ++)
+				for (int ibeta = 0; ibeta < 3; ibeta ++)
+					testKernels_dsyrk (triangles [iuplo], transposes [itrans], syrkSizes [isize] [0], syrkSizes [isize] [1], betas [ibeta]);
+	long gemvSizes [] [2] = { { 1, 1 }, { 7, 3 }, { 5, 4 }, { 9, 11 }, { 300, 257 } };
+	for (unsigned isize = 0; isize < sizeof gemvSizes / sizeof gemvSizes [0]; isize ++)
+		for (int itrans = 0; itrans < 2; itrans ++)
+			for (long inc = 1; inc <= 2; inc ++)
+				testKernels_dgemv (transposes [itrans], gemvSizes [isize] [0], gemvSizes [isize] [1], inc);
+}
+
 #undef MAX
 #undef MIN
 
@@ -133,6 +133,10 @@ int NUMblas_dgemm (const char *transa, const char *transb, long *m, long *n, lon
        Iain Duff, AERE Harwell.
        Jeremy Du Croz, Numerical Algorithms Group Ltd.
        Sven Hammarling, Numerical Algorithms Group Ltd.
+    Large products are computed on cache-sized blocks of op( A ) and op( B ),
+    which are copied into contiguous panels and multiplied four rows by four
+    columns at a time; the order of the summations therefore differs from that
+    of the reference implementation.
 */
 
 int NUMblas_dger (long *m, long *n, double *alpha, double *x, long *incx, double *y,
@@ -548,6 +552,87 @@ int NUMblas_dsyr2k (const char *uplo, const char *trans, long *n, long *k, doubl
     Level 3 Blas routine.
 */
 
+int NUMblas_dsyrk (const char *uplo, const char *trans, long *n, long *k, double *alpha, double *a,
+	long *lda, double *beta, double *c, long *ldc);
+/*  Purpose
+    =======
+    NUMblas_dsyrk  performs one of the symmetric rank k operations
+       C := alpha*A*A' + beta*C,
+    or
+       C := alpha*A'*A + beta*C,
+    where  alpha and beta  are scalars, C is an  n by n  symmetric matrix
+    and  A  is an  n by k  matrix in the first case and a  k by n  matrix
+    in the second case.
+    Parameters
+    ==========
+    UPLO   - char*.
+             On  entry,   UPLO  specifies  whether  the  upper  or  lower
+             triangular  part  of the  array  C  is to be  referenced  as
+             follows:
+                UPLO = 'U' or 'u'   Only the  upper triangular part of  C
+                                    is to be referenced.
+                UPLO = 'L' or 'l'   Only the  lower triangular part of  C
+                                    is to be referenced.
+             Unchanged on exit.
+    TRANS  - char*.
+             On entry,  TRANS  specifies the operation to be performed as
+             follows:
+                TRANS = 'N' or 'n'   C := alpha*A*A' + beta*C.
+                TRANS = 'T' or 't'   C := alpha*A'*A + beta*C.
+                TRANS = 'C' or 'c'   C := alpha*A'*A + beta*C.
+             Unchanged on exit.
+    N      - long.
+             On entry,  N specifies the order of the matrix C.  N must be
+             at least zero.
+             Unchanged on exit.
+    K      - long.
+             On entry with  TRANS = 'N' or 'n',  K  specifies  the number
+             of  columns   of  the   matrix   A,   and  on   entry   with
+             TRANS = 'T' or 't' or 'C' or 'c',  K  specifies  the  number
+             of rows of the matrix  A.  K must be at least zero.
+             Unchanged on exit.
+    ALPHA  - double.
+             On entry, ALPHA specifies the scalar alpha.
+             Unchanged on exit.
+    A      - double array of DIMENSION ( LDA, ka ), where ka is
+             k  when  TRANS = 'N' or 'n',  and is  n  otherwise.
+             Before entry with  TRANS = 'N' or 'n',  the  leading  n by k
+             part of the array  A  must contain the matrix  A,  otherwise
+             the leading  k by n  part of the array  A  must contain  the
+             matrix A.
+             Unchanged on exit.
+    LDA    - long.
+             On entry, LDA specifies the first dimension of A as declared
+             in  the  calling  (sub)  program.   When  TRANS = 'N' or 'n'
+             then  LDA must be at least  max( 1, n ), otherwise  LDA must
+             be at least  max( 1, k ).
+             Unchanged on exit.
+    BETA   - double.
+             On entry, BETA specifies the scalar beta.
+             Unchanged on exit.
+    C      - double array of DIMENSION ( LDC, n ).
+             Before entry  with  UPLO = 'U' or 'u',  the leading  n by n
+             upper triangular part of the array C must contain the upper
+             triangular part  of the  symmetric matrix  and the strictly
+             lower triangular part of C is not referenced.  On exit, the
+             upper triangular part of the array  C is overwritten by the
+             upper triangular part of the updated matrix.
+             Before entry  with  UPLO = 'L' or 'l',  the leading  n by n
+             lower triangular part of the array C must contain the lower
+             triangular part  of the  symmetric matrix  and the strictly
+             upper triangular part of C is not referenced.  On exit, the
+             lower triangular part of the array  C is overwritten by the
+             lower triangular part of the updated matrix.
+    LDC    - long.
+             On entry, LDC specifies the first dimension of C as declared
+             in  the  calling  (sub)  program.   LDC  must  be  at  least
+             max( 1, n ).
+             Unchanged on exit.
+    Level 3 Blas routine.
+    Unlike the reference implementation, this one works on cache-sized
+    blocks of A, with the same kernel as NUMblas_dgemm.
+*/
+
 int NUMblas_dtrmm (const char *side, const char *uplo, const char *transa, const char *diag,
 	long *m, long *n, double *alpha, double *a, long *lda,
 	double *b, long *ldb);
@@ -777,6 +862,10 @@ int NUMblas_dtrsm (const char *side, const char *uplo, const char *transa, const
 long NUMblas_idamax (long *n, double *dx, long *incx);
 /* finds the index of element having max. absolute value.*/
 
+void NUMblas_testBlockedKernels ();
+/* compares NUMblas_dgemm, NUMblas_dsyrk and NUMblas_dgemv with plain sums, for all transpose and triangle options
+   and for sizes around the block sizes; throws a MelderError at the first difference. */
+
 #ifdef __cplusplus
 	}
 #endif
@@ -82,6 +82,11 @@ void NUMfft_Table_init (NUMfft_Table me, long n) {
 	NUMrffti (n, my trigcache, my splitcache);
 }
 
+void NUMfft_Table_reinit (NUMfft_Table me, long n) {
+	my n = n;
+	NUMrffti (n, my trigcache, my splitcache);
+}
+
 void NUMrealft (double *data, long n, int isign) {
 	isign == 1 ? NUMforwardRealFastFourierTransform (data, n) :
 	NUMreverseRealFastFourierTransform (data, n);
@@ -25,6 +25,7 @@
 
 #include "Configuration_and_Procrustes.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 Procrustes Configurations_to_Procrustes (Configuration me, Configuration thee, int orthogonal) {
 	try {
@@ -45,4 +46,282 @@ Procrustes Configurations_to_Procrustes (Configuration me, Configuration thee, i
 	}
 }
 
+/*
+	Fitting many configurations to one target.
+	Every thread has its own Procrustes workspace, which it reuses for all its configurations.
+	The threads do not throw; a configuration that could not be fitted is reported afterwards.
+*/
+
+#define PROCRUSTES_MINIMUM_CONFIGURATIONS_PER_THREAD  4
+
+Thing_define (Configurations_procrustes_Args, Thing) {
+	double **target, targetSumOfSquares;
+	Configuration *configurations;
+	long firstConfiguration, lastConfiguration, numberOfPoints, numberOfDimensions;
+	int orthogonal;
+	double **results;   // [1..numberOfConfigurations][1..numberOfResultColumns]
+	double **fitted;   // [1..numberOfConfigurations*numberOfPoints][1..numberOfDimensions], or NULL
+	NUMProcrustesWorkspace workspace;
+	double **t, *v;
+	long failedConfiguration;
+
+	void v_destroy ()
+		override;
+};
+
+Thing_implement (Configurations_procrustes_Args, Thing, 0);
+
+void structConfigurations_procrustes_Args :: v_destroy () {
+	NUMProcrustesWorkspace_delete (workspace);
+	NUMmatrix_free <double> (t, 1, 1);
+	NUMvector_free <double> (v, 1);
+	Configurations_procrustes_Args_Parent :: v_destroy ();
+}
+
+static long Configurations_procrustes_getNumberOfResultColumns (long numberOfDimensions) {
+	return 1 + numberOfDimensions + numberOfDimensions * numberOfDimensions + 2;
+}
+
+static MelderThread_RETURN_TYPE Configurations_procrustes_fit (Configurations_procrustes_Args me) {
+	long k = my numberOfDimensions;
+	for (long iconfiguration = my firstConfiguration; iconfiguration <= my lastConfiguration; iconfiguration ++) {
+		Configuration thee = my configurations [iconfiguration];
+		double scale = 1.0, *result = my results [iconfiguration];
+		for (long j = 1; j <= k; j ++) {
+			my v [j] = 0.0;
+		}
+		if (! NUMProcrustesWorkspace_run (my workspace, my target, thy data, my t, my orthogonal ? NULL : my v, my orthogonal ? NULL : & scale)) {
+			my failedConfiguration = iconfiguration;
+			break;
+		}
+		long icol = 0;
+		result [++ icol] = scale;
+		for (long j = 1; j <= k; j ++) {
+			result [++ icol] = my v [j];
+		}
+		for (long i = 1; i <= k; i ++) {
+			for (long j = 1; j <= k; j ++) {
+				result [++ icol] = my t [i] [j];
+			}
+		}
+		double residualSumOfSquares = 0.0;
+		for (long ipoint = 1; ipoint <= my numberOfPoints; ipoint ++) {
+			for (long j = 1; j <= k; j ++) {
+				double yt = 0.0;
+				for (long m = 1; m <= k; m ++) {
+					yt += thy data [ipoint] [m] * my t [m] [j];
+				}
+				double fit = scale * yt + my v [j], residual = my target [ipoint] [j] - fit;
+				residualSumOfSquares += residual * residual;
+				if (my fitted) {
+					my fitted [(iconfiguration - 1) * my numberOfPoints + ipoint] [j] = fit;
+				}
+			}
+		}
+		result [++ icol] = residualSumOfSquares;
+		result [++ icol] = residualSumOfSquares / my targetSumOfSquares;
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	The sum of squares about the centroid, or about the origin for orthogonal transforms.
+*/
+static double NUMdmatrix_getSumOfSquares (double **x, long numberOfPoints, long numberOfDimensions, int orthogonal) {
+	double sumOfSquares = 0.0;
+	for (long j = 1; j <= numberOfDimensions; j ++) {
+		double mean = 0.0;
+		if (! orthogonal) {
+			for (long ipoint = 1; ipoint <= numberOfPoints; ipoint ++) {
+				mean += x [ipoint] [j];
+			}
+			mean /= numberOfPoints;
+		}
+		for (long ipoint = 1; ipoint <= numberOfPoints; ipoint ++) {
+			double dx = x [ipoint] [j] - mean;
+			sumOfSquares += dx * dx;
+		}
+	}
+	return sumOfSquares;
+}
+
+static int Configurations_procrustes_init (autoConfigurations_procrustes_Args *args, long numberOfConfigurations, Configuration *configurations,
+	int orthogonal, double **results, double **fitted)
+{
+	long numberOfPoints = configurations [1] -> numberOfRows, numberOfDimensions = configurations [1] -> numberOfColumns;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfConfigurations / PROCRUSTES_MINIMUM_CONFIGURATIONS_PER_THREAD) {
+		numberOfThreads = numberOfConfigurations / PROCRUSTES_MINIMUM_CONFIGURATIONS_PER_THREAD;
+	}
+	if (numberOfThreads > 16) {
+		numberOfThreads = 16;
+	}
+	if (numberOfThreads < 1) {
+		numberOfThreads = 1;
+	}
+	long numberOfConfigurationsPerThread = (numberOfConfigurations - 1) / numberOfThreads + 1;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoConfigurations_procrustes_Args arg = Thing_new (Configurations_procrustes_Args);
+		arg -> configurations = configurations;
+		arg -> firstConfiguration = 1 + (ithread - 1) * numberOfConfigurationsPerThread;
+		arg -> lastConfiguration = ithread == numberOfThreads ? numberOfConfigurations : arg -> firstConfiguration + numberOfConfigurationsPerThread - 1;
+		arg -> numberOfPoints = numberOfPoints;
+		arg -> numberOfDimensions = numberOfDimensions;
+		arg -> orthogonal = orthogonal;
+		arg -> results = results;
+		arg -> fitted = fitted;
+		arg -> workspace = NUMProcrustesWorkspace_new (numberOfPoints, numberOfDimensions);
+		arg -> t = NUMmatrix <double> (1, numberOfDimensions, 1, numberOfDimensions);
+		arg -> v = NUMvector <double> (1, numberOfDimensions);
+		args [ithread - 1].reset (arg.transfer());
+	}
+	return numberOfThreads;
+}
+
+static void Configurations_procrustes_run (autoConfigurations_procrustes_Args *args, int numberOfThreads, double **target) {
+	double targetSumOfSquares = NUMdmatrix_getSumOfSquares (target, args [0] -> numberOfPoints, args [0] -> numberOfDimensions, args [0] -> orthogonal);
+	if (targetSumOfSquares == 0.0) {
+		Melder_throw ("The target configuration is degenerate.");
+	}
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		args [ithread - 1] -> target = target;
+		args [ithread - 1] -> targetSumOfSquares = targetSumOfSquares;
+		args [ithread - 1] -> failedConfiguration = 0;
+	}
+	MelderThread_run (Configurations_procrustes_fit, args, numberOfThreads);
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		long failedConfiguration = args [ithread - 1] -> failedConfiguration;
+		if (failedConfiguration != 0) {
+			Melder_throw (args [ithread - 1] -> configurations [failedConfiguration], ": no Procrustes fit (degenerate configuration, or no SVD).");
+		}
+	}
+}
+
+static Table Configurations_procrustes_to_Table (long numberOfConfigurations, Configuration *configurations, double **results) {
+	long k = configurations [1] -> numberOfColumns;
+	autoMelderString columnNames;
+	MelderString_append (& columnNames, L"configuration scale");
+	for (long j = 1; j <= k; j ++) {
+		MelderString_append (& columnNames, L" t", Melder_integer (j));
+	}
+	for (long i = 1; i <= k; i ++) {
+		for (long j = 1; j <= k; j ++) {
+			MelderString_append (& columnNames, L" r", Melder_integer (i), L"_", Melder_integer (j));
+		}
+	}
+	MelderString_append (& columnNames, L" residualSumOfSquares relativeResidual");
+	autoTable thee = Table_createWithColumnNames (numberOfConfigurations, columnNames.string);
+	long numberOfResultColumns = Configurations_procrustes_getNumberOfResultColumns (k);
+	for (long iconfiguration = 1; iconfiguration <= numberOfConfigurations; iconfiguration ++) {
+		const wchar_t *name = Thing_getName (configurations [iconfiguration]);
+		Table_setStringValue (thee.peek(), iconfiguration, 1, name ? name : Melder_integer (iconfiguration));
+		for (long icol = 1; icol <= numberOfResultColumns; icol ++) {
+			Table_setNumericValue (thee.peek(), iconfiguration, 1 + icol, results [iconfiguration] [icol]);
+		}
+	}
+	return thee.transfer();
+}
+
+static void Configurations_checkDimensions (Configuration me, long numberOfConfigurations, Configuration *configurations) {
+	for (long iconfiguration = 1; iconfiguration <= numberOfConfigurations; iconfiguration ++) {
+		Configuration thee = configurations [iconfiguration];
+		if (thy numberOfRows != my numberOfRows || thy numberOfColumns != my numberOfColumns) {
+			Melder_throw ("Configurations must have the same number of points and the same dimension.");
+		}
+	}
+}
+
+Table Configurations_to_Table_procrustes (Configuration target, long numberOfConfigurations, Configuration *configurations, int orthogonal) {
+	try {
+		if (numberOfConfigurations < 1) {
+			Melder_throw ("There are no configurations to fit.");
+		}
+		Configurations_checkDimensions (target, numberOfConfigurations, configurations);
+		autoNUMmatrix <double> results (1, numberOfConfigurations, 1, Configurations_procrustes_getNumberOfResultColumns (target -> numberOfColumns));
+		autoConfigurations_procrustes_Args args [16];
+		int numberOfThreads = Configurations_procrustes_init (args, numberOfConfigurations, configurations, orthogonal, results.peek(), NULL);
+		Configurations_procrustes_run (args, numberOfThreads, target -> data);
+		return Configurations_procrustes_to_Table (numberOfConfigurations, configurations, results.peek());
+	} catch (MelderError) {
+		Melder_throw (target, ": Procrustes table not created.");
+	}
+}
+
+Table Configurations_to_Table_generalizedProcrustes (long numberOfConfigurations, Configuration *configurations, int orthogonal,
+	long maximumNumberOfIterations, double tolerance, Configuration *consensus)
+{
+	try {
+		if (numberOfConfigurations < 2) {
+			Melder_throw ("A generalized Procrustes analysis needs at least two configurations.");
+		}
+		Configuration first = configurations [1];
+		Configurations_checkDimensions (first, numberOfConfigurations, configurations);
+		long numberOfPoints = first -> numberOfRows, k = first -> numberOfColumns;
+		long numberOfResultColumns = Configurations_procrustes_getNumberOfResultColumns (k);
+		autoNUMmatrix <double> results (1, numberOfConfigurations, 1, numberOfResultColumns);
+		autoNUMmatrix <double> fitted (1, numberOfConfigurations * numberOfPoints, 1, k);
+		autoNUMmatrix <double> mean (1, numberOfPoints, 1, k);
+		NUMmatrix_copyElements (first -> data, mean.peek(), 1, numberOfPoints, 1, k);
+		if (! orthogonal) {
+			NUMcentreColumns (mean.peek(), 1, numberOfPoints, 1, k, NULL);
+		}
+		/*
+			The consensus keeps the size of the first configuration; otherwise it would shrink.
+		*/
+		double size = NUMdmatrix_getSumOfSquares (mean.peek(), numberOfPoints, k, orthogonal);
+		if (size == 0.0) {
+			Melder_throw (first, ": degenerate configuration.");
+		}
+		autoConfigurations_procrustes_Args args [16];
+		int numberOfThreads = Configurations_procrustes_init (args, numberOfConfigurations, configurations, orthogonal, results.peek(), fitted.peek());
+		double previousLoss = 0.0;
+		for (long iteration = 1; iteration <= maximumNumberOfIterations; iteration ++) {
+			Configurations_procrustes_run (args, numberOfThreads, mean.peek());
+			double loss = 0.0;
+			for (long iconfiguration = 1; iconfiguration <= numberOfConfigurations; iconfiguration ++) {
+				loss += results [iconfiguration] [numberOfResultColumns - 1];
+			}
+			if ((iteration > 1 && previousLoss - loss <= tolerance * previousLoss) || iteration == maximumNumberOfIterations) {
+				break;
+			}
+			previousLoss = loss;
+			/*
+				The new consensus is the mean of the fitted configurations.
+			*/
+			for (long ipoint = 1; ipoint <= numberOfPoints; ipoint ++) {
+				for (long j = 1; j <= k; j ++) {
+					double sum = 0.0;
+					for (long iconfiguration = 1; iconfiguration <= numberOfConfigurations; iconfiguration ++) {
+						sum += fitted [(iconfiguration - 1) * numberOfPoints + ipoint] [j];
+					}
+					mean [ipoint] [j] = sum / numberOfConfigurations;
+				}
+			}
+			if (! orthogonal) {
+				NUMcentreColumns (mean.peek(), 1, numberOfPoints, 1, k, NULL);
+			}
+			double newSize = NUMdmatrix_getSumOfSquares (mean.peek(), numberOfPoints, k, orthogonal);
+			if (newSize == 0.0) {
+				Melder_throw ("The consensus configuration became degenerate.");
+			}
+			double factor = sqrt (size / newSize);
+			for (long ipoint = 1; ipoint <= numberOfPoints; ipoint ++) {
+				for (long j = 1; j <= k; j ++) {
+					mean [ipoint] [j] *= factor;
+				}
+			}
+		}
+		autoTable thee = Configurations_procrustes_to_Table (numberOfConfigurations, configurations, results.peek());
+		if (consensus) {
+			autoConfiguration him = Data_copy (first);
+			NUMmatrix_copyElements (mean.peek(), his data, 1, numberOfPoints, 1, k);
+			Thing_setName (him.peek(), L"consensus");
+			*consensus = him.transfer();
+		}
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw ("Generalized Procrustes table not created.");
+	}
+}
+
 /* End of file Configuration_and_Procrustes.c */
@@ -30,6 +30,9 @@
 #ifndef _Procrustes_h_
 	#include "Procrustes.h"
 #endif
+#ifndef _Table_h_
+	#include "Table.h"
+#endif
 
 #ifdef __cplusplus
 	extern "C" {
@@ -37,6 +40,25 @@
 
 Procrustes Configurations_to_Procrustes (Configuration me, Configuration thee, int orthogonal);
 
+Table Configurations_to_Table_procrustes (Configuration target, long numberOfConfigurations, Configuration *configurations, int orthogonal);
+/*
+	Fits each of configurations[1..numberOfConfigurations] to the target, as Configurations_to_Procrustes (target, configuration),
+	with the configurations divided over threads.
+	One row per configuration, with its name, the scale, the translation t1..tk, the rotation r11..rkk (row by row),
+	the residual sum of squares, and that sum relative to the sum of squares of the target
+	(about its centroid, or about the origin for orthogonal transforms).
+*/
+
+Table Configurations_to_Table_generalizedProcrustes (long numberOfConfigurations, Configuration *configurations, int orthogonal,
+	long maximumNumberOfIterations, double tolerance, Configuration *consensus);
+/*
+	Generalized Procrustes analysis: the consensus starts as the first configuration and is replaced by the mean
+	of all configurations fitted to it (keeping its size), until the total residual sum of squares decreases by
+	less than tolerance times itself.
+	The table has the fits of the configurations to the final consensus, as in Configurations_to_Table_procrustes.
+	If consensus != NULL, it receives the consensus configuration.
+*/
+
 #ifdef __cplusplus
 	}
 #endif
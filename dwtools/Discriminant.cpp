@@ -502,28 +502,6 @@ Configuration Discriminant_and_TableOfReal_to_Configuration (Discriminant me, Ta
 	}
 }
 
-/*
-	Calculate squared Mahalanobis distance: (v-m)'S^-1(v-m).
-	Input matrix (li) is the inverse L^-1 of the Cholesky decomposition
-	S = L.L'.
-*/
-static double mahalanobisDistanceSq (double **li, long n, double *v, double *m,
-                                     double *buf) {
-	for (long i = 1; i <= n; i++) {
-		buf[i] = v[i] - m[i];
-	}
-
-	double chisq = 0;
-	for (long i = n; i > 0; i--) {
-		double t = 0;
-		for (long j = 1; j <= i; j++) {
-			t += li[i][j] * buf[j];
-		}
-		chisq += t * t;
-	}
-	return chisq;
-}
-
 TableOfReal Discriminant_and_TableOfReal_mahalanobis (Discriminant me, TableOfReal thee, long group, bool poolCovarianceMatrices) {
 	try {
 		if (group < 1 || group > my numberOfGroups) {
@@ -558,7 +536,6 @@ ClassificationTable Discriminant_and_TableOfReal_to_ClassificationTable (Discrim
 		autoNUMvector<double> log_p (1, g);
 		autoNUMvector<double> log_apriori (1, g);
 		autoNUMvector<double> ln_determinant (1, g);
-		autoNUMvector<double> buf (1, p);
 		autoNUMvector<SSCP> sscpvec (1, g);
 		autoSSCP pool = SSCPs_to_SSCP_pool (my groups);
 		autoClassificationTable him = ClassificationTable_create (m, g);
@@ -643,12 +620,22 @@ ClassificationTable Discriminant_and_TableOfReal_to_ClassificationTable (Discrim
 
 		// Generalized squared distance function:
 		// D^2(x) = (x - mu)' S^-1 (x - mu) + ln (determinant(S)) - 2 ln (apriori)
+		// The squared Mahalanobis distances of all rows to all groups go into the table first.
+
+		autoNUMvector<double **> linv (1, g);
+		autoNUMvector<long> nr (1, g);
+		autoNUMvector<double *> centroid (1, g);
+		for (long j = 1; j <= g; j++) {
+			linv[j] = sscpvec[j] -> data;
+			nr[j] = p;
+			centroid[j] = ( (SSCP) groups -> item[j]) -> centroid;
+		}
+		NUMmahalanobisDistances_chi (linv.peek(), nr.peek(), centroid.peek(), g, p, thy data, m, his data);
 
 		for (long i = 1; i <= m; i++) {
 			double norm = 0, pt_max = -1e38;
 			for (long j = 1; j <= g; j++) {
-				SSCP t = (SSCP) groups -> item[j];
-				double md = mahalanobisDistanceSq (sscpvec[j] -> data, p, thy data[i], t -> centroid, buf.peek());
+				double md = his data[i][j];
 				double pt = log_apriori[j] - 0.5 * (ln_determinant[j] + md);
 				if (pt > pt_max) {
 					pt_max = pt;
@@ -681,7 +668,7 @@ ClassificationTable Discriminant_and_TableOfReal_to_ClassificationTable_dw (Disc
 		autoNUMvector<double> log_p (1, g);
 		autoNUMvector<double> log_apriori (1, g);
 		autoNUMvector<double> ln_determinant (1, g);
-		autoNUMvector<double> buf (1, p);
+		autoNUMvector<double> md (1, g);
 		autoNUMvector<double> displacement (1, p);
 		autoNUMvector<double> x (1, p);
 		autoNUMvector<SSCP> sscpvec (1, g);
@@ -767,6 +754,17 @@ ClassificationTable Discriminant_and_TableOfReal_to_ClassificationTable_dw (Disc
 
 		// Generalized squared distance function:
 		// D^2(x) = (x - mu)' S^-1 (x - mu) + ln (determinant(S)) - 2 ln (apriori)
+		// Each row is displaced by the result of the previous rows, so the distances are computed row by row.
+
+		autoNUMvector<double **> linv (1, g);
+		autoNUMvector<long> nr (1, g);
+		autoNUMvector<double *> centroid (1, g);
+		for (long j = 1; j <= g; j++) {
+			linv[j] = sscpvec[j] -> data;
+			nr[j] = p;
+			centroid[j] = ( (SSCP) groups -> item[j]) -> centroid;
+		}
+		double *xrow[2] = { NULL, x.peek() }, *mdrow[2] = { NULL, md.peek() };
 
 		for (long i = 1; i <= m; i++) {
 			SSCP winner;
@@ -775,10 +773,9 @@ ClassificationTable Discriminant_and_TableOfReal_to_ClassificationTable_dw (Disc
 			for (long k = 1; k <= p; k++) {
 				x[k] = thy data[i][k] + displacement[k];
 			}
+			NUMmahalanobisDistances_chi (linv.peek(), nr.peek(), centroid.peek(), g, p, xrow, 1, mdrow);
 			for (long j = 1; j <= g; j++) {
-				SSCP t = (SSCP) groups -> item[j];
-				double md = mahalanobisDistanceSq (sscpvec[j] -> data, p, x.peek(), t -> centroid, buf.peek());
-				double pt = log_apriori[j] - 0.5 * (ln_determinant[j] + md);
+				double pt = log_apriori[j] - 0.5 * (ln_determinant[j] + md[j]);
 				if (pt > pt_max) {
 					pt_max = pt; iwinner = j;
 				}
@@ -22,6 +22,7 @@
 */
 
 #include "EditDistanceTable.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "EditDistanceTable_def.h"
@@ -321,6 +322,142 @@ TableOfReal EditCostsTable_to_TableOfReal (EditCostsTable me) {
 	}
 }
 
+/*
+ * Interned symbols: every distinct symbol gets a number 1..numberOfSymbols, found with a hash table,
+ * so that the costs have to be looked up in the EditCostsTable only once for every distinct symbol (pair),
+ * and the dynamic programming compares and indexes with numbers only.
+ */
+Thing_define (EditSymbols, Thing) { public:
+	long numberOfSymbols, capacity, hashMask;
+	wchar_t **symbols;   // [1..capacity]
+	long *hash;   // [0..hashMask]: symbol number, or 0 if empty
+
+	void v_destroy ()
+		override;
+};
+
+Thing_implement (EditSymbols, Thing, 0);
+
+void structEditSymbols :: v_destroy () {
+	for (long i = 1; i <= numberOfSymbols; i++) {
+		Melder_free (symbols[i]);
+	}
+	NUMvector_free<wchar_t *> (symbols, 1);
+	NUMvector_free<long> (hash, 0);
+	EditSymbols_Parent :: v_destroy ();
+}
+
+static EditSymbols EditSymbols_create () {
+	autoEditSymbols me = Thing_new (EditSymbols);
+	my capacity = 64;
+	my symbols = NUMvector<wchar_t *> (1, my capacity);
+	my hashMask = 127;
+	my hash = NUMvector<long> (0, my hashMask);
+	return me.transfer();
+}
+
+static unsigned long EditSymbols_hash (const wchar_t *symbol, long length) {
+	unsigned long hash = 2166136261UL;   // FNV-1a
+	for (long i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned long) symbol[i]) * 16777619UL;
+	}
+	return hash;
+}
+
+static long EditSymbols_intern (EditSymbols me, const wchar_t *symbol, long length) {
+	unsigned long slot = EditSymbols_hash (symbol, length) & my hashMask;
+	for (; my hash[slot] != 0; slot = (slot + 1) & my hashMask) {
+		const wchar_t *other = my symbols[my hash[slot]];
+		if (wcsncmp (other, symbol, length) == 0 && other[length] == '\0') {
+			return my hash[slot];
+		}
+	}
+	if (my numberOfSymbols == my capacity) {
+		autoNUMvector<wchar_t *> symbols (1, 2 * my capacity);
+		for (long i = 1; i <= my numberOfSymbols; i++) {
+			symbols[i] = my symbols[i];
+		}
+		NUMvector_free<wchar_t *> (my symbols, 1);
+		my symbols = symbols.transfer();
+		my capacity *= 2;
+	}
+	autostring copy = Melder_malloc (wchar_t, length + 1);
+	wcsncpy (copy.peek(), symbol, length);
+	copy[length] = '\0';
+	my symbols[++ my numberOfSymbols] = copy.transfer();
+	my hash[slot] = my numberOfSymbols;
+	if (2 * my numberOfSymbols > my hashMask) {   // keep the table at most half full
+		long hashMask = 2 * my hashMask + 1;
+		autoNUMvector<long> hash ((long) 0, hashMask);
+		for (long i = 1; i <= my numberOfSymbols; i++) {
+			unsigned long islot = EditSymbols_hash (my symbols[i], wcslen (my symbols[i])) & hashMask;
+			while (hash[islot] != 0) {
+				islot = (islot + 1) & hashMask;
+			}
+			hash[islot] = i;
+		}
+		NUMvector_free<long> (my hash, 0);
+		my hash = hash.transfer();
+		my hashMask = hashMask;
+	}
+	return my numberOfSymbols;
+}
+
+static bool isSymbolSeparator (wchar_t c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/*
+	Interns the symbols of the string (characters, or separated by white space) into ids[1..] if ids is not NULL.
+	Returns the number of symbols.
+*/
+static long EditSymbols_internString (EditSymbols me, const wchar_t *string, bool symbolsAreCharacters, long *ids) {
+	long numberOfSymbols = 0;
+	if (string == NULL) {
+		return 0;
+	}
+	if (symbolsAreCharacters) {
+		for (const wchar_t *p = string; *p != '\0'; p++) {
+			numberOfSymbols++;
+			if (ids) ids[numberOfSymbols] = EditSymbols_intern (me, p, 1);
+		}
+		return numberOfSymbols;
+	}
+	for (const wchar_t *p = string; *p != '\0';) {
+		while (isSymbolSeparator (*p)) p++;
+		if (*p == '\0') break;
+		const wchar_t *start = p;
+		while (*p != '\0' && ! isSymbolSeparator (*p)) p++;
+		numberOfSymbols++;
+		if (ids) ids[numberOfSymbols] = EditSymbols_intern (me, start, p - start);
+	}
+	return numberOfSymbols;
+}
+
+/*
+	The insertion costs of the target symbols, the deletion costs of the source symbols
+	and the substitution costs of all target-source pairs, as EditCostsTable_get...Cost would return them.
+*/
+static void EditCostsTable_getDenseCosts (EditCostsTable me, EditSymbols targetSymbols, EditSymbols sourceSymbols,
+	autoNUMvector<double> *insertionCost, autoNUMvector<double> *deletionCost, autoNUMmatrix<double> *substitutionCost)
+{
+	long numberOfTargetSymbols = targetSymbols -> numberOfSymbols, numberOfSourceSymbols = sourceSymbols -> numberOfSymbols;
+	insertionCost -> reset (1, numberOfTargetSymbols);
+	deletionCost -> reset (1, numberOfSourceSymbols);
+	substitutionCost -> reset (1, numberOfTargetSymbols > 0 ? numberOfTargetSymbols : 1, 1, numberOfSourceSymbols > 0 ? numberOfSourceSymbols : 1);   // never empty
+	for (long i = 1; i <= numberOfTargetSymbols; i++) {
+		(*insertionCost)[i] = EditCostsTable_getInsertionCost (me, targetSymbols -> symbols[i]);
+	}
+	for (long j = 1; j <= numberOfSourceSymbols; j++) {
+		(*deletionCost)[j] = EditCostsTable_getDeletionCost (me, sourceSymbols -> symbols[j]);
+	}
+	for (long i = 1; i <= numberOfTargetSymbols; i++) {
+		for (long j = 1; j <= numberOfSourceSymbols; j++) {
+			(*substitutionCost)[i][j] = EditCostsTable_getSubstitutionCost (me, targetSymbols -> symbols[i], sourceSymbols -> symbols[j]);
+		}
+	}
+}
+
 Thing_implement (EditDistanceTable, TableOfReal, 0);
 
 void structEditDistanceTable :: v_info () {
@@ -356,6 +493,7 @@ void EditDistanceTable_setEditCosts (EditDistanceTable me, EditCostsTable thee)
 		forget (my editCostsTable);
 		autoEditCostsTable ect = (EditCostsTable) Data_copy (thee);
 		my editCostsTable = ect.transfer();
+		EditDistanceTable_findPath (me, 0);
 	} catch (MelderError) {
 		Melder_throw (me, ": edit costs not set.");
 	}
@@ -532,20 +670,38 @@ void EditDistanceTable_findPath (EditDistanceTable me, TableOfReal *directions)
 		autoNUMmatrix<short> psi (0, numberOfTargets, 0, numberOfSources);
 		autoNUMmatrix<double> delta (0, numberOfTargets, 0, numberOfSources);
 
+		/*
+		 * Look up the costs once for every distinct target and source symbol.
+		 */
+		autoEditSymbols targetSymbols = EditSymbols_create (), sourceSymbols = EditSymbols_create ();
+		autoNUMvector<long> target (1, numberOfTargets), source (1, numberOfSources);
+		for (long i = 1; i <= numberOfTargets; i++) {
+			const wchar_t *label = my rowLabels[i+1] ? my rowLabels[i+1] : L"";
+			target[i] = EditSymbols_intern (targetSymbols.peek(), label, wcslen (label));
+		}
+		for (long j = 1; j <= numberOfSources; j++) {
+			const wchar_t *label = my columnLabels[j+1] ? my columnLabels[j+1] : L"";
+			source[j] = EditSymbols_intern (sourceSymbols.peek(), label, wcslen (label));
+		}
+		autoNUMvector<double> insertionCost, deletionCost;
+		autoNUMmatrix<double> substitutionCost;
+		EditCostsTable_getDenseCosts (my editCostsTable, targetSymbols.peek(), sourceSymbols.peek(), & insertionCost, & deletionCost, & substitutionCost);
+
 		for (long j = 1; j <= numberOfSources; j++) {
-			delta[0][j] = delta[0][j - 1] + EditCostsTable_getDeletionCost (my editCostsTable, my columnLabels[j+1]);
+			delta[0][j] = delta[0][j - 1] + deletionCost[source[j]];
 			psi[0][j] = WARPING_fromLeft;
 		}
 		for (long i = 1; i <= numberOfTargets; i++) {
-			delta[i][0] = delta[i - 1][0] + EditCostsTable_getInsertionCost (my editCostsTable, my rowLabels[i+1]);
+			delta[i][0] = delta[i - 1][0] + insertionCost[target[i]];
 			psi[i][0] = WARPING_fromBelow;
 		}
 		for (long j = 1; j <= numberOfSources; j++) {
+			double deletion = deletionCost[source[j]];
 			for (long i = 1; i <= numberOfTargets; i++) {
 				// the substitution, deletion and insertion costs.
-				double left = delta[i][j - 1] + EditCostsTable_getInsertionCost (my editCostsTable, my rowLabels[i+1]);
-				double bottom = delta[i - 1][j] + EditCostsTable_getDeletionCost (my editCostsTable, my columnLabels[j+1]);
-				double mindist = delta[i - 1][j - 1] + EditCostsTable_getSubstitutionCost (my editCostsTable, my rowLabels[i+1], my columnLabels[j+1]); // diag
+				double left = delta[i][j - 1] + insertionCost[target[i]];
+				double bottom = delta[i - 1][j] + deletion;
+				double mindist = delta[i - 1][j - 1] + substitutionCost[target[i]][source[j]]; // diag
 				psi[i][j] = WARPING_fromDiag;
 				if (bottom < mindist) {
 					mindist = bottom;
@@ -602,4 +758,258 @@ TableOfReal EditDistanceTable_to_TableOfReal (EditDistanceTable me) {
 	}
 }
 
+/********** Edit distances of many strings **********/
+
+/*
+ * The query is the source (at most one word of 64 bits in the bit-parallel kernels), the strings are the targets.
+ * With unit costs (insertion and deletion 1, substitution 0 or 1) the distance is the Levenshtein distance,
+ * computed with Myers' bit-parallel algorithm (in Hyyrö's formulation, with a 1 shifted in for global alignment);
+ * with insertion and deletion 1 and substitution 0 or at least 2, a substitution never beats a deletion plus an insertion,
+ * so the distance is n + m - 2 * LCS, with the LCS length computed bit-parallel as well (Allison & Dix).
+ * A match is any target-source pair with substitution cost 0, so the symbols need not be compared as strings.
+ * Other costs go through the dynamic programming of EditDistanceTable_findPath, two rows at a time,
+ * stopping early when a whole row exceeds the maximum distance.
+ */
+enum { EditDistanceKernel_GENERAL, EditDistanceKernel_LEVENSHTEIN, EditDistanceKernel_LCS };
+
+Thing_define (EditDistances_Args, Thing) { public:
+	int kernel;
+	long numberOfStrings, numberOfQuerySymbols;
+	long *firstSymbol;   // [1..numberOfStrings + 1]: the symbols of string i are symbols [firstSymbol[i]..firstSymbol[i+1]-1]
+	long *symbols, *query;
+	uint64_t *matchBits;   // [1..numberOfTargetSymbols]: bit j-1 set if the target symbol matches query symbol j
+	double *insertionCost, *deletionCost, **substitutionCost;
+	double maximumDistance;
+	bool costsAreNonnegative;
+	double *previousRow, *currentRow;   // [0..numberOfQuerySymbols], one pair per thread
+	double *distances;
+	bool isMainThread;
+	volatile long *next, *numberDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (EditDistances_Args, Thing, 0);
+
+MelderThread_MUTEX (editDistancesMutex);
+static bool editDistancesMutex_inited;
+
+static double EditDistances_levenshtein (EditDistances_Args me, const long *target, long numberOfTargetSymbols) {
+	const long m = my numberOfQuerySymbols;
+	const uint64_t last = (uint64_t) 1 << (m - 1);
+	uint64_t pv = ~ (uint64_t) 0, mv = 0;
+	long score = m;
+	for (long i = 1; i <= numberOfTargetSymbols; i++) {
+		uint64_t eq = my matchBits[target[i]];
+		uint64_t xv = eq | mv;
+		uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+		uint64_t ph = mv | ~ (xh | pv);
+		uint64_t mh = pv & xh;
+		if (ph & last) score++;
+		else if (mh & last) score--;
+		ph = (ph << 1) | 1;
+		mh <<= 1;
+		pv = mh | ~ (xv | ph);
+		mv = ph & xv;
+	}
+	return score;
+}
+
+static double EditDistances_lcs (EditDistances_Args me, const long *target, long numberOfTargetSymbols) {
+	const long m = my numberOfQuerySymbols;
+	const uint64_t mask = m == 64 ? ~ (uint64_t) 0 : ((uint64_t) 1 << m) - 1;
+	uint64_t v = ~ (uint64_t) 0;
+	for (long i = 1; i <= numberOfTargetSymbols; i++) {
+		uint64_t u = v & my matchBits[target[i]];
+		v = (v + u) | (v - u);
+	}
+	long lcs = 0;
+	for (uint64_t zeroes = ~ v & mask; zeroes != 0; zeroes &= zeroes - 1) {
+		lcs++;
+	}
+	return numberOfTargetSymbols + m - 2 * lcs;
+}
+
+static double EditDistances_general (EditDistances_Args me, const long *target, long numberOfTargetSymbols) {
+	const long m = my numberOfQuerySymbols;
+	double *previous = my previousRow, *current = my currentRow;
+	previous[0] = 0.0;
+	for (long j = 1; j <= m; j++) {
+		previous[j] = previous[j - 1] + my deletionCost[my query[j]];
+	}
+	for (long i = 1; i <= numberOfTargetSymbols; i++) {
+		double insertion = my insertionCost[target[i]], *substitution = my substitutionCost[target[i]];
+		current[0] = previous[0] + insertion;
+		double rowMinimum = current[0];
+		for (long j = 1; j <= m; j++) {
+			double left = current[j - 1] + insertion;
+			double bottom = previous[j] + my deletionCost[my query[j]];
+			double mindist = previous[j - 1] + substitution[my query[j]];
+			if (bottom < mindist) mindist = bottom;
+			if (left < mindist) mindist = left;
+			current[j] = mindist;
+			if (mindist < rowMinimum) rowMinimum = mindist;
+		}
+		if (my costsAreNonnegative && my maximumDistance > 0.0 && rowMinimum > my maximumDistance) {
+			return NUMundefined;   // every path through this row already costs too much
+		}
+		double *swap = previous; previous = current; current = swap;
+	}
+	return previous[m];
+}
+
+static MelderThread_RETURN_TYPE EditDistances_compute (EditDistances_Args me) {
+	for (;;) {
+		MelderThread_LOCK (editDistancesMutex);
+		long istring = ++ *my next;
+		MelderThread_UNLOCK (editDistancesMutex);
+		if (istring > my numberOfStrings || *my cancelled) break;
+		const long *target = my symbols + my firstSymbol[istring] - 1;   // target [1..numberOfTargetSymbols]
+		long numberOfTargetSymbols = my firstSymbol[istring + 1] - my firstSymbol[istring];
+		double distance =
+			my kernel == EditDistanceKernel_LEVENSHTEIN ? EditDistances_levenshtein (me, target, numberOfTargetSymbols) :
+			my kernel == EditDistanceKernel_LCS ? EditDistances_lcs (me, target, numberOfTargetSymbols) :
+			EditDistances_general (me, target, numberOfTargetSymbols);
+		if (my maximumDistance > 0.0 && distance != NUMundefined && distance > my maximumDistance) {
+			distance = NUMundefined;
+		}
+		my distances[istring] = distance;
+		MelderThread_LOCK (editDistancesMutex);
+		long numberOfStringsDone = ++ *my numberDone;
+		MelderThread_UNLOCK (editDistancesMutex);
+		if (my isMainThread && numberOfStringsDone % 1000 == 0) {
+			try {
+				Melder_progress ((double) numberOfStringsDone / my numberOfStrings,
+					L"Compared ", Melder_integer (numberOfStringsDone), L" out of ", Melder_integer (my numberOfStrings), L" strings");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+Table Strings_to_Table_editDistances (Strings me, const wchar_t *query, bool symbolsAreCharacters, EditCostsTable costs, double maximumDistance) {
+	try {
+		long numberOfStrings = my numberOfStrings;
+		autoEditCostsTable defaultCosts;
+		if (! costs) {
+			defaultCosts.reset (EditCostsTable_createDefault ());
+			costs = defaultCosts.peek();
+		}
+		/*
+		 * Intern the symbols of the query (the source) and of all the strings (the targets).
+		 */
+		autoEditSymbols sourceSymbols = EditSymbols_create (), targetSymbols = EditSymbols_create ();
+		long numberOfQuerySymbols = EditSymbols_internString (sourceSymbols.peek(), query, symbolsAreCharacters, NULL);
+		autoNUMvector<long> querySymbols (1, numberOfQuerySymbols);
+		EditSymbols_internString (sourceSymbols.peek(), query, symbolsAreCharacters, querySymbols.peek());
+		autoNUMvector<long> firstSymbol (1, numberOfStrings + 1);
+		long numberOfSymbols = 0;
+		for (long istring = 1; istring <= numberOfStrings; istring++) {
+			firstSymbol[istring] = numberOfSymbols + 1;
+			numberOfSymbols += EditSymbols_internString (targetSymbols.peek(), my strings[istring], symbolsAreCharacters, NULL);
+		}
+		firstSymbol[numberOfStrings + 1] = numberOfSymbols + 1;
+		autoNUMvector<long> symbols (1, numberOfSymbols);
+		for (long istring = 1; istring <= numberOfStrings; istring++) {
+			EditSymbols_internString (targetSymbols.peek(), my strings[istring], symbolsAreCharacters, & symbols[firstSymbol[istring] - 1]);
+		}
+		autoNUMvector<double> insertionCost, deletionCost;
+		autoNUMmatrix<double> substitutionCost;
+		EditCostsTable_getDenseCosts (costs, targetSymbols.peek(), sourceSymbols.peek(), & insertionCost, & deletionCost, & substitutionCost);
+		/*
+		 * Choose the kernel.
+		 */
+		long numberOfTargetSymbols = targetSymbols -> numberOfSymbols, numberOfSourceSymbols = sourceSymbols -> numberOfSymbols;
+		bool unitIndels = true, unitSubstitutions = true, expensiveSubstitutions = true, costsAreNonnegative = true;
+		for (long i = 1; i <= numberOfTargetSymbols; i++) {
+			if (insertionCost[i] != 1.0) unitIndels = false;
+			if (insertionCost[i] < 0.0) costsAreNonnegative = false;
+		}
+		for (long j = 1; j <= numberOfSourceSymbols; j++) {
+			if (deletionCost[j] != 1.0) unitIndels = false;
+			if (deletionCost[j] < 0.0) costsAreNonnegative = false;
+		}
+		for (long i = 1; i <= numberOfTargetSymbols; i++) {
+			for (long j = 1; j <= numberOfSourceSymbols; j++) {
+				double cost = substitutionCost[i][j];
+				if (cost != 0.0 && cost != 1.0) unitSubstitutions = false;
+				if (cost != 0.0 && cost < 2.0) expensiveSubstitutions = false;
+				if (cost < 0.0) costsAreNonnegative = false;
+			}
+		}
+		int kernel = numberOfQuerySymbols < 1 || numberOfQuerySymbols > 64 || ! unitIndels ? EditDistanceKernel_GENERAL :
+			unitSubstitutions ? EditDistanceKernel_LEVENSHTEIN :
+			expensiveSubstitutions ? EditDistanceKernel_LCS : EditDistanceKernel_GENERAL;
+		autoNUMvector<uint64_t> matchBits (1, numberOfTargetSymbols);
+		for (long i = 1; i <= numberOfTargetSymbols; i++) {
+			for (long j = 1; j <= numberOfQuerySymbols && j <= 64; j++) {
+				if (substitutionCost[i][querySymbols[j]] == 0.0) {
+					matchBits[i] |= (uint64_t) 1 << (j - 1);
+				}
+			}
+		}
+		/*
+		 * Compare the query with all strings in parallel.
+		 */
+		autoNUMvector<double> distances (1, numberOfStrings);
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfStrings / 100 + 1) numberOfThreads = numberOfStrings / 100 + 1;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		if (! editDistancesMutex_inited) { MelderThread_MUTEX_INIT (editDistancesMutex); editDistancesMutex_inited = true; }
+		autoEditDistances_Args args [16];
+		autoNUMmatrix<double> rows (1, 2 * numberOfThreads, 0, numberOfQuerySymbols);
+		volatile long next = 0, numberDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+			autoEditDistances_Args arg = Thing_new (EditDistances_Args);
+			arg -> kernel = kernel;
+			arg -> numberOfStrings = numberOfStrings;
+			arg -> numberOfQuerySymbols = numberOfQuerySymbols;
+			arg -> firstSymbol = firstSymbol.peek();
+			arg -> symbols = symbols.peek();
+			arg -> query = querySymbols.peek();
+			arg -> matchBits = matchBits.peek();
+			arg -> insertionCost = insertionCost.peek();
+			arg -> deletionCost = deletionCost.peek();
+			arg -> substitutionCost = substitutionCost.peek();
+			arg -> maximumDistance = maximumDistance;
+			arg -> costsAreNonnegative = costsAreNonnegative;
+			arg -> previousRow = rows[2 * ithread - 1];
+			arg -> currentRow = rows[2 * ithread];
+			arg -> distances = distances.peek();
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> next = & next;
+			arg -> numberDone = & numberDone;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
+		}
+		{
+			autoMelderProgress progress (L"Computing edit distances...");
+			MelderThread_run (EditDistances_compute, args, numberOfThreads);
+		}
+		/*
+		 * List the strings that are close enough.
+		 */
+		long numberOfRows = 0;
+		for (long istring = 1; istring <= numberOfStrings; istring++) {
+			if (distances[istring] != NUMundefined) numberOfRows++;
+		}
+		autoTable thee = Table_createWithColumnNames (numberOfRows, L"index string distance");
+		long irow = 0;
+		for (long istring = 1; istring <= numberOfStrings; istring++) {
+			if (distances[istring] == NUMundefined) continue;
+			irow++;
+			Table_setNumericValue (thee.peek(), irow, 1, istring);
+			Table_setStringValue (thee.peek(), irow, 2, my strings[istring] ? my strings[istring] : L"");
+			Table_setNumericValue (thee.peek(), irow, 3, distances[istring]);
+		}
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": edit distances not computed.");
+	}
+}
+
 /* End of file EditDistanceTable.cpp */
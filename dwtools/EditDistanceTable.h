@@ -77,4 +77,13 @@ TableOfReal EditDistanceTable_to_TableOfReal_directions (EditDistanceTable me);
 
 TableOfReal EditDistanceTable_to_TableOfReal (EditDistanceTable me);
 
+Table Strings_to_Table_editDistances (Strings me, const wchar_t *query, bool symbolsAreCharacters, EditCostsTable costs, double maximumDistance);
+/*
+	The edit distance from the query (the source) to every string of me (the targets),
+	with the symbols of each string separated by spaces, or each character a symbol.
+	The costs are those of an EditDistanceTable with the given EditCostsTable (NULL: the default costs).
+	Only the strings whose distance is at most maximumDistance are listed (maximumDistance <= 0: all).
+	Result: a Table with the columns "index", "string" and "distance".
+*/
+
 #endif /* _EditDistanceTable_h_ */
@@ -722,6 +722,24 @@ void GaussianMixture_initialGuess (GaussianMixture me, TableOfReal thee, double
 }
 
 
+/*
+	dsq[i][im] = squared Mahalanobis distance of row i to component im, for all rows at once.
+	Precondition: the lowerCholesky of every component has been expanded.
+*/
+static void GaussianMixture_and_TableOfReal_getMahalanobisDistances (GaussianMixture me, TableOfReal thee, double **dsq) {
+	autoNUMvector<double **> linv (1, my numberOfComponents);
+	autoNUMvector<long> nr (1, my numberOfComponents);
+	autoNUMvector<double *> centroid (1, my numberOfComponents);
+	for (long im = 1; im <= my numberOfComponents; im++) {
+		Covariance cov = (Covariance) my covariances -> item[im];
+		linv[im] = cov -> lowerCholesky;
+		nr[im] = cov -> numberOfRows;
+		centroid[im] = cov -> centroid;
+	}
+	NUMmahalanobisDistances_chi (linv.peek(), nr.peek(), centroid.peek(), my numberOfComponents, my dimension,
+		thy data, thy numberOfRows, dsq);
+}
+
 ClassificationTable GaussianMixture_and_TableOfReal_to_ClassificationTable (GaussianMixture me, TableOfReal thee) {
 	try {
 		autoClassificationTable him = ClassificationTable_create (thy numberOfRows, my numberOfComponents);
@@ -733,11 +751,12 @@ ClassificationTable GaussianMixture_and_TableOfReal_to_ClassificationTable (Gaus
 
 		double ln2pid = - 0.5 * my dimension * log (NUM2pi);
 		autoNUMvector<double> lnN (1, my numberOfComponents);
+		GaussianMixture_and_TableOfReal_getMahalanobisDistances (me, thee, his data);
 		for (long i = 1; i <=  thy numberOfRows; i++) {
 			double psum = 0;
 			for (long im = 1; im <= my numberOfComponents; im++) {
 				Covariance cov = (Covariance) my covariances -> item[im];
-				double dsq = NUMmahalanobisDistance_chi (cov -> lowerCholesky, thy data[i], cov -> centroid, cov -> numberOfRows, my dimension);
+				double dsq = his data[i][im];
 				lnN[im] = ln2pid - 0.5 * (cov -> lnd + dsq);
 				psum += his data[i][im] = my mixingProbabilities[im] * exp (lnN[im]);
 			}
@@ -776,11 +795,12 @@ void GaussianMixture_and_TableOfReal_getGammas (GaussianMixture me, TableOfReal
 		*lnp = 0;
 		double ln2pid = - 0.5 * my dimension * log (NUM2pi);
 		autoNUMvector<double> lnN (1, my numberOfComponents);
+		GaussianMixture_and_TableOfReal_getMahalanobisDistances (me, thee, gamma);
 		for (long i = 1; i <=  thy numberOfRows; i++) {
 			double rowsum = 0;
 			for (long im = 1; im <= my numberOfComponents; im++) {
 				Covariance cov = (Covariance) my covariances -> item[im];
-				double dsq = NUMmahalanobisDistance_chi (cov -> lowerCholesky, thy data[i], cov -> centroid, cov -> numberOfRows, my dimension);
+				double dsq = gamma[i][im];
 				lnN[im] = ln2pid - 0.5 * (cov -> lnd + dsq);
 				gamma[i][im] = my mixingProbabilities[im] * exp (lnN[im]); // eq. Bishop 9.16
 				rowsum += gamma[i][im];
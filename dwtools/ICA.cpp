@@ -27,18 +27,66 @@
 #include "NUM2.h"
 #include "Sound_and_PCA.h"
 #include "SVD.h"
+#include "MelderThread.h"
+
+/*
+	The matrix products below run their innermost loop along rows (i-k-j order),
+	so that every matrix is read with unit stride.
+*/
+
+// matrix multiply V*C, V is nrv x ncv, C is ncv x ncc, R is nrv x ncc;
+static void NUMdmatrices_multiply_VC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
+	for (long i = 1; i <= nrv; i++) {
+		double *ri = r[i];
+		for (long j = 1; j <= ncc; j++) {
+			ri[j] = 0;
+		}
+		for (long k = 1; k <= ncv; k++) {
+			// R_ij += V_ik C_kj
+			double vik = v[i][k], *ck = c[k];
+			for (long j = 1; j <= ncc; j++) {
+				ri[j] += vik * ck[j];
+			}
+		}
+	}
+}
+
+// matrix multiply V'*C, V is nrv x ncv, C is nrv x ncc, R is ncv x ncc;
+static void NUMdmatrices_multiply_VpC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
+	for (long i = 1; i <= ncv; i++) {
+		for (long j = 1; j <= ncc; j++) {
+			r[i][j] = 0;
+		}
+	}
+	for (long k = 1; k <= nrv; k++) {
+		double *vk = v[k], *ck = c[k];
+		for (long i = 1; i <= ncv; i++) {
+			// R_ij += V'_ik C_kj = V_ki C_kj
+			double vki = vk[i], *ri = r[i];
+			for (long j = 1; j <= ncc; j++) {
+				ri[j] += vki * ck[j];
+			}
+		}
+	}
+}
 
 // matrix multiply R = V*C*V', V is nrv x ncv, C is ncv x ncv, R is nrv x nrv
-static void NUMdmatrices_multiply_VCVp (double **r, double **v, long nrv, long ncv, double **c, int csym) {
+// as (V*C)*V', i.e. in order nrv*ncv*(ncv+nrv) rather than (nrv*ncv)^2; work is nrv x ncv (or NULL)
+static void NUMdmatrices_multiply_VCVp (double **r, double **v, long nrv, long ncv, double **c, int csym, double **work = NULL) {
+	autoNUMmatrix<double> vc;
+	if (work == NULL) {
+		vc.reset (1, nrv, 1, ncv);
+		work = vc.peek();
+	}
+	NUMdmatrices_multiply_VC (work, v, nrv, ncv, c, ncv);
 	for (long i = 1; i <= nrv; i++) {
 		long jstart = csym ? i : 1;
+		double *wi = work[i];
 		for (long j = jstart; j <= nrv; j++) {
-			// V_ik C_kl V'_lj = V_ik C_kl V_jl
-			double vcv = 0;
-			for (long k = 1; k <= ncv; k++) {
-				for (long l = 1; l <= ncv; l++) {
-					vcv += v[i][k] * c[k][l] * v[j][l];
-				}
+			// (VC)_il V'_lj = (VC)_il V_jl
+			double vcv = 0, *vj = v[j];
+			for (long l = 1; l <= ncv; l++) {
+				vcv += wi[l] * vj[l];
 			}
 			r[i][j] = vcv;
 			if (csym) {
@@ -50,15 +98,15 @@ static void NUMdmatrices_multiply_VCVp (double **r, double **v, long nrv, long n
 
 // matrix multiply R = V'*C*V, V is nrv x ncv, C is ncv x ncv, R is nrv x nrv
 static void NUMdmatrices_multiply_VpCV (double **r, double **v, long nrv, long ncv, double **c, int csym) {
+	// as (V'*C)*V
+	autoNUMmatrix<double> vpc (1, ncv, 1, ncv);
+	NUMdmatrices_multiply_VpC (vpc.peek(), v, nrv, ncv, c, ncv);
 	for (long i = 1; i <= ncv; i++) {
 		long jstart = csym ? i : 1;
 		for (long j = jstart; j <= ncv; j++) {
-			// V'_ik C_kl V_lj = V_ki C_kl V_lj
 			double vcv = 0;
-			for (long k = 1; k <= nrv; k++) {
-				for (long l = 1; l <= ncv; l++) {
-					vcv += v[k][i] * c[k][l] * v[l][j];
-				}
+			for (long l = 1; l <= ncv; l++) {
+				vcv += vpc[i][l] * v[l][j];
 			}
 			r[i][j] = vcv;
 			if (csym) {
@@ -68,48 +116,80 @@ static void NUMdmatrices_multiply_VpCV (double **r, double **v, long nrv, long n
 	}
 }
 
-// matrix multiply V*C, V is nrv x ncv, C is ncv x ncc, R is nrv x ncc;
-static void NUMdmatrices_multiply_VC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
-	for (long i = 1; i <= nrv; i++) {
-		for (long j = 1; j <= ncc; j++) {
-			// V_ik C_kj
-			double vc = 0;
-			for (long k = 1; k <= ncv; k++) {
-				vc += v[i][k] * c[k][j];
-			}
-			r[i][j] = vc;
-		}
-	}
-}
-
-// matrix multiply V'*C, V is nrv x ncv, C is nrv x ncc, R is ncv x ncc;
-static void NUMdmatrices_multiply_VpC (double **r, double **v, long nrv, long ncv, double **c, long ncc) {
-	for (long i = 1; i <= ncv; i++) {
-		for (long j = 1; j <= ncc; j++) {
-			// V'_ik C_kj
-			double vc = 0;
-			for (long k = 1; k <= nrv; k++) {
-				vc += v[k][i] * c[k][j];
-			}
-			r[i][j] = vc;
-		}
-	}
-}
-
 // D += scalef * M * M', M = nrm x ncm, D is nrm x nrm
 static void NUMdmatrices_multiplyScaleAdd (double **r, double **m, long nrm, long ncm, double scalef) {
 	for (long i = 1; i <= nrm; i++) {
-		for (long j = 1; j <= nrm; j++) {
-			// M_ik M'_kj = M_ik M_jk
+		for (long j = i; j <= nrm; j++) {
+			// M_ik M'_kj = M_ik M_jk, symmetric in i and j
 			double mm = 0;
 			for (long k = 1; k <= ncm; k++) {
 				mm += m[i][k] * m[j][k];
 			}
 			r[i][j] += scalef * mm;
+			if (j != i) {
+				r[j][i] += scalef * mm;
+			}
 		}
 	}
 }
 
+/*
+	R[k] = V * C[k] * V' for many symmetric matrices C[k] at once, in parallel; R[k] may be C[k].
+*/
+Thing_define (NUMdmatrices_multiply_VCVp_Args, Thing) { public:
+	double ***r, ***c, **v;
+	long dimension, numberOfMatrices;
+	volatile long *next;
+};
+
+Thing_implement (NUMdmatrices_multiply_VCVp_Args, Thing, 0);
+
+MelderThread_MUTEX (multiplyMutex);
+static bool multiplyMutex_inited;
+
+static MelderThread_RETURN_TYPE NUMdmatrices_multiply_VCVp_matrices (NUMdmatrices_multiply_VCVp_Args me) {
+	const long dimension = my dimension;
+	autoNUMmatrix<double> copy, work;
+	MelderThread_LOCK (multiplyMutex);
+	copy.reset (1, dimension, 1, dimension);
+	work.reset (1, dimension, 1, dimension);
+	MelderThread_UNLOCK (multiplyMutex);
+	for (;;) {
+		MelderThread_LOCK (multiplyMutex);
+		long k = ++ *my next;
+		MelderThread_UNLOCK (multiplyMutex);
+		if (k > my numberOfMatrices) break;
+		double **c = my c[k];
+		if (my r[k] == c) {
+			NUMmatrix_copyElements (c, copy.peek(), 1, dimension, 1, dimension);
+			c = copy.peek();
+		}
+		NUMdmatrices_multiply_VCVp (my r[k], my v, dimension, dimension, c, 1, work.peek());
+	}
+	MelderThread_RETURN;
+}
+
+static void NUMdmatrices_multiply_VCVp_many (double ***r, double **v, long dimension, double ***c, long numberOfMatrices) {
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfMatrices) numberOfThreads = numberOfMatrices;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! multiplyMutex_inited) { MelderThread_MUTEX_INIT (multiplyMutex); multiplyMutex_inited = true; }
+	autoNUMdmatrices_multiply_VCVp_Args args [16];
+	volatile long next = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+		autoNUMdmatrices_multiply_VCVp_Args arg = Thing_new (NUMdmatrices_multiply_VCVp_Args);
+		arg -> r = r;
+		arg -> c = c;
+		arg -> v = v;
+		arg -> dimension = dimension;
+		arg -> numberOfMatrices = numberOfMatrices;
+		arg -> next = & next;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (NUMdmatrices_multiply_VCVp_matrices, args, numberOfThreads);
+}
+
 /*
 	d = diag(diag(W'*C0*W));
 	W = W*d^(-1/2);
@@ -187,7 +267,10 @@ static void Diagonalizer_and_CrossCorrelationTables_ffdiag (Diagonalizer me, Cro
 		autoCrossCorrelationTables ccts = CrossCorrelationTables_and_Diagonalizer_diagonalize (thee, me);
 		autoNUMmatrix<double> w (1, dimension, 1, dimension);
 		autoNUMmatrix<double> vnew (1, dimension, 1, dimension);
-		autoNUMmatrix<double> cc (1, dimension, 1, dimension);
+		autoNUMvector <double **> tables (1, ccts -> size);
+		for (long k = 1; k <= ccts -> size; k++) {
+			tables[k] = ((CrossCorrelationTable) ccts -> item[k]) -> data;
+		}
 
 		for (long i = 1; i <= dimension; i++) {
 			w[i][i] = 1;
@@ -249,11 +332,7 @@ static void Diagonalizer_and_CrossCorrelationTables_ffdiag (Diagonalizer me, Cro
 				// update V
 				NUMmatrix_copyElements (v, vnew.peek(), 1, dimension, 1, dimension);
 				NUMdmatrices_multiply_VC (v, w.peek(), dimension, dimension, vnew.peek(), dimension);
-				for (long k = 1; k <= ccts -> size; k++) {
-					CrossCorrelationTable ct = (CrossCorrelationTable) ccts -> item[k];
-					NUMmatrix_copyElements (ct -> data, cc.peek(), 1, dimension, 1, dimension);
-					NUMdmatrices_multiply_VCVp (ct -> data, w.peek(), dimension, dimension, cc.peek(), 1);
-				}
+				NUMdmatrices_multiply_VCVp_many (tables.peek(), w.peek(), dimension, tables.peek(), ccts -> size);
 				dm_new = CrossCorrelationTables_getDiagonalityMeasure (ccts.peek(), 0, 0, 0);
 				iter++;
 				Melder_progress ((double) iter / (double) maxNumberOfIterations, L"Iteration: ", Melder_integer (iter), L", measure: ", Melder_double (dm_new), L"\n fractional measure: ", Melder_double (dm_new / dm_start));
@@ -338,10 +417,13 @@ static void Diagonalizer_and_CrossCorrelationTable_qdiag (Diagonalizer me, Cross
 
 		// P*C[i]*P'
 
-		for (long ic = 1; ic <= thy size; ic++) {
-			CrossCorrelationTable cov1 = (CrossCorrelationTable) thy item[ic];
-			CrossCorrelationTable cov2 = (CrossCorrelationTable) ccts -> item[ic];
-			NUMdmatrices_multiply_VCVp (cov2 -> data, p.peek(), dimension, dimension, cov1 -> data, 1);
+		{
+			autoNUMvector <double **> tables1 (1, thy size), tables2 (1, thy size);
+			for (long ic = 1; ic <= thy size; ic++) {
+				tables1[ic] = ((CrossCorrelationTable) thy item[ic]) -> data;
+				tables2[ic] = ((CrossCorrelationTable) ccts -> item[ic]) -> data;
+			}
+			NUMdmatrices_multiply_VCVp_many (tables2.peek(), p.peek(), dimension, tables1.peek(), thy size);
 		}
 
 		// W = P'\W == inv(P') * W
@@ -433,31 +515,156 @@ void MixingMatrix_and_CrossCorrelationTables_improveUnmixing (MixingMatrix me, C
 }
 
 
+/*
+	Lagged cross-correlations of many rows at once.
+	The rows are handled in blocks of NUMcrossCorrelate_BLOCK_ROWS, the columns in chunks of
+	NUMcrossCorrelate_BLOCK_COLUMNS, so that the centred samples of two row blocks stay in the cache
+	while they are multiplied. Every (row block pair, lag) combination is an independent work item.
+	Per matrix element the products are summed in the order of the columns, as before.
+*/
+#define NUMcrossCorrelate_BLOCK_ROWS  16
+#define NUMcrossCorrelate_BLOCK_COLUMNS  1024
+
+Thing_define (NUMcrossCorrelate_rows_Args, Thing) { public:
+	double **x, ***cc, *centroid, scale;
+	const long *lags;
+	long nrows, icol1, icol2, numberOfLags, numberOfBlocks;
+	volatile long *next;
+};
+
+Thing_implement (NUMcrossCorrelate_rows_Args, Thing, 0);
+
+MelderThread_MUTEX (crossCorrelateMutex);
+static bool crossCorrelateMutex_inited;
+
+static void NUMcrossCorrelate_centreBlock (NUMcrossCorrelate_rows_Args me, long firstRow, long lastRow, long firstColumn, long numberOfColumns, double **buffer) {
+	for (long i = firstRow; i <= lastRow; i ++) {
+		double *xi = my x[i] + firstColumn, *bi = buffer[i - firstRow + 1], ci = my centroid[i];
+		for (long k = 0; k < numberOfColumns; k ++) {
+			bi[k] = xi[k] - ci;
+		}
+	}
+}
+
+static MelderThread_RETURN_TYPE NUMcrossCorrelate_rows_blocks (NUMcrossCorrelate_rows_Args me) {
+	autoNUMmatrix <double> bufferI, bufferJ, acc;
+	MelderThread_LOCK (crossCorrelateMutex);
+	bufferI.reset (1, NUMcrossCorrelate_BLOCK_ROWS, 0, NUMcrossCorrelate_BLOCK_COLUMNS - 1);
+	bufferJ.reset (1, NUMcrossCorrelate_BLOCK_ROWS, 0, NUMcrossCorrelate_BLOCK_COLUMNS - 1);
+	acc.reset (1, NUMcrossCorrelate_BLOCK_ROWS, 1, NUMcrossCorrelate_BLOCK_ROWS);
+	MelderThread_UNLOCK (crossCorrelateMutex);
+	const long numberOfBlockPairs = my numberOfBlocks * (my numberOfBlocks + 1) / 2;
+	for (;;) {
+		MelderThread_LOCK (crossCorrelateMutex);
+		long item = ++ *my next;
+		MelderThread_UNLOCK (crossCorrelateMutex);
+		if (item > numberOfBlockPairs * my numberOfLags) break;
+		long ilag = (item - 1) / numberOfBlockPairs + 1, pair = (item - 1) % numberOfBlockPairs;
+		long iblock = 1;
+		while (pair >= my numberOfBlocks - iblock + 1) {
+			pair -= my numberOfBlocks - iblock + 1;
+			iblock ++;
+		}
+		long jblock = iblock + pair;
+		long lag = my lags [ilag];
+		long ifirst = (iblock - 1) * NUMcrossCorrelate_BLOCK_ROWS + 1, ilast = ifirst + NUMcrossCorrelate_BLOCK_ROWS - 1;
+		long jfirst = (jblock - 1) * NUMcrossCorrelate_BLOCK_ROWS + 1, jlast = jfirst + NUMcrossCorrelate_BLOCK_ROWS - 1;
+		if (ilast > my nrows) ilast = my nrows;
+		if (jlast > my nrows) jlast = my nrows;
+		for (long a = 1; a <= ilast - ifirst + 1; a ++) {
+			for (long b = 1; b <= jlast - jfirst + 1; b ++) {
+				acc [a] [b] = 0;
+			}
+		}
+		long lastColumn = my icol2 - lag;
+		for (long k1 = my icol1; k1 <= lastColumn; k1 += NUMcrossCorrelate_BLOCK_COLUMNS) {
+			long ncolumns = lastColumn - k1 + 1;
+			if (ncolumns > NUMcrossCorrelate_BLOCK_COLUMNS) ncolumns = NUMcrossCorrelate_BLOCK_COLUMNS;
+			NUMcrossCorrelate_centreBlock (me, ifirst, ilast, k1, ncolumns, bufferI.peek());
+			NUMcrossCorrelate_centreBlock (me, jfirst, jlast, k1 + lag, ncolumns, bufferJ.peek());
+			for (long i = ifirst; i <= ilast; i ++) {
+				long a = i - ifirst + 1;
+				double *bi = bufferI [a];
+				long j = i > jfirst ? i : jfirst;
+				for (; j + 3 <= jlast; j += 4) {
+					/*
+						Four independent sums at a time, each still in the order of the columns.
+					*/
+					long b = j - jfirst + 1;
+					double *bj0 = bufferJ [b], *bj1 = bufferJ [b + 1], *bj2 = bufferJ [b + 2], *bj3 = bufferJ [b + 3];
+					double ccor0 = acc [a] [b], ccor1 = acc [a] [b + 1], ccor2 = acc [a] [b + 2], ccor3 = acc [a] [b + 3];
+					for (long k = 0; k < ncolumns; k ++) {
+						double bik = bi [k];
+						ccor0 += bik * bj0 [k];
+						ccor1 += bik * bj1 [k];
+						ccor2 += bik * bj2 [k];
+						ccor3 += bik * bj3 [k];
+					}
+					acc [a] [b] = ccor0;
+					acc [a] [b + 1] = ccor1;
+					acc [a] [b + 2] = ccor2;
+					acc [a] [b + 3] = ccor3;
+				}
+				for (; j <= jlast; j ++) {
+					long b = j - jfirst + 1;
+					double *bj = bufferJ [b], ccor = acc [a] [b];
+					for (long k = 0; k < ncolumns; k ++) {
+						ccor += bi [k] * bj [k];
+					}
+					acc [a] [b] = ccor;
+				}
+			}
+		}
+		double **cc = my cc [ilag];
+		for (long i = ifirst; i <= ilast; i ++) {
+			for (long j = i > jfirst ? i : jfirst; j <= jlast; j ++) {
+				cc [j] [i] = cc [i] [j] = acc [i - ifirst + 1] [j - jfirst + 1] * my scale;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
 /* Preconditions:
- * 	x[1..nrows][1..ncols], cc[1..nrows][1..nrows], centroid[1..nrows]
- * 	if (lag>0) {i2 + lag <= ncols} else {i1-lag >= 1}
+ * 	x[1..nrows][1..ncols], cc[1..numberOfLags][1..nrows][1..nrows], centroid[1..nrows]
+ * 	1 <= icol1, icol2 <= ncols, 0 <= lags[i] <= icol2 - icol1
  * 	no array boundary checks!
- * 	lag >= 0
+ * The centroid is taken over columns icol1..icol2, for lag tau the products run over icol1..icol2-tau.
  */
-static void NUMcrossCorrelate_rows (double **x, long nrows, long icol1, long icol2, long lag, double **cc, double *centroid, double scale) {
-	lag = abs (lag);
-	long nsamples = icol2 - icol1 + 1 + lag;
+static void NUMcrossCorrelate_rows (double **x, long nrows, long icol1, long icol2, const long *lags, long numberOfLags, double ***cc, double *centroid, double scale) {
+	long nsamples = icol2 - icol1 + 1;
 	for (long i = 1; i <= nrows; i++) {
 		double sum = 0;
-		for (long k = icol1; k <= icol2 + lag; k++) {
+		for (long k = icol1; k <= icol2; k++) {
 			sum += x[i][k];
 		}
 		centroid[i] = sum / nsamples;
 	}
-	for (long i = 1; i <= nrows; i++) {
-		for (long j = i; j <= nrows; j++) {
-			double ccor = 0;
-			for (long k = icol1; k <= icol2; k++) {
-				ccor += (x[i][k] - centroid[i]) * (x[j][k + lag] - centroid[j]);
-			}
-			cc[j][i] = cc[i][j] = ccor * scale;
-		}
+	long numberOfBlocks = (nrows - 1) / NUMcrossCorrelate_BLOCK_ROWS + 1;
+	long numberOfItems = numberOfBlocks * (numberOfBlocks + 1) / 2 * numberOfLags;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfItems) numberOfThreads = numberOfItems;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! crossCorrelateMutex_inited) { MelderThread_MUTEX_INIT (crossCorrelateMutex); crossCorrelateMutex_inited = true; }
+	autoNUMcrossCorrelate_rows_Args args [16];
+	volatile long next = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread++) {
+		autoNUMcrossCorrelate_rows_Args arg = Thing_new (NUMcrossCorrelate_rows_Args);
+		arg -> x = x;
+		arg -> cc = cc;
+		arg -> centroid = centroid;
+		arg -> scale = scale;
+		arg -> lags = lags;
+		arg -> nrows = nrows;
+		arg -> icol1 = icol1;
+		arg -> icol2 = icol2;
+		arg -> numberOfLags = numberOfLags;
+		arg -> numberOfBlocks = numberOfBlocks;
+		arg -> next = & next;
+		args [ithread - 1].reset (arg.transfer());
 	}
+	MelderThread_run (NUMcrossCorrelate_rows_blocks, args, numberOfThreads);
 }
 
 /*
@@ -480,14 +687,17 @@ CrossCorrelationTable Sound_to_CrossCorrelationTable (Sound me, double startTime
 		if (i2 > my nx) {
 			i2 = my nx;
 		}
-		i2 -= lag;
-		long nsamples = i2 - i1 + 1;
+		long nsamples = i2 - lag - i1 + 1;
 		if (nsamples <= my ny) {
 			Melder_throw ("Not enough samples, choose a longer interval.");
 		}
 		autoCrossCorrelationTable thee = CrossCorrelationTable_create (my ny);
+		autoNUMvector<long> lags (1, 1);
+		autoNUMvector<double **> tables (1, 1);
+		lags[1] = lag;
+		tables[1] = thy data;
 
-		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lag, thy data, thy centroid, my dx);
+		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lags.peek(), 1, tables.peek(), thy centroid, my dx);
 
 		thy numberOfObservations = nsamples;
 
@@ -519,12 +729,15 @@ CrossCorrelationTable Sounds_to_CrossCorrelationTable_combined (Sound me, Sound
 		if (i2 > my nx) {
 			i2 = my nx;
 		}
-		i2 -= ndelta;
-		long nsamples = i2 - i1 + 1;
+		long nsamples = i2 - ndelta - i1 + 1;
 		if (nsamples <= nchannels) {
 			Melder_throw ("Not enough samples");
 		}
 		autoCrossCorrelationTable him = CrossCorrelationTable_create (nchannels);
+		autoNUMvector<long> lags (1, 1);
+		autoNUMvector<double **> tables (1, 1);
+		lags[1] = ndelta;
+		tables[1] = his data;
 		autoNUMvector<double *> data (1, nchannels);
 		for (long i = 1; i <= my ny; i++) {
 			data[i] = my z[i];
@@ -533,7 +746,7 @@ CrossCorrelationTable Sounds_to_CrossCorrelationTable_combined (Sound me, Sound
 			data[i + my ny] = thy z[i];
 		}
 
-		NUMcrossCorrelate_rows (data.peek(), nchannels, i1, i2, ndelta, his data, his centroid, my dx);
+		NUMcrossCorrelate_rows (data.peek(), nchannels, i1, i2, lags.peek(), 1, tables.peek(), his centroid, my dx);
 
 		his numberOfObservations = nsamples;
 
@@ -567,12 +780,39 @@ CrossCorrelationTables Sound_to_CrossCorrelationTables (Sound me, double startTi
 		if (startTime + ncovars * lagStep >= endTime) {
 			Melder_throw ("Lag time too large.");
 		}
+		long i1 = Sampled_xToNearestIndex (me, startTime);
+		if (i1 < 1) {
+			i1 = 1;
+		}
+		long i2 = Sampled_xToNearestIndex (me, endTime);
+		if (i2 > my nx) {
+			i2 = my nx;
+		}
+		/*
+			All lags in one pass over the samples; the centroid is the same for all lags.
+		*/
 		autoCrossCorrelationTables thee = CrossCorrelationTables_create ();
+		autoNUMvector<long> lags (1, ncovars);
+		autoNUMvector<double **> tables (1, ncovars);
 		for (long i = 1; i <= ncovars; i++) {
-			double lag = (i - 1) * lagStep;
-			autoCrossCorrelationTable ct = Sound_to_CrossCorrelationTable (me, startTime, endTime, lag);
+			lags[i] = (i - 1) * lagStep / my dx;
+			long nsamples = i2 - lags[i] - i1 + 1;
+			if (nsamples <= my ny) {
+				Melder_throw ("Not enough samples, choose a longer interval.");
+			}
+			autoCrossCorrelationTable ct = CrossCorrelationTable_create (my ny);
+			ct -> numberOfObservations = nsamples;
+			tables[i] = ct -> data;
 			Collection_addItem (thee.peek(), ct.transfer());
 		}
+		if (ncovars > 0) {
+			CrossCorrelationTable first = (CrossCorrelationTable) thy item[1];
+			NUMcrossCorrelate_rows (my z, my ny, i1, i2, lags.peek(), ncovars, tables.peek(), first -> centroid, my dx);
+			for (long i = 2; i <= ncovars; i++) {
+				CrossCorrelationTable ct = (CrossCorrelationTable) thy item[i];
+				NUMvector_copyElements (first -> centroid, ct -> centroid, 1, my ny);
+			}
+		}
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": no CrossCorrelationTables created.");
@@ -892,11 +1132,18 @@ CrossCorrelationTable CrossCorrelationTable_and_Diagonalizer_diagonalize (CrossC
 CrossCorrelationTables CrossCorrelationTables_and_Diagonalizer_diagonalize (CrossCorrelationTables me, Diagonalizer thee) {
 	try {
 		autoCrossCorrelationTables him = CrossCorrelationTables_create ();
+		autoNUMvector <double **> tables (1, my size), diagonalized (1, my size);
 		for (long i = 1; i <= my size; i++) {
 			CrossCorrelationTable item = (CrossCorrelationTable) my item[i];
-			autoCrossCorrelationTable ct = CrossCorrelationTable_and_Diagonalizer_diagonalize (item, thee);
+			if (item -> numberOfRows != thy numberOfRows) {
+				Melder_throw ("The CrossCorrelationTable and the Diagonalizer matrix dimensions must be equal.");
+			}
+			autoCrossCorrelationTable ct = CrossCorrelationTable_create (item -> numberOfColumns);
+			tables[i] = item -> data;
+			diagonalized[i] = ct -> data;
 			Collection_addItem (him.peek(), ct.transfer());
 		}
+		NUMdmatrices_multiply_VCVp_many (diagonalized.peek(), thy data, thy numberOfRows, tables.peek(), my size);
 		return him.transfer();
 	} catch (MelderError) {
 		Melder_throw ("CrossCorrelationTables not diagonalized.");
@@ -37,6 +37,7 @@
 #include "MDS.h"
 #include "SSCP.h"
 #include "PCA.h"
+#include "MelderThread.h"
 
 #define TINY 1e-30
 
@@ -92,6 +93,62 @@ static long NUMdmatrix_countZeros (double **m, long nr, long nc) {
 	return nZeros;
 }
 
+/*
+	The pairwise kernels of smacof, Kruskal and indscal work row by row: every row of the result
+	only depends on the input, so the rows can be divided over threads. The row functions may
+	neither allocate memory nor throw.
+*/
+typedef void (*MDS_RowFunction) (void *closure, long row);
+
+#define MDS_MINIMUM_ROWS_PER_THREAD  64
+
+Thing_define (MDS_rows_Args, Thing) { public:
+	MDS_RowFunction rowFunction;
+	void *closure;
+	long numberOfRows;
+	volatile long *next;
+};
+
+Thing_implement (MDS_rows_Args, Thing, 0);
+
+MelderThread_MUTEX (rowsMutex);
+static bool rowsMutex_inited;
+
+static MelderThread_RETURN_TYPE MDS_rows_compute (MDS_rows_Args me) {
+	for (;;) {
+		MelderThread_LOCK (rowsMutex);
+		long row = ++ *my next;
+		MelderThread_UNLOCK (rowsMutex);
+		if (row > my numberOfRows) break;
+		my rowFunction (my closure, row);
+	}
+	MelderThread_RETURN;
+}
+
+static void MDS_forEachRow (long numberOfRows, MDS_RowFunction rowFunction, void *closure) {
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfRows / MDS_MINIMUM_ROWS_PER_THREAD) numberOfThreads = numberOfRows / MDS_MINIMUM_ROWS_PER_THREAD;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads <= 1) {
+		for (long row = 1; row <= numberOfRows; row ++) {
+			rowFunction (closure, row);
+		}
+		return;
+	}
+	if (! rowsMutex_inited) { MelderThread_MUTEX_INIT (rowsMutex); rowsMutex_inited = true; }
+	autoMDS_rows_Args args [16];
+	volatile long next = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoMDS_rows_Args arg = Thing_new (MDS_rows_Args);
+		arg -> rowFunction = rowFunction;
+		arg -> closure = closure;
+		arg -> numberOfRows = numberOfRows;
+		arg -> next = & next;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (MDS_rows_compute, args, numberOfThreads);
+}
+
 static void NUMsort3 (double *data, long *iPoint, long *jPoint, long ifrom, long ito, int ascending) {
 	if (ifrom > ito || ifrom < 1) {
 		Melder_throw ("invalid range.");
@@ -1300,37 +1357,72 @@ ScalarProduct Distance_to_ScalarProduct (Distance me, int normalize) {
 /**********  Configuration & ..... ***********************************/
 
 
-Distance Configuration_to_Distance (Configuration me) {
-	try {
-		autoDistance thee = Distance_create (my numberOfRows);
-		TableOfReal_copyLabels (me, thee.peek(), 1, -1);
-		for (long i = 1; i <= thy numberOfRows - 1; i++) {
-			for (long j = i + 1; j <= thy numberOfColumns; j++) {
-				double dmax = 0, d = 0;
+struct Configuration_distances_Closure {
+	Configuration configuration;
+	double **distance;
+};
 
-				/*
-					first divide distance by maximum to prevent overflow when metric is a large number.
-					d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
-					metric changed 24/11/97
-					my w[k] * pow (|i-j|) instead of pow (my w[k] * |i-j|)
-				*/
+static void Configuration_distances_row (void *closure, long i) {
+	Configuration_distances_Closure *c = (Configuration_distances_Closure *) closure;
+	Configuration me = c -> configuration;
+	double **d = c -> distance, *xi = my data[i], *w = my w, metric = my metric;
+	long nDimensions = my numberOfColumns;
+	for (long j = i + 1; j <= my numberOfRows; j++) {
+		double *xj = my data[j], dmax = 0, dij = 0;
 
-				for (long k = 1; k <= my numberOfColumns; k++) {
-					double dtmp  = fabs (my data[i][k] - my data[j][k]);
-					if (dtmp > dmax) {
-						dmax = dtmp;
-					}
+		/*
+			first divide distance by maximum to prevent overflow when metric is a large number.
+			d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
+			metric changed 24/11/97
+			my w[k] * pow (|i-j|) instead of pow (my w[k] * |i-j|)
+		*/
+
+		for (long k = 1; k <= nDimensions; k++) {
+			double dtmp = fabs (xi[k] - xj[k]);
+			if (dtmp > dmax) {
+				dmax = dtmp;
+			}
+		}
+		if (dmax > 0) {
+			if (metric == 2) {   // Euclidean, without calls to pow ()
+				for (long k = 1; k <= nDimensions; k++) {
+					double arg = (xi[k] - xj[k]) / dmax;
+					dij += w[k] * arg * arg;
 				}
-				if (dmax > 0) {
-					for (long k = 1; k <= my numberOfColumns; k++) {
-						double arg = fabs (my data[i][k] - my data[j][k]) / dmax;
-						d += my w[k] * pow (arg, my metric);
-					}
+				dij = sqrt (dij);
+			} else if (metric == 1) {   // city block
+				for (long k = 1; k <= nDimensions; k++) {
+					dij += w[k] * (fabs (xi[k] - xj[k]) / dmax);
 				}
-				thy data[i][j] = thy data[j][i] = dmax * pow (d, 1.0 / my metric);
+			} else {
+				for (long k = 1; k <= nDimensions; k++) {
+					double arg = fabs (xi[k] - xj[k]) / dmax;
+					dij += w[k] * pow (arg, metric);
+				}
+				dij = pow (dij, 1.0 / metric);
 			}
 		}
+		d[i][j] = d[j][i] = dmax * dij;
+	}
+}
+
+/*
+	Distances between the points of the configuration into an existing Distance (no labels copied).
+*/
+static void Configuration_into_Distance (Configuration me, Distance thee) {
+	Configuration_distances_Closure closure;
+	closure.configuration = me;
+	closure.distance = thy data;
+	MDS_forEachRow (my numberOfRows - 1, Configuration_distances_row, & closure);
+}
+
+Distance Configuration_to_Distance (Configuration me) {
+	try {
+		autoDistance thee = Distance_create (my numberOfRows);
+		TableOfReal_copyLabels (me, thee.peek(), 1, -1);
+		Configuration_into_Distance (me, thee.peek());
 		return thee.transfer();
+
 	} catch (MelderError) {
 		Melder_throw (me, ": no Distance created.");
 	}
@@ -1724,44 +1816,69 @@ Distances Dissimilarities_to_Distances (Dissimilarities me, int measurementLevel
 
 /*****************  Kruskal *****************************************/
 
-static void smacof_guttmanTransform (Configuration cx, Configuration cz,
-                                     Distance disp, Weight weight, double **vplus) {
-	long nPoints = cx -> numberOfRows, nDimensions = cx -> numberOfColumns;
-	double **z = cz -> data;
+struct smacof_Closure {
+	double **x, **z, **bz, **vplus, **w, **disparity, **distanceZ;
+	long numberOfPoints, numberOfDimensions;
+};
 
-	autoNUMmatrix<double> b (1, nPoints, 1, nPoints);
-	autoDistance distZ = Configuration_to_Distance (cz);
+// row i of B(Z)Z, with b[i][j] = -w[i][j] * disparity[i][j] / dz[i][j] (i != j) and b[i][i] = - sum (j != i, b[i][j]) (eq. 8.25)
 
-	// compute B(Z) (eq. 8.25)
-
-	for (long i = 1; i <= nPoints; i++) {
-		double sum = 0;
-		for (long j = 1; j <= nPoints; j++) {
-			double dzij = distZ -> data[i][j];
-			if (i == j || dzij == 0) {
-				continue;
-			}
-			b[i][j] = - weight -> data[i][j] * disp -> data[i][j] / dzij;
-			sum += b[i][j];
+static void smacof_bz_row (void *closure, long i) {
+	smacof_Closure *c = (smacof_Closure *) closure;
+	double *bzi = c -> bz[i], *zi = c -> z[i], *wi = c -> w[i], *disparityi = c -> disparity[i], *dzi = c -> distanceZ[i];
+	long nDimensions = c -> numberOfDimensions;
+	for (long m = 1; m <= nDimensions; m++) {
+		bzi[m] = 0;
+	}
+	for (long j = 1; j <= c -> numberOfPoints; j++) {
+		double dzij = dzi[j];
+		if (i == j || dzij == 0) {
+			continue;
+		}
+		double bij = - wi[j] * disparityi[j] / dzij, *zj = c -> z[j];
+		for (long m = 1; m <= nDimensions; m++) {
+			bzi[m] += bij * (zj[m] - zi[m]);
 		}
-		b[i][i] = - sum;
 	}
+}
 
-	// Guttman transform: Xu = (V+)B(Z)Z (eq. 8.29)
+// row i of (V+)B(Z)Z (eq. 8.29)
 
-	for (long i = 1; i <= nPoints; i++) {
-		for (long j = 1; j <= nDimensions; j++) {
-			double xij = 0;
-			for (long k = 1;  k <= nPoints; k++) {
-				for (long l = 1; l <= nPoints; l++) {
-					xij += vplus[i][k] * b[k][l] * z[l][j];
-				}
-			}
-			cx -> data[i][j] = xij;
+static void smacof_vplusbz_row (void *closure, long i) {
+	smacof_Closure *c = (smacof_Closure *) closure;
+	double *xi = c -> x[i], *vplusi = c -> vplus[i];
+	long nDimensions = c -> numberOfDimensions;
+	for (long m = 1; m <= nDimensions; m++) {
+		xi[m] = 0;
+	}
+	for (long k = 1; k <= c -> numberOfPoints; k++) {
+		double vik = vplusi[k], *bzk = c -> bz[k];
+		for (long m = 1; m <= nDimensions; m++) {
+			xi[m] += vik * bzk[m];
 		}
 	}
 }
 
+/*
+	Guttman transform Xu = (V+)B(Z)Z, computed as (V+)(B(Z)Z) in order nPoints^2 * nDimensions.
+	distZ are the distances between the points of cz, bz is nPoints x nDimensions workspace.
+*/
+static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance disp, Weight weight,
+                                     Distance distZ, double **vplus, double **bz) {
+	smacof_Closure closure;
+	closure.x = cx -> data;
+	closure.z = cz -> data;
+	closure.bz = bz;
+	closure.vplus = vplus;
+	closure.w = weight -> data;
+	closure.disparity = disp -> data;
+	closure.distanceZ = distZ -> data;
+	closure.numberOfPoints = cx -> numberOfRows;
+	closure.numberOfDimensions = cx -> numberOfColumns;
+	MDS_forEachRow (closure.numberOfPoints, smacof_bz_row, & closure);
+	MDS_forEachRow (closure.numberOfPoints, smacof_vplusbz_row, & closure);
+}
+
 double Distance_Weight_stress (Distance fit, Distance conf, Weight weight, int type) {
 	double eta_fit, eta_conf, rho, stress = NUMundefined, denum, tmp;
 
@@ -1930,55 +2047,71 @@ double Distance_Weight_congruenceCoefficient (Distance x, Distance y, Weight w)
 	return xy / (sqrt (x2) * sqrt (y2));
 }
 
-Configuration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf,
-        Weight weight, Any transformator, double tolerance, long numberOfIterations, int showProgress, double *stress) {
+/*
+	The Moore-Penrose inverse of V (eq. 8.19).
+	V is row and column centered and therefore: rank(V) <= nPoints-1; V^-1 does not exist.
+	For equal weights w, V = w (n I - 1 1') and V+ = (I - 1 1' / n) / (n w), which spares an SVD.
+*/
+static void smacof_vplus (Weight weight, double **vplus) {
+	long nPoints = weight -> numberOfRows;
+	double **w = weight -> data, w0 = nPoints > 1 ? w[1][2] : 0;
+	bool equalWeights = w0 > 0;
+	for (long i = 1; i <= nPoints && equalWeights; i++) {
+		for (long j = 1; j <= nPoints; j++) {
+			if (i != j && w[i][j] != w0) {
+				equalWeights = false;
+				break;
+			}
+		}
+	}
+	if (equalWeights) {
+		double offDiagonal = -1.0 / (nPoints * nPoints * w0), diagonal = (nPoints - 1.0) / (nPoints * nPoints * w0);
+		for (long i = 1; i <= nPoints; i++) {
+			for (long j = 1; j <= nPoints; j++) {
+				vplus[i][j] = i == j ? diagonal : offDiagonal;
+			}
+		}
+		return;
+	}
+	double tol = 1e-6;
+	autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
+	for (long i = 1; i <= nPoints; i++) {
+		double wsum = 0;
+		for (long j = 1; j <= nPoints; j++) {
+			if (i == j) {
+				continue;
+			}
+			v[i][j] = - w[i][j];
+			wsum += w[i][j];
+		}
+		v[i][i] = wsum;
+	}
+	NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus, tol);
+}
+
+static Configuration Dissimilarity_Configuration_Weight_Transformator_smacof_vplus (Dissimilarity me, Configuration conf,
+        Weight weight, Transformator t, double **vplus, double tolerance, long numberOfIterations, int showProgress, double *stress) {
 	try {
-		Transformator t = (Transformator) transformator;
 		long nPoints = conf -> numberOfRows;
 		long nDimensions = conf -> numberOfColumns;
-		double tol = 1e-6, stressp = 1e38;
-		bool no_weight = weight == 0;
+		double stressp = 1e38;
 
-		if (my numberOfRows != nPoints || (!no_weight && weight -> numberOfRows != nPoints) ||
-		        t -> numberOfPoints != nPoints) {
-			Melder_throw ("Dimensions not in concordance.");
-		}
-		autoWeight aw = 0;
-		if (no_weight) {
-			aw.reset (Weight_create (nPoints));
-			weight = aw.peek();
-		}
-		autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
-		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		autoNUMmatrix<double> bz (1, nPoints, 1, nDimensions);
 		autoConfiguration z = Data_copy (conf);
 		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
 
-		double **w = weight -> data;
+		/*
+			At the start of each iteration conf and z are equal,
+			so the distances of conf serve for the transformation and for B(Z).
+		*/
+		autoDistance dist = Configuration_to_Distance (conf);
+		autoDistance cdist = Data_copy (dist.peek());
 
 		if (showProgress) {
 			Melder_progress (0.0, L"MDS analysis");
 		}
 
-		// Get V (eq. 8.19).
-
-		for (long i = 1; i <= nPoints; i++) {
-			double wsum = 0;
-			for (long j = 1; j <= nPoints; j++) {
-				if (i == j) {
-					continue;
-				}
-				v[i][j] = - w[i][j];
-				wsum += w[i][j];
-			}
-			v[i][i] = wsum;
-		}
-
-		// V is row and column centered and therefore: rank(V) <= nPoints-1.
-		// V^-1 does not exist -> get Moore-Penrose inverse.
-
-		NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus.peek(), tol);
 		for (long iter = 1; iter <= numberOfIterations; iter++) {
-			autoDistance dist = Configuration_to_Distance (conf);
 
 			// transform & normalization
 
@@ -1986,11 +2119,11 @@ Configuration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimila
 
 			// Make conf the Guttman transform of z
 
-			smacof_guttmanTransform (conf, z.peek(), fit.peek(), weight, vplus.peek());
+			smacof_guttmanTransform (conf, z.peek(), fit.peek(), weight, dist.peek(), vplus, bz.peek());
 
 			// Compute stress
 
-			autoDistance cdist = Configuration_to_Distance (conf);
+			Configuration_into_Distance (conf, cdist.peek());
 
 			*stress = Distance_Weight_stress (fit.peek(), cdist.peek(), weight, MDS_NORMALIZED_STRESS);
 
@@ -2003,6 +2136,7 @@ Configuration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimila
 			// Make Z = X
 
 			NUMmatrix_copyElements (conf -> data, z -> data, 1, nPoints, 1, nDimensions);
+			NUMmatrix_copyElements (cdist -> data, dist -> data, 1, nPoints, 1, nPoints);
 
 			stressp = *stress;
 			if (showProgress) {
@@ -2018,17 +2152,62 @@ Configuration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimila
 		if (showProgress) {
 			Melder_progress (1.0, 0);
 		}
+		throw;
+	}
+}
+
+static void Dissimilarity_Configuration_Weight_Transformator_checkDimensions (Dissimilarity me, Configuration conf, Weight weight, Transformator t) {
+	long nPoints = conf -> numberOfRows;
+	if (my numberOfRows != nPoints || (weight && weight -> numberOfRows != nPoints) || t -> numberOfPoints != nPoints) {
+		Melder_throw ("Dimensions not in concordance.");
+	}
+}
+
+Configuration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf,
+        Weight weight, Any transformator, double tolerance, long numberOfIterations, int showProgress, double *stress) {
+	try {
+		Transformator t = (Transformator) transformator;
+		long nPoints = conf -> numberOfRows;
+
+		Dissimilarity_Configuration_Weight_Transformator_checkDimensions (me, conf, weight, t);
+		autoWeight aw = 0;
+		if (weight == 0) {
+			aw.reset (Weight_create (nPoints));
+			weight = aw.peek();
+		}
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		smacof_vplus (weight, vplus.peek());
+		autoConfiguration z = Dissimilarity_Configuration_Weight_Transformator_smacof_vplus (me, conf, weight, t,
+		                      vplus.peek(), tolerance, numberOfIterations, showProgress, stress);
+		return z.transfer();
+	} catch (MelderError) {
 		Melder_throw (me, ": no improved Configuration created (smacof method).");
 	}
 }
 
+/*
+	The repetitions share V+, which only depends on the weights.
+	The random starting configurations are drawn in the order of the repetitions and on ties in stress
+	the earliest repetition wins, so the result only depends on the state of the random generator.
+*/
 Configuration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf,
         Weight w, Any transformator, double tolerance, long numberOfIterations, long numberOfRepetitions, int showProgress) {
 	int showMulti = showProgress && numberOfRepetitions > 1;
 	try {
+		Transformator t = (Transformator) transformator;
 		int showSingle = showProgress && numberOfRepetitions == 1;
+		long nPoints = conf -> numberOfRows;
 		double stress, stressmax = 1e38;
 
+		Dissimilarity_Configuration_Weight_Transformator_checkDimensions (me, conf, w, t);
+		autoWeight aw = 0;
+		if (w == 0) {
+			aw.reset (Weight_create (nPoints));
+			w = aw.peek();
+		}
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		smacof_vplus (w, vplus.peek());
+
 		autoConfiguration cstart = Data_copy (conf);
 		autoConfiguration  cbest = Data_copy (conf);
 
@@ -2037,8 +2216,8 @@ Configuration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Diss
 		}
 
 		for (long i = 1; i <= numberOfRepetitions; i++) {
-			autoConfiguration cresult = Dissimilarity_Configuration_Weight_Transformator_smacof
-			                            (me, cstart.peek(), w, transformator, tolerance, numberOfIterations, showSingle, &stress);
+			autoConfiguration cresult = Dissimilarity_Configuration_Weight_Transformator_smacof_vplus
+			                            (me, cstart.peek(), w, t, vplus.peek(), tolerance, numberOfIterations, showSingle, &stress);
 			if (stress < stressmax) {
 				stressmax = stress;
 				cbest.reset (cresult.transfer());
@@ -2272,7 +2451,8 @@ static double func (Data object, const double p[]) {
 		double g1 = stress * ( (dist->data[ii][jj] - fit->data[ii][jj]) / s - (dist->data[ii][jj] - dbar) / t);
 		for (long j = 1; j <= numberOfDimensions; j++) {
 			double dj = x[ii][j] - x[jj][j];
-			double g2 = g1 * pow (fabs (dj) / dist->data[ii][jj], metric - 1);
+			double ratio = fabs (dj) / dist->data[ii][jj];
+			double g2 = g1 * (metric == 2 ? ratio : pow (ratio, metric - 1));
 			if (dj < 0) {
 				g2 = -g2;
 			}
@@ -2502,6 +2682,40 @@ Configuration Dissimilarity_Configuration_kruskal (Dissimilarity me, Configurati
 	Journal of Classification 10, 115-124.
 */
 
+struct indscal_Closure {
+	ScalarProducts zc;
+	Collection sprc;
+	double **x, **w, **wsih;
+	long h, nPoints, nSources, nDimensions;
+};
+
+// row k of the S[i][h] matrices (eq. 6) and of the weighted S matrix (eq. 8)
+
+static void indscal_sih_row (void *closure, long k) {
+	indscal_Closure *c = (indscal_Closure *) closure;
+	double **x = c -> x, **w = c -> w, *xk = x[k], *wsihk = c -> wsih[k];
+	long nPoints = c -> nPoints, h = c -> h;
+	for (long l = 1; l <= nPoints; l++) {
+		wsihk[l] = 0;
+	}
+	for (long i = 1; i <= c -> nSources; i++) {
+		double *zik = ((ScalarProduct) c -> zc -> item[i]) -> data[k];
+		double *sihk = ((ScalarProduct) c -> sprc -> item[i]) -> data[k];
+		double *wi = w[i];
+		for (long l = 1; l <= nPoints; l++) {
+			double s = zik[l], *xl = x[l];
+			for (long j = 1; j <= c -> nDimensions; j++) {
+				if (j == h) {
+					continue;
+				}
+				s -= xk[j] * xl[j] * wi[j];
+			}
+			sihk[l] = s;
+			wsihk[l] += wi[h] * s;
+		}
+	}
+}
+
 static void indscal_iteration_tenBerge (ScalarProducts zc, Configuration xc, Salience weights) {
 	long nPoints = xc -> numberOfRows, nDimensions = xc -> numberOfColumns;
 	long nSources = zc -> size;
@@ -2512,40 +2726,24 @@ static void indscal_iteration_tenBerge (ScalarProducts zc, Configuration xc, Sal
 	double tolerance = 1e-4;
 	autoNUMmatrix<double> wsih (1, nPoints, 1, nPoints);
 	autoNUMvector<double> solution (1, nPoints);
+	autoCollection sprc = Data_copy ( (Collection) zc);
+
+	indscal_Closure closure;
+	closure.zc = zc;
+	closure.sprc = sprc.peek();
+	closure.x = x;
+	closure.w = w;
+	closure.wsih = wsih.peek();
+	closure.nPoints = nPoints;
+	closure.nSources = nSources;
+	closure.nDimensions = nDimensions;
 
 	for (long h = 1; h <= nDimensions; h++) {
-		autoCollection sprc = Data_copy ( (Collection) zc);
-		for (long k = 1; k <= nPoints; k++) {
-			for (long l = 1; l <= nPoints; l++) {
-				wsih[k][l] = 0;
-			}
-		}
-
-		for (long i = 1; i <= nSources; i++) {
-			ScalarProduct spr = (ScalarProduct) sprc -> item[i];
-			double **sih = spr -> data;
-
-			// Construct the S[i][h] matrices (eq. 6)
-
-			for (long j = 1; j <= nDimensions; j++) {
-				if (j == h) {
-					continue;
-				}
-				for (long k = 1; k <= nPoints; k++) {
-					for (long l = 1; l <= nPoints; l++) {
-						sih[k][l] -= x[k][j] * x[l][j] * w[i][j];
-					}
-				}
-			}
 
-			// the weighted S matrix (eq. 8)
+		// Construct the S[i][h] matrices (eq. 6) and the weighted S matrix (eq. 8)
 
-			for (long k = 1; k <= nPoints; k++) {
-				for (long l = 1; l <= nPoints; l++) {
-					wsih[k][l] += w[i][h] * sih[k][l];
-				}
-			}
-		}
+		closure.h = h;
+		MDS_forEachRow (nPoints, indscal_sih_row, & closure);
 
 		// largest eigenvalue of m (nonsymmetric matrix!!) is optimal solution for this dimension
 
@@ -61,6 +61,7 @@
 #include "SSCP.h"
 #include "Eigen.h"
 #include "NUMclapack.h"
+#include "NUMcblas.h"
 #include "NUMlapack.h"
 #include "NUM2.h"
 #include "SVD.h"
@@ -553,14 +554,13 @@ SSCP TableOfReal_to_SSCP (I, long rowb, long rowe, long colb, long cole) {
 		SSCP_setNumberOfObservations (thee.peek(), m);
 
 		// sum of squares and cross products = T'T
+		// v is the column-major n x m matrix T', so T'T is a symmetric rank-m update (upper part in column-major order)
 
+		double alpha = 1.0, beta = 0.0;
+		(void) NUMblas_dsyrk ("U", "N", &n, &m, &alpha, &v[1][1], &n, &beta, &thy data[1][1], &n);
 		for (long i = 1; i <= n; i++) {
-			for (long j = i; j <= n; j++) {
-				double t = 0;
-				for (long k = 1; k <= m; k++) {
-					t += v[k][i] * v[k][j];
-				}
-				thy data[i][j] = thy data[j][i] = t;
+			for (long j = i + 1; j <= n; j++) {
+				thy data[i][j] = thy data[j][i];
 			}
 		}
 		for (long j = 1; j <= n; j++) {
@@ -612,8 +612,15 @@ TableOfReal Covariance_and_TableOfReal_mahalanobis (Covariance me, thou, bool us
 			}
 		}
 
+		autoNUMvector<double **> linv (1, 1);
+		autoNUMvector<long> nr (1, 1);
+		autoNUMvector<double *> m (1, 1);
+		linv[1] = covari.peek();
+		nr[1] = my numberOfRows;
+		m[1] = centroid.peek();
+		NUMmahalanobisDistances_chi (linv.peek(), nr.peek(), m.peek(), 1, my numberOfRows, thy data, thy numberOfRows, his data);
 		for (long k = 1; k <= thy numberOfRows; k++) {
-			his data[k][1] = sqrt (NUMmahalanobisDistance_chi (covari.peek(), thy data[k], centroid.peek(), my numberOfRows, my numberOfRows));
+			his data[k][1] = sqrt (his data[k][1]);
 			if (thy rowLabels[k] != 0) {
 				TableOfReal_setRowLabel (him.peek(), k, thy rowLabels[k]);
 			}
@@ -24,6 +24,7 @@
 
 #include "Sound_to_SPINET.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 static double fgamma (double x, long n) {
 	double x2p1 = 1 + x * x, d = x2p1;
@@ -33,6 +34,76 @@ static double fgamma (double x, long n) {
 	return 1 / d;
 }
 
+/*
+	The gammatone of filter i is applied as a recursive filter (NUMgammatone) whose response equals
+	the convolution with Sound_createGammaTone (0, 0.1, samplingFrequency, gamma, 1.02, f[i], 0, 0, 0)
+	(note the order of frequency and bandwidth); filters are divided among threads,
+	and every thread has its own filter output and frame.
+*/
+Thing_define (SPINET_filter_Args, Thing) { public:
+	Sound sound, window, filtered, frame;
+	SPINET spinet;
+	double windowDuration, b, *f, *bw;
+	bool isMainThread;
+	volatile long *next, *numberDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (SPINET_filter_Args, Thing, 0);
+
+MelderThread_MUTEX (spinetMutex);
+static bool spinetMutex_inited;
+
+static MelderThread_RETURN_TYPE SPINET_filter (SPINET_filter_Args me) {
+	Sound sound = my sound, filtered = my filtered, frame = my frame;
+	SPINET thee = my spinet;
+	const long nFilters = thy ny, numberOfFrames = thy nx;
+	const long numberOfTaps = filtered -> nx - sound -> nx + 1;
+	const double samplingFrequency = 1 / sound -> dx;
+	for (;;) {
+		MelderThread_LOCK (spinetMutex);
+		long i = ++ *my next;
+		MelderThread_UNLOCK (spinetMutex);
+		if (i > nFilters || *my cancelled) break;
+		double bb = (my f[i] / 1000) * exp (- my f[i] / 1000); // outer & middle ear and phase locking
+		double tgammaMax = (thy gamma - 1) / my bw[i]; // Time where gammafunction envelope has maximum
+		double gammaMaxAmplitude = pow ( (thy gamma - 1) / (NUMe * my bw[i]), (thy gamma - 1)); // tgammaMax
+		double timeCorrection = tgammaMax - my windowDuration / 2;
+
+		structNUMgammatone gammaTone;
+		NUMgammatone_init (& gammaTone, thy gamma, 1.0, NUM2pi * my f[i], my b, 0.0, numberOfTaps, samplingFrequency);
+		if (Melder_debug == 48) {   // the convolution as a check; only on the main thread, because this can throw
+			autoSound gammaToneSound = Sound_createGammaTone (0, 0.1, samplingFrequency, thy gamma, my b, my f[i], 0, 0, 0);
+			autoSound convolved = Sounds_convolve (sound, gammaToneSound.peek(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
+			Melder_assert (convolved -> nx == filtered -> nx);
+			NUMvector_copyElements (convolved -> z[1], filtered -> z[1], 1, filtered -> nx);
+		} else {
+			NUMgammatone_filter (& gammaTone, sound -> z[1], sound -> nx, filtered -> z[1], filtered -> nx);
+		}
+
+		// To energy measure: weigh with broad-band transfer function
+
+		for (long j = 1; j <= numberOfFrames; j++) {
+			Sound_into_Sound (filtered, frame, Sampled_indexToX (thee, j) + timeCorrection);
+			Sounds_multiply (frame, my window);
+			thy y[i][j] = Sound_power (frame) * bb / gammaMaxAmplitude;
+		}
+		MelderThread_LOCK (spinetMutex);
+		long numberOfFiltersDone = ++ *my numberDone;
+		MelderThread_UNLOCK (spinetMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress ( (double) numberOfFiltersDone / nFilters, L"SPINET: filter ", Melder_integer (numberOfFiltersDone), L" from ",
+				                   Melder_integer (nFilters), L".");
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
 /*
 	precondition:
 	0 < minimumFrequencyHz < maximumFrequencyHz
@@ -56,7 +127,6 @@ SPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration,
 		autoSPINET thee = SPINET_create (my xmin, my xmax, numberOfFrames, timeStep, firstTime,
 		                                 minimumFrequencyHz, maximumFrequencyHz, nFilters, excitationErbProportion, inhibitionErbProportion);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		autoSound frame = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoNUMvector<double> f (1, nFilters);
 		autoNUMvector<double> bw (1, nFilters);
 		autoNUMvector<double> aex (1, nFilters);
@@ -71,26 +141,36 @@ SPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration,
 
 		autoMelderProgress progress (L"SPINET analysis");
 
-		for (long i = 1; i <= nFilters; i++) {
-			double bb = (f[i] / 1000) * exp (- f[i] / 1000); // outer & middle ear and phase locking
-			double tgammaMax = (thy gamma - 1) / bw[i]; // Time where gammafunction envelope has maximum
-			double gammaMaxAmplitude = pow ( (thy gamma - 1) / (NUMe * bw[i]), (thy gamma - 1)); // tgammaMax
-			double timeCorrection = tgammaMax - windowDuration / 2;
-
-			autoSound gammaTone = Sound_createGammaTone (0, 0.1, samplingFrequency,
-			                      thy gamma, b, f[i], 0, 0, 0);
-			autoSound filtered = Sounds_convolve (me, gammaTone.peek(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
-
-			// To energy measure: weigh with broad-band transfer function
-
-			for (long j = 1; j <= numberOfFrames; j++) {
-				Sound_into_Sound (filtered.peek(), frame.peek(), Sampled_indexToX (thee.peek(), j) + timeCorrection);
-				Sounds_multiply (frame.peek(), window.peek());
-				thy y[i][j] = Sound_power (frame.peek()) * bb / gammaMaxAmplitude;
-			}
-			Melder_progress ( (double) i / nFilters, L"SPINET: filter ", Melder_integer (i), L" from ",
-			                   Melder_integer (nFilters), L".");
+		long numberOfTaps = floor (0.1 * samplingFrequency + 0.5);   // as in Sound_createGammaTone (0, 0.1, ...)
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > nFilters) numberOfThreads = nFilters;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1 || Melder_debug == 48) numberOfThreads = 1;
+		if (! spinetMutex_inited) { MelderThread_MUTEX_INIT (spinetMutex); spinetMutex_inited = true; }
+		autoSound filtered [16], frame [16];
+		autoSPINET_filter_Args args [16];
+		volatile long next = 0, numberDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			filtered [ithread - 1].reset (Sound_create (1, my xmin, my xmax + 0.1, my nx + numberOfTaps - 1, my dx, my x1 + 0.5 / samplingFrequency));
+			frame [ithread - 1].reset (Sound_createSimple (1, windowDuration, samplingFrequency));
+			autoSPINET_filter_Args arg = Thing_new (SPINET_filter_Args);
+			arg -> sound = me;
+			arg -> window = window.peek();
+			arg -> filtered = filtered [ithread - 1].peek();
+			arg -> frame = frame [ithread - 1].peek();
+			arg -> spinet = thee.peek();
+			arg -> windowDuration = windowDuration;
+			arg -> b = b;
+			arg -> f = f.peek();
+			arg -> bw = bw.peek();
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> next = & next;
+			arg -> numberDone = & numberDone;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
 		}
+		MelderThread_run (SPINET_filter, args, numberOfThreads);
 
 		// Excitatory and inhibitory area functions
 
@@ -102,16 +182,22 @@ SPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration,
 			}
 		}
 
-		// On-center off-surround interactions
+		// On-center off-surround interactions; the weights do not depend on the frame
 
+		autoNUMmatrix<double> weight (1, nFilters, 1, nFilters);
+		for (long i = 1; i <= nFilters; i++) {
+			for (long k = 1; k <= nFilters; k++) {
+				double fr = (f[k] - f[i]) / bw[i];
+				double hexsq = fgamma (fr / thy excitationErbProportion, thy gamma);
+				double hinsq = fgamma (fr / thy inhibitionErbProportion, thy gamma);
+				weight[i][k] = hexsq / aex[i] - hinsq / ain[i];
+			}
+		}
 		for (long j = 1; j <= numberOfFrames; j++)
 			for (long i = 1; i <= nFilters; i++) {
 				double a = 0;
 				for (long k = 1; k <= nFilters; k++) {
-					double fr = (f[k] - f[i]) / bw[i];
-					double hexsq = fgamma (fr / thy excitationErbProportion, thy gamma);
-					double hinsq = fgamma (fr / thy inhibitionErbProportion, thy gamma);
-					a += thy y[k][j] * (hexsq / aex[i] - hinsq / ain[i]);
+					a += thy y[k][j] * weight[i][k];
 				}
 				thy s[i][j] = a > 0 ? a : 0;
 			}
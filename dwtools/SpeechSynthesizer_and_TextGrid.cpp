@@ -702,8 +702,7 @@ Table IntervalTiers_to_Table_textAlignmentment (IntervalTier target, IntervalTie
 		autoStrings sources = IntervalTier_to_Strings_withOriginData (source, sourceOrigin.peek());
 		autoEditDistanceTable edit = EditDistanceTable_create (targets.peek(), sources.peek());
 		if (costs != 0) {
-			EditDistanceTable_setEditCosts (edit.peek(), costs);
-			EditDistanceTable_findPath (edit.peek(), NULL);
+			EditDistanceTable_setEditCosts (edit.peek(), costs);   // also finds the new path
 		}
 		long pathLength = edit -> warpingPath -> pathLength;
 		autoTable thee = Table_createWithColumnNames (pathLength - 1, L"targetInterval targetText targetStart targetEnd sourceInterval sourceText sourceStart sourceEnd operation");
@@ -377,6 +377,39 @@ NORMAL (L"We calculate the @@Procrustes transform@ that transforms the second "
 	"object as closely as possible.")
 MAN_END
 
+MAN_BEGIN (L"Configurations: To Table (Procrustes)...", L"djmw", 20150612)
+INTRO (L"A command that fits each of the selected @Configuration objects except the first "
+	"to the first, by means of a @@Procrustes transform@, and creates a @Table with the results.")
+ENTRY (L"Setting")
+TAG (L"##Orthogonal transform")
+DEFINITION (L"determines whether or not a translation and a scaling are allowed in the transform.")
+ENTRY (L"The Table")
+NORMAL (L"Every fitted Configuration gives one row, with its name, the scale %s, the translation ##t1#...##t%k#, "
+	"the rotation matrix ##r1_1#...##r%k_%k# (row by row), the residual sum of squares between the target and "
+	"the transformed Configuration, and this sum divided by the sum of squares of the target "
+	"(about its centroid, or about the origin for an orthogonal transform).")
+NORMAL (L"The fits are the same as those of @@Configuration & Configuration: To Procrustes...@, "
+	"but they are computed for many configurations at once, divided over the available processors.")
+MAN_END
+
+MAN_BEGIN (L"Configurations: To Table (generalized Procrustes)...", L"djmw", 20150612)
+INTRO (L"A command that fits all selected @Configuration objects to a common consensus configuration, "
+	"and creates a @Table with the results and a Configuration with the consensus.")
+ENTRY (L"Settings")
+TAG (L"##Orthogonal transform")
+DEFINITION (L"determines whether or not a translation and a scaling are allowed in the transforms.")
+TAG (L"##Maximum number of iterations#, ##Tolerance")
+DEFINITION (L"determine when the iteration stops: after the maximum number of iterations, or when the "
+	"total residual sum of squares decreases by less than %tolerance times itself.")
+ENTRY (L"Algorithm")
+NORMAL (L"The consensus starts as the first selected Configuration (centred, unless the transform is orthogonal). "
+	"In every iteration, all Configurations are fitted to the consensus with a @@Procrustes transform@, "
+	"and the consensus is replaced by the mean of the fitted Configurations, "
+	"rescaled to the size of the first consensus.")
+NORMAL (L"The Table has the fits of the original Configurations to the final consensus, "
+	"with the same columns as in @@Configurations: To Table (Procrustes)...@.")
+MAN_END
+
 MAN_BEGIN (L"Confusion: To Dissimilarity...", L"djmw", 20040407)
 INTRO (L"A command that creates a @Dissimilarity from every selected "
 	"@Confusion.")
@@ -66,6 +66,7 @@
 
 #include "praat.h"
 #include "NUM2.h"
+#include "NUMcblas.h"
 #include "NUMlapack.h"
 #include "NUMmachar.h"
 
@@ -5243,6 +5244,11 @@ DIRECT (Praat_ReportFloatingPointProperties)
 	MelderInfo_close ();
 END
 
+DIRECT (Praat_testBlasKernels)
+	NUMblas_testBlockedKernels ();
+	Melder_information (L"The BLAS kernels give the same results as plain sums.");
+END
+
 FORM (Praat_getTukeyQ, L"Get TukeyQ", 0)
 	REAL (L"Critical value", L"2.0")
 	NATURAL (L"Number of means", L"3")
@@ -6606,6 +6612,35 @@ DIRECT (Strings_to_EditDistanceTable)
 	praat_new (table.transfer(), s1 -> name, L"_", s2 -> name);
 END
 
+FORM (Strings_to_Table_editDistances, L"Strings: To Table (edit distances)", 0)
+	SENTENCE (L"Query", L"h E l @U")
+	OPTIONMENU (L"Symbols", 1)
+	OPTION (L"separated by spaces")
+	OPTION (L"characters")
+	REAL (L"Maximum distance", L"0.0 (=all)")
+	OK
+DO
+	LOOP {
+		iam (Strings);
+		praat_new (Strings_to_Table_editDistances (me, GET_STRING (L"Query"), GET_INTEGER (L"Symbols") == 2, NULL,
+			GET_REAL (L"Maximum distance")), my name, L"_distances");
+	}
+END
+
+FORM (Strings_and_EditCostsTable_to_Table_editDistances, L"Strings & EditCostsTable: To Table (edit distances)", 0)
+	SENTENCE (L"Query", L"h E l @U")
+	OPTIONMENU (L"Symbols", 1)
+	OPTION (L"separated by spaces")
+	OPTION (L"characters")
+	REAL (L"Maximum distance", L"0.0 (=all)")
+	OK
+DO
+	Strings me = FIRST (Strings);
+	EditCostsTable costs = FIRST (EditCostsTable);
+	praat_new (Strings_to_Table_editDistances (me, GET_STRING (L"Query"), GET_INTEGER (L"Symbols") == 2, costs,
+		GET_REAL (L"Maximum distance")), my name, L"_distances");
+END
+
 FORM (Strings_to_Permutation, L"Strings: To Permutation", L"Strings: To Permutation...")
 	BOOLEAN (L"Sort", 1)
 	OK
@@ -8075,6 +8110,7 @@ void praat_uvafon_David_init () {
 	espeakdata_praat_init ();
 
 	praat_addMenuCommand (L"Objects", L"Technical", L"Report floating point properties", L"Report integer properties", 0, DO_Praat_ReportFloatingPointProperties);
+	praat_addMenuCommand (L"Objects", L"Technical", L"Test BLAS kernels", L"Report floating point properties", praat_HIDDEN, DO_Praat_testBlasKernels);
 	praat_addMenuCommand (L"Objects", L"Goodies", L"Get TukeyQ...", 0, praat_HIDDEN, DO_Praat_getTukeyQ);
 	praat_addMenuCommand (L"Objects", L"Goodies", L"Get invTukeyQ...", 0, praat_HIDDEN, DO_Praat_getInvTukeyQ);
 	praat_addMenuCommand (L"Objects", L"New", L"Create Strings from espeak voices", L"Create Strings as directory list...", praat_DEPTH_1 + praat_HIDDEN, DO_Strings_createFromEspeakVoices);
@@ -8749,6 +8785,7 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classStrings, 0, L"Extract part...", L"Replace all...", 0, DO_Strings_extractPart);
 	praat_addAction1 (classStrings, 0, L"To Permutation...", L"To Distributions", 0, DO_Strings_to_Permutation);
 	praat_addAction1 (classStrings, 2, L"To EditDistanceTable", L"To Distributions", 0, DO_Strings_to_EditDistanceTable);
+	praat_addAction1 (classStrings, 0, L"To Table (edit distances)...", L"To EditDistanceTable", 0, DO_Strings_to_Table_editDistances);
 
 	praat_addAction1 (classSVD, 0, L"To TableOfReal...", 0, 0, DO_SVD_to_TableOfReal);
 	praat_addAction1 (classSVD, 0, L"Extract left singular vectors", 0, 0, DO_SVD_extractLeftSingularVectors);
@@ -8831,6 +8868,7 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classTableOfReal, 1, L"Draw column as distribution...", L"Draw rows as histogram...", praat_DEPTH_1, DO_TableOfReal_drawColumnAsDistribution);
 
 	praat_addAction2 (classStrings, 1, classPermutation, 1, L"Permute strings", 0, 0, DO_Strings_and_Permutation_permuteStrings);
+	praat_addAction2 (classStrings, 1, classEditCostsTable, 1, L"To Table (edit distances)...", 0, 0, DO_Strings_and_EditCostsTable_to_Table_editDistances);
 
 	praat_addAction2 (classTableOfReal, 1, classPermutation, 1, L"Permute rows",	0, 0, DO_TableOfReal_and_Permutation_permuteRows);
 
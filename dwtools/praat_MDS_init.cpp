@@ -429,6 +429,34 @@ DO
 		Thing_getName (c2), L"_to_", Thing_getName (c1));
 END
 
+FORM (Configurations_to_Table_procrustes, L"Configurations: To Table (Procrustes)", L"Configurations: To Table (Procrustes)...")
+	BOOLEAN (L"Orthogonal transform", 0)
+	OK
+DO
+	autoConfigurations set = (Configurations) praat_getSelectedObjects ();
+	if (set -> size < 2) {
+		Melder_throw ("Select a target Configuration and at least one other Configuration.");
+	}
+	Configuration target = (Configuration) set -> item [1];
+	praat_new (Configurations_to_Table_procrustes (target, set -> size - 1, (Configuration *) set -> item + 1,
+		GET_INTEGER (L"Orthogonal transform")), L"to_", Thing_getName (target));
+END
+
+FORM (Configurations_to_Table_generalizedProcrustes, L"Configurations: To Table (generalized Procrustes)", L"Configurations: To Table (generalized Procrustes)...")
+	BOOLEAN (L"Orthogonal transform", 0)
+	NATURAL (L"Maximum number of iterations", L"50")
+	POSITIVE (L"Tolerance", L"1e-6")
+	OK
+DO
+	autoConfigurations set = (Configurations) praat_getSelectedObjects ();
+	Configuration consensus = NULL;
+	autoTable thee = Configurations_to_Table_generalizedProcrustes (set -> size, (Configuration *) set -> item,
+		GET_INTEGER (L"Orthogonal transform"), GET_INTEGER (L"Maximum number of iterations"), GET_REAL (L"Tolerance"), & consensus);
+	autoConfiguration him = consensus;
+	praat_new (thee.transfer(), L"to_consensus");
+	praat_new (him.transfer(), L"consensus");
+END
+
 FORM (Configurations_to_AffineTransform_congruence, L"Configurations: To AffineTransform (congruence)", L"Configurations: To AffineTransform (congruence)...")
 	NATURAL (L"Maximum number of iterations", L"50")
 	POSITIVE (L"Tolerance", L"1e-6")
@@ -1735,6 +1763,8 @@ void praat_uvafon_MDS_init () {
 	praat_addAction1 (classConfiguration, 0, L"Match configurations -", 0, 0, 0);
 	praat_addAction1 (classConfiguration, 2, L"To Procrustes...", 0, 1, DO_Configurations_to_Procrustes);
 	praat_addAction1 (classConfiguration, 2, L"To AffineTransform (congruence)...", 0, 1, DO_Configurations_to_AffineTransform_congruence);
+	praat_addAction1 (classConfiguration, 0, L"To Table (Procrustes)...", 0, 1, DO_Configurations_to_Table_procrustes);
+	praat_addAction1 (classConfiguration, 0, L"To Table (generalized Procrustes)...", 0, 1, DO_Configurations_to_Table_generalizedProcrustes);
 
 	praat_addAction1 (classConfusion, 0, L"To ContingencyTable", L"To Matrix", 0, DO_Confusion_to_ContingencyTable);
 	praat_addAction1 (classConfusion, 0, L"To Proximity -", L"Analyse", 0, 0);
@@ -81,9 +81,10 @@ TableOfReal AmplitudeTier_downto_TableOfReal (AmplitudeTier me) {
 
 void Sound_AmplitudeTier_multiply_inline (Sound me, AmplitudeTier amplitude) {
 	if (amplitude -> points -> size == 0) return;
+	autoNUMvector <double> factors (1, my nx);
+	RealTier_getValuesAtRegularTimes (amplitude, my x1, my dx, my nx, factors.peek());
 	for (long isamp = 1; isamp <= my nx; isamp ++) {
-		double t = my x1 + (isamp - 1) * my dx;
-		double factor = RealTier_getValueAtTime (amplitude, t);
+		double factor = factors [isamp];
 		for (long channel = 1; channel <= my ny; channel ++) {
 			my z [channel] [isamp] *= factor;
 		}
@@ -134,7 +135,7 @@ static double Sound_getPeak (Sound me, double tmin, double tmax, long channel) {
 	return maximum - minimum;
 }
 */
-static double Sound_getHannWindowedRms (Sound me, double tmid, double widthLeft, double widthRight) {
+double Sound_getHannWindowedRms (Sound me, double tmid, double widthLeft, double widthRight) {
 	double sumOfSquares = 0.0, windowSumOfSquares = 0.0;
 	long imin, imax;
 	if (Sampled_getWindowSamples (me, tmid - widthLeft, tmid + widthRight, & imin, & imax) < 3) return NUMundefined;
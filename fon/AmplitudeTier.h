@@ -43,6 +43,7 @@ void Sound_AmplitudeTier_multiply_inline (Sound me, AmplitudeTier intensity);
 Sound Sound_AmplitudeTier_multiply (Sound me, AmplitudeTier intensity);
 
 AmplitudeTier PointProcess_Sound_to_AmplitudeTier_point (PointProcess me, Sound thee);
+double Sound_getHannWindowedRms (Sound me, double tmid, double widthLeft, double widthRight);
 AmplitudeTier PointProcess_Sound_to_AmplitudeTier_period (PointProcess me, Sound thee,
 	double tmin, double tmax, double shortestPeriod, double longestPeriod, double maximumPeriodFactor);
 double AmplitudeTier_getShimmer_local (AmplitudeTier me, double shortestPeriod, double longestPeriod, double maximumAmplitudeFactor);
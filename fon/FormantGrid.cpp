@@ -161,18 +161,18 @@ void FormantGrid_removeBandwidthPointsBetween (FormantGrid me, long iformant, do
 
 void Sound_FormantGrid_filter_inline (Sound me, FormantGrid formantGrid) {
 	double dt = my dx;
-	if (formantGrid -> formants -> size && formantGrid -> bandwidths -> size)
+	if (formantGrid -> formants -> size == 0 || formantGrid -> bandwidths -> size == 0) return;
+	autoNUMvector <double> formants (1, my nx), bandwidths (1, my nx);
 	for (long iformant = 1; iformant <= formantGrid -> formants -> size; iformant ++) {
 		RealTier formantTier = (RealTier) formantGrid -> formants -> item [iformant];
 		RealTier bandwidthTier = (RealTier) formantGrid -> bandwidths -> item [iformant];
+		RealTier_getValuesAtRegularTimes (formantTier, my x1, my dx, my nx, formants.peek());
+		RealTier_getValuesAtRegularTimes (bandwidthTier, my x1, my dx, my nx, bandwidths.peek());
 		for (long isamp = 1; isamp <= my nx; isamp ++) {
-			double t = my x1 + (isamp - 1) * my dx;
 			/*
 			 * Compute LP coefficients.
 			 */
-			double formant, bandwidth;
-			formant = RealTier_getValueAtTime (formantTier, t);
-			bandwidth = RealTier_getValueAtTime (bandwidthTier, t);
+			double formant = formants [isamp], bandwidth = bandwidths [isamp];
 			if (NUMdefined (formant) && NUMdefined (bandwidth)) {
 				double cosomdt = cos (2 * NUMpi * formant * dt);
 				double r = exp (- NUMpi * bandwidth * dt);
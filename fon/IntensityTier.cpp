@@ -100,9 +100,10 @@ TableOfReal IntensityTier_downto_TableOfReal (IntensityTier me) {
 
 void Sound_IntensityTier_multiply_inline (Sound me, IntensityTier intensity) {
 	if (intensity -> points -> size == 0) return;
+	autoNUMvector <double> values (1, my nx);
+	RealTier_getValuesAtRegularTimes (intensity, my x1, my dx, my nx, values.peek());
 	for (long isamp = 1; isamp <= my nx; isamp ++) {
-		double t = my x1 + (isamp - 1) * my dx;
-		double factor = pow (10, RealTier_getValueAtTime (intensity, t) / 20);
+		double factor = pow (10, values [isamp] / 20);
 		for (long channel = 1; channel <= my ny; channel ++) {
 			my z [channel] [isamp] *= factor;
 		}
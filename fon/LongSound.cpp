@@ -43,6 +43,7 @@
  */
 
 #include "LongSound.h"
+#include "NUM2.h"
 #include "Preferences.h"
 #include "flac_FLAC_stream_decoder.h"
 #include "mp3.h"
@@ -695,4 +696,95 @@ void LongSound_concatenate (Collection me, MelderFile file, int audioFileType, i
 	}
 }
 
+/*
+ * Chunked analysis.
+ */
+
+void LongSound_getAnalysisSampling (LongSound me, double samplingFrequency, long *numberOfSamples, double *samplingPeriod, double *firstTime) {
+	double upfactor = samplingFrequency * my dx;
+	if (samplingFrequency <= 0.0 || fabs (upfactor - 1) < 1e-6) {   // as in Sound_resample
+		*numberOfSamples = my nx, *samplingPeriod = my dx, *firstTime = my x1;
+	} else if (fabs (upfactor - 2) < 1e-6) {   // as in Sound_upsample
+		*numberOfSamples = my nx * 2, *samplingPeriod = my dx / 2, *firstTime = my x1 - my dx / 4;
+	} else {
+		*numberOfSamples = floor ((my xmax - my xmin) * samplingFrequency + 0.5);
+		if (*numberOfSamples < 1)
+			Melder_throw ("The resampled Sound would have no samples.");
+		*samplingPeriod = 1.0 / samplingFrequency;
+		*firstTime = 0.5 * (my xmin + my xmax - (*numberOfSamples - 1) / samplingFrequency);
+	}
+}
+
+/*
+ * Read the samples firstSample..lastSample of the LongSound, resampled to the sampling of 'part',
+ * into part -> z [channel] [firstSample..lastSample].
+ * The polyphase resampler only looks at nearby input samples,
+ * so the result does not depend on how the sound is divided into chunks.
+ */
+static void LongSound_readResampled (LongSound me, NUMresampler resampler, double *weights, Sound part, long firstSample, long lastSample) {
+	long imin, imax;
+	NUMresampler_getInputRange (resampler, firstSample, lastSample, & imin, & imax);
+	autoNUMmatrix <double> original (1, my numberOfChannels, imin, imax);
+	autoNUMvector <double *> rows (1, my numberOfChannels);
+	for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+		rows [channel] = & original [channel] [imin - 1];
+	}
+	LongSound_readAudioToFloat (me, rows.peek(), imin, imax - imin + 1);
+	for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+		NUMresampler_resample (resampler, original [channel], part -> z [channel], firstSample, lastSample, weights);
+	}
+}
+
+void LongSound_analyseInChunks (LongSound me, double samplingFrequency, Sampled frames, double margin,
+	void (*analyse) (void *closure, Sound part, long firstSample, long lastSample, long firstFrame, long lastFrame), void *closure)
+{
+	long numberOfSamples;
+	double samplingPeriod, firstTime;
+	LongSound_getAnalysisSampling (me, samplingFrequency, & numberOfSamples, & samplingPeriod, & firstTime);
+	bool resample = samplingPeriod != my dx;
+	autoNUMresampler resampler;
+	autoNUMvector <double> weights;
+	if (resample) {
+		NUMresampler_init (& resampler, my nx, my dx, my x1, numberOfSamples, samplingPeriod, firstTime, 50);
+		weights.reset (0, 2 * resampler.halfWidth - 1);
+	}
+	long framesPerChunk = LongSound_getBufferSizePref_seconds () / frames -> dx;
+	if (framesPerChunk < 1) framesPerChunk = 1;
+	/*
+	 * The part has the domain and sampling of the whole (resampled) sound,
+	 * but only the samples that are needed for the current chunk of frames.
+	 */
+	autoSound part = Thing_new (Sound);
+	part -> xmin = my xmin, part -> xmax = my xmax;
+	part -> nx = numberOfSamples, part -> dx = samplingPeriod, part -> x1 = firstTime;
+	part -> ymin = 1, part -> ymax = my numberOfChannels;
+	part -> ny = my numberOfChannels, part -> dy = 1, part -> y1 = 1;
+	autoNUMvector <double *> rows (1, my numberOfChannels);
+	for (long firstFrame = 1; firstFrame <= frames -> nx; firstFrame += framesPerChunk) {
+		long lastFrame = firstFrame + framesPerChunk - 1;
+		if (lastFrame > frames -> nx) lastFrame = frames -> nx;
+		long firstSample = floor ((Sampled_indexToX (frames, firstFrame) - margin - firstTime) / samplingPeriod + 1.0) - 2;
+		long lastSample = ceil ((Sampled_indexToX (frames, lastFrame) + margin - firstTime) / samplingPeriod + 1.0) + 2;
+		if (firstSample < 1) firstSample = 1;
+		if (lastSample > numberOfSamples) lastSample = numberOfSamples;
+		autoNUMmatrix <double> samples (1, my numberOfChannels, firstSample, lastSample);
+		part -> z = samples.peek();
+		try {
+			if (resample) {
+				LongSound_readResampled (me, & resampler, weights.peek(), part.peek(), firstSample, lastSample);
+			} else {
+				for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+					rows [channel] = & samples [channel] [firstSample - 1];
+				}
+				LongSound_readAudioToFloat (me, rows.peek(), firstSample, lastSample - firstSample + 1);
+			}
+			analyse (closure, part.peek(), firstSample, lastSample, firstFrame, lastFrame);
+		} catch (MelderError) {
+			part -> z = NULL;   // not ours
+			throw;
+		}
+		part -> z = NULL;
+	}
+}
+
 /* End of file LongSound.cpp */
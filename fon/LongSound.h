@@ -80,6 +80,26 @@ void LongSound_readAudioToShort (LongSound me, short *buffer, long firstSample,
 void LongSound_concatenate (Collection collection, MelderFile file, int audioFileType, int numberOfBitsPerSamplePoint);
 /* Concatenate a collection of Sound and LongSound objects. */
 
+void LongSound_getAnalysisSampling (LongSound me, double samplingFrequency, long *numberOfSamples, double *samplingPeriod, double *firstTime);
+/*
+	The sampling of the Sound that Sound_resample would make of the whole LongSound;
+	a samplingFrequency of 0.0 means the LongSound's own sampling.
+*/
+
+void LongSound_analyseInChunks (LongSound me, double samplingFrequency, Sampled frames, double margin,
+	void (*analyse) (void *closure, Sound part, long firstSample, long lastSample, long firstFrame, long lastFrame), void *closure);
+/*
+	Feeds the LongSound chunk by chunk to an analysis whose frames have the time sampling of 'frames'.
+	For every chunk of frames firstFrame..lastFrame, 'analyse' receives a Sound 'part'
+	with the domain, channels and (resampled) sampling of the whole LongSound, but of which only the samples
+	firstSample..lastSample are available; these include all samples within 'margin' seconds of the centres of the frames;
+	the sample numbers and times are those of the whole sound, so that the frames come out
+	identical to those of the same analysis on the whole sound in memory.
+	The number of frames per chunk is chosen so that the chunks are about as long as the LongSound buffer.
+	If the sound has to be resampled, this is done as by Sound_resample_polyphase with a precision of 50,
+	whose result does not depend on the chunks.
+*/
+
 void LongSound_preferences (void);
 long LongSound_getBufferSizePref_seconds (void);
 void LongSound_setBufferSizePref_seconds (long size);
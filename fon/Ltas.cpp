@@ -25,6 +25,8 @@
 #include "Ltas.h"
 #include "Sound_and_Spectrum.h"
 #include "Sound_to_PointProcess.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 Thing_implement (Ltas, Vector, 2);
 
@@ -304,6 +306,202 @@ Ltas Sound_to_Ltas (Sound me, double bandwidth) {
 	}
 }
 
+/*
+ * Pitch-synchronous spectra.
+ *
+ * Every period between two pulses is Fourier-transformed at its own length, exactly as
+ * Sound_extractPart (rectangular) followed by Sound_to_Spectrum (not fast) would do,
+ * but without creating a Sound and a Spectrum for each period.
+ * The periods are processed in blocks by several threads. Each thread owns a few FFT tables
+ * (neighbouring periods tend to have the same length) and its own energy accumulators.
+ * The blocks are dealt out to the threads in a fixed order and the accumulators are added up
+ * in thread order, so that the result does not depend on the timing of the threads.
+ */
+
+#define Ltas_PERIODS_PER_BLOCK  64
+#define Ltas_FFT_TABLES_PER_THREAD  4
+
+Thing_define (Ltas_periods_Args, Thing) { public:
+	Sound sound;
+	long numberOfPeriods, *firstSample, *numberOfSamples;
+	bool harmonics;
+	long numberOfBins;   // bands, or harmonics
+	double bandWidth;
+	int ithread, numberOfThreads;
+	autoNUMfft_Table fftTables [Ltas_FFT_TABLES_PER_THREAD];
+	long fftTableSizes [Ltas_FFT_TABLES_PER_THREAD], nextFftTable;
+	autoNUMvector <double> data, energies, numbers;
+	long totalNumberOfEnergies;
+	bool isMainThread;
+	volatile long *numberOfPeriodsDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (Ltas_periods_Args, Thing, 0);
+
+MelderThread_MUTEX (ltasMutex);
+static bool ltasMutex_inited;
+
+static NUMfft_Table Ltas_periods_Args_getFftTable (Ltas_periods_Args me, long numberOfSamples) {
+	for (int itable = 0; itable < Ltas_FFT_TABLES_PER_THREAD; itable ++)
+		if (my fftTableSizes [itable] == numberOfSamples)
+			return & my fftTables [itable];
+	int itable = my nextFftTable;
+	my nextFftTable = (my nextFftTable + 1) % Ltas_FFT_TABLES_PER_THREAD;
+	NUMfft_Table_reinit (& my fftTables [itable], numberOfSamples);
+	my fftTableSizes [itable] = numberOfSamples;
+	return & my fftTables [itable];
+}
+
+static MelderThread_RETURN_TYPE Ltas_periods_accumulate (Ltas_periods_Args me) {
+	Sound sound = my sound;
+	double *data = my data.peek(), *energies = my energies.peek(), *numbers = my numbers.peek();
+	long numberOfBlocks = (my numberOfPeriods - 1) / Ltas_PERIODS_PER_BLOCK + 1;
+	for (long iblock = my ithread; iblock <= numberOfBlocks; iblock += my numberOfThreads) {
+		if (*my cancelled) break;
+		long firstPeriod = (iblock - 1) * Ltas_PERIODS_PER_BLOCK + 1, lastPeriod = firstPeriod + Ltas_PERIODS_PER_BLOCK - 1;
+		if (lastPeriod > my numberOfPeriods) lastPeriod = my numberOfPeriods;
+		for (long iperiod = firstPeriod; iperiod <= lastPeriod; iperiod ++) {
+			long numberOfSamples = my numberOfSamples [iperiod], offset = my firstSample [iperiod] - 1;
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				long isamp = offset + i;
+				data [i] = isamp < 1 || isamp > sound -> nx ? 0.0 :
+					sound -> ny == 1 ? sound -> z [1] [isamp] : 0.5 * (sound -> z [1] [isamp] + sound -> z [2] [isamp]);
+			}
+			NUMfft_forward (Ltas_periods_Args_getFftTable (me, numberOfSamples), data);
+			/*
+			 * The energy in each frequency bin, as in Sound_to_Spectrum.
+			 */
+			long numberOfFrequencies = numberOfSamples / 2 + 1;
+			double scaling = sound -> dx, df = 1.0 / (sound -> dx * numberOfSamples);
+			long numberOfBinsToUse = my harmonics && my numberOfBins < numberOfFrequencies ? my numberOfBins : numberOfFrequencies;
+			for (long ifreq = 1; ifreq <= numberOfBinsToUse; ifreq ++) {
+				double realPart, imaginaryPart;
+				if (ifreq == 1) {
+					realPart = data [1] * scaling;
+					imaginaryPart = 0.0;
+				} else if (ifreq < numberOfFrequencies) {
+					realPart = data [ifreq + ifreq - 2] * scaling;
+					imaginaryPart = data [ifreq + ifreq - 1] * scaling;
+				} else if ((numberOfSamples & 1) != 0) {
+					realPart = data [numberOfSamples - 1] * scaling;
+					imaginaryPart = data [numberOfSamples] * scaling;
+				} else {
+					realPart = data [numberOfSamples] * scaling;
+					imaginaryPart = 0.0;
+				}
+				double energy = (realPart * realPart + imaginaryPart * imaginaryPart) * 2.0 * df;
+				if (my harmonics) {
+					energies [ifreq] += energy;
+				} else {
+					double frequency = (ifreq - 1) * df;
+					long iband = ceil (frequency / my bandWidth);
+					if (iband >= 1 && iband <= my numberOfBins) {
+						energies [iband] += energy;
+						numbers [iband] += 1;
+						my totalNumberOfEnergies += 1;
+					}
+				}
+			}
+		}
+		MelderThread_LOCK (ltasMutex);
+		long numberOfPeriodsDone = (*my numberOfPeriodsDone += lastPeriod - firstPeriod + 1);
+		MelderThread_UNLOCK (ltasMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress ((double) numberOfPeriodsDone / my numberOfPeriods, L"Sound & PointProcess: To Ltas: period ",
+					Melder_integer (numberOfPeriodsDone), L" out of ", Melder_integer (my numberOfPeriods));
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+/*
+ * Adds the energies of all the periods that satisfy the period criteria into energies [1..numberOfBins]
+ * (and, unless 'harmonics', their number per band into numbers [1..numberOfBins]).
+ * Returns the number of periods, which can be zero.
+ */
+static long PointProcess_Sound_accumulatePeriodEnergies (PointProcess pulses, Sound sound,
+	double shortestPeriod, double longestPeriod, double maximumPeriodFactor,
+	bool harmonics, long numberOfBins, double bandWidth,
+	double *energies, double *numbers, long *totalNumberOfEnergies)
+{
+	/*
+	 * Select the periods and find their sample ranges, as Sound_extractPart would.
+	 */
+	autoNUMvector <long> firstSample (1, pulses -> nt), numberOfSamples (1, pulses -> nt);
+	long numberOfPeriods = 0, maximumNumberOfSamples = 1;
+	for (long ipulse = 2; ipulse < pulses -> nt; ipulse ++) {
+		double leftInterval = pulses -> t [ipulse] - pulses -> t [ipulse - 1];
+		double rightInterval = pulses -> t [ipulse + 1] - pulses -> t [ipulse];
+		double intervalFactor = leftInterval > rightInterval ? leftInterval / rightInterval : rightInterval / leftInterval;
+		if (leftInterval >= shortestPeriod && leftInterval <= longestPeriod &&
+			rightInterval >= shortestPeriod && rightInterval <= longestPeriod &&
+			intervalFactor <= maximumPeriodFactor)
+		{
+			double t1 = pulses -> t [ipulse] - 0.5 * leftInterval, t2 = pulses -> t [ipulse] + 0.5 * rightInterval;
+			long ix1 = 1 + (long) ceil ((t1 - sound -> x1) / sound -> dx);
+			long ix2 = 1 + (long) floor ((t2 - sound -> x1) / sound -> dx);
+			if (ix2 < ix1)
+				Melder_throw ("The period around ", pulses -> t [ipulse], " seconds contains no samples.");
+			numberOfPeriods += 1;
+			firstSample [numberOfPeriods] = ix1;
+			numberOfSamples [numberOfPeriods] = ix2 - ix1 + 1;
+			if (numberOfSamples [numberOfPeriods] > maximumNumberOfSamples)
+				maximumNumberOfSamples = numberOfSamples [numberOfPeriods];
+		}
+	}
+	if (numberOfPeriods == 0) return 0;
+
+	long numberOfBlocks = (numberOfPeriods - 1) / Ltas_PERIODS_PER_BLOCK + 1;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! ltasMutex_inited) { MelderThread_MUTEX_INIT (ltasMutex); ltasMutex_inited = true; }
+	autoLtas_periods_Args args [16];
+	volatile long numberOfPeriodsDone = 0;
+	volatile int cancelled = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoLtas_periods_Args arg = Thing_new (Ltas_periods_Args);
+		arg -> sound = sound;
+		arg -> numberOfPeriods = numberOfPeriods;
+		arg -> firstSample = firstSample.peek();
+		arg -> numberOfSamples = numberOfSamples.peek();
+		arg -> harmonics = harmonics;
+		arg -> numberOfBins = numberOfBins;
+		arg -> bandWidth = bandWidth;
+		arg -> ithread = ithread;
+		arg -> numberOfThreads = numberOfThreads;
+		for (int itable = 0; itable < Ltas_FFT_TABLES_PER_THREAD; itable ++) {
+			NUMfft_Table_init (& arg -> fftTables [itable], maximumNumberOfSamples);   // room for every period
+			arg -> fftTableSizes [itable] = 0;
+		}
+		arg -> data.reset (1, maximumNumberOfSamples);
+		arg -> energies.reset (1, numberOfBins);
+		arg -> numbers.reset (1, numberOfBins);
+		arg -> isMainThread = ithread == numberOfThreads;
+		arg -> numberOfPeriodsDone = & numberOfPeriodsDone;
+		arg -> cancelled = & cancelled;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (Ltas_periods_accumulate, args, numberOfThreads);
+
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		Ltas_periods_Args arg = args [ithread - 1].peek();
+		for (long ibin = 1; ibin <= numberOfBins; ibin ++) {
+			energies [ibin] += arg -> energies [ibin];
+			if (numbers) numbers [ibin] += arg -> numbers [ibin];
+		}
+		if (totalNumberOfEnergies) *totalNumberOfEnergies += arg -> totalNumberOfEnergies;
+	}
+	return numberOfPeriods;
+}
+
 Ltas PointProcess_Sound_to_Ltas (PointProcess pulses, Sound sound,
 	double maximumFrequency, double bandWidth,
 	double shortestPeriod, double longestPeriod, double maximumPeriodFactor)
@@ -316,38 +514,9 @@ Ltas PointProcess_Sound_to_Ltas (PointProcess pulses, Sound sound,
 		if (numberOfPeriods < 1)
 			Melder_throw ("Cannot compute an Ltas if there are no periods in the point process.");
 		autoMelderProgress progress (L"Ltas analysis...");
-		for (long ipulse = 2; ipulse < pulses -> nt; ipulse ++) {
-			double leftInterval = pulses -> t [ipulse] - pulses -> t [ipulse - 1];
-			double rightInterval = pulses -> t [ipulse + 1] - pulses -> t [ipulse];
-			double intervalFactor = leftInterval > rightInterval ? leftInterval / rightInterval : rightInterval / leftInterval;
-			Melder_progress ((double) ipulse / pulses -> nt, L"Sound & PointProcess: To Ltas: pulse ", Melder_integer (ipulse), L" out of ", Melder_integer (pulses -> nt));
-			if (leftInterval >= shortestPeriod && leftInterval <= longestPeriod &&
-				rightInterval >= shortestPeriod && rightInterval <= longestPeriod &&
-				intervalFactor <= maximumPeriodFactor)
-			{
-				/*
-				 * We have a period! Compute the spectrum.
-				 */
-				autoSound period = Sound_extractPart (sound,
-					pulses -> t [ipulse] - 0.5 * leftInterval, pulses -> t [ipulse] + 0.5 * rightInterval,
-					kSound_windowShape_RECTANGULAR, 1.0, FALSE);
-				autoSpectrum spectrum = Sound_to_Spectrum (period.peek(), FALSE);
-				for (long ifreq = 1; ifreq <= spectrum -> nx; ifreq ++) {
-					double frequency = spectrum -> xmin + (ifreq - 1) * spectrum -> dx;
-					double realPart = spectrum -> z [1] [ifreq];
-					double imaginaryPart = spectrum -> z [2] [ifreq];
-					double energy = (realPart * realPart + imaginaryPart * imaginaryPart) * 2.0 * spectrum -> dx /* OLD: * sound -> nx */;
-					long iband = ceil (frequency / bandWidth);
-					if (iband >= 1 && iband <= ltas -> nx) {
-						ltas -> z [1] [iband] += energy;
-						numbers -> z [1] [iband] += 1;
-						totalNumberOfEnergies += 1;
-					}
-				}
-			} else {
-				numberOfPeriods -= 1;
-			}
-		}
+		numberOfPeriods = PointProcess_Sound_accumulatePeriodEnergies (pulses, sound,
+			shortestPeriod, longestPeriod, maximumPeriodFactor,
+			false, ltas -> nx, bandWidth, ltas -> z [1], numbers -> z [1], & totalNumberOfEnergies);
 		if (numberOfPeriods < 1)
 			Melder_throw ("There are no periods in the point process.");
 		for (long iband = 1; iband <= ltas -> nx; iband ++) {
@@ -428,34 +597,9 @@ Ltas PointProcess_Sound_to_Ltas_harmonics (PointProcess pulses, Sound sound,
 		if (numberOfPeriods < 1)
 			Melder_throw ("There are no periods in the point process.");
 		autoMelderProgress progress (L"LTAS (harmonics) analysis...");
-		for (long ipulse = 2; ipulse < pulses -> nt; ipulse ++) {
-			double leftInterval = pulses -> t [ipulse] - pulses -> t [ipulse - 1];
-			double rightInterval = pulses -> t [ipulse + 1] - pulses -> t [ipulse];
-			double intervalFactor = leftInterval > rightInterval ? leftInterval / rightInterval : rightInterval / leftInterval;
-			Melder_progress ((double) ipulse / pulses -> nt, L"Sound & PointProcess: To Ltas: pulse ", Melder_integer (ipulse), L" out of ", Melder_integer (pulses -> nt));
-			if (leftInterval >= shortestPeriod && leftInterval <= longestPeriod &&
-				rightInterval >= shortestPeriod && rightInterval <= longestPeriod &&
-				intervalFactor <= maximumPeriodFactor)
-			{
-				/*
-				 * We have a period! Compute the spectrum.
-				 */
-				long localMaximumHarmonic;
-				autoSound period = Sound_extractPart (sound,
-					pulses -> t [ipulse] - 0.5 * leftInterval, pulses -> t [ipulse] + 0.5 * rightInterval,
-					kSound_windowShape_RECTANGULAR, 1.0, FALSE);
-				autoSpectrum spectrum = Sound_to_Spectrum (period.peek(), FALSE);
-				localMaximumHarmonic = maximumHarmonic < spectrum -> nx ? maximumHarmonic : spectrum -> nx;
-				for (long iharm = 1; iharm <= localMaximumHarmonic; iharm ++) {
-					double realPart = spectrum -> z [1] [iharm];
-					double imaginaryPart = spectrum -> z [2] [iharm];
-					double energy = (realPart * realPart + imaginaryPart * imaginaryPart) * 2.0 * spectrum -> dx;
-					ltas -> z [1] [iharm] += energy;
-				}
-			} else {
-				numberOfPeriods -= 1;
-			}
-		}
+		numberOfPeriods = PointProcess_Sound_accumulatePeriodEnergies (pulses, sound,
+			shortestPeriod, longestPeriod, maximumPeriodFactor,
+			true, ltas -> nx, 1.0, ltas -> z [1], NULL, NULL);
 		if (numberOfPeriods < 1)
 			Melder_throw (L"There are no periods in the point process.");
 		for (long iharm = 1; iharm <= ltas -> nx; iharm ++) {
@@ -25,6 +25,7 @@
 #include "Pitch_to_PointProcess.h"
 #include "PointProcess_and_Sound.h"
 #include "Sound_and_LPC.h"
+#include "OverlapAdd.h"
 
 #define MAX_T  0.02000000001   /* Maximum interval between two voice pulses (otherwise voiceless). */
 
@@ -215,115 +216,11 @@ static long PointProcess_getFirstVoicedPoint (PointProcess me, double maxT) {
 	return 0;
 }
 
-static void copyRise (Sound me, double tmin, double tmax, Sound thee, double tmaxTarget) {
-	long imin, imax, imaxTarget, distance, i;
-	double dphase;
-	imin = Sampled_xToHighIndex (me, tmin);
-	if (imin < 1) imin = 1;
-	imax = Sampled_xToHighIndex (me, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
-	if (imax > my nx) imax = my nx;
-	if (imax < imin) return;
-	imaxTarget = Sampled_xToHighIndex (thee, tmaxTarget) - 1;
-	distance = imaxTarget - imax;
-	dphase = NUMpi / (imax - imin + 1);
-	for (i = imin; i <= imax; i ++) {
-		long iTarget = i + distance;
-		if (iTarget >= 1 && iTarget <= thy nx)
-			thy z [1] [iTarget] += my z [1] [i] * 0.5 * (1 - cos (dphase * (i - imin + 0.5)));
-	}
-}
-
-static void copyFall (Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
-	long imin, imax, iminTarget, distance, i;
-	double dphase;
-	imin = Sampled_xToHighIndex (me, tmin);
-	if (imin < 1) imin = 1;
-	imax = Sampled_xToHighIndex (me, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
-	if (imax > my nx) imax = my nx;
-	if (imax < imin) return;
-	iminTarget = Sampled_xToHighIndex (thee, tminTarget);
-	distance = iminTarget - imin;
-	dphase = NUMpi / (imax - imin + 1);
-	for (i = imin; i <= imax; i ++) {
-		long iTarget = i + distance;
-		if (iTarget >= 1 && iTarget <= thy nx)
-			thy z [1] [iTarget] += my z [1] [i] * 0.5 * (1 + cos (dphase * (i - imin + 0.5)));
-	}
-}
-
-static void copyBell (Sound me, double tmid, double leftWidth, double rightWidth, Sound thee, double tmidTarget) {
-	copyRise (me, tmid - leftWidth, tmid, thee, tmidTarget);
-	copyFall (me, tmid, tmid + rightWidth, thee, tmidTarget);
-}
-
-static void copyBell2 (Sound me, PointProcess source, long isource, double leftWidth, double rightWidth,
-	Sound thee, double tmidTarget, double maxT)
-{
-	/*
-	 * Replace 'leftWidth' and 'rightWidth' by the lengths of the intervals in the source (instead of target),
-	 * if these are shorter.
-	 */
-	double tmid = source -> t [isource];
-	if (isource > 1 && tmid - source -> t [isource - 1] <= maxT) {
-		double sourceLeftWidth = tmid - source -> t [isource - 1];
-		if (sourceLeftWidth < leftWidth) leftWidth = sourceLeftWidth;
-	}
-	if (isource < source -> nt && source -> t [isource + 1] - tmid <= maxT) {
-		double sourceRightWidth = source -> t [isource + 1] - tmid;
-		if (sourceRightWidth < rightWidth) rightWidth = sourceRightWidth;
-	}
-	copyBell (me, tmid, leftWidth, rightWidth, thee, tmidTarget);
-}
-
-static void copyFlat (Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
-	long imin = Sampled_xToHighIndex (me, tmin);
-	if (imin < 1) imin = 1;
-	long imax = Sampled_xToHighIndex (me, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
-	if (imax > my nx) imax = my nx;
-	if (imax < imin) return;
-	long iminTarget = Sampled_xToHighIndex (thee, tminTarget);
-	if (iminTarget < 1) iminTarget = 1;
-	trace ("%.17g %.17g %.17g %ld %ld %ld", tmin, tmax, tminTarget, imin, imax, iminTarget);
-	Melder_assert (iminTarget + imax - imin <= thy nx);
-	NUMvector_copyElements (my z [1] + imin, thy z [1] + iminTarget, 0, imax - imin);
-}
-
 Sound Sound_Point_Point_to_Sound (Sound me, PointProcess source, PointProcess target, double maxT) {
 	try {
-		autoSound thee = Sound_create (1, my xmin, my xmax, my nx, my dx, my x1);
-		if (source -> nt < 2 || target -> nt < 2) {   /* Almost completely voiceless? */
-			NUMvector_copyElements (my z [1], thy z [1], 1, my nx);
-			return thee.transfer();
-		}
-		for (long i = 1; i <= target -> nt; i ++) {
-			double tmid = target -> t [i];
-			double tleft = i > 1 ? target -> t [i - 1] : my xmin;
-			double tright = i < target -> nt ? target -> t [i + 1] : my xmax;
-			double leftWidth = tmid - tleft, rightWidth = tright - tmid;
-			int leftVoiced = i > 1 && leftWidth <= maxT;
-			int rightVoiced = i < target -> nt && rightWidth <= maxT;
-			long isource = PointProcess_getNearestIndex (source, tmid);
-			if (! leftVoiced) leftWidth = rightWidth;   /* Symmetric bell. */
-			if (! rightVoiced) rightWidth = leftWidth;   /* Symmetric bell. */
-			if (leftVoiced || rightVoiced) {
-				copyBell2 (me, source, isource, leftWidth, rightWidth, thee.peek(), tmid, maxT);
-				if (! leftVoiced) {
-					double startOfFlat = i == 1 ? tleft : (tleft + tmid) / 2;
-					double endOfFlat = tmid - leftWidth;
-					copyFlat (me, startOfFlat, endOfFlat, thee.peek(), startOfFlat);
-					copyFall (me, endOfFlat, tmid, thee.peek(), endOfFlat);
-				} else if (! rightVoiced) {
-					double startOfFlat = tmid + rightWidth;
-					double endOfFlat = i == target -> nt ? tright : (tmid + tright) / 2;
-					copyRise (me, tmid, startOfFlat, thee.peek(), startOfFlat);
-					copyFlat (me, startOfFlat, endOfFlat, thee.peek(), startOfFlat);
-				}
-			} else {
-				double startOfFlat = i == 1 ? tleft : (tleft + tmid) / 2;
-				double endOfFlat = i == target -> nt ? tright : (tmid + tright) / 2;
-				copyFlat (me, startOfFlat, endOfFlat, thee.peek(), startOfFlat);
-			}
-		}
+		autoOverlapAddWindows windows = OverlapAddWindows_create ();
+		autoOverlapAddPlan plan = Sound_Point_Point_to_OverlapAddPlan (me, source, target, maxT, windows.peek());
+		autoSound thee = OverlapAddPlan_to_Sound (plan.peek());
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": not manipulated.");
@@ -334,146 +231,9 @@ Sound Sound_Point_Pitch_Duration_to_Sound (Sound me, PointProcess pulses,
 	PitchTier pitch, DurationTier duration, double maxT)
 {
 	try {
-		long ipointleft, ipointright;
-		double deltat = 0, handledTime = my xmin;
-		double startOfSourceNoise, endOfSourceNoise, startOfTargetNoise, endOfTargetNoise;
-		double durationOfSourceNoise, durationOfTargetNoise;
-		double startOfSourceVoice, endOfSourceVoice, startOfTargetVoice, endOfTargetVoice;
-		double durationOfSourceVoice, durationOfTargetVoice;
-		double startingPeriod, finishingPeriod, ttarget, voicelessPeriod;
-		if (duration -> points -> size == 0)
-			Melder_throw ("No duration points.");
-
-		/*
-		 * Create a Sound long enough to hold the longest possible duration-manipulated sound.
-		 */
-		autoSound thee = Sound_create (1, my xmin, my xmin + 3 * (my xmax - my xmin), 3 * my nx, my dx, my x1);
-
-		/*
-		 * Below, I'll abbreviate the voiced interval as "voice" and the voiceless interval as "noise".
-		 */
-		if (pitch && pitch -> points -> size) for (ipointleft = 1; ipointleft <= pulses -> nt; ipointleft = ipointright + 1) {
-			/*
-			 * Find the beginning of the voice.
-			 */
-			startOfSourceVoice = pulses -> t [ipointleft];   /* The first pulse of the voice. */
-			startingPeriod = 1.0 / RealTier_getValueAtTime (pitch, startOfSourceVoice);
-			startOfSourceVoice -= 0.5 * startingPeriod;   /* The first pulse is in the middle of a period. */
-
-			/*
-			 * Measure one noise.
-			 */
-			startOfSourceNoise = handledTime;
-			endOfSourceNoise = startOfSourceVoice;
-			durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
-			startOfTargetNoise = startOfSourceNoise + deltat;
-			endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
-			durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
-
-			/*
-			 * Copy the noise.
-			 */
-			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-			ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
-			while (ttarget < endOfTargetNoise) {
-				double tsource;
-				double tleft = startOfSourceNoise, tright = endOfSourceNoise;
-				int i;
-				for (i = 1; i <= 15; i ++) {
-					double tsourcemid = 0.5 * (tleft + tright);
-					double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
-						startOfSourceNoise, tsourcemid);
-					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
-				}
-				tsource = 0.5 * (tleft + tright);
-				copyBell (me, tsource, voicelessPeriod, voicelessPeriod, thee.peek(), ttarget);
-				voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-				ttarget += voicelessPeriod;
-			}
-			deltat += durationOfTargetNoise - durationOfSourceNoise;
-
-			/*
-			 * Find the end of the voice.
-			 */
-			for (ipointright = ipointleft + 1; ipointright <= pulses -> nt; ipointright ++)
-				if (pulses -> t [ipointright] - pulses -> t [ipointright - 1] > maxT)
-					break;
-			ipointright --;
-			endOfSourceVoice = pulses -> t [ipointright];   /* The last pulse of the voice. */
-			finishingPeriod = 1.0 / RealTier_getValueAtTime (pitch, endOfSourceVoice);
-			endOfSourceVoice += 0.5 * finishingPeriod;   /* The last pulse is in the middle of a period. */
-			/*
-			 * Measure one voice.
-			 */
-			durationOfSourceVoice = endOfSourceVoice - startOfSourceVoice;
-
-			/*
-			 * This will be copied to an interval with a different location and duration.
-			 */
-			startOfTargetVoice = startOfSourceVoice + deltat;
-			endOfTargetVoice = startOfTargetVoice +
-				RealTier_getArea (duration, startOfSourceVoice, endOfSourceVoice);
-			durationOfTargetVoice = endOfTargetVoice - startOfTargetVoice;
-
-			/*
-			 * Copy the voiced part.
-			 */
-			ttarget = startOfTargetVoice + 0.5 * startingPeriod;
-			while (ttarget < endOfTargetVoice) {
-				double tsource, period;
-				long isourcepulse;
-				double tleft = startOfSourceVoice, tright = endOfSourceVoice;
-				int i;
-				for (i = 1; i <= 15; i ++) {
-					double tsourcemid = 0.5 * (tleft + tright);
-					double ttargetmid = startOfTargetVoice + RealTier_getArea (duration,
-						startOfSourceVoice, tsourcemid);
-					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
-				}
-				tsource = 0.5 * (tleft + tright);
-				period = 1.0 / RealTier_getValueAtTime (pitch, tsource);
-				isourcepulse = PointProcess_getNearestIndex (pulses, tsource);
-				copyBell2 (me, pulses, isourcepulse, period, period, thee.peek(), ttarget, maxT);
-				ttarget += period;
-			}
-			deltat += durationOfTargetVoice - durationOfSourceVoice;
-			handledTime = endOfSourceVoice;
-		}
-
-		/*
-		 * Copy the remaining unvoiced part, if we are at the end.
-		 */
-		startOfSourceNoise = handledTime;
-		endOfSourceNoise = my xmax;
-		durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
-		startOfTargetNoise = startOfSourceNoise + deltat;
-		endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
-		durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
-		voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-		ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
-		while (ttarget < endOfTargetNoise) {
-			double tsource;
-			double tleft = startOfSourceNoise, tright = endOfSourceNoise;
-			for (int i = 1; i <= 15; i ++) {
-				double tsourcemid = 0.5 * (tleft + tright);
-				double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
-					startOfSourceNoise, tsourcemid);
-				if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
-			}
-			tsource = 0.5 * (tleft + tright);
-			copyBell (me, tsource, voicelessPeriod, voicelessPeriod, thee.peek(), ttarget);
-			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-			ttarget += voicelessPeriod;
-		}
-
-		/*
-		 * Find the number of trailing zeroes and hack the sound's time domain.
-		 */
-		thy xmax = thy xmin + RealTier_getArea (duration, my xmin, my xmax);
-		if (fabs (thy xmax - my xmax) < 1e-12) thy xmax = my xmax;   /* Common situation. */
-		thy nx = Sampled_xToLowIndex (thee.peek(), thy xmax);
-		if (thy nx > 3 * my nx) thy nx = 3 * my nx;
-
+		autoOverlapAddWindows windows = OverlapAddWindows_create ();
+		autoOverlapAddPlan plan = Sound_Point_Pitch_Duration_to_OverlapAddPlan (me, pulses, pitch, duration, maxT, windows.peek());
+		autoSound thee = OverlapAddPlan_to_Sound (plan.peek());
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": not manipulated.");
@@ -683,6 +443,55 @@ Sound Manipulation_to_Sound (Manipulation me, int method) {
 	}
 }
 
+Collection Manipulation_to_Sounds_overlapAdd (Manipulation me, long numberOfVariants,
+	PitchTier *pitchTiers, DurationTier *durationTiers)
+{
+	try {
+		if (! my sound)  Melder_throw ("Missing original sound.");
+		if (! my pulses) Melder_throw ("Missing pulses analysis.");
+		/*
+		 * Plan all variants in the main thread, in order, so that the voiceless periods are drawn
+		 * from the random generator exactly as with successive calls to Manipulation_to_Sound.
+		 */
+		autoOverlapAddWindows windows = OverlapAddWindows_create ();
+		autoCollection plans = Collection_create (NULL, numberOfVariants);
+		autoCollection thee = Collection_create (NULL, numberOfVariants);
+		autoNUMvector <OverlapAddPlan> planList (1, numberOfVariants);
+		autoNUMvector <Sound> soundList (1, numberOfVariants);
+		for (long ivariant = 1; ivariant <= numberOfVariants; ivariant ++) {
+			PitchTier pitch = pitchTiers && pitchTiers [ivariant] ? pitchTiers [ivariant] : my pitch;
+			DurationTier duration = durationTiers && durationTiers [ivariant] ? durationTiers [ivariant] : my duration;
+			if (! pitch) Melder_throw ("Missing pitch manipulation.");
+			autoOverlapAddPlan plan;
+			if (! duration || duration -> points -> size == 0) {
+				autoPointProcess targetPulses = PitchTier_Point_to_PointProcess (pitch, my pulses, MAX_T);
+				plan.reset (Sound_Point_Point_to_OverlapAddPlan (my sound, my pulses, targetPulses.peek(), MAX_T, windows.peek()));
+			} else {
+				plan.reset (Sound_Point_Pitch_Duration_to_OverlapAddPlan (my sound, my pulses, pitch, duration, MAX_T, windows.peek()));
+			}
+			autoSound sound = Sound_create (1, plan -> xmin, plan -> xmax, plan -> nx, my sound -> dx, my sound -> x1);
+			autoMelderString name;
+			if (pitchTiers && pitchTiers [ivariant]) MelderString_append (& name, Thing_getName (pitchTiers [ivariant]));
+			if (durationTiers && durationTiers [ivariant]) {
+				if (name.length > 0) MelderString_appendCharacter (& name, '_');
+				MelderString_append (& name, Thing_getName (durationTiers [ivariant]));
+			}
+			Thing_setName (sound.peek(), name.length > 0 ? name.string : Thing_getName (me));
+			planList [ivariant] = plan.peek();
+			soundList [ivariant] = sound.peek();
+			Collection_addItem (plans.peek(), plan.transfer());
+			Collection_addItem (thee.peek(), sound.transfer());
+		}
+		/*
+		 * Render all variants together, spread over the available threads.
+		 */
+		OverlapAddPlans_render (numberOfVariants, planList.peek(), soundList.peek());
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": overlap-add synthesis not performed.");
+	}
+}
+
 Manipulation Manipulation_AnyTier_to_Manipulation (Manipulation me, AnyTier tier) {
 	try {
 		if (! my pitch) Melder_throw ("Missing pitch manipulation.");
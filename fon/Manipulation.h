@@ -71,6 +71,15 @@ Sound Sound_Point_Point_to_Sound (Sound me, PointProcess source, PointProcess ta
 /*void Sound_Formant_Intensity_filter (Sound me, FormantTier formant, IntensityTier intensity);*/
 
 Sound Manipulation_to_Sound (Manipulation me, int method);
+Collection Manipulation_to_Sounds_overlapAdd (Manipulation me, long numberOfVariants,
+	PitchTier *pitchTiers, DurationTier *durationTiers);
+	/*
+	 * Overlap-add resynthesis of many variants of the same manipulation, rendered in parallel.
+	 * Variant i uses pitchTiers [i] and durationTiers [i] instead of the Manipulation's own tiers;
+	 * either array, or any element, can be NULL, in which case the Manipulation's own tier is used.
+	 * Each variant gives the same result as Manipulation_to_Sound with Manipulation_OVERLAPADD,
+	 * called for the variants in order from the same random state (with a duration tier, the voiceless parts get random periods).
+	 */
 int Manipulation_playPart (Manipulation me, double tmin, double tmax, int method);
 int Manipulation_play (Manipulation me, int method);
 int Manipulation_writeToTextFileWithoutSound (Manipulation me, MelderFile fs);
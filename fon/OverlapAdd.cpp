@@ -0,0 +1,509 @@
+/* OverlapAdd.cpp
+ *
+ * Copyright (C) 1992-2012,2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "OverlapAdd.h"
+#include "MelderThread.h"
+
+#define OverlapAdd_MAXIMUM_CACHED_WINDOW_LENGTH  4096
+#define OverlapAdd_SAMPLES_PER_BLOCK  65536
+
+/********** WINDOWS **********/
+
+Thing_implement (OverlapAddWindows, Thing, 0);
+
+void structOverlapAddWindows :: v_destroy () {
+	if (rise) for (long length = 1; length <= maximumLength; length ++) {
+		NUMvector_free <double> (rise [length], 0);
+		NUMvector_free <double> (fall [length], 0);
+	}
+	NUMvector_free <double *> (rise, 1);
+	NUMvector_free <double *> (fall, 1);
+	OverlapAddWindows_Parent :: v_destroy ();
+}
+
+OverlapAddWindows OverlapAddWindows_create () {
+	try {
+		autoOverlapAddWindows me = Thing_new (OverlapAddWindows);
+		my maximumLength = OverlapAdd_MAXIMUM_CACHED_WINDOW_LENGTH;
+		my rise = NUMvector <double *> (1, my maximumLength);
+		my fall = NUMvector <double *> (1, my maximumLength);
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw ("Overlap-add windows not created.");
+	}
+}
+
+static void OverlapAddWindows_need (OverlapAddWindows me, long length) {
+	if (length > my maximumLength || my rise [length]) return;   // longer windows are computed while rendering
+	autoNUMvector <double> rise ((long) 0, length - 1), fall ((long) 0, length - 1);
+	double dphase = NUMpi / length;
+	for (long i = 0; i < length; i ++) {
+		rise [i] = 0.5 * (1 - cos (dphase * (i + 0.5)));
+		fall [i] = 0.5 * (1 + cos (dphase * (i + 0.5)));
+	}
+	my rise [length] = rise.transfer();
+	my fall [length] = fall.transfer();
+}
+
+/********** PLANNING **********/
+
+Thing_implement (OverlapAddPlan, Thing, 0);
+
+void structOverlapAddPlan :: v_destroy () {
+	NUMvector_free <struct structOverlapAddSegment> (segments, 1);
+	NUMvector_free <long> (highestTargetSoFar, 1);
+	NUMvector_free <long> (lowestTargetFromHere, 1);
+	OverlapAddPlan_Parent :: v_destroy ();
+}
+
+static OverlapAddPlan OverlapAddPlan_create (Sound source, OverlapAddWindows windows, long capacity) {
+	autoOverlapAddPlan me = Thing_new (OverlapAddPlan);
+	my source = source;
+	my windows = windows;
+	my capacity = capacity;
+	my maximumNumberOfSegments = 1000;
+	my segments = NUMvector <struct structOverlapAddSegment> (1, my maximumNumberOfSegments);
+	return me.transfer();
+}
+
+static void OverlapAddPlan_addSegment (OverlapAddPlan me, long imin, long imax, long offset, int shape) {
+	long ifirst = imin, ilast = imax;
+	if (ifirst + offset < 1) ifirst = 1 - offset;
+	if (ilast + offset > my capacity) ilast = my capacity - offset;
+	if (ilast < ifirst) return;   // nothing lands inside the target
+	if (my numberOfSegments == my maximumNumberOfSegments) {
+		long newMaximumNumberOfSegments = 2 * my maximumNumberOfSegments;
+		OverlapAddSegment newSegments = NUMvector <struct structOverlapAddSegment> (1, newMaximumNumberOfSegments);
+		NUMvector_copyElements <struct structOverlapAddSegment> (my segments, newSegments, 1, my numberOfSegments);
+		NUMvector_free <struct structOverlapAddSegment> (my segments, 1);
+		my segments = newSegments;
+		my maximumNumberOfSegments = newMaximumNumberOfSegments;
+	}
+	OverlapAddSegment segment = & my segments [++ my numberOfSegments];
+	segment -> imin = imin;
+	segment -> imax = imax;
+	segment -> ifirst = ifirst;
+	segment -> ilast = ilast;
+	segment -> offset = offset;
+	segment -> shape = shape;
+	if (shape != OverlapAdd_FLAT) OverlapAddWindows_need (my windows, imax - imin + 1);
+}
+
+/*
+ * The target has the same sampling as the source, so the source's time-to-index conversion serves for both.
+ */
+static void OverlapAddPlan_addRise (OverlapAddPlan me, double tmin, double tmax, double tmaxTarget) {
+	Sound source = my source;
+	long imin = Sampled_xToHighIndex (source, tmin);
+	if (imin < 1) imin = 1;
+	long imax = Sampled_xToHighIndex (source, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
+	if (imax > source -> nx) imax = source -> nx;
+	if (imax < imin) return;
+	long imaxTarget = Sampled_xToHighIndex (source, tmaxTarget) - 1;
+	OverlapAddPlan_addSegment (me, imin, imax, imaxTarget - imax, OverlapAdd_RISE);
+}
+
+static void OverlapAddPlan_addFall (OverlapAddPlan me, double tmin, double tmax, double tminTarget) {
+	Sound source = my source;
+	long imin = Sampled_xToHighIndex (source, tmin);
+	if (imin < 1) imin = 1;
+	long imax = Sampled_xToHighIndex (source, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
+	if (imax > source -> nx) imax = source -> nx;
+	if (imax < imin) return;
+	long iminTarget = Sampled_xToHighIndex (source, tminTarget);
+	OverlapAddPlan_addSegment (me, imin, imax, iminTarget - imin, OverlapAdd_FALL);
+}
+
+static void OverlapAddPlan_addBell (OverlapAddPlan me, double tmid, double leftWidth, double rightWidth, double tmidTarget) {
+	OverlapAddPlan_addRise (me, tmid - leftWidth, tmid, tmidTarget);
+	OverlapAddPlan_addFall (me, tmid, tmid + rightWidth, tmidTarget);
+}
+
+static void OverlapAddPlan_addBell2 (OverlapAddPlan me, PointProcess source, long isource, double leftWidth, double rightWidth,
+	double tmidTarget, double maxT)
+{
+	/*
+	 * Replace 'leftWidth' and 'rightWidth' by the lengths of the intervals in the source (instead of target),
+	 * if these are shorter.
+	 */
+	double tmid = source -> t [isource];
+	if (isource > 1 && tmid - source -> t [isource - 1] <= maxT) {
+		double sourceLeftWidth = tmid - source -> t [isource - 1];
+		if (sourceLeftWidth < leftWidth) leftWidth = sourceLeftWidth;
+	}
+	if (isource < source -> nt && source -> t [isource + 1] - tmid <= maxT) {
+		double sourceRightWidth = source -> t [isource + 1] - tmid;
+		if (sourceRightWidth < rightWidth) rightWidth = sourceRightWidth;
+	}
+	OverlapAddPlan_addBell (me, tmid, leftWidth, rightWidth, tmidTarget);
+}
+
+static void OverlapAddPlan_addFlat (OverlapAddPlan me, double tmin, double tmax, double tminTarget) {
+	Sound source = my source;
+	long imin = Sampled_xToHighIndex (source, tmin);
+	if (imin < 1) imin = 1;
+	long imax = Sampled_xToHighIndex (source, tmax) - 1;   /* Not xToLowIndex: ensure separation of subsequent calls. */
+	if (imax > source -> nx) imax = source -> nx;
+	if (imax < imin) return;
+	long iminTarget = Sampled_xToHighIndex (source, tminTarget);
+	if (iminTarget < 1) iminTarget = 1;
+	Melder_assert (iminTarget + imax - imin <= my capacity);
+	OverlapAddPlan_addSegment (me, imin, imax, iminTarget - imin, OverlapAdd_FLAT);
+}
+
+/*
+ * A block of target samples is touched only by the segments between the first one that reaches up to the block
+ * and the last one that reaches down to it.
+ */
+static void OverlapAddPlan_index (OverlapAddPlan me) {
+	if (my numberOfSegments == 0) return;
+	my highestTargetSoFar = NUMvector <long> (1, my numberOfSegments);
+	my lowestTargetFromHere = NUMvector <long> (1, my numberOfSegments);
+	long highest = my segments [1]. ilast + my segments [1]. offset;
+	for (long iseg = 1; iseg <= my numberOfSegments; iseg ++) {
+		OverlapAddSegment segment = & my segments [iseg];
+		if (segment -> ilast + segment -> offset > highest) highest = segment -> ilast + segment -> offset;
+		my highestTargetSoFar [iseg] = highest;
+	}
+	long lowest = my segments [my numberOfSegments]. ifirst + my segments [my numberOfSegments]. offset;
+	for (long iseg = my numberOfSegments; iseg >= 1; iseg --) {
+		OverlapAddSegment segment = & my segments [iseg];
+		if (segment -> ifirst + segment -> offset < lowest) lowest = segment -> ifirst + segment -> offset;
+		my lowestTargetFromHere [iseg] = lowest;
+	}
+}
+
+OverlapAddPlan Sound_Point_Point_to_OverlapAddPlan (Sound me, PointProcess source, PointProcess target, double maxT,
+	OverlapAddWindows windows)
+{
+	try {
+		autoOverlapAddPlan thee = OverlapAddPlan_create (me, windows, my nx);
+		thy xmin = my xmin;
+		thy xmax = my xmax;
+		thy nx = my nx;
+		if (source -> nt < 2 || target -> nt < 2) {   /* Almost completely voiceless? */
+			OverlapAddPlan_addSegment (thee.peek(), 1, my nx, 0, OverlapAdd_FLAT);
+			OverlapAddPlan_index (thee.peek());
+			return thee.transfer();
+		}
+		for (long i = 1; i <= target -> nt; i ++) {
+			double tmid = target -> t [i];
+			double tleft = i > 1 ? target -> t [i - 1] : my xmin;
+			double tright = i < target -> nt ? target -> t [i + 1] : my xmax;
+			double leftWidth = tmid - tleft, rightWidth = tright - tmid;
+			int leftVoiced = i > 1 && leftWidth <= maxT;
+			int rightVoiced = i < target -> nt && rightWidth <= maxT;
+			long isource = PointProcess_getNearestIndex (source, tmid);
+			if (! leftVoiced) leftWidth = rightWidth;   /* Symmetric bell. */
+			if (! rightVoiced) rightWidth = leftWidth;   /* Symmetric bell. */
+			if (leftVoiced || rightVoiced) {
+				OverlapAddPlan_addBell2 (thee.peek(), source, isource, leftWidth, rightWidth, tmid, maxT);
+				if (! leftVoiced) {
+					double startOfFlat = i == 1 ? tleft : (tleft + tmid) / 2;
+					double endOfFlat = tmid - leftWidth;
+					OverlapAddPlan_addFlat (thee.peek(), startOfFlat, endOfFlat, startOfFlat);
+					OverlapAddPlan_addFall (thee.peek(), endOfFlat, tmid, endOfFlat);
+				} else if (! rightVoiced) {
+					double startOfFlat = tmid + rightWidth;
+					double endOfFlat = i == target -> nt ? tright : (tmid + tright) / 2;
+					OverlapAddPlan_addRise (thee.peek(), tmid, startOfFlat, startOfFlat);
+					OverlapAddPlan_addFlat (thee.peek(), startOfFlat, endOfFlat, startOfFlat);
+				}
+			} else {
+				double startOfFlat = i == 1 ? tleft : (tleft + tmid) / 2;
+				double endOfFlat = i == target -> nt ? tright : (tmid + tright) / 2;
+				OverlapAddPlan_addFlat (thee.peek(), startOfFlat, endOfFlat, startOfFlat);
+			}
+		}
+		OverlapAddPlan_index (thee.peek());
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": overlap-add not planned.");
+	}
+}
+
+OverlapAddPlan Sound_Point_Pitch_Duration_to_OverlapAddPlan (Sound me, PointProcess pulses,
+	PitchTier pitch, DurationTier duration, double maxT, OverlapAddWindows windows)
+{
+	try {
+		long ipointleft, ipointright;
+		double deltat = 0, handledTime = my xmin;
+		double startOfSourceNoise, endOfSourceNoise, startOfTargetNoise, endOfTargetNoise;
+		double durationOfSourceNoise, durationOfTargetNoise;
+		double startOfSourceVoice, endOfSourceVoice, startOfTargetVoice, endOfTargetVoice;
+		double durationOfSourceVoice, durationOfTargetVoice;
+		double startingPeriod, finishingPeriod, ttarget, voicelessPeriod;
+		if (duration -> points -> size == 0)
+			Melder_throw ("No duration points.");
+
+		/*
+		 * Leave room for the longest possible duration-manipulated sound.
+		 */
+		autoOverlapAddPlan thee = OverlapAddPlan_create (me, windows, 3 * my nx);
+
+		/*
+		 * Below, I'll abbreviate the voiced interval as "voice" and the voiceless interval as "noise".
+		 */
+		if (pitch && pitch -> points -> size) for (ipointleft = 1; ipointleft <= pulses -> nt; ipointleft = ipointright + 1) {
+			/*
+			 * Find the beginning of the voice.
+			 */
+			startOfSourceVoice = pulses -> t [ipointleft];   /* The first pulse of the voice. */
+			startingPeriod = 1.0 / RealTier_getValueAtTime (pitch, startOfSourceVoice);
+			startOfSourceVoice -= 0.5 * startingPeriod;   /* The first pulse is in the middle of a period. */
+
+			/*
+			 * Measure one noise.
+			 */
+			startOfSourceNoise = handledTime;
+			endOfSourceNoise = startOfSourceVoice;
+			durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
+			startOfTargetNoise = startOfSourceNoise + deltat;
+			endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
+			durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
+
+			/*
+			 * Copy the noise.
+			 */
+			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+			ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
+			while (ttarget < endOfTargetNoise) {
+				double tsource;
+				double tleft = startOfSourceNoise, tright = endOfSourceNoise;
+				int i;
+				for (i = 1; i <= 15; i ++) {
+					double tsourcemid = 0.5 * (tleft + tright);
+					double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
+						startOfSourceNoise, tsourcemid);
+					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
+				}
+				tsource = 0.5 * (tleft + tright);
+				OverlapAddPlan_addBell (thee.peek(), tsource, voicelessPeriod, voicelessPeriod, ttarget);
+				voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+				ttarget += voicelessPeriod;
+			}
+			deltat += durationOfTargetNoise - durationOfSourceNoise;
+
+			/*
+			 * Find the end of the voice.
+			 */
+			for (ipointright = ipointleft + 1; ipointright <= pulses -> nt; ipointright ++)
+				if (pulses -> t [ipointright] - pulses -> t [ipointright - 1] > maxT)
+					break;
+			ipointright --;
+			endOfSourceVoice = pulses -> t [ipointright];   /* The last pulse of the voice. */
+			finishingPeriod = 1.0 / RealTier_getValueAtTime (pitch, endOfSourceVoice);
+			endOfSourceVoice += 0.5 * finishingPeriod;   /* The last pulse is in the middle of a period. */
+			/*
+			 * Measure one voice.
+			 */
+			durationOfSourceVoice = endOfSourceVoice - startOfSourceVoice;
+
+			/*
+			 * This will be copied to an interval with a different location and duration.
+			 */
+			startOfTargetVoice = startOfSourceVoice + deltat;
+			endOfTargetVoice = startOfTargetVoice +
+				RealTier_getArea (duration, startOfSourceVoice, endOfSourceVoice);
+			durationOfTargetVoice = endOfTargetVoice - startOfTargetVoice;
+
+			/*
+			 * Copy the voiced part.
+			 */
+			ttarget = startOfTargetVoice + 0.5 * startingPeriod;
+			while (ttarget < endOfTargetVoice) {
+				double tsource, period;
+				long isourcepulse;
+				double tleft = startOfSourceVoice, tright = endOfSourceVoice;
+				int i;
+				for (i = 1; i <= 15; i ++) {
+					double tsourcemid = 0.5 * (tleft + tright);
+					double ttargetmid = startOfTargetVoice + RealTier_getArea (duration,
+						startOfSourceVoice, tsourcemid);
+					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
+				}
+				tsource = 0.5 * (tleft + tright);
+				period = 1.0 / RealTier_getValueAtTime (pitch, tsource);
+				isourcepulse = PointProcess_getNearestIndex (pulses, tsource);
+				OverlapAddPlan_addBell2 (thee.peek(), pulses, isourcepulse, period, period, ttarget, maxT);
+				ttarget += period;
+			}
+			deltat += durationOfTargetVoice - durationOfSourceVoice;
+			handledTime = endOfSourceVoice;
+		}
+
+		/*
+		 * Copy the remaining unvoiced part, if we are at the end.
+		 */
+		startOfSourceNoise = handledTime;
+		endOfSourceNoise = my xmax;
+		durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
+		startOfTargetNoise = startOfSourceNoise + deltat;
+		endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
+		durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
+		voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+		ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
+		while (ttarget < endOfTargetNoise) {
+			double tsource;
+			double tleft = startOfSourceNoise, tright = endOfSourceNoise;
+			for (int i = 1; i <= 15; i ++) {
+				double tsourcemid = 0.5 * (tleft + tright);
+				double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
+					startOfSourceNoise, tsourcemid);
+				if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
+			}
+			tsource = 0.5 * (tleft + tright);
+			OverlapAddPlan_addBell (thee.peek(), tsource, voicelessPeriod, voicelessPeriod, ttarget);
+			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+			ttarget += voicelessPeriod;
+		}
+
+		/*
+		 * Find the number of trailing zeroes and hack the sound's time domain.
+		 */
+		thy xmin = my xmin;
+		thy xmax = my xmin + RealTier_getArea (duration, my xmin, my xmax);
+		if (fabs (thy xmax - my xmax) < 1e-12) thy xmax = my xmax;   /* Common situation. */
+		thy nx = Sampled_xToLowIndex (me, thy xmax);
+		if (thy nx > 3 * my nx) thy nx = 3 * my nx;
+		if (thy nx < 1)
+			Melder_throw ("The manipulated sound would contain no samples.");
+
+		OverlapAddPlan_index (thee.peek());
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": overlap-add not planned.");
+	}
+}
+
+/********** RENDERING **********/
+
+void OverlapAddPlan_render (OverlapAddPlan me, long firstSample, long numberOfSamples, double *buffer) {
+	long lastSample = firstSample + numberOfSamples - 1;
+	for (long i = 0; i < numberOfSamples; i ++) buffer [i] = 0.0;
+	if (my numberOfSegments == 0) return;
+	/*
+	 * Both index arrays are nondecreasing, so that the relevant segments can be found by bisection.
+	 */
+	long left = 1, right = my numberOfSegments + 1;
+	while (left < right) {
+		long mid = (left + right) / 2;
+		if (my highestTargetSoFar [mid] >= firstSample) right = mid; else left = mid + 1;
+	}
+	long firstSegment = left;
+	left = 0, right = my numberOfSegments;
+	while (left < right) {
+		long mid = (left + right + 1) / 2;
+		if (my lowestTargetFromHere [mid] <= lastSample) left = mid; else right = mid - 1;
+	}
+	long lastSegment = left;
+	const double *source = my source -> z [1];
+	OverlapAddWindows windows = my windows;
+	for (long iseg = firstSegment; iseg <= lastSegment; iseg ++) {
+		OverlapAddSegment segment = & my segments [iseg];
+		long ifirst = segment -> ifirst, ilast = segment -> ilast, offset = segment -> offset - firstSample;
+		if (ifirst + offset < 0) ifirst = - offset;
+		if (ilast + offset >= numberOfSamples) ilast = numberOfSamples - 1 - offset;
+		if (ilast < ifirst) continue;
+		if (segment -> shape == OverlapAdd_FLAT) {
+			for (long i = ifirst; i <= ilast; i ++)
+				buffer [i + offset] = source [i];
+			continue;
+		}
+		long imin = segment -> imin, length = segment -> imax - imin + 1;
+		if (length <= windows -> maximumLength) {
+			const double *window = ( segment -> shape == OverlapAdd_RISE ? windows -> rise [length] : windows -> fall [length] ) - imin;
+			for (long i = ifirst; i <= ilast; i ++)
+				buffer [i + offset] += source [i] * window [i];
+		} else {
+			double dphase = NUMpi / length, sign = segment -> shape == OverlapAdd_RISE ? -1.0 : 1.0;
+			for (long i = ifirst; i <= ilast; i ++)
+				buffer [i + offset] += source [i] * (0.5 * (1 + sign * cos (dphase * (i - imin + 0.5))));
+		}
+	}
+}
+
+Thing_define (OverlapAdd_render_Args, Thing) { public:
+	OverlapAddPlan *plans;
+	Sound *targets;
+	long numberOfBlocks, *blockPlan, *blockFirstSample;
+	int ithread, numberOfThreads;
+};
+
+Thing_implement (OverlapAdd_render_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE OverlapAdd_render_thread (OverlapAdd_render_Args me) {
+	for (long iblock = my ithread; iblock <= my numberOfBlocks; iblock += my numberOfThreads) {
+		long iplan = my blockPlan [iblock], firstSample = my blockFirstSample [iblock];
+		OverlapAddPlan plan = my plans [iplan];
+		long numberOfSamples = plan -> nx - firstSample + 1;
+		if (numberOfSamples > OverlapAdd_SAMPLES_PER_BLOCK) numberOfSamples = OverlapAdd_SAMPLES_PER_BLOCK;
+		OverlapAddPlan_render (plan, firstSample, numberOfSamples, & my targets [iplan] -> z [1] [firstSample]);
+	}
+	MelderThread_RETURN;
+}
+
+void OverlapAddPlans_render (long numberOfPlans, OverlapAddPlan *plans, Sound *targets) {
+	long numberOfBlocks = 0;
+	for (long iplan = 1; iplan <= numberOfPlans; iplan ++) {
+		Melder_assert (targets [iplan] -> nx == plans [iplan] -> nx);
+		numberOfBlocks += (plans [iplan] -> nx - 1) / OverlapAdd_SAMPLES_PER_BLOCK + 1;
+	}
+	if (numberOfBlocks == 0) return;
+	autoNUMvector <long> blockPlan (1, numberOfBlocks), blockFirstSample (1, numberOfBlocks);
+	long iblock = 0;
+	for (long iplan = 1; iplan <= numberOfPlans; iplan ++) {
+		for (long firstSample = 1; firstSample <= plans [iplan] -> nx; firstSample += OverlapAdd_SAMPLES_PER_BLOCK) {
+			iblock ++;
+			blockPlan [iblock] = iplan;
+			blockFirstSample [iblock] = firstSample;
+		}
+	}
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	autoOverlapAdd_render_Args args [16];
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoOverlapAdd_render_Args arg = Thing_new (OverlapAdd_render_Args);
+		arg -> plans = plans;
+		arg -> targets = targets;
+		arg -> numberOfBlocks = numberOfBlocks;
+		arg -> blockPlan = blockPlan.peek();
+		arg -> blockFirstSample = blockFirstSample.peek();
+		arg -> ithread = ithread;
+		arg -> numberOfThreads = numberOfThreads;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (OverlapAdd_render_thread, args, numberOfThreads);
+}
+
+Sound OverlapAddPlan_to_Sound (OverlapAddPlan me) {
+	try {
+		autoSound thee = Sound_create (1, my xmin, my xmax, my nx, my source -> dx, my source -> x1);
+		OverlapAddPlan plans [2] = { NULL, me };
+		Sound targets [2] = { NULL, thee.peek() };
+		OverlapAddPlans_render (1, plans, targets);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": not rendered.");
+	}
+}
+
+/* End of file OverlapAdd.cpp */
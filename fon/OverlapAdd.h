@@ -0,0 +1,99 @@
+#ifndef _OverlapAdd_h_
+#define _OverlapAdd_h_
+/* OverlapAdd.h
+ *
+ * Copyright (C) 1992-2012,2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Sound.h"
+#include "PointProcess.h"
+#include "PitchTier.h"
+#include "DurationTier.h"
+
+/*
+ * Overlap-add resynthesis in two stages.
+ *
+ * Planning decides which stretch of the source is copied to which place in the target, and with which half-window
+ * (a raised-cosine rise or fall, or flat). It touches no samples, but it is sequential
+ * (it draws the random voiceless periods), so it runs in the main thread.
+ *
+ * Rendering adds the windowed source samples into any block of target samples. It does not allocate,
+ * and it reads the windows from a table with one entry per half-window length, so that blocks can be rendered
+ * by any thread and in any order; the result does not depend on the blocking.
+ */
+
+/*
+ * Raised-cosine half-windows, shared by all the plans made for the same source.
+ * The windows are computed during planning; rendering only reads them.
+ */
+Thing_define (OverlapAddWindows, Thing) {
+	long maximumLength;
+	double **rise, **fall;   // [1..maximumLength] [0..length-1], NULL if that length has not been needed
+	void v_destroy ()
+		override;
+};
+
+OverlapAddWindows OverlapAddWindows_create ();
+
+#define OverlapAdd_RISE  1
+#define OverlapAdd_FALL  2
+#define OverlapAdd_FLAT  3
+
+typedef struct structOverlapAddSegment {
+	long imin, imax;   // the source samples that determine the shape of the half-window
+	long ifirst, ilast;   // the part of imin..imax that lands inside the target
+	long offset;   // from source sample number to target sample number
+	int shape;   // a flat segment replaces the target samples instead of adding to them
+} *OverlapAddSegment;
+
+Thing_define (OverlapAddPlan, Thing) {
+	Sound source;   // not owned; the target has the same sampling
+	OverlapAddWindows windows;   // not owned
+	double xmin, xmax;
+	long nx;   // of the target
+	long capacity;   // target samples 1..capacity can receive source samples
+	long numberOfSegments, maximumNumberOfSegments;
+	struct structOverlapAddSegment *segments;   // [1..numberOfSegments], in the order of the original overlap-add
+	long *highestTargetSoFar, *lowestTargetFromHere;   // [1..numberOfSegments], to find the segments that touch a block
+	void v_destroy ()
+		override;
+};
+
+OverlapAddPlan Sound_Point_Point_to_OverlapAddPlan (Sound me, PointProcess source, PointProcess target, double maxT,
+	OverlapAddWindows windows);
+OverlapAddPlan Sound_Point_Pitch_Duration_to_OverlapAddPlan (Sound me, PointProcess pulses,
+	PitchTier pitch, DurationTier duration, double maxT, OverlapAddWindows windows);
+	/*
+	 * The source 'me' and the 'windows' have to outlive the plan.
+	 */
+
+void OverlapAddPlan_render (OverlapAddPlan me, long firstSample, long numberOfSamples, double *buffer);
+	/*
+	 * Puts target samples firstSample .. firstSample + numberOfSamples - 1 into buffer [0 .. numberOfSamples - 1].
+	 * Safe to call from several threads at the same time.
+	 */
+
+void OverlapAddPlans_render (long numberOfPlans, OverlapAddPlan *plans, Sound *targets);
+	/*
+	 * Renders each of plans [1..numberOfPlans] into all of the corresponding targets [1..numberOfPlans],
+	 * which have to be mono Sounds with the number of samples of their plans; the work is spread over several threads.
+	 */
+
+Sound OverlapAddPlan_to_Sound (OverlapAddPlan me);
+
+/* End of file OverlapAdd.h */
+#endif
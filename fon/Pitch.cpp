@@ -21,6 +21,7 @@
 #include <ctype.h>
 #include "Sound_and_Spectrum.h"
 #include "Matrix_and_Pitch.h"
+#include "PitchPathFinder.h"
 
 #include "oo_DESTROY.h"
 #include "Pitch_def.h"
@@ -433,134 +434,10 @@ void Pitch_pathFinder (Pitch me, double silenceThreshold, double voicingThreshol
 		"Voiced/unvoiced cost = %g\nCeiling = %g\nPull formants = %d", silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost,
 		ceiling, pullFormants);
 	try {
-		long maxnCandidates = Pitch_getMaxnCandidates (me);
-		long place;
-		volatile double maximum, value;
-		double ceiling2 = pullFormants ? 2 * ceiling : ceiling;
-		/* Next three lines 20011015 */
-		double timeStepCorrection = 0.01 / my dx;
-		octaveJumpCost *= timeStepCorrection;
-		voicedUnvoicedCost *= timeStepCorrection;
-
-		my ceiling = ceiling;
-		autoNUMmatrix <double> delta (1, my nx, 1, maxnCandidates);
-		autoNUMmatrix <long> psi (1, my nx, 1, maxnCandidates);
-
-		for (long iframe = 1; iframe <= my nx; iframe ++) {
-			Pitch_Frame frame = & my frame [iframe];
-			double unvoicedStrength = silenceThreshold <= 0 ? 0 :
-				2 - frame->intensity / (silenceThreshold / (1 + voicingThreshold));
-			unvoicedStrength = voicingThreshold + (unvoicedStrength > 0 ? unvoicedStrength : 0);
-			for (long icand = 1; icand <= frame->nCandidates; icand ++) {
-				Pitch_Candidate candidate = & frame->candidate [icand];
-				int voiceless = candidate->frequency == 0 || candidate->frequency > ceiling2;
-				delta [iframe] [icand] = voiceless ? unvoicedStrength :
-					candidate->strength - octaveCost * NUMlog2 (ceiling / candidate->frequency);
-			}
-		}
-
-		/* Look for the most probable path through the maxima. */
-		/* There is a cost for the voiced/unvoiced transition, */
-		/* and a cost for a frequency jump. */
-
-		for (long iframe = 2; iframe <= my nx; iframe ++) {
-			Pitch_Frame prevFrame = & my frame [iframe - 1], curFrame = & my frame [iframe];
-			double *prevDelta = delta [iframe - 1], *curDelta = delta [iframe];
-			long *curPsi = psi [iframe];
-			for (long icand2 = 1; icand2 <= curFrame -> nCandidates; icand2 ++) {
-				double f2 = curFrame -> candidate [icand2]. frequency;
-				maximum = -1e30;
-				place = 0;
-				for (long icand1 = 1; icand1 <= prevFrame -> nCandidates; icand1 ++) {
-					double f1 = prevFrame -> candidate [icand1]. frequency;
-					double transitionCost;
-					bool previousVoiceless = f1 <= 0 || f1 >= ceiling2;
-					bool currentVoiceless = f2 <= 0 || f2 >= ceiling2;
-					if (currentVoiceless) {
-						if (previousVoiceless) {
-							transitionCost = 0;   // both voiceless
-						} else {
-							transitionCost = voicedUnvoicedCost;   // voiced-to-unvoiced transition
-						}
-					} else {
-						if (previousVoiceless) {
-							transitionCost = voicedUnvoicedCost;   // unvoiced-to-voiced transition
-							if (Melder_debug == 30) {
-								/*
-								 * Try to take into account a frequency jump across a voiceless stretch.
-								 */
-								long place1 = icand1;
-								for (long jframe = iframe - 2; jframe >= 1; jframe --) {
-									place1 = psi [jframe + 1] [place1];
-									f1 = my frame [jframe]. candidate [place1]. frequency;
-									if (f1 > 0 && f1 < ceiling) {
-										transitionCost += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
-										break;
-									}
-								}
-							}
-						} else {
-							transitionCost = octaveJumpCost * fabs (NUMlog2 (f1 / f2));   // both voiced
-						}
-					}
-					value = prevDelta [icand1] - transitionCost + curDelta [icand2];
-					//if (Melder_debug == 33) Melder_casual ("Frame %ld, current candidate %ld (delta %g), previous candidate %ld (delta %g), "
-					//	"transition cost %g, value %g, maximum %g", iframe, icand2, curDelta [icand2], icand1, prevDelta [icand1], transitionCost, value, maximum);
-					if (value > maximum) {
-						maximum = value;
-						place = icand1;
-					} else if (value == maximum) {
-						if (Melder_debug == 33) Melder_casual ("A tie in frame %ld, current candidate %ld, previous candidate %ld", iframe, icand2, icand1);
-					}
-				}
-				curDelta [icand2] = maximum;
-				curPsi [icand2] = place;
-			}
-		}
-
-		/* Find the end of the most probable path. */
-
-		place = 1;
-		maximum = delta [my nx] [place];
-		for (long icand = 2; icand <= my frame [my nx]. nCandidates; icand ++) {
-			if (delta [my nx] [icand] > maximum) {
-				place = icand;
-				maximum = delta [my nx] [place];
-			}
-		}
-
-		/* Backtracking: follow the path backwards. */
-
-		for (long iframe = my nx; iframe >= 1; iframe --) {
-			if (Melder_debug == 33) Melder_casual ("Frame %ld: swapping candidates 1 and %ld", iframe, place);
-			Pitch_Frame frame = & my frame [iframe];
-			structPitch_Candidate help = frame -> candidate [1];
-			frame -> candidate [1] = frame -> candidate [place];
-			frame -> candidate [place] = help;
-			place = psi [iframe] [place];   // This assignment is challenging to CodeWarrior 11.
-		}
-
-		/* Pull formants: devoice frames with frequencies between ceiling and ceiling2. */
-
-		if (ceiling2 > ceiling) {
-			if (Melder_debug == 33) Melder_casual ("Pulling formants...");
-			for (long iframe = my nx; iframe >= 1; iframe --) {
-				Pitch_Frame frame = & my frame [iframe];
-				Pitch_Candidate winner = & frame -> candidate [1];
-				double f = winner -> frequency;
-				if (f > ceiling && f <= ceiling2) {
-					for (long icand = 2; icand <= frame -> nCandidates; icand ++) {
-						Pitch_Candidate loser = & frame -> candidate [icand];
-						if (loser -> frequency == 0.0) {
-							structPitch_Candidate help = * winner;
-							* winner = * loser;
-							* loser = help;
-							break;
-						}
-					}
-				}
-			}
-		}
+		autoPitchPathFinder finder = Pitch_to_PitchPathFinder (me);
+		PitchPathFinder_setCosts (finder.peek(), silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost, ceiling, pullFormants);
+		PitchPathFinder_run (finder.peek());
+		Pitch_PitchPathFinder_apply (me, finder.peek());
 	} catch (MelderError) {
 		Melder_throw (me, ": path not found.");
 	}
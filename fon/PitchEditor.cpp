@@ -27,6 +27,13 @@ Thing_implement (PitchEditor, FunctionEditor, 0);
 #define HEIGHT_INTENS  6.0
 #define RADIUS  2.5
 
+/********** DESTRUCTION **********/
+
+void structPitchEditor :: v_destroy () {
+	forget (our pathFinder);
+	PitchEditor_Parent :: v_destroy ();
+}
+
 /********** MENU COMMANDS **********/
 
 static void menu_cb_setCeiling (EDITOR_ARGS) {
@@ -61,10 +68,20 @@ static void menu_cb_pathFinder (EDITOR_ARGS) {
 	EDITOR_DO
 		Pitch pitch = (Pitch) my data;
 		Editor_save (me, L"Path finder");
-		Pitch_pathFinder (pitch,
+		/*
+		 * Reuse the candidates and their logarithms from the previous run,
+		 * unless the candidates have been edited in the meantime.
+		 */
+		if (! my pathFinder || ! PitchPathFinder_isForPitch (my pathFinder, pitch)) {
+			forget (my pathFinder);
+			my pathFinder = Pitch_to_PitchPathFinder (pitch);
+		}
+		PitchPathFinder_setCosts (my pathFinder,
 			GET_REAL (L"Silence threshold"), GET_REAL (L"Voicing threshold"),
 			GET_REAL (L"Octave cost"), GET_REAL (L"Octave-jump cost"),
 			GET_REAL (L"Voiced/unvoiced cost"), GET_REAL (L"Ceiling"), GET_INTEGER (L"Pull formants"));
+		PitchPathFinder_run (my pathFinder);
+		Pitch_PitchPathFinder_apply (pitch, my pathFinder);
 		FunctionEditor_redraw (me);
 		Editor_broadcastDataChanged (me);
 	EDITOR_END
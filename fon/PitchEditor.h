@@ -20,9 +20,13 @@
  */
 
 #include "FunctionEditor.h"
-#include "Pitch.h"
+#include "PitchPathFinder.h"
 
 Thing_define (PitchEditor, FunctionEditor) {
+	PitchPathFinder pathFinder;   // kept between runs of the path finder, as long as the candidates do not change
+
+	void v_destroy ()
+		override;
 	void v_createMenus ()
 		override;
 	void v_createHelpMenuItems (EditorMenu menu)
@@ -0,0 +1,628 @@
+/* PitchPathFinder.cpp
+ *
+ * Copyright (C) 1992-2011,2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "PitchPathFinder.h"
+#include "MelderThread.h"
+
+#define PitchPathFinder_PRUNED  -1e30
+#define PitchPathFinder_isViable(delta)  ((delta) > 0.1 * PitchPathFinder_PRUNED)
+#define PitchPathFinder_MAXIMUM_NUMBER_OF_CANDIDATES  65535
+#define PitchPathFinder_FRAMES_PER_THREAD  5000
+#define PitchPathFinder_MINIMUM_NUMBER_OF_FORGOTTEN_FRAMES  1024
+
+Thing_implement (PitchPathFinder, Thing, 0);
+
+void structPitchPathFinder :: v_destroy () {
+	NUMvector_free <long> (firstCandidate, 0);
+	NUMvector_free <double> (intensity, 0);
+	NUMvector_free <double> (frequency, 0);
+	NUMvector_free <double> (strength, 0);
+	NUMvector_free <double> (log2Frequency, 0);
+	NUMvector_free <unsigned short> (psi, 0);
+	NUMvector_free <double> (delta, 1);
+	NUMvector_free <double> (newDelta, 1);
+	NUMvector_free <long> (survivors, 1);
+	NUMvector_free <long> (survivorStamps, 1);
+	NUMvector_free <long> (decision, 1);
+	NUMvector_free <double> (decidedFrequency, 1);
+	NUMvector_free <double> (decidedStrength, 1);
+	PitchPathFinder_Parent :: v_destroy ();
+}
+
+template <class T> static void grow (T **v, long lo, long oldHi, long newHi) {
+	T *newV = NUMvector <T> (lo, newHi);
+	if (*v) {
+		NUMvector_copyElements <T> (*v, newV, lo, oldHi);
+		NUMvector_free <T> (*v, lo);
+	}
+	*v = newV;
+}
+
+static void PitchPathFinder_growSearch (PitchPathFinder me, long numberOfCandidates) {
+	if (numberOfCandidates <= my maximumNumberOfCandidates) return;
+	if (numberOfCandidates > PitchPathFinder_MAXIMUM_NUMBER_OF_CANDIDATES)
+		Melder_throw ("Cannot handle more than ", PitchPathFinder_MAXIMUM_NUMBER_OF_CANDIDATES, " candidates in a frame.");
+	long oldMaximum = my maximumNumberOfCandidates;
+	grow <double> (& my delta, 1, oldMaximum, numberOfCandidates);
+	grow <double> (& my newDelta, 1, oldMaximum, numberOfCandidates);
+	grow <long> (& my survivors, 1, oldMaximum, numberOfCandidates);
+	grow <long> (& my survivorStamps, 1, oldMaximum, numberOfCandidates);
+	my maximumNumberOfCandidates = numberOfCandidates;
+}
+
+static inline long PitchPathFinder_getDecisionIndex (PitchPathFinder me, long iframe) {
+	return iframe - my firstStoredDecision + 1;
+}
+
+static void PitchPathFinder_growDecisions (PitchPathFinder me, long numberOfFrames) {
+	if (PitchPathFinder_getDecisionIndex (me, numberOfFrames) <= my decisionCapacity) return;
+	/*
+	 * Try to make room by moving the decisions that are still needed to the start.
+	 * These are the decisions that the caller has not forgotten,
+	 * and those of the frames whose candidates are still stored (PitchPathFinder_forgetDecidedFrames needs them).
+	 */
+	long firstKeptDecision = my numberOfForgottenDecisions + 1;
+	if (firstKeptDecision > my firstStoredFrame) firstKeptDecision = my firstStoredFrame;
+	long numberOfForgettableDecisions = firstKeptDecision - my firstStoredDecision;
+	if (numberOfForgettableDecisions >= my decisionCapacity / 2) {
+		long numberOfKeptDecisions = my numberOfDecidedFrames - firstKeptDecision + 1;
+		for (long i = 1; i <= numberOfKeptDecisions; i ++) {
+			my decision [i] = my decision [i + numberOfForgettableDecisions];
+			my decidedFrequency [i] = my decidedFrequency [i + numberOfForgettableDecisions];
+			my decidedStrength [i] = my decidedStrength [i + numberOfForgettableDecisions];
+		}
+		my firstStoredDecision = firstKeptDecision;
+		if (PitchPathFinder_getDecisionIndex (me, numberOfFrames) <= my decisionCapacity) return;
+	}
+	long numberOfNeededDecisions = PitchPathFinder_getDecisionIndex (me, numberOfFrames);
+	long newCapacity = 2 * my decisionCapacity > numberOfNeededDecisions ? 2 * my decisionCapacity : numberOfNeededDecisions;
+	grow <long> (& my decision, 1, my decisionCapacity, newCapacity);
+	grow <double> (& my decidedFrequency, 1, my decisionCapacity, newCapacity);
+	grow <double> (& my decidedStrength, 1, my decisionCapacity, newCapacity);
+	my decisionCapacity = newCapacity;
+}
+
+static inline long PitchPathFinder_getFirstCandidate (PitchPathFinder me, long iframe) {
+	return my firstCandidate [iframe - my firstStoredFrame];
+}
+
+static inline long PitchPathFinder_getNumberOfCandidates (PitchPathFinder me, long iframe) {
+	return my firstCandidate [iframe - my firstStoredFrame + 1] - my firstCandidate [iframe - my firstStoredFrame];
+}
+
+/********** CREATION **********/
+
+Thing_define (PitchPathFinder_copy_Args, Thing) {
+	Pitch pitch;
+	PitchPathFinder finder;
+	long firstFrame, lastFrame;
+};
+
+Thing_implement (PitchPathFinder_copy_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE PitchPathFinder_copy_thread (PitchPathFinder_copy_Args me) {
+	PitchPathFinder finder = my finder;
+	for (long iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
+		Pitch_Frame frame = & my pitch -> frame [iframe];
+		long offset = finder -> firstCandidate [iframe - 1] - 1;
+		finder -> intensity [iframe - 1] = frame -> intensity;
+		for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+			double frequency = frame -> candidate [icand]. frequency;
+			finder -> frequency [offset + icand] = frequency;
+			finder -> strength [offset + icand] = frame -> candidate [icand]. strength;
+			finder -> log2Frequency [offset + icand] = frequency == 0.0 ? 0.0 : NUMlog2 (frequency);
+		}
+	}
+	MelderThread_RETURN;
+}
+
+PitchPathFinder Pitch_to_PitchPathFinder (Pitch me) {
+	try {
+		autoPitchPathFinder thee = Thing_new (PitchPathFinder);
+		thy streaming = false;
+		thy timeStep = my dx;
+		thy numberOfFrames = my nx;
+		thy firstStoredFrame = 1;
+		thy firstStoredDecision = 1;
+		thy frameCapacity = my nx;
+		thy firstCandidate = NUMvector <long> (0, my nx);
+		long numberOfCandidates = 0, maximumNumberOfCandidates = 1;
+		for (long iframe = 1; iframe <= my nx; iframe ++) {
+			thy firstCandidate [iframe - 1] = numberOfCandidates;
+			long nCandidates = my frame [iframe]. nCandidates;
+			if (nCandidates < 1)
+				Melder_throw ("Frame ", iframe, " has no candidates.");
+			numberOfCandidates += nCandidates;
+			if (nCandidates > maximumNumberOfCandidates) maximumNumberOfCandidates = nCandidates;
+		}
+		thy firstCandidate [my nx] = numberOfCandidates;
+		thy candidateCapacity = numberOfCandidates;
+		thy intensity = NUMvector <double> (0, my nx - 1);
+		thy frequency = NUMvector <double> (0, numberOfCandidates - 1);
+		thy strength = NUMvector <double> (0, numberOfCandidates - 1);
+		thy log2Frequency = NUMvector <double> (0, numberOfCandidates - 1);
+		thy psi = NUMvector <unsigned short> (0, numberOfCandidates - 1);
+		PitchPathFinder_growSearch (thee.peek(), maximumNumberOfCandidates);
+		PitchPathFinder_growDecisions (thee.peek(), my nx);
+
+		/*
+		 * Copy the candidates and take the logarithms of their frequencies, in parallel.
+		 */
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > my nx / PitchPathFinder_FRAMES_PER_THREAD) numberOfThreads = my nx / PitchPathFinder_FRAMES_PER_THREAD;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		long numberOfFramesPerThread = (my nx - 1) / numberOfThreads + 1;
+		autoPitchPathFinder_copy_Args args [16];
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoPitchPathFinder_copy_Args arg = Thing_new (PitchPathFinder_copy_Args);
+			arg -> pitch = me;
+			arg -> finder = thee.peek();
+			arg -> firstFrame = 1 + (ithread - 1) * numberOfFramesPerThread;
+			arg -> lastFrame = ithread == numberOfThreads ? my nx : arg -> firstFrame + numberOfFramesPerThread - 1;
+			args [ithread - 1].reset (arg.transfer());
+		}
+		MelderThread_run (PitchPathFinder_copy_thread, args, numberOfThreads);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": no path finder created.");
+	}
+}
+
+PitchPathFinder PitchPathFinder_create (double timeStep, long maximumLatency) {
+	try {
+		autoPitchPathFinder me = Thing_new (PitchPathFinder);
+		my streaming = true;
+		my timeStep = timeStep;
+		my maximumLatency = maximumLatency;
+		my firstStoredFrame = 1;
+		my firstStoredDecision = 1;
+		my frameCapacity = 100;
+		my firstCandidate = NUMvector <long> (0, my frameCapacity);
+		my intensity = NUMvector <double> (0, my frameCapacity - 1);
+		my candidateCapacity = 1000;
+		my frequency = NUMvector <double> (0, my candidateCapacity - 1);
+		my strength = NUMvector <double> (0, my candidateCapacity - 1);
+		my log2Frequency = NUMvector <double> (0, my candidateCapacity - 1);
+		my psi = NUMvector <unsigned short> (0, my candidateCapacity - 1);
+		PitchPathFinder_growSearch (me.peek(), 15);
+		PitchPathFinder_growDecisions (me.peek(), 100);
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw ("Pitch path finder not created.");
+	}
+}
+
+void PitchPathFinder_setCosts (PitchPathFinder me, double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost,
+	double ceiling, bool pullFormants)
+{
+	my silenceThreshold = silenceThreshold;
+	my voicingThreshold = voicingThreshold;
+	my octaveCost = octaveCost;
+	/* Next three lines 20011015 */
+	double timeStepCorrection = 0.01 / my timeStep;
+	my octaveJumpCost = octaveJumpCost * timeStepCorrection;
+	my voicedUnvoicedCost = voicedUnvoicedCost * timeStepCorrection;
+	my ceiling = ceiling;
+	my pullFormants = pullFormants;
+	my ceiling2 = pullFormants ? 2 * ceiling : ceiling;
+}
+
+/********** THE SEARCH **********/
+
+/*
+ * Computes the path scores and back pointers of frame 'iframe' from the path scores of the previous frame.
+ *
+ * The octave jumps between voiced candidates are computed from the stored logarithms,
+ * which differs from the octave jumps computed from the frequency ratios, NUMlog2 (f1 / f2), in the last bits.
+ * So that this cannot change the path, a predecessor that comes within a rounding margin of the best one so far
+ * is compared with it by the frequency ratios (this resolves exact ties such as 100 and 400 Hz before 200 Hz
+ * in favour of the first candidate, as a plain comparison would), and the path score of the winner
+ * is computed from the frequency ratio as well. The path scores are therefore exactly those of the plain search.
+ */
+static inline double PitchPathFinder_octaveJump (double f1, double f2) {
+	return fabs (NUMlog2 (f1 / f2));
+}
+
+static void PitchPathFinder_step (PitchPathFinder me, long iframe) {
+	long first2 = PitchPathFinder_getFirstCandidate (me, iframe), n2 = PitchPathFinder_getNumberOfCandidates (me, iframe);
+	double ceiling = my ceiling, ceiling2 = my ceiling2;
+	double unvoicedStrength = my silenceThreshold <= 0 ? 0 :
+		2 - my intensity [iframe - my firstStoredFrame] / (my silenceThreshold / (1 + my voicingThreshold));
+	unvoicedStrength = my voicingThreshold + (unvoicedStrength > 0 ? unvoicedStrength : 0);
+	double *curDelta = my newDelta;
+	for (long icand = 1; icand <= n2; icand ++) {
+		double frequency = my frequency [first2 + icand - 1];
+		int voiceless = frequency == 0 || frequency > ceiling2;
+		curDelta [icand] = voiceless ? unvoicedStrength :
+			my strength [first2 + icand - 1] - my octaveCost * NUMlog2 (ceiling / frequency);
+	}
+	if (iframe == 1) {
+		for (long icand = 1; icand <= n2; icand ++) my psi [first2 + icand - 1] = 0;
+	} else {
+		/* Look for the most probable path through the maxima. */
+		/* There is a cost for the voiced/unvoiced transition, */
+		/* and a cost for a frequency jump. */
+		long first1 = PitchPathFinder_getFirstCandidate (me, iframe - 1), n1 = PitchPathFinder_getNumberOfCandidates (me, iframe - 1);
+		const double *prevDelta = my delta, *f1s = & my frequency [first1 - 1], *l1s = & my log2Frequency [first1 - 1];
+		double octaveJumpCost = my octaveJumpCost, voicedUnvoicedCost = my voicedUnvoicedCost;
+		volatile double maximum, value;
+		for (long icand2 = 1; icand2 <= n2; icand2 ++) {
+			double f2 = my frequency [first2 + icand2 - 1], l2 = my log2Frequency [first2 + icand2 - 1];
+			bool currentVoiceless = f2 <= 0 || f2 >= ceiling2;
+			long place = 0;
+			bool placeIsBothVoiced = false;
+			maximum = -1e30;
+			for (long icand1 = 1; icand1 <= n1; icand1 ++) {
+				double f1 = f1s [icand1];
+				double transitionCost;
+				bool previousVoiceless = f1 <= 0 || f1 >= ceiling2, bothVoiced = false;
+				if (currentVoiceless) {
+					if (previousVoiceless) {
+						transitionCost = 0;   // both voiceless
+					} else {
+						transitionCost = voicedUnvoicedCost;   // voiced-to-unvoiced transition
+					}
+				} else {
+					if (previousVoiceless) {
+						transitionCost = voicedUnvoicedCost;   // unvoiced-to-voiced transition
+						if (Melder_debug == 30) {
+							/*
+							 * Try to take into account a frequency jump across a voiceless stretch.
+							 */
+							long place1 = icand1;
+							for (long jframe = iframe - 2; jframe >= 1; jframe --) {
+								if (jframe >= my firstStoredFrame) {
+									place1 = my psi [PitchPathFinder_getFirstCandidate (me, jframe + 1) + place1 - 1];
+									f1 = my frequency [PitchPathFinder_getFirstCandidate (me, jframe) + place1 - 1];
+								} else {
+									jframe = my lastForgottenVoicedFrame;   // forgotten frames lie on the decided path
+									if (jframe == 0) break;
+									f1 = my lastForgottenVoicedFrequency;
+								}
+								if (f1 > 0 && f1 < ceiling) {
+									transitionCost += octaveJumpCost * fabs (NUMlog2 (f1 / f2)) / (iframe - jframe);
+									break;
+								}
+							}
+						}
+					} else {
+						transitionCost = octaveJumpCost * fabs (l1s [icand1] - l2);   // both voiced
+						bothVoiced = true;
+					}
+				}
+				value = prevDelta [icand1] - transitionCost + curDelta [icand2];
+				bool nearTie = place != 0 && (bothVoiced || placeIsBothVoiced) &&
+					fabs (value - maximum) <= 1e-9 * (1.0 + fabs (prevDelta [icand1]) + fabs (maximum) + octaveJumpCost);
+				if (nearTie) {
+					/*
+					 * Decide by the frequency ratios.
+					 */
+					volatile double exactValue = bothVoiced ?
+						prevDelta [icand1] - octaveJumpCost * PitchPathFinder_octaveJump (f1, f2) + curDelta [icand2] : value;
+					volatile double exactMaximum = placeIsBothVoiced ?
+						prevDelta [place] - octaveJumpCost * PitchPathFinder_octaveJump (f1s [place], f2) + curDelta [icand2] : maximum;
+					if (exactValue > exactMaximum) {
+						maximum = value;
+						place = icand1;
+						placeIsBothVoiced = bothVoiced;
+					} else if (exactValue == exactMaximum) {
+						if (Melder_debug == 33) Melder_casual ("A tie in frame %ld, current candidate %ld, previous candidate %ld", iframe, icand2, icand1);
+					}
+				} else if (value > maximum) {
+					maximum = value;
+					place = icand1;
+					placeIsBothVoiced = bothVoiced;
+				} else if (value == maximum) {
+					if (Melder_debug == 33) Melder_casual ("A tie in frame %ld, current candidate %ld, previous candidate %ld", iframe, icand2, icand1);
+				}
+			}
+			if (placeIsBothVoiced)
+				maximum = prevDelta [place] - octaveJumpCost * PitchPathFinder_octaveJump (f1s [place], f2) + curDelta [icand2];
+			curDelta [icand2] = maximum;
+			my psi [first2 + icand2 - 1] = place;
+		}
+	}
+	my newDelta = my delta;
+	my delta = curDelta;
+}
+
+/*
+ * Records candidate 'place' (in the order of addition) as being on the path in frame 'iframe',
+ * and records the winner, which is a voiceless candidate instead if a formant has to be pulled.
+ */
+static void PitchPathFinder_decide (PitchPathFinder me, long iframe, long place) {
+	long first = PitchPathFinder_getFirstCandidate (me, iframe), n = PitchPathFinder_getNumberOfCandidates (me, iframe);
+	long winner = place;
+	double f = my frequency [first + place - 1];
+	if (my ceiling2 > my ceiling && f > my ceiling && f <= my ceiling2) {
+		/*
+		 * Pull formants: devoice frames with frequencies between ceiling and ceiling2,
+		 * by taking the first voiceless candidate after the winner has been swapped into the first position.
+		 */
+		for (long icand = 2; icand <= n; icand ++) {
+			long original = icand == place ? 1 : icand;
+			if (my frequency [first + original - 1] == 0.0) {
+				winner = original;
+				break;
+			}
+		}
+	}
+	long index = PitchPathFinder_getDecisionIndex (me, iframe);
+	my decision [index] = place;
+	my decidedFrequency [index] = my frequency [first + winner - 1];
+	my decidedStrength [index] = my strength [first + winner - 1];
+}
+
+/*
+ * Decides frames iframe, iframe - 1, ..., numberOfDecidedFrames + 1 by following the back pointers from 'place'.
+ */
+static void PitchPathFinder_decideBackwards (PitchPathFinder me, long iframe, long place) {
+	for (long jframe = iframe; jframe > my numberOfDecidedFrames; jframe --) {
+		PitchPathFinder_decide (me, jframe, place);
+		place = my psi [PitchPathFinder_getFirstCandidate (me, jframe) + place - 1];
+	}
+	my numberOfDecidedFrames = iframe;
+}
+
+/*
+ * Follows the back pointers from candidate 'place' in the last frame down to frame 'iframe'.
+ */
+static long PitchPathFinder_traceBack (PitchPathFinder me, long place, long iframe) {
+	for (long jframe = my numberOfFrames; jframe > iframe; jframe --)
+		place = my psi [PitchPathFinder_getFirstCandidate (me, jframe) + place - 1];
+	return place;
+}
+
+static long PitchPathFinder_getBestCandidateOfLastFrame (PitchPathFinder me) {
+	long n = PitchPathFinder_getNumberOfCandidates (me, my numberOfFrames);
+	long place = 1;
+	double maximum = my delta [place];
+	for (long icand = 2; icand <= n; icand ++) {
+		if (my delta [icand] > maximum) {
+			place = icand;
+			maximum = my delta [place];
+		}
+	}
+	return place;
+}
+
+void PitchPathFinder_run (PitchPathFinder me) {
+	Melder_assert (! my streaming && my firstStoredDecision == 1);
+	my numberOfDecidedFrames = 0;
+	my numberOfForgottenDecisions = 0;
+	for (long iframe = 1; iframe <= my numberOfFrames; iframe ++)
+		PitchPathFinder_step (me, iframe);
+	PitchPathFinder_finish (me);
+}
+
+void PitchPathFinder_finish (PitchPathFinder me) {
+	if (my numberOfDecidedFrames == my numberOfFrames) return;
+	/* Find the end of the most probable path. */
+	long place = PitchPathFinder_getBestCandidateOfLastFrame (me);
+	/* Backtracking: follow the path backwards. */
+	PitchPathFinder_decideBackwards (me, my numberOfFrames, place);
+	/*
+	 * Frames that are added later have to continue this path.
+	 */
+	long n = PitchPathFinder_getNumberOfCandidates (me, my numberOfFrames);
+	for (long icand = 1; icand <= n; icand ++)
+		if (icand != place) my delta [icand] = PitchPathFinder_PRUNED;
+}
+
+/********** STREAMING **********/
+
+static void PitchPathFinder_forgetDecidedFrames (PitchPathFinder me) {
+	/*
+	 * Keep the last decided frame, because the next frame needs its candidates.
+	 */
+	long firstKeptFrame = my numberOfDecidedFrames;
+	long numberOfForgettableFrames = firstKeptFrame - my firstStoredFrame;
+	if (numberOfForgettableFrames < PitchPathFinder_MINIMUM_NUMBER_OF_FORGOTTEN_FRAMES ||
+		numberOfForgettableFrames < my numberOfFrames - firstKeptFrame) return;   // not yet worth the copying
+	for (long iframe = firstKeptFrame - 1; iframe >= my firstStoredFrame; iframe --) {
+		double f = my frequency [PitchPathFinder_getFirstCandidate (me, iframe) + my decision [PitchPathFinder_getDecisionIndex (me, iframe)] - 1];
+		if (f > 0 && f < my ceiling) {
+			my lastForgottenVoicedFrame = iframe;
+			my lastForgottenVoicedFrequency = f;
+			break;
+		}
+	}
+	long firstKeptIndex = firstKeptFrame - my firstStoredFrame, firstKeptCandidate = my firstCandidate [firstKeptIndex];
+	long numberOfKeptFrames = my numberOfFrames - firstKeptFrame + 1;
+	long numberOfKeptCandidates = my firstCandidate [firstKeptIndex + numberOfKeptFrames] - firstKeptCandidate;
+	for (long j = 0; j <= numberOfKeptFrames; j ++)
+		my firstCandidate [j] = my firstCandidate [firstKeptIndex + j] - firstKeptCandidate;
+	for (long j = 0; j < numberOfKeptFrames; j ++)
+		my intensity [j] = my intensity [firstKeptIndex + j];
+	for (long i = 0; i < numberOfKeptCandidates; i ++) {
+		my frequency [i] = my frequency [firstKeptCandidate + i];
+		my strength [i] = my strength [firstKeptCandidate + i];
+		my log2Frequency [i] = my log2Frequency [firstKeptCandidate + i];
+		my psi [i] = my psi [firstKeptCandidate + i];
+	}
+	my firstStoredFrame = firstKeptFrame;
+}
+
+/*
+ * Decides the frames through which all surviving paths go.
+ */
+static void PitchPathFinder_decideMergedFrames (PitchPathFinder me) {
+	long numberOfSurvivors = 0, n = PitchPathFinder_getNumberOfCandidates (me, my numberOfFrames);
+	for (long icand = 1; icand <= n; icand ++)
+		if (PitchPathFinder_isViable (my delta [icand])) my survivors [++ numberOfSurvivors] = icand;
+	for (long iframe = my numberOfFrames; iframe > my numberOfDecidedFrames; iframe --) {
+		if (numberOfSurvivors == 1) {
+			PitchPathFinder_decideBackwards (me, iframe, my survivors [1]);
+			return;
+		}
+		if (iframe == my numberOfDecidedFrames + 1) return;   // the paths have not merged in any undecided frame
+		/*
+		 * Replace the survivors by their distinct predecessors.
+		 */
+		long first = PitchPathFinder_getFirstCandidate (me, iframe), numberOfPredecessors = 0;
+		my stamp ++;
+		for (long isurvivor = 1; isurvivor <= numberOfSurvivors; isurvivor ++) {
+			long predecessor = my psi [first + my survivors [isurvivor] - 1];
+			if (my survivorStamps [predecessor] != my stamp) {
+				my survivorStamps [predecessor] = my stamp;
+				my survivors [++ numberOfPredecessors] = predecessor;
+			}
+		}
+		numberOfSurvivors = numberOfPredecessors;
+	}
+}
+
+/*
+ * Decides the frames that are older than the maximum latency, by following the currently best path,
+ * and removes the paths that do not go through the decided candidate.
+ */
+static void PitchPathFinder_decideLateFrames (PitchPathFinder me) {
+	long lastFrameToDecide = my numberOfFrames - my maximumLatency;
+	if (my maximumLatency <= 0 || lastFrameToDecide <= my numberOfDecidedFrames) return;
+	long place = PitchPathFinder_traceBack (me, PitchPathFinder_getBestCandidateOfLastFrame (me), lastFrameToDecide);
+	PitchPathFinder_decideBackwards (me, lastFrameToDecide, place);
+	long n = PitchPathFinder_getNumberOfCandidates (me, my numberOfFrames);
+	for (long icand = 1; icand <= n; icand ++)
+		if (PitchPathFinder_isViable (my delta [icand]) && PitchPathFinder_traceBack (me, icand, lastFrameToDecide) != place)
+			my delta [icand] = PitchPathFinder_PRUNED;
+}
+
+void PitchPathFinder_addFrame (PitchPathFinder me, double intensity,
+	long numberOfCandidates, const double frequency [], const double strength [])
+{
+	try {
+		Melder_assert (my streaming);
+		if (numberOfCandidates < 1)
+			Melder_throw ("A frame should have at least one candidate.");
+		PitchPathFinder_forgetDecidedFrames (me);
+		PitchPathFinder_growSearch (me, numberOfCandidates);
+		PitchPathFinder_growDecisions (me, my numberOfFrames + 1);
+		long index = my numberOfFrames + 1 - my firstStoredFrame;
+		if (index + 1 > my frameCapacity) {
+			long newCapacity = 2 * my frameCapacity;
+			grow <long> (& my firstCandidate, 0, my frameCapacity, newCapacity);
+			grow <double> (& my intensity, 0, my frameCapacity - 1, newCapacity - 1);
+			my frameCapacity = newCapacity;
+		}
+		long first = my firstCandidate [index];
+		if (first + numberOfCandidates > my candidateCapacity) {
+			long newCapacity = 2 * (first + numberOfCandidates);
+			grow <double> (& my frequency, 0, my candidateCapacity - 1, newCapacity - 1);
+			grow <double> (& my strength, 0, my candidateCapacity - 1, newCapacity - 1);
+			grow <double> (& my log2Frequency, 0, my candidateCapacity - 1, newCapacity - 1);
+			grow <unsigned short> (& my psi, 0, my candidateCapacity - 1, newCapacity - 1);
+			my candidateCapacity = newCapacity;
+		}
+		/*
+		 * Change without error.
+		 */
+		my intensity [index] = intensity;
+		for (long icand = 1; icand <= numberOfCandidates; icand ++) {
+			my frequency [first + icand - 1] = frequency [icand];
+			my strength [first + icand - 1] = strength [icand];
+			my log2Frequency [first + icand - 1] = frequency [icand] == 0.0 ? 0.0 : NUMlog2 (frequency [icand]);
+		}
+		my firstCandidate [index + 1] = first + numberOfCandidates;
+		my numberOfFrames += 1;
+		PitchPathFinder_step (me, my numberOfFrames);
+		PitchPathFinder_decideMergedFrames (me);
+		PitchPathFinder_decideLateFrames (me);
+	} catch (MelderError) {
+		Melder_throw (me, ": frame not added.");
+	}
+}
+
+long PitchPathFinder_getNumberOfDecidedFrames (PitchPathFinder me) {
+	return my numberOfDecidedFrames;
+}
+
+void PitchPathFinder_getDecidedCandidate (PitchPathFinder me, long iframe, double *frequency, double *strength) {
+	Melder_assert (iframe > my numberOfForgottenDecisions && iframe <= my numberOfDecidedFrames);
+	long index = PitchPathFinder_getDecisionIndex (me, iframe);
+	if (frequency) *frequency = my decidedFrequency [index];
+	if (strength) *strength = my decidedStrength [index];
+}
+
+void PitchPathFinder_forgetDecisions (PitchPathFinder me, long lastFrame) {
+	Melder_assert (lastFrame <= my numberOfDecidedFrames);
+	if (lastFrame > my numberOfForgottenDecisions) my numberOfForgottenDecisions = lastFrame;
+}
+
+/********** PITCH **********/
+
+bool PitchPathFinder_isForPitch (PitchPathFinder me, Pitch pitch) {
+	if (my streaming || my numberOfFrames != pitch -> nx) return false;
+	for (long iframe = 1; iframe <= my numberOfFrames; iframe ++) {
+		Pitch_Frame frame = & pitch -> frame [iframe];
+		long first = PitchPathFinder_getFirstCandidate (me, iframe), n = PitchPathFinder_getNumberOfCandidates (me, iframe);
+		if (frame -> nCandidates != n || frame -> intensity != my intensity [iframe - 1]) return false;
+		for (long icand = 1; icand <= n; icand ++) {
+			Pitch_Candidate candidate = & frame -> candidate [icand];
+			long jcand = 0;
+			while (jcand < n && (my frequency [first + jcand] != candidate -> frequency || my strength [first + jcand] != candidate -> strength))
+				jcand ++;
+			if (jcand == n) return false;
+		}
+	}
+	return true;
+}
+
+void Pitch_PitchPathFinder_apply (Pitch me, PitchPathFinder thee) {
+	Melder_assert (! thy streaming && thy numberOfFrames == my nx && thy numberOfDecidedFrames == my nx && thy numberOfForgottenDecisions == 0);
+	my ceiling = thy ceiling;
+	for (long iframe = my nx; iframe >= 1; iframe --) {
+		Pitch_Frame frame = & my frame [iframe];
+		long first = PitchPathFinder_getFirstCandidate (thee, iframe), place = thy decision [PitchPathFinder_getDecisionIndex (thee, iframe)];
+		Melder_assert (frame -> nCandidates == PitchPathFinder_getNumberOfCandidates (thee, iframe));
+		for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+			frame -> candidate [icand]. frequency = thy frequency [first + icand - 1];
+			frame -> candidate [icand]. strength = thy strength [first + icand - 1];
+		}
+		if (Melder_debug == 33) Melder_casual ("Frame %ld: swapping candidates 1 and %ld", iframe, place);
+		structPitch_Candidate help = frame -> candidate [1];
+		frame -> candidate [1] = frame -> candidate [place];
+		frame -> candidate [place] = help;
+	}
+
+	/* Pull formants: devoice frames with frequencies between ceiling and ceiling2. */
+
+	if (thy ceiling2 > thy ceiling) {
+		if (Melder_debug == 33) Melder_casual ("Pulling formants...");
+		for (long iframe = my nx; iframe >= 1; iframe --) {
+			Pitch_Frame frame = & my frame [iframe];
+			Pitch_Candidate winner = & frame -> candidate [1];
+			double f = winner -> frequency;
+			if (f > thy ceiling && f <= thy ceiling2) {
+				for (long icand = 2; icand <= frame -> nCandidates; icand ++) {
+					Pitch_Candidate loser = & frame -> candidate [icand];
+					if (loser -> frequency == 0.0) {
+						structPitch_Candidate help = * winner;
+						* winner = * loser;
+						* loser = help;
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+/* End of file PitchPathFinder.cpp */
@@ -0,0 +1,118 @@
+#ifndef _PitchPathFinder_h_
+#define _PitchPathFinder_h_
+/* PitchPathFinder.h
+ *
+ * Copyright (C) 1992-2011,2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Pitch.h"
+
+/*
+ * The Viterbi search for the best path through the pitch candidates.
+ *
+ * The finder keeps its own copy of the candidates, in the order in which they were added,
+ * together with the base-2 logarithms of their frequencies, which are computed only once.
+ * For the search it keeps the path scores of the last frame only, and per candidate a 16-bit back pointer.
+ *
+ * There are two ways to use it:
+ * 1. Pitch_to_PitchPathFinder copies all the frames of a Pitch; after setCosts, run decides all the frames,
+ *    and can be repeated with different costs; apply then puts the winning candidates first in the Pitch.
+ * 2. PitchPathFinder_create starts an empty streaming finder; after setCosts, frames are added one by one,
+ *    and a frame is decided as soon as all the surviving paths go through the same candidate in that frame
+ *    (which gives exactly the result of a complete search),
+ *    or, if that takes longer than the maximum latency, by a path from the currently best candidate,
+ *    to which all later paths are then kept. The candidates of a frame are forgotten soon after it has been decided;
+ *    its decision is kept until the caller has read it and calls PitchPathFinder_forgetDecisions.
+ *    With a maximum latency, and a caller that forgets the decisions it has read,
+ *    the memory used stays bounded however many frames are added.
+ */
+Thing_define (PitchPathFinder, Thing) {
+	bool streaming;
+	double timeStep;
+	long maximumLatency;   // in frames; 0 means that streaming decisions wait until the paths merge
+	/*
+	 * The costs, as in Pitch_pathFinder.
+	 */
+	double silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost, ceiling;
+	bool pullFormants;
+	double ceiling2;
+	/*
+	 * The frames that have not been forgotten: firstStoredFrame .. numberOfFrames.
+	 * Stored frame 'iframe' has its candidates at [firstCandidate [iframe - firstStoredFrame] .. firstCandidate [iframe - firstStoredFrame + 1] - 1].
+	 */
+	long numberOfFrames, firstStoredFrame, frameCapacity, candidateCapacity;
+	long *firstCandidate;   // [0..frameCapacity]
+	double *intensity;   // [0..frameCapacity-1]
+	double *frequency, *strength, *log2Frequency;   // [0..candidateCapacity-1]
+	unsigned short *psi;   // [0..candidateCapacity-1]: the best candidate in the previous frame
+	/*
+	 * The search.
+	 */
+	long maximumNumberOfCandidates;
+	double *delta, *newDelta;   // [1..maximumNumberOfCandidates]: path scores in the last frame
+	long *survivors, *survivorStamps, stamp;   // [1..maximumNumberOfCandidates]
+	/*
+	 * The decisions that have not been forgotten: firstStoredDecision .. numberOfDecidedFrames.
+	 * Frame 'iframe' has its decision at [iframe - firstStoredDecision + 1].
+	 */
+	long numberOfDecidedFrames, numberOfForgottenDecisions, firstStoredDecision, decisionCapacity;
+	long *decision;   // [1..decisionCapacity]: the candidate on the path, numbered in the order of addition
+	double *decidedFrequency, *decidedStrength;   // [1..decisionCapacity]: the winner, after pulling formants
+	/*
+	 * For the look-back across voiceless stretches (Melder_debug 30):
+	 * the last frame before firstStoredFrame whose decided frequency lies between 0 and the ceiling (0 if none).
+	 */
+	long lastForgottenVoicedFrame;
+	double lastForgottenVoicedFrequency;
+
+	void v_destroy ()
+		override;
+};
+
+PitchPathFinder Pitch_to_PitchPathFinder (Pitch me);
+PitchPathFinder PitchPathFinder_create (double timeStep, long maximumLatency);
+
+void PitchPathFinder_setCosts (PitchPathFinder me, double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost,
+	double ceiling, bool pullFormants);
+
+void PitchPathFinder_run (PitchPathFinder me);
+	/* Decides all frames anew with the current costs; not for streaming finders. */
+bool PitchPathFinder_isForPitch (PitchPathFinder me, Pitch pitch);
+	/* Does the Pitch still have the same frames and candidates (in any order) as when the finder was made from it? */
+void Pitch_PitchPathFinder_apply (Pitch me, PitchPathFinder thee);
+	/*
+	 * Puts the candidates of every frame in the order of the finder, with the winner first,
+	 * and sets the ceiling of the Pitch.
+	 */
+
+void PitchPathFinder_addFrame (PitchPathFinder me, double intensity,
+	long numberOfCandidates, const double frequency [], const double strength []);
+	/* frequency [1..numberOfCandidates], strength [1..numberOfCandidates]; for streaming finders. */
+void PitchPathFinder_finish (PitchPathFinder me);
+	/* Decides all remaining frames, as at the end of a complete search. */
+long PitchPathFinder_getNumberOfDecidedFrames (PitchPathFinder me);
+void PitchPathFinder_getDecidedCandidate (PitchPathFinder me, long iframe, double *frequency, double *strength);
+	/* For the decided frames that have not been forgotten. */
+void PitchPathFinder_forgetDecisions (PitchPathFinder me, long lastFrame);
+	/*
+	 * The caller will not ask for the decisions of frames 1 .. lastFrame any longer,
+	 * so that their memory can be reused. Precondition: lastFrame <= PitchPathFinder_getNumberOfDecidedFrames (me).
+	 */
+
+/* End of file PitchPathFinder.h */
+#endif
@@ -207,6 +207,48 @@ void PointProcess_addPoint (PointProcess me, double t) {
 	}
 }
 
+void PointProcess_addPoints (PointProcess me, long numberOfPoints, const double t []) {
+	try {
+		if (numberOfPoints <= 0) return;
+		/*
+		 * Create without change.
+		 */
+		autoNUMvector <double> newTimes (1, numberOfPoints);
+		bool sorted = true;
+		for (long i = 1; i <= numberOfPoints; i ++) {
+			if (t [i] == NUMundefined)
+				Melder_throw ("Cannot add a point at an undefined time.");
+			newTimes [i] = t [i];
+			if (i > 1 && t [i] < t [i - 1]) sorted = false;
+		}
+		if (! sorted) NUMsort_d (numberOfPoints, newTimes.peek());
+		long maxnt = my nt + numberOfPoints > my maxnt ? my nt + numberOfPoints : my maxnt;
+		autoNUMvector <double> merged (1, maxnt);
+		/*
+		 * Merge the two sorted lists in a single pass. A new time that already occurs is not added again;
+		 * since equal existing times come first, this leaves the existing points alone.
+		 */
+		long i = 1, j = 1, nt = 0;
+		while (i <= my nt || j <= numberOfPoints) {
+			if (j > numberOfPoints || (i <= my nt && my t [i] <= newTimes [j])) {
+				merged [++ nt] = my t [i ++];
+			} else {
+				double next = newTimes [j ++];
+				if (nt == 0 || next != merged [nt]) merged [++ nt] = next;
+			}
+		}
+		/*
+		 * Change without error.
+		 */
+		NUMvector_free (my t, 1);
+		my t = merged.transfer();
+		my nt = nt;
+		my maxnt = maxnt;
+	} catch (MelderError) {
+		Melder_throw (me, ": points not added.");
+	}
+}
+
 void PointProcess_removePoint (PointProcess me, long index) {
 	if (index < 1 || index > my nt) return;
 	for (long i = index; i < my nt; i ++)
@@ -264,9 +306,7 @@ PointProcess PointProcesses_union (PointProcess me, PointProcess thee) {
 		autoPointProcess him = Data_copy (me);
 		if (thy xmin < my xmin) his xmin = thy xmin;
 		if (thy xmax > my xmax) his xmax = thy xmax;
-		for (long i = 1; i <= thy nt; i ++) {
-			PointProcess_addPoint (him.peek(), thy t [i]);
-		}
+		PointProcess_addPoints (him.peek(), thy nt, thy t);
 		return him.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, " & ", thee, ": union not computed.");
@@ -295,9 +335,20 @@ PointProcess PointProcesses_intersection (PointProcess me, PointProcess thee) {
 		autoPointProcess him = Data_copy (me);
 		if (thy xmin > my xmin) his xmin = thy xmin;
 		if (thy xmax < my xmax) his xmax = thy xmax;
-		for (long i = my nt; i >= 1; i --)
-			if (! PointProcess_findPoint (thee, my t [i]))
-				PointProcess_removePoint (him.peek(), i);
+		/*
+		 * Both sets of times are sorted, so a single merging walk suffices.
+		 */
+		long numberOfPoints = 0;
+		for (long i = 1, j = 1; i <= my nt && j <= thy nt; ) {
+			if (my t [i] < thy t [j]) {
+				i ++;
+			} else if (my t [i] > thy t [j]) {
+				j ++;
+			} else {
+				his t [++ numberOfPoints] = my t [i ++];
+			}
+		}
+		his nt = numberOfPoints;
 		return him.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, " & ", thee, ": intersection not computed.");
@@ -307,9 +358,13 @@ PointProcess PointProcesses_intersection (PointProcess me, PointProcess thee) {
 PointProcess PointProcesses_difference (PointProcess me, PointProcess thee) {
 	try {
 		autoPointProcess him = Data_copy (me);
-		for (long i = my nt; i >= 1; i --)
-			if (PointProcess_findPoint (thee, my t [i]))
-				PointProcess_removePoint (him.peek(), i);
+		long numberOfPoints = 0;
+		for (long i = 1, j = 1; i <= my nt; i ++) {
+			while (j <= thy nt && thy t [j] < my t [i]) j ++;
+			if (j > thy nt || thy t [j] != my t [i])
+				his t [++ numberOfPoints] = my t [i];
+		}
+		his nt = numberOfPoints;
 		return him.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, " & ", thee, ": difference not computed.");
@@ -320,10 +375,13 @@ void PointProcess_fill (PointProcess me, double tmin, double tmax, double period
 	try {
 		if (tmax <= tmin) tmin = my xmin, tmax = my xmax;   // autowindowing
 		long n = floor ((tmax - tmin) / period);
+		if (n < 1) return;
+		autoNUMvector <double> times (1, n);
 		double t = 0.5 * (tmin + tmax - n * period);
 		for (long i = 1; i <= n; i ++, t += period) {
-			PointProcess_addPoint (me, t);
+			times [i] = t;
 		}
+		PointProcess_addPoints (me, n, times.peek());
 	} catch (MelderError) {
 		Melder_throw (me, ": not filled.");
 	}
@@ -357,7 +415,7 @@ long PointProcess_getWindowPoints (PointProcess me, double tmin, double tmax, lo
 	return imax - imin + 1;
 }
 
-static int PointProcess_isPeriod (PointProcess me, long ileft, double minimumPeriod, double maximumPeriod, double maximumPeriodFactor) {
+int PointProcess_isPeriod (PointProcess me, long ileft, double minimumPeriod, double maximumPeriod, double maximumPeriodFactor) {
 	/*
 	 * This function answers the question: is the interval from point 'ileft' to point 'ileft+1' a period?
 	 */
@@ -33,6 +33,13 @@ long PointProcess_getHighIndex (PointProcess me, double t);
 long PointProcess_getNearestIndex (PointProcess me, double t);
 long PointProcess_getWindowPoints (PointProcess me, double tmin, double tmax, long *imin, long *imax);
 void PointProcess_addPoint (PointProcess me, double t);
+void PointProcess_addPoints (PointProcess me, long numberOfPoints, const double t []);
+/*
+	Adds the times t [1..numberOfPoints], in any order; a time that already occurs (in the PointProcess
+	or earlier in t) is not added again. The points that were already there are kept as they are.
+	The new times are sorted and merged with the existing ones in a single pass,
+	which takes O (n + m log m) time instead of O (n m) for repeated calls to PointProcess_addPoint.
+*/
 long PointProcess_findPoint (PointProcess me, double t);
 void PointProcess_removePoint (PointProcess me, long index);
 void PointProcess_removePointNear (PointProcess me, double t);
@@ -46,6 +53,8 @@ PointProcess PointProcesses_difference (PointProcess me, PointProcess thee);
 void PointProcess_fill (PointProcess me, double tmin, double tmax, double period);
 void PointProcess_voice (PointProcess me, double period, double maxT);
 
+int PointProcess_isPeriod (PointProcess me, long ileft, double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
+	/* Is the interval from point ileft to point ileft + 1 a period? */
 long PointProcess_getNumberOfPeriods (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
 double PointProcess_getMeanPeriod (PointProcess me, double tmin, double tmax,
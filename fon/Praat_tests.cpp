@@ -6,6 +6,9 @@
 /* 24 May 2011: C++ */
 
 #include "Praat_tests.h"
+#include "AudioRingBuffer.h"
+#include "PitchPathFinder.h"
+#include "../external/portaudio/portaudio.h"
 
 #include "enums_getText.h"
 #include "Praat_tests_enums.h"
@@ -18,6 +21,154 @@
 
 constexpr char32 greeting [] {U"Hello?"};
 
+static short ringBufferTestSample (int64 iframe, int ichan) {
+	return (short) round (30000.0 * sin (0.01 * iframe + ichan));   // test/fon/SoundRecorder_ringBuffer.praat computes the same
+}
+
+static void checkAudioRingBuffer (int64 numberOfFrames, wchar_t *fileName) {
+	/*
+	 * Stream synthetic blocks of random sizes through a small ring buffer and a background writer,
+	 * as the SoundRecorder does with the blocks from the audio input, but without waiting for hardware.
+	 */
+	const int numberOfChannels = 2;
+	const long maximumBlockSize = 700;
+	long memorySize = (long) (numberOfFrames / 3 + 1);
+	autoAudioRingBuffer ringBuffer = AudioRingBuffer_create (numberOfChannels, 1000);
+	autoNUMvector <short> memory ((long) 0, memorySize * numberOfChannels - 1);
+	autoAudioStreamWriter writer = AudioStreamWriter_create (ringBuffer.peek(), memory.peek(), memorySize);
+	if (fileName [0] != '\0') {
+		structMelderFile file = { 0 };
+		Melder_relativePathToFile (fileName, & file);
+		AudioStreamWriter_openFile (writer.peek(), & file, wcsstr (fileName, L".flac") ? Melder_FLAC : Melder_WAV, 44100);
+	}
+	AudioStreamWriter_start (writer.peek());
+	short block [maximumBlockSize * numberOfChannels];
+	for (int64 iframe = 0; iframe < numberOfFrames; ) {
+		long blockSize = NUMrandomInteger (1, maximumBlockSize);
+		if (blockSize > numberOfFrames - iframe) blockSize = (long) (numberOfFrames - iframe);
+		for (long i = 0; i < blockSize; i ++)
+			for (int ichan = 0; ichan < numberOfChannels; ichan ++)
+				block [i * numberOfChannels + ichan] = ringBufferTestSample (iframe + i, ichan);
+		while ((long) ringBuffer -> capacity - AudioRingBuffer_getNumberOfReadableFrames (ringBuffer.peek()) < blockSize)
+			Pa_Sleep (1);   // unlike an audio device, we can wait for the writer
+		if (AudioRingBuffer_write (ringBuffer.peek(), block, blockSize) != blockSize)
+			Melder_throw ("Ring buffer refused frames although there was room.");
+		iframe += blockSize;
+	}
+	AudioStreamWriter_stop (writer.peek());
+	if (ringBuffer -> numberOfDroppedFrames != 0 || ringBuffer -> numberOfDropouts != 0)
+		Melder_throw ("Unexpected drop-outs.");
+	long numberOfFramesInMemory = AudioStreamWriter_getNumberOfFramesInMemory (writer.peek());
+	if (numberOfFramesInMemory != (numberOfFrames < memorySize ? numberOfFrames : memorySize))
+		Melder_throw ("Wrong number of frames in memory: ", numberOfFramesInMemory, ".");
+	for (long iframe = 0; iframe < numberOfFramesInMemory; iframe ++)
+		for (int ichan = 0; ichan < numberOfChannels; ichan ++)
+			if (memory [iframe * numberOfChannels + ichan] != ringBufferTestSample (iframe, ichan))
+				Melder_throw ("Wrong sample in memory at frame ", iframe, ".");
+	if (fileName [0] != '\0' && writer -> numberOfFramesInFile != numberOfFrames)
+		Melder_throw ("Wrong number of frames in file: ", writer -> numberOfFramesInFile, ".");
+	MelderInfo_writeLine (L"Streamed ", Melder_integer (numberOfFrames), L" frames, ", Melder_integer (numberOfFramesInMemory), L" of them into memory.");
+
+	/*
+	 * Overflow: without a consumer, the frames that do not fit are counted, and a run of overfull writes is one drop-out.
+	 */
+	autoAudioRingBuffer fullRingBuffer = AudioRingBuffer_create (1, 1024);
+	short silence [500] = { 0 };
+	long numberOfFramesWritten = 0;
+	for (int iblock = 1; iblock <= 6; iblock ++)
+		numberOfFramesWritten += AudioRingBuffer_write (fullRingBuffer.peek(), silence, 500);
+	if (numberOfFramesWritten != 1024 || fullRingBuffer -> numberOfDroppedFrames != 3000 - 1024 || fullRingBuffer -> numberOfDropouts != 1)
+		Melder_throw ("Wrong overflow accounting.");
+	short smallMemory [512];
+	autoAudioStreamWriter smallWriter = AudioStreamWriter_create (fullRingBuffer.peek(), smallMemory, 512);
+	AudioStreamWriter_drain (smallWriter.peek());
+	if (! AudioRingBuffer_isClosed (fullRingBuffer.peek()) || AudioStreamWriter_getNumberOfFramesInMemory (smallWriter.peek()) != 512)
+		Melder_throw ("A full writer should close the ring buffer.");
+	MelderInfo_writeLine (L"Overflow: ", Melder_integer (fullRingBuffer -> numberOfDroppedFrames), L" frames dropped in ",
+		Melder_integer (fullRingBuffer -> numberOfDropouts), L" drop-out.");
+}
+
+static void checkPitchPathFinder (int64 numberOfFrames, long maximumLatency) {
+	/*
+	 * Random candidates, many of them at octave distances, so that there are exact ties.
+	 */
+	const long maximumNumberOfCandidates = 8;
+	autoPitch pitch = Pitch_create (0.0, numberOfFrames * 0.01, numberOfFrames, 0.01, 0.005, 600.0, maximumNumberOfCandidates);
+	for (long iframe = 1; iframe <= numberOfFrames; iframe ++) {
+		Pitch_Frame frame = & pitch -> frame [iframe];
+		Pitch_Frame_init (frame, NUMrandomInteger (1, maximumNumberOfCandidates));
+		frame -> intensity = NUMrandomInteger (1, 4) / 4.0;
+		double base = NUMrandomInteger (70, 80);
+		for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+			long kind = NUMrandomInteger (0, 5);
+			frame -> candidate [icand]. frequency = kind == 0 ? 0.0 : kind == 5 ? NUMrandomUniform (75.0, 1000.0) : base * (1 << (kind - 1));
+			frame -> candidate [icand]. strength = NUMrandomInteger (1, 4) / 4.0;
+		}
+	}
+	autoNUMvector <double> decidedFrequency (1, numberOfFrames), decidedStrength (1, numberOfFrames);
+	autoNUMvector <double> frequency (1, maximumNumberOfCandidates), strength (1, maximumNumberOfCandidates);
+	int savedDebug = Melder_debug;
+	for (int variant = 1; variant <= 4; variant ++) {
+		double octaveCost = variant == 1 ? 0.01 : 0.0, ceiling = variant == 3 ? 300.0 : 600.0;
+		bool pullFormants = variant == 3;
+		Melder_debug = variant == 4 ? 30 : savedDebug;   // the look-back across voiceless stretches
+		try {
+			autoPitchPathFinder batch = Pitch_to_PitchPathFinder (pitch.peek());
+			PitchPathFinder_setCosts (batch.peek(), 0.03, 0.45, octaveCost, 0.35, 0.14, ceiling, pullFormants);
+			PitchPathFinder_run (batch.peek());
+			for (long iframe = 1; iframe <= numberOfFrames; iframe ++)
+				PitchPathFinder_getDecidedCandidate (batch.peek(), iframe, & decidedFrequency [iframe], & decidedStrength [iframe]);
+			/*
+			 * Without a latency bound, the streaming finder has to decide every frame as the complete search does;
+			 * with a bound, frame i has to be decided when frame i + maximumLatency comes in.
+			 */
+			for (int bounded = 0; bounded <= 1; bounded ++) {
+				autoPitchPathFinder stream = PitchPathFinder_create (0.01, bounded ? maximumLatency : 0);
+				PitchPathFinder_setCosts (stream.peek(), 0.03, 0.45, octaveCost, 0.35, 0.14, ceiling, pullFormants);
+				long numberOfReadFrames = 0, maximumDelay = 0;
+				for (long iframe = 1; iframe <= numberOfFrames; iframe ++) {
+					Pitch_Frame frame = & pitch -> frame [iframe];
+					for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+						frequency [icand] = frame -> candidate [icand]. frequency;
+						strength [icand] = frame -> candidate [icand]. strength;
+					}
+					PitchPathFinder_addFrame (stream.peek(), frame -> intensity, frame -> nCandidates, frequency.peek(), strength.peek());
+					long numberOfDecidedFrames = PitchPathFinder_getNumberOfDecidedFrames (stream.peek());
+					if (iframe - numberOfDecidedFrames > maximumDelay) maximumDelay = iframe - numberOfDecidedFrames;
+					if (bounded && numberOfDecidedFrames < iframe - maximumLatency)
+						Melder_throw ("Frame ", iframe - maximumLatency, " undecided after frame ", iframe, ".");
+					for (long jframe = numberOfReadFrames + 1; jframe <= numberOfDecidedFrames; jframe ++) {
+						double f, s;
+						PitchPathFinder_getDecidedCandidate (stream.peek(), jframe, & f, & s);
+						if (! bounded && (f != decidedFrequency [jframe] || s != decidedStrength [jframe]))
+							Melder_throw ("Streaming decision of frame ", jframe, " differs from the complete search.");
+					}
+					numberOfReadFrames = numberOfDecidedFrames;
+					PitchPathFinder_forgetDecisions (stream.peek(), numberOfReadFrames);
+				}
+				PitchPathFinder_finish (stream.peek());
+				if (PitchPathFinder_getNumberOfDecidedFrames (stream.peek()) != numberOfFrames)
+					Melder_throw ("Not all frames decided at the end.");
+				for (long jframe = numberOfReadFrames + 1; jframe <= numberOfFrames; jframe ++) {
+					double f, s;
+					PitchPathFinder_getDecidedCandidate (stream.peek(), jframe, & f, & s);
+					if (! bounded && (f != decidedFrequency [jframe] || s != decidedStrength [jframe]))
+						Melder_throw ("Final decision of frame ", jframe, " differs from the complete search.");
+				}
+				if (stream -> frameCapacity > 10000 + 4 * maximumLatency || stream -> decisionCapacity > 10000 + 4 * maximumLatency)
+					Melder_throw ("Memory not bounded: room for ", stream -> frameCapacity, " frames and ", stream -> decisionCapacity, " decisions.");
+				MelderInfo_write (L"Costs ", Melder_integer (variant), bounded ? L", bounded" : L", unbounded",
+					L": largest delay ", Melder_integer (maximumDelay), L" frames, ");
+				MelderInfo_writeLine (L"room for ", Melder_integer (stream -> frameCapacity),
+					L" frames and ", Melder_integer (stream -> decisionCapacity), L" decisions.");
+			}
+		} catch (MelderError) {
+			Melder_debug = savedDebug;
+			throw;
+		}
+	}
+	Melder_debug = savedDebug;
+}
 
 int Praat_tests (int itest, wchar_t *arg1, wchar_t *arg2, wchar_t *arg3, wchar_t *arg4) {
 	int64 n = wcstoll (arg1, NULL, 10);
@@ -111,6 +262,14 @@ int Praat_tests (int itest, wchar_t *arg1, wchar_t *arg2, wchar_t *arg3, wchar_t
 				s += L"abc";
 			t = Melder_stopwatch ();
 		} break;
+		case kPraatTests_CHECK_AUDIO_RING_BUFFER: {
+			checkAudioRingBuffer (n, arg2);
+			t = Melder_stopwatch ();
+		} break;
+		case kPraatTests_CHECK_PITCH_PATH_FINDER: {
+			checkPitchPathFinder (n, wcstol (arg2, NULL, 10));
+			t = Melder_stopwatch ();
+		} break;
 	}
 	MelderInfo_writeLine (Melder_single (t / n * 1e9), L" nanoseconds");
 	MelderInfo_writeLine (Melder_integer (5 + 6 << 1));
@@ -15,6 +15,8 @@ enums_begin (kPraatTests, 0)
 	enums_add (kPraatTests, 10, TIME_UNSIGNED_TO_FLOAT_EXTERN, U"TimeUnsignedToFloat_extern")
 	enums_add (kPraatTests, 11, TIME_STRING_MELDER, U"TimeStringMelder")
 	enums_add (kPraatTests, 12, TIME_STRING_CPP, U"TimeStringC++")
-enums_end (kPraatTests, 12, CHECK_RANDOM_1009_2009)
+	enums_add (kPraatTests, 13, CHECK_AUDIO_RING_BUFFER, U"CheckAudioRingBuffer")
+	enums_add (kPraatTests, 14, CHECK_PITCH_PATH_FINDER, U"CheckPitchPathFinder")
+enums_end (kPraatTests, 14, CHECK_RANDOM_1009_2009)
 
 /* End of file Praat_tests_enums.h */
@@ -122,6 +122,23 @@ void RealTier_addPoint (RealTier me, double t, double value) {
 	}
 }
 
+void RealTier_addPoints (RealTier me, long numberOfPoints, const double times [], const double values []) {
+	try {
+		if (numberOfPoints <= 0) return;
+		autoNUMvector <Any> points (1, numberOfPoints);
+		try {
+			for (long i = 1; i <= numberOfPoints; i ++)
+				points [i] = RealPoint_create (times [i], values [i]);
+		} catch (MelderError) {
+			for (long i = 1; i <= numberOfPoints; i ++) forget (((Thing *) points.peek()) [i]);
+			throw;
+		}
+		SortedSet_addItems (my points, numberOfPoints, points.peek());
+	} catch (MelderError) {
+		Melder_throw (me, ": points not added.");
+	}
+}
+
 double RealTier_getValueAtIndex (RealTier me, long i) {
 	if (i < 1 || i > my numberOfPoints ()) return NUMundefined;
 	return my point (i) -> value;
@@ -146,6 +163,33 @@ double RealTier_getValueAtTime (RealTier me, double t) {
 		: fleft + (t - tleft) * (fright - fleft) / (tright - tleft);   // linear interpolation
 }
 
+void RealTier_getValuesAtRegularTimes (RealTier me, double t1, double dt, long numberOfTimes, double values []) {
+	long n = my numberOfPoints ();
+	if (n == 0) {
+		for (long itime = 1; itime <= numberOfTimes; itime ++) values [itime] = NUMundefined;
+		return;
+	}
+	RealPoint *points = (RealPoint *) my points -> item;
+	double tfirst = points [1] -> number, ffirst = points [1] -> value;
+	double tlast = points [n] -> number, flast = points [n] -> value;
+	long ileft = 1;
+	for (long itime = 1; itime <= numberOfTimes; itime ++) {
+		double t = t1 + (itime - 1) * dt;
+		if (t <= tfirst) { values [itime] = ffirst; continue; }   // constant extrapolation
+		if (t >= tlast) { values [itime] = flast; continue; }   // constant extrapolation
+		/*
+		 * The times are increasing, so the interval that contains t is found by walking forward
+		 * instead of by a binary search for every time.
+		 */
+		while (points [ileft + 1] -> number <= t) ileft ++;
+		double tleft = points [ileft] -> number, fleft = points [ileft] -> value;
+		double tright = points [ileft + 1] -> number, fright = points [ileft + 1] -> value;
+		values [itime] = t == tright ? fright   // be very accurate
+			: tleft == tright ? 0.5 * (fleft + fright)   // unusual, but possible; no preference
+			: fleft + (t - tleft) * (fright - fleft) / (tright - tleft);   // linear interpolation
+	}
+}
+
 double RealTier_getMaximumValue (RealTier me) {
 	double result = NUMundefined;
 	long n = my numberOfPoints ();
@@ -344,6 +388,9 @@ TableOfReal RealTier_downto_TableOfReal (RealTier me, const wchar_t *timeLabel,
 void RealTier_interpolateQuadratically (RealTier me, long numberOfPointsPerParabola, int logarithmically) {
 	try {
 		autoRealTier thee = Data_copy (me);
+		long numberOfNewPoints = (my numberOfPoints () - 1) * (2 * numberOfPointsPerParabola + 1), inew = 0;
+		if (numberOfNewPoints <= 0) return;
+		autoNUMvector <double> newTimes (1, numberOfNewPoints), newValues (1, numberOfNewPoints);
 		for (long ipoint = 1; ipoint < my numberOfPoints (); ipoint ++) {
 			RealPoint point1 = my point (ipoint), point2 = my point (ipoint + 1);
 			double time1 = point1 -> number, time2 = point2 -> number, tmid = 0.5 * (time1 + time2);
@@ -359,12 +406,14 @@ void RealTier_interpolateQuadratically (RealTier me, long numberOfPointsPerParab
 				double phase = (newTime - time1) / (tmid - time1);
 				double newValue = value1 + (valuemid - value1) * phase * phase;
 				if (logarithmically) newValue = exp (newValue);
-				RealTier_addPoint (thee.peek(), newTime, newValue);
+				newTimes [++ inew] = newTime;
+				newValues [inew] = newValue;
 			}
 			/*
 			 * The midpoint.
 			 */
-			RealTier_addPoint (thee.peek(), tmid, logarithmically ? exp (valuemid) : valuemid);
+			newTimes [++ inew] = tmid;
+			newValues [inew] = logarithmically ? exp (valuemid) : valuemid;
 			/*
 			 * Right from the midpoint.
 			 */
@@ -373,9 +422,11 @@ void RealTier_interpolateQuadratically (RealTier me, long numberOfPointsPerParab
 				double phase = (time2 - newTime) / (time2 - tmid);
 				double newValue = value2 + (valuemid - value2) * phase * phase;
 				if (logarithmically) newValue = exp (newValue);
-				RealTier_addPoint (thee.peek(), newTime, newValue);
+				newTimes [++ inew] = newTime;
+				newValues [inew] = newValue;
 			}
 		}
+		RealTier_addPoints (thee.peek(), numberOfNewPoints, newTimes.peek(), newValues.peek());
 		Thing_swap (me, thee.peek());
 	} catch (MelderError) {
 		Melder_throw (me, ": not interpolated quadratically.");
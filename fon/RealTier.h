@@ -59,6 +59,15 @@ double RealTier_getValueAtTime (RealTier me, double t);
 /* Outside points: constant extrapolation. */
 /* No points: NUMundefined. */
 
+void RealTier_getValuesAtRegularTimes (RealTier me, double t1, double dt, long numberOfTimes, double values []);
+/*
+	values [i] := RealTier_getValueAtTime (me, t1 + (i - 1) * dt), for i = 1..numberOfTimes.
+	Precondition:
+		dt > 0.0
+	The points are visited only once, so that this takes O (numberOfPoints + numberOfTimes) time,
+	which is what you want when a tier has to be sampled for every sample of a Sound.
+*/
+
 double RealTier_getMinimumValue (RealTier me);
 double RealTier_getMaximumValue (RealTier me);
 double RealTier_getArea (RealTier me, double tmin, double tmax);
@@ -68,6 +77,12 @@ double RealTier_getStandardDeviation_curve (RealTier me, double tmin, double tma
 double RealTier_getStandardDeviation_points (RealTier me, double tmin, double tmax);
 
 void RealTier_addPoint (RealTier me, double t, double value);
+void RealTier_addPoints (RealTier me, long numberOfPoints, const double times [], const double values []);
+/*
+	Adds the points (times [1..numberOfPoints], values [1..numberOfPoints]), in any order,
+	with the same result as calling RealTier_addPoint () for each of them in turn,
+	but in O (n + m log m) rather than O (n m) time.
+*/
 void RealTier_draw (RealTier me, Graphics g, double tmin, double tmax,
 	double ymin, double ymax, int garnish, const wchar_t *method, const wchar_t *quantity);
 TableOfReal RealTier_downto_TableOfReal (RealTier me, const wchar_t *timeLabel, const wchar_t *valueLabel);
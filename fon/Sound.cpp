@@ -26,6 +26,7 @@
 #include "Sound.h"
 #include "Sound_extensions.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #include "enums_getText.h"
 #include "Sound_enums.h"
@@ -425,6 +426,75 @@ Sound Sound_resample (Sound me, double samplingFrequency, long precision) {
 	}
 }
 
+Thing_define (Sound_resample_Args, Thing) { public:
+	Sound input, output;
+	NUMresampler resampler;
+	double *weights;
+	long numberOfBlocks;
+	volatile long *next;
+};
+
+Thing_implement (Sound_resample_Args, Thing, 0);
+
+MelderThread_MUTEX (resampleMutex);
+static bool resampleMutex_inited;
+
+#define Sound_resample_BLOCK_SIZE  8192
+
+static MelderThread_RETURN_TYPE Sound_resample_blocks (Sound_resample_Args me) {
+	Sound thee = my output;
+	for (;;) {
+		MelderThread_LOCK (resampleMutex);
+		long item = ++ *my next;
+		MelderThread_UNLOCK (resampleMutex);
+		if (item > thy ny * my numberOfBlocks) break;
+		long channel = (item - 1) / my numberOfBlocks + 1, iblock = (item - 1) % my numberOfBlocks + 1;
+		long firstSample = (iblock - 1) * Sound_resample_BLOCK_SIZE + 1, lastSample = firstSample + Sound_resample_BLOCK_SIZE - 1;
+		if (lastSample > thy nx) lastSample = thy nx;
+		NUMresampler_resample (my resampler, my input -> z [channel], thy z [channel], firstSample, lastSample, my weights);
+	}
+	MelderThread_RETURN;
+}
+
+Sound Sound_resample_polyphase (Sound me, double samplingFrequency, long precision) {
+	double upfactor = samplingFrequency * my dx;
+	if (fabs (upfactor - 1) < 1e-6) return Data_copy (me);
+	try {
+		long numberOfSamples = floor ((my xmax - my xmin) * samplingFrequency + 0.5);
+		if (numberOfSamples < 1)
+			Melder_throw ("The resampled Sound would have no samples.");
+		if (precision < 1) precision = 1;
+		autoSound thee = Sound_create (my ny, my xmin, my xmax, numberOfSamples, 1.0 / samplingFrequency,
+			0.5 * (my xmin + my xmax - (numberOfSamples - 1) / samplingFrequency));
+		autoNUMresampler resampler;
+		NUMresampler_init (& resampler, my nx, my dx, my x1, thy nx, thy dx, thy x1, precision);
+
+		long numberOfBlocks = (thy nx - 1) / Sound_resample_BLOCK_SIZE + 1;
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > my ny * numberOfBlocks) numberOfThreads = my ny * numberOfBlocks;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		if (! resampleMutex_inited) { MelderThread_MUTEX_INIT (resampleMutex); resampleMutex_inited = true; }
+		autoNUMmatrix <double> weights (1, numberOfThreads, 0, 2 * resampler.halfWidth - 1);
+		autoSound_resample_Args args [16];
+		volatile long next = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoSound_resample_Args arg = Thing_new (Sound_resample_Args);
+			arg -> input = me;
+			arg -> output = thee.peek();
+			arg -> resampler = & resampler;
+			arg -> weights = weights [ithread];
+			arg -> numberOfBlocks = numberOfBlocks;
+			arg -> next = & next;
+			args [ithread - 1].reset (arg.transfer());
+		}
+		MelderThread_run (Sound_resample_blocks, args, numberOfThreads);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": not resampled.");
+	}
+}
+
 Sound Sounds_append (Sound me, double silenceDuration, Sound thee) {
 	try {
 		long nx_silence = floor (silenceDuration / my dx + 0.5), nx = my nx + nx_silence + thy nx;
@@ -510,6 +580,162 @@ Sound Sounds_concatenate_e (Collection me, double overlapTime) {
 	}
 }
 
+/*
+ * Linear convolution of (possibly very long) channels, by the overlap-save method with uniform blocks.
+ * The shorter signal (the kernel) is transformed once; every block of output samples is computed
+ * from its own stretch of the longer signal, so that blocks and channels are independent and are
+ * computed in parallel, and the memory needed is a small multiple of the length of the kernel.
+ * If the kernel is short, or few output samples are needed, the direct sum is cheaper and is used instead.
+ */
+
+Thing_define (Sounds_convolve_Args, Thing) { public:
+	double **x, **h, **y;   // per channel: the longer signal [1..nx], the kernel [1..nh], the output [1..lastOut-firstOut+1]
+	long numberOfChannels, nx, nh, firstOut, lastOut;
+	long nfft;   // 0 for direct summation
+	double **kernelSpectra;   // per channel, including the factor 1 / nfft of the backward transform
+	long blockSize, numberOfBlocks;
+	volatile long *next;
+};
+
+Thing_implement (Sounds_convolve_Args, Thing, 0);
+
+MelderThread_MUTEX (convolveMutex);
+static bool convolveMutex_inited;
+
+#define Sounds_convolve_DIRECT_BLOCK_SIZE  4096
+#define Sounds_convolve_MAXIMUM_PREFERRED_FFT_SIZE  65536
+
+static MelderThread_RETURN_TYPE Sounds_convolve_blocks (Sounds_convolve_Args me) {
+	const long nx = my nx, nh = my nh, nfft = my nfft;
+	autoNUMfft_Table fftTable;
+	autoNUMvector <double> segment;
+	if (nfft > 0) {
+		MelderThread_LOCK (convolveMutex);
+		NUMfft_Table_init (& fftTable, nfft);
+		segment.reset (1, nfft);
+		MelderThread_UNLOCK (convolveMutex);
+	}
+	for (;;) {
+		MelderThread_LOCK (convolveMutex);
+		long item = ++ *my next;
+		MelderThread_UNLOCK (convolveMutex);
+		if (item > my numberOfChannels * my numberOfBlocks) break;
+		long channel = (item - 1) / my numberOfBlocks + 1, iblock = (item - 1) % my numberOfBlocks + 1;
+		long firstOutput = my firstOut + (iblock - 1) * my blockSize, lastOutput = firstOutput + my blockSize - 1;
+		if (lastOutput > my lastOut) lastOutput = my lastOut;
+		const double *x = my x [channel], *h = my h [channel];
+		double *y = my y [channel] - (my firstOut - 1);   // y [i] is output sample i of the full convolution
+		if (nfft == 0) {
+			for (long i = firstOutput; i <= lastOutput; i ++) {
+				long jmin = i - nx + 1 > 1 ? i - nx + 1 : 1, jmax = i < nh ? i : nh;
+				double sum = 0.0;
+				for (long j = jmin; j <= jmax; j ++) sum += x [i - j + 1] * h [j];
+				y [i] = sum;
+			}
+		} else {
+			/*
+			 * The circular convolution of x [firstOutput - nh + 1 ...] with the kernel
+			 * equals the linear convolution from its nh-th sample on.
+			 */
+			const double *kernelSpectrum = my kernelSpectra [channel];
+			long offset = firstOutput - nh, numberOfInputs = lastOutput - firstOutput + nh;
+			for (long k = 1; k <= numberOfInputs; k ++) {
+				long ix = offset + k;
+				segment [k] = ix >= 1 && ix <= nx ? x [ix] : 0.0;
+			}
+			for (long k = numberOfInputs + 1; k <= nfft; k ++) segment [k] = 0.0;
+			NUMfft_forward (& fftTable, segment.peek());
+			segment [1] *= kernelSpectrum [1];
+			for (long k = 2; k < nfft; k += 2) {
+				double re = segment [k], im = segment [k + 1];
+				segment [k] = re * kernelSpectrum [k] - im * kernelSpectrum [k + 1];
+				segment [k + 1] = re * kernelSpectrum [k + 1] + im * kernelSpectrum [k];
+			}
+			segment [nfft] *= kernelSpectrum [nfft];
+			NUMfft_backward (& fftTable, segment.peek());
+			for (long i = firstOutput; i <= lastOutput; i ++) y [i] = segment [i - offset];
+		}
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	For channel = 1..numberOfChannels and i = firstOut..lastOut:
+		y [channel] [i - firstOut + 1] = sum (j, x [channel] [i - j + 1] * h [channel] [j]),
+	with x [channel] [1..nx] and h [channel] [1..nh] zero outside their ranges;
+	the full convolution runs from i = 1 to i = nx + nh - 1.
+	Channels may share their arrays.
+*/
+static void convolveChannels (long numberOfChannels, double **x, long nx, double **h, long nh, double **y, long firstOut, long lastOut) {
+	if (nh > nx) {   // convolution is commutative; the shorter signal becomes the kernel
+		double **xtemp = x; x = h; h = xtemp;
+		long ntemp = nx; nx = nh; nh = ntemp;
+	}
+	const long numberOfOutputs = lastOut - firstOut + 1;
+	if (numberOfOutputs < 1) return;
+
+	/*
+	 * Estimate the costs in multiply-adds: nh per output sample for the direct sum,
+	 * against a forward and a backward transform per block of nfft - nh + 1 output samples.
+	 * The largest useful transform covers all the output in one block.
+	 */
+	long nfft = 0, blockSize = Sounds_convolve_DIRECT_BLOCK_SIZE;
+	double minimumCost = (double) numberOfOutputs * nh;
+	long minimumFftSize = 2;
+	while (minimumFftSize < 2 * nh) minimumFftSize *= 2;
+	for (long n = minimumFftSize; ; n *= 2) {
+		long outputsPerBlock = n - nh + 1;
+		double numberOfBlocks = ceil ((double) numberOfOutputs / outputsPerBlock);
+		double log2n = log ((double) n) / NUMln2;
+		double cost = numberOfBlocks * (2.0 * n * log2n + 2.0 * n) + n * log2n;
+		if (cost < minimumCost) {
+			minimumCost = cost;
+			nfft = n;
+			blockSize = outputsPerBlock;
+		}
+		if (outputsPerBlock >= numberOfOutputs || 2 * n > Sounds_convolve_MAXIMUM_PREFERRED_FFT_SIZE) break;
+	}
+
+	autoNUMmatrix <double> kernelSpectra;
+	if (nfft > 0) {
+		autoNUMfft_Table fftTable;
+		NUMfft_Table_init (& fftTable, nfft);
+		kernelSpectra.reset (1, numberOfChannels, 1, nfft);
+		for (long channel = 1; channel <= numberOfChannels; channel ++) {
+			double *spectrum = kernelSpectra [channel];
+			for (long j = 1; j <= nh; j ++) spectrum [j] = h [channel] [j] / nfft;
+			NUMfft_forward (& fftTable, spectrum);
+		}
+	}
+
+	long numberOfBlocks = (numberOfOutputs - 1) / blockSize + 1;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfChannels * numberOfBlocks) numberOfThreads = numberOfChannels * numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! convolveMutex_inited) { MelderThread_MUTEX_INIT (convolveMutex); convolveMutex_inited = true; }
+	autoSounds_convolve_Args args [16];
+	volatile long next = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoSounds_convolve_Args arg = Thing_new (Sounds_convolve_Args);
+		arg -> x = x;
+		arg -> h = h;
+		arg -> y = y;
+		arg -> numberOfChannels = numberOfChannels;
+		arg -> nx = nx;
+		arg -> nh = nh;
+		arg -> firstOut = firstOut;
+		arg -> lastOut = lastOut;
+		arg -> nfft = nfft;
+		arg -> kernelSpectra = kernelSpectra.peek();
+		arg -> blockSize = blockSize;
+		arg -> numberOfBlocks = numberOfBlocks;
+		arg -> next = & next;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (Sounds_convolve_blocks, args, numberOfThreads);
+}
+
 Sound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain) {
 	try {
 		if (my ny > 1 && thy ny > 1 && my ny != thy ny)
@@ -517,34 +743,15 @@ Sound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling scali
 		if (my dx != thy dx)
 			Melder_throw ("The sampling frequencies of the two sounds have to be equal.");
 		long n1 = my nx, n2 = thy nx;
-		long n3 = n1 + n2 - 1, nfft = 1;
-		while (nfft < n3) nfft *= 2;
-		autoNUMvector <double> data1 (1, nfft);
-		autoNUMvector <double> data2 (1, nfft);
+		long n3 = n1 + n2 - 1;
 		long numberOfChannels = my ny > thy ny ? my ny : thy ny;
 		autoSound him = Sound_create (numberOfChannels, my xmin + thy xmin, my xmax + thy xmax, n3, my dx, my x1 + thy x1);
+		autoNUMvector <double *> myChannels (1, numberOfChannels), thyChannels (1, numberOfChannels);
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			double *a = my z [my ny == 1 ? 1 : channel];
-			for (long i = n1; i > 0; i --) data1 [i] = a [i];
-			for (long i = n1 + 1; i <= nfft; i ++) data1 [i] = 0.0;
-			a = thy z [thy ny == 1 ? 1 : channel];
-			for (long i = n2; i > 0; i --) data2 [i] = a [i];
-			for (long i = n2 + 1; i <= nfft; i ++) data2 [i] = 0.0;
-			NUMrealft (data1.peek(), nfft, 1);
-			NUMrealft (data2.peek(), nfft, 1);
-			data2 [1] *= data1 [1];
-			data2 [2] *= data1 [2];
-			for (long i = 3; i <= nfft; i += 2) {
-				double temp = data1 [i] * data2 [i] - data1 [i + 1] * data2 [i + 1];
-				data2 [i + 1] = data1 [i] * data2 [i + 1] + data1 [i + 1] * data2 [i];
-				data2 [i] = temp;
-			}
-			NUMrealft (data2.peek(), nfft, -1);
-			a = him -> z [channel];
-			for (long i = 1; i <= n3; i ++) {
-				a [i] = data2 [i];
-			}
+			myChannels [channel] = my z [my ny == 1 ? 1 : channel];
+			thyChannels [channel] = thy z [thy ny == 1 ? 1 : channel];
 		}
+		convolveChannels (numberOfChannels, myChannels.peek(), n1, thyChannels.peek(), n2, his z, 1, n3);
 		switch (signalOutsideTimeDomain) {
 			case kSounds_convolve_signalOutsideTimeDomain_ZERO: {
 				// do nothing
@@ -567,15 +774,15 @@ Sound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling scali
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling_INTEGRAL: {
-				Vector_multiplyByScalar (him.peek(), my dx / nfft);
+				Vector_multiplyByScalar (him.peek(), my dx);
 			} break;
 			case kSounds_convolve_scaling_SUM: {
-				Vector_multiplyByScalar (him.peek(), 1.0 / nfft);
+				// do nothing
 			} break;
 			case kSounds_convolve_scaling_NORMALIZE: {
 				double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (thee);
 				if (normalizationFactor != 0.0) {
-					Vector_multiplyByScalar (him.peek(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (him.peek(), 1.0 / normalizationFactor);
 				}
 			} break;
 			case kSounds_convolve_scaling_PEAK_099: {
@@ -597,37 +804,22 @@ Sound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_scaling
 			Melder_throw ("The sampling frequencies of the two sounds have to be equal.");
 		long numberOfChannels = my ny > thy ny ? my ny : thy ny;
 		long n1 = my nx, n2 = thy nx;
-		long n3 = n1 + n2 - 1, nfft = 1;
-		while (nfft < n3) nfft *= 2;
-		autoNUMvector <double> data1 (1, nfft);
-		autoNUMvector <double> data2 (1, nfft);
+		long n3 = n1 + n2 - 1;
 		double my_xlast = my x1 + (n1 - 1) * my dx;
 		autoSound him = Sound_create (numberOfChannels, thy xmin - my xmax, thy xmax - my xmin, n3, my dx, thy x1 - my_xlast);
+		/*
+		 * The cross-correlation is the convolution of thee with me reversed in time:
+		 * his z [channel] [i] belongs to the lag i - n1.
+		 */
+		autoNUMmatrix <double> reversed (1, my ny, 1, n1);
+		for (long channel = 1; channel <= my ny; channel ++)
+			for (long i = 1; i <= n1; i ++) reversed [channel] [i] = my z [channel] [n1 + 1 - i];
+		autoNUMvector <double *> myChannels (1, numberOfChannels), thyChannels (1, numberOfChannels);
 		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			double *a = my z [my ny == 1 ? 1 : channel];
-			for (long i = n1; i > 0; i --) data1 [i] = a [i];
-			for (long i = n1 + 1; i <= nfft; i ++) data1 [i] = 0.0;
-			a = thy z [thy ny == 1 ? 1 : channel];
-			for (long i = n2; i > 0; i --) data2 [i] = a [i];
-			for (long i = n2 + 1; i <= nfft; i ++) data2 [i] = 0.0;
-			NUMrealft (data1.peek(), nfft, 1);
-			NUMrealft (data2.peek(), nfft, 1);
-			data2 [1] *= data1 [1];
-			data2 [2] *= data1 [2];
-			for (long i = 3; i <= nfft; i += 2) {
-				double temp = data1 [i] * data2 [i] + data1 [i + 1] * data2 [i + 1];   // reverse me by taking the conjugate of data1
-				data2 [i + 1] = data1 [i] * data2 [i + 1] - data1 [i + 1] * data2 [i];   // reverse me by taking the conjugate of data1
-				data2 [i] = temp;
-			}
-			NUMrealft (data2.peek(), nfft, -1);
-			a = him -> z [channel];
-			for (long i = 1; i < n1; i ++) {
-				a [i] = data2 [i + (nfft - (n1 - 1))];   // data for the first part ("negative lags") is at the end of data2
-			}
-			for (long i = 1; i <= n2; i ++) {
-				a [i + (n1 - 1)] = data2 [i];   // data for the second part ("positive lags") is at the beginning of data2
-			}
+			myChannels [channel] = reversed [my ny == 1 ? 1 : channel];
+			thyChannels [channel] = thy z [thy ny == 1 ? 1 : channel];
 		}
+		convolveChannels (numberOfChannels, thyChannels.peek(), n2, myChannels.peek(), n1, his z, 1, n3);
 		switch (signalOutsideTimeDomain) {
 			case kSounds_convolve_signalOutsideTimeDomain_ZERO: {
 				// do nothing
@@ -650,15 +842,15 @@ Sound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_scaling
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling_INTEGRAL: {
-				Vector_multiplyByScalar (him.peek(), my dx / nfft);
+				Vector_multiplyByScalar (him.peek(), my dx);
 			} break;
 			case kSounds_convolve_scaling_SUM: {
-				Vector_multiplyByScalar (him.peek(), 1.0 / nfft);
+				// do nothing
 			} break;
 			case kSounds_convolve_scaling_NORMALIZE: {
 				double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (thee);
 				if (normalizationFactor != 0.0) {
-					Vector_multiplyByScalar (him.peek(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (him.peek(), 1.0 / normalizationFactor);
 				}
 			} break;
 			case kSounds_convolve_scaling_PEAK_099: {
@@ -674,31 +866,13 @@ Sound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_scaling
 
 Sound Sound_autoCorrelate (Sound me, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain) {
 	try {
-		long numberOfChannels = my ny, n1 = my nx, n2 = n1 + n1 - 1, nfft = 1;
-		while (nfft < n2) nfft *= 2;
-		autoNUMvector <double> data (1, nfft);
+		long numberOfChannels = my ny, n1 = my nx, n2 = n1 + n1 - 1;
 		double my_xlast = my x1 + (n1 - 1) * my dx;
 		autoSound thee = Sound_create (numberOfChannels, my xmin - my xmax, my xmax - my xmin, n2, my dx, my x1 - my_xlast);
-		for (long channel = 1; channel <= numberOfChannels; channel ++) {
-			double *a = my z [channel];
-			for (long i = n1; i > 0; i --) data [i] = a [i];
-			for (long i = n1 + 1; i <= nfft; i ++) data [i] = 0.0;
-			NUMrealft (data.peek(), nfft, 1);
-			data [1] *= data [1];
-			data [2] *= data [2];
-			for (long i = 3; i <= nfft; i += 2) {
-				data [i] = data [i] * data [i] + data [i + 1] * data [i + 1];
-				data [i + 1] = 0.0;   // reverse me by taking the conjugate of data1
-			}
-			NUMrealft (data.peek(), nfft, -1);
-			a = thy z [channel];
-			for (long i = 1; i < n1; i ++) {
-				a [i] = data [i + (nfft - (n1 - 1))];   // data for the first part ("negative lags") is at the end of data
-			}
-			for (long i = 1; i <= n1; i ++) {
-				a [i + (n1 - 1)] = data [i];   // data for the second part ("positive lags") is at the beginning of data
-			}
-		}
+		autoNUMmatrix <double> reversed (1, numberOfChannels, 1, n1);
+		for (long channel = 1; channel <= numberOfChannels; channel ++)
+			for (long i = 1; i <= n1; i ++) reversed [channel] [i] = my z [channel] [n1 + 1 - i];
+		convolveChannels (numberOfChannels, my z, n1, reversed.peek(), n1, thy z, 1, n2);
 		switch (signalOutsideTimeDomain) {
 			case kSounds_convolve_signalOutsideTimeDomain_ZERO: {
 				// do nothing
@@ -721,15 +895,15 @@ Sound Sound_autoCorrelate (Sound me, enum kSounds_convolve_scaling scaling, enum
 		}
 		switch (scaling) {
 			case kSounds_convolve_scaling_INTEGRAL: {
-				Vector_multiplyByScalar (thee.peek(), my dx / nfft);
+				Vector_multiplyByScalar (thee.peek(), my dx);
 			} break;
 			case kSounds_convolve_scaling_SUM: {
-				Vector_multiplyByScalar (thee.peek(), 1.0 / nfft);
+				// do nothing
 			} break;
 			case kSounds_convolve_scaling_NORMALIZE: {
 				double normalizationFactor = Matrix_getNorm (me) * Matrix_getNorm (me);
 				if (normalizationFactor != 0.0) {
-					Vector_multiplyByScalar (thee.peek(), 1.0 / nfft / normalizationFactor);
+					Vector_multiplyByScalar (thee.peek(), 1.0 / normalizationFactor);
 				}
 			} break;
 			case kSounds_convolve_scaling_PEAK_099: {
@@ -1231,14 +1405,17 @@ Sound Sounds_crossCorrelate_short (Sound me, Sound thee, double tmin, double tma
 			Melder_throw ("Window too small.");
 		double t1 = (dphase + i1) * dt;
 		autoSound him = Sound_create (1, tmin, tmax, nt, dt, t1);
-		for (long i = 1; i <= nt; i ++) {
-			long di = i - 1 + i1;
-			for (long ime = 1; ime <= my nx; ime ++) {
-				if (ime + di < 1) continue;
-				if (ime + di > thy nx) break;
-				for (long channel = 1; channel <= my ny; channel ++) {
-					his z [1] [i] += my z [channel] [ime] * thy z [channel] [ime + di];
-				}
+		/*
+		 * The lags i1..i2 are a stretch of the convolution of thee with me reversed in time,
+		 * summed over the channels.
+		 */
+		autoNUMmatrix <double> reversed (1, my ny, 1, my nx), correlations (1, my ny, 1, nt);
+		for (long channel = 1; channel <= my ny; channel ++)
+			for (long i = 1; i <= my nx; i ++) reversed [channel] [i] = my z [channel] [my nx + 1 - i];
+		convolveChannels (my ny, thy z, thy nx, reversed.peek(), my nx, correlations.peek(), i1 + my nx, i2 + my nx);
+		for (long channel = 1; channel <= my ny; channel ++) {
+			for (long i = 1; i <= nt; i ++) {
+				his z [1] [i] += correlations [channel] [i];
 			}
 		}
 		if (normalize) {
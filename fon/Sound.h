@@ -117,6 +117,14 @@ Sound Sound_resample (Sound me, double samplingFrequency, long precision);
 		precision >= 2: sinx/x interpolation with maximum depth equal to 'precision'.
 */
 
+Sound Sound_resample_polyphase (Sound me, double samplingFrequency, long precision);
+/*
+	The same sampling as Sound_resample, but with a windowed-sinc filter of 'precision' zero crossings
+	on either side (see NUMresampler_init) instead of a whole-signal FFT filter,
+	so that the result at every point depends only on the nearby samples.
+	Channels and stretches of the sound are resampled in parallel.
+*/
+
 Sound Sounds_append (Sound me, double silenceDuration, Sound thee);
 /*
 	Function:
@@ -150,6 +158,12 @@ Sound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling scali
 		for (i = 1..result -> nx)
 			result -> z [1] [i] == result -> dx *
 				sum (j = 1..i, my z [1] [j] * thy z [1] [i - j + 1])
+	Method:
+		direct summation if the shorter sound is short, otherwise overlap-save in blocks
+		a few times the length of the shorter sound, so that a long sound never needs one huge FFT;
+		blocks and channels are computed in parallel.
+		Sounds_crossCorrelate, Sound_autoCorrelate and Sounds_crossCorrelate_short work in the same way,
+		the last one computing only the lags between tmin and tmax.
 */
 Sound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain);
 Sound Sounds_crossCorrelate_short (Sound me, Sound thee, double tmin, double tmax, int normalize);
@@ -183,6 +183,40 @@ static void win_waveInClose (SoundRecorder me) {
 }
 #endif
 
+static void forgetStream (SoundRecorder me) {
+	forget (my streamWriter);   // joins the writer thread, before the ring buffer goes
+	forget (my ringBuffer);
+	my streamFileType = 0;
+}
+
+static void startStream (SoundRecorder me) {
+	/*
+	 * A ring buffer of about two seconds absorbs the hiccups of the writer thread (e.g. a slow disk).
+	 */
+	my ringBuffer = AudioRingBuffer_create (my numberOfChannels, (long) (2.0 * theControlPanel. sampleRate));
+	my streamWriter = AudioStreamWriter_create (my ringBuffer, my buffer, my nmax);
+	if (my streamFileType)
+		AudioStreamWriter_openFile (my streamWriter, & my streamFile, my streamFileType, (long) theControlPanel. sampleRate);
+	AudioStreamWriter_start (my streamWriter);
+}
+
+static void finishStream (SoundRecorder me) {
+	if (! my streamWriter) return;
+	try {
+		AudioStreamWriter_stop (my streamWriter);
+	} catch (MelderError) {
+		my nsamp = AudioStreamWriter_getNumberOfFramesInMemory (my streamWriter);
+		forgetStream (me);
+		throw;
+	}
+	my nsamp = AudioStreamWriter_getNumberOfFramesInMemory (my streamWriter);
+	long numberOfDropouts = my ringBuffer -> numberOfDropouts, numberOfDroppedFrames = my ringBuffer -> numberOfDroppedFrames;
+	forgetStream (me);
+	if (numberOfDropouts > 0)
+		Melder_warning ("The recording had ", numberOfDropouts, " drop-outs; ",
+			numberOfDroppedFrames, " samples were lost.");
+}
+
 static void stopRecording (SoundRecorder me) {	
 	if (! my recording) return;
 	try {
@@ -192,6 +226,7 @@ static void stopRecording (SoundRecorder me) {
 				Pa_StopStream (my portaudioStream);
 				Pa_CloseStream (my portaudioStream);
 				my portaudioStream = NULL;
+				finishStream (me);
 			} else {
 				#if defined (_WIN32)
 					/*
@@ -235,6 +270,7 @@ void structSoundRecorder :: v_destroy () {
 	#elif motif
 		if (our workProcId) XtRemoveWorkProc (our workProcId);
 	#endif
+	forgetStream (this);
 	NUMvector_free (buffer, 0);
 
 	if (our inputUsesPortAudio) {
@@ -354,11 +390,6 @@ static bool tooManySamplesInBufferToReturnToGui (SoundRecorder me) {
 	return false;
 }
 
-static long getMyNsamp (SoundRecorder me) {
-	volatile long nsamp = my nsamp;   // Prevent inlining.
-	return nsamp;
-}
-
 #if cocoa
 static void workProc (CFRunLoopTimerRef timer, void *void_me) {
 	(void) timer;
@@ -446,7 +477,20 @@ static bool workProc (void *void_me) {
 				}
 			} while (my recording && tooManySamplesInBufferToReturnToGui (me));
 		} else {
-			if (my recording) {
+			if (my recording && my inputUsesPortAudio) {
+				/*
+				 * The buffer is filled by the stream writer thread, which also keeps the latest samples for us,
+				 * so that the meter never reads samples that are being written.
+				 */
+				short latestSamples [3000*2];
+				long numberOfLatestSamples = AudioStreamWriter_getLatestFrames (my streamWriter, latestSamples, 3000);
+				showMeter (me, latestSamples, numberOfLatestSamples);
+				GuiScale_setValue (my progressScale,
+					1000.0 * ((double) AudioStreamWriter_getNumberOfFramesInMemory (my streamWriter) / (double) my nmax));
+				if (AudioRingBuffer_isClosed (my ringBuffer))
+					stopRecording (me);   // the buffer and the file, if any, are full
+				Pa_Sleep (10);
+			} else if (my recording) {
 				/*
 				 * We have to know how far the buffer has been filled.
 				 * However, the buffer may be filled at interrupt time,
@@ -454,23 +498,13 @@ static bool workProc (void *void_me) {
 				 * So we ask for the buffer filling just once, namely here at the beginning.
 				 */
 				long lastSample = 0;
-				if (my inputUsesPortAudio) {
-					 /*
-					  * The buffer filling is contained in my nsamp,
-					  * which has been set during interrupt time and may again be updated behind our backs during this workproc.
-					  * So we do it in such a way that the compiler cannot ask for my nsamp twice.
-					  */
-					lastSample = getMyNsamp (me);
-					Pa_Sleep (10);
-				} else {
-					#if defined (_WIN32)
-						MMTIME mmtime;
-						mmtime. wType = TIME_BYTES;
-						if (waveInGetPosition (my hWaveIn, & mmtime, sizeof (MMTIME)) == MMSYSERR_NOERROR)
-							lastSample = mmtime. u.cb / (sizeof (short) * my numberOfChannels);
-					#elif defined (macintosh)
-					#endif
-				}
+				#if defined (_WIN32)
+					MMTIME mmtime;
+					mmtime. wType = TIME_BYTES;
+					if (waveInGetPosition (my hWaveIn, & mmtime, sizeof (MMTIME)) == MMSYSERR_NOERROR)
+						lastSample = mmtime. u.cb / (sizeof (short) * my numberOfChannels);
+				#elif defined (macintosh)
+				#endif
 				long firstSample = lastSample - 3000;
 				if (firstSample < 0) firstSample = 0;
 				showMeter (me, my buffer + firstSample * my numberOfChannels, lastSample - firstSample);
@@ -500,29 +534,16 @@ static int portaudioStreamCallback (
 {
 	/*
 	 * This procedure may be called at interrupt time.
-	 * It therefore accesses only data that is constant during recording,
-	 * namely me, my buffer, my numberOfChannels, and my nmax.
-	 * The only thing it changes is my nsamp;
-	 * the workProc will therefore have to take some care in accessing my nsamp (see there).
+	 * It therefore only hands the samples to the lock-free ring buffer,
+	 * from which the stream writer thread moves them into my buffer and/or the file.
 	 */
 	iam (SoundRecorder);
 	(void) output;
 	(void) timeInfo;
-	(void) statusFlags;
 	if (Melder_debug == 20) Melder_casual ("The PortAudio stream callback receives %ld frames.", frameCount);
-	Melder_assert (my nsamp <= my nmax);
-	unsigned long samplesLeft = my nmax - my nsamp;
-	if (samplesLeft > 0) {
-		unsigned long dsamples = samplesLeft > frameCount ? frameCount : samplesLeft;
-		if (Melder_debug == 20) Melder_casual ("play %ls %ls", Melder_integer (dsamples),
-			Melder_double (Pa_GetStreamCpuLoad (my portaudioStream)));
-		memcpy (my buffer + my nsamp * my numberOfChannels, input, 2 * dsamples * my numberOfChannels);
-		my nsamp += dsamples;
-		if (my nsamp >= my nmax) return paComplete;
-	} else /*if (my nsamp >= my nmax)*/ {
-		my nsamp = my nmax;
-		return paComplete;
-	}
+	if (AudioRingBuffer_isClosed (my ringBuffer)) return paComplete;
+	if (statusFlags & paInputOverflow) AudioRingBuffer_countDropout (my ringBuffer);
+	AudioRingBuffer_write (my ringBuffer, (const short *) input, (long) frameCount);
 	return paContinue;
 }
 
@@ -550,6 +571,7 @@ static void gui_button_cb_record (I, GuiButtonEvent event) {
 					macCoreStreamInfo. flags = paMacCoreChangeDeviceParameters | paMacCoreFailIfConversionRequired;
 					streamParameters. hostApiSpecificStreamInfo = & macCoreStreamInfo;
 				#endif
+				startStream (me);
 				if (Melder_debug == 20) Melder_casual ("Before Pa_OpenStream");
 				PaError err = Pa_OpenStream (& my portaudioStream, & streamParameters, NULL,
 					theControlPanel. sampleRate, 0, paNoFlag, portaudioStreamCallback, (void *) me);
@@ -580,6 +602,7 @@ static void gui_button_cb_record (I, GuiButtonEvent event) {
 		Graphics_setColour (my graphics, Graphics_WHITE);
 		Graphics_fillRectangle (my graphics, 0.0, 1.0, 0.0, 1.0);
 		my recording = false;
+		forgetStream (me);
 		Melder_flushError ("Cannot record.");
 	}
 }
@@ -965,6 +988,38 @@ static void menu_cb_writeNist (EDITOR_ARGS) {
 	EDITOR_END
 }
 
+static void recordToFile (SoundRecorder me, MelderFile file, int audioFileType) {
+	if (my recording)
+		Melder_throw ("Stop the current recording first.");
+	if (! my inputUsesPortAudio)
+		Melder_throw ("Recording straight to a file is possible only if the sound input uses PortAudio.");
+	MelderFile_copy (file, & my streamFile);
+	my streamFileType = audioFileType;
+	gui_button_cb_record (me, NULL);
+}
+
+static void menu_cb_recordToWav (EDITOR_ARGS) {
+	EDITOR_IAM (SoundRecorder);
+	EDITOR_FORM_WRITE (L"Record to WAV file", 0)
+		wchar_t *name = GuiText_getString (my soundName);
+		swprintf (defaultName, 300, L"%ls.wav", name);
+		Melder_free (name);
+	EDITOR_DO_WRITE
+		recordToFile (me, file, Melder_WAV);
+	EDITOR_END
+}
+
+static void menu_cb_recordToFlac (EDITOR_ARGS) {
+	EDITOR_IAM (SoundRecorder);
+	EDITOR_FORM_WRITE (L"Record to FLAC file", 0)
+		wchar_t *name = GuiText_getString (my soundName);
+		swprintf (defaultName, 300, L"%ls.flac", name);
+		Melder_free (name);
+	EDITOR_DO_WRITE
+		recordToFile (me, file, Melder_FLAC);
+	EDITOR_END
+}
+
 static void updateMenus (SoundRecorder me) {
 	GuiMenuItem_check (my d_meterIntensityButton,
 		my p_meter_which == kSoundRecorder_meter_INTENSITY);
@@ -992,6 +1047,9 @@ void structSoundRecorder :: v_createMenus () {
 	Editor_addCommand (this, L"File", L"Save as NeXT/Sun file...", 0, menu_cb_writeNextSun);
 	Editor_addCommand (this, L"File", L"Save as NIST file...", 0, menu_cb_writeNist);
 	Editor_addCommand (this, L"File", L"-- write --", 0, 0);
+	Editor_addCommand (this, L"File", L"Record to WAV file...", 0, menu_cb_recordToWav);
+	Editor_addCommand (this, L"File", L"Record to FLAC file...", 0, menu_cb_recordToFlac);
+	Editor_addCommand (this, L"File", L"-- record --", 0, 0);
 	Editor_addMenu (this, L"Meter", 0);
 	d_meterIntensityButton =
 		Editor_addCommand (this, L"Meter", L"Intensity", GuiMenu_RADIO_FIRST, menu_cb_intensity);
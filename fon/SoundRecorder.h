@@ -23,6 +23,7 @@
 
 #include "Editor.h"
 #include "Sound.h"
+#include "AudioRingBuffer.h"
 
 #include "SoundRecorder_enums.h"
 
@@ -81,6 +82,10 @@ Thing_define (SoundRecorder, Editor) {
 	struct SoundRecorder_Device device_ [1+SoundRecorder_IDEVICE_MAX];
 	struct SoundRecorder_Fsamp fsamp_ [1+SoundRecorder_IFSAMP_MAX];
 	short *buffer;
+	AudioRingBuffer ringBuffer;   // between the PortAudio callback and the stream writer
+	AudioStreamWriter streamWriter;   // moves the recorded frames into 'buffer' and, optionally, into 'streamFile'
+	structMelderFile streamFile;
+	int streamFileType;   // 0 if the recording is not streamed to disk
 	GuiRadioButton monoButton, stereoButton;
 	GuiDrawingArea meter;
 	GuiScale progressScale;
@@ -41,7 +41,66 @@
 #include "enums_getValue.h"
 #include "Sound_and_Spectrogram_enums.h"
 
-Spectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, double fmax,
+struct structSpectrogram_Analysis {
+	Spectrogram spectrogram;
+	long nsamp_window, halfnsamp_window, nsampFFT, half_nsampFFT, numberOfFreqs, binWidth_samples;
+	double oneByBinWidth, *frame, *spec, *window;
+	NUMfft_Table fftTable;
+};
+
+static void Sound_into_Spectrogram (void *void_me, Sound sound, long /* firstSample */, long /* lastSample */, long firstFrame, long lastFrame) {
+	struct structSpectrogram_Analysis *me = (struct structSpectrogram_Analysis *) void_me;
+	Spectrogram thee = my spectrogram;
+	double *frame = my frame, *spec = my spec, *window = my window;
+	const long half_nsampFFT = my half_nsampFFT;
+	for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+		double t = Sampled_indexToX (thee, iframe);
+		long leftSample = Sampled_xToLowIndex (sound, t), rightSample = leftSample + 1;
+		long startSample = rightSample - my halfnsamp_window;
+		long endSample = leftSample + my halfnsamp_window;
+		Melder_assert (startSample >= 1);
+		Melder_assert (endSample <= sound -> nx);
+		for (long i = 1; i <= half_nsampFFT; i ++) {
+			spec [i] = 0.0;
+		}
+		for (long channel = 1; channel <= sound -> ny; channel ++) {
+			for (long j = 1, i = startSample; j <= my nsamp_window; j ++) {
+				frame [j] = sound -> z [channel] [i ++] * window [j];
+			}
+			for (long j = my nsamp_window + 1; j <= my nsampFFT; j ++) frame [j] = 0.0f;
+
+			Melder_progress (iframe / (thy nx + 1.0),
+				L"Sound to Spectrogram: analysis of frame ", Melder_integer (iframe), L" out of ", Melder_integer (thy nx));
+
+			/* Compute Fast Fourier Transform of the frame. */
+
+			NUMfft_forward (my fftTable, frame);   // complex spectrum
+
+			/* Put power spectrum in frame [1..half_nsampFFT + 1]. */
+
+			spec [1] += frame [1] * frame [1];   // DC component
+			for (long i = 2; i <= half_nsampFFT; i ++)
+				spec [i] += frame [i + i - 2] * frame [i + i - 2] + frame [i + i - 1] * frame [i + i - 1];
+			spec [half_nsampFFT + 1] += frame [my nsampFFT] * frame [my nsampFFT];   /* Nyquist frequency. Correct?? */
+		}
+		if (sound -> ny > 1 ) for (long i = 1; i <= half_nsampFFT; i ++) {
+			spec [i] /= sound -> ny;
+		}
+
+		/* Bin into frame [1..nBands]. */
+		for (long iband = 1; iband <= my numberOfFreqs; iband ++) {
+			long leftsample = (iband - 1) * my binWidth_samples + 1, rightsample = leftsample + my binWidth_samples;
+			float power = 0.0f;
+			for (long i = leftsample; i < rightsample; i ++) power += spec [i];
+			thy z [iband] [iframe] = power * my oneByBinWidth;
+		}
+	}
+}
+
+/*
+ * 'me' is a Sound or a LongSound.
+ */
+static Spectrogram Sampled_to_Spectrogram (Sampled me, double effectiveAnalysisWidth, double fmax,
 	double minimumTimeStep1, double minimumFreqStep1, enum kSound_to_Spectrogram_windowShape windowType,
 	double maximumTimeOversampling, double maximumFreqOversampling)
 {
@@ -134,47 +193,12 @@ Spectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, doubl
 		}
 		double oneByBinWidth = 1.0 / windowssq / binWidth_samples;
 
-		for (long iframe = 1; iframe <= numberOfTimes; iframe ++) {
-			double t = Sampled_indexToX (thee.peek(), iframe);
-			long leftSample = Sampled_xToLowIndex (me, t), rightSample = leftSample + 1;
-			long startSample = rightSample - halfnsamp_window;
-			long endSample = leftSample + halfnsamp_window;
-			Melder_assert (startSample >= 1);
-			Melder_assert (endSample <= my nx);
-			for (long i = 1; i <= half_nsampFFT; i ++) {
-				spec [i] = 0.0;
-			}
-			for (long channel = 1; channel <= my ny; channel ++) {
-				for (long j = 1, i = startSample; j <= nsamp_window; j ++) {
-					frame [j] = my z [channel] [i ++] * window [j];
-				}
-				for (long j = nsamp_window + 1; j <= nsampFFT; j ++) frame [j] = 0.0f;
-
-				Melder_progress (iframe / (numberOfTimes + 1.0),
-					L"Sound to Spectrogram: analysis of frame ", Melder_integer (iframe), L" out of ", Melder_integer (numberOfTimes));
-
-				/* Compute Fast Fourier Transform of the frame. */
-
-				NUMfft_forward (& fftTable, frame.peek());   // complex spectrum
-
-				/* Put power spectrum in frame [1..half_nsampFFT + 1]. */
-
-				spec [1] += frame [1] * frame [1];   // DC component
-				for (long i = 2; i <= half_nsampFFT; i ++)
-					spec [i] += frame [i + i - 2] * frame [i + i - 2] + frame [i + i - 1] * frame [i + i - 1];
-				spec [half_nsampFFT + 1] += frame [nsampFFT] * frame [nsampFFT];   /* Nyquist frequency. Correct?? */
-			}
-			if (my ny > 1 ) for (long i = 1; i <= half_nsampFFT; i ++) {
-				spec [i] /= my ny;
-			}
-
-			/* Bin into frame [1..nBands]. */
-			for (long iband = 1; iband <= numberOfFreqs; iband ++) {
-				long leftsample = (iband - 1) * binWidth_samples + 1, rightsample = leftsample + binWidth_samples;
-				float power = 0.0f;
-				for (long i = leftsample; i < rightsample; i ++) power += spec [i];
-				thy z [iband] [iframe] = power * oneByBinWidth;
-			}
+		struct structSpectrogram_Analysis analysis = { thee.peek(), nsamp_window, halfnsamp_window, nsampFFT, half_nsampFFT,
+			numberOfFreqs, binWidth_samples, oneByBinWidth, frame.peek(), spec.peek(), window.peek(), & fftTable };
+		if (Thing_member (me, classLongSound)) {
+			LongSound_analyseInChunks ((LongSound) me, 0.0, thee.peek(), physicalAnalysisWidth, Sound_into_Spectrogram, & analysis);
+		} else {
+			Sound_into_Spectrogram (& analysis, (Sound) me, 1, my nx, 1, numberOfTimes);
 		}
 		return thee.transfer();
 	} catch (MelderError) {
@@ -182,6 +206,22 @@ Spectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, doubl
 	}
 }
 
+Spectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, double fmax,
+	double minimumTimeStep1, double minimumFreqStep1, enum kSound_to_Spectrogram_windowShape windowShape,
+	double maximumTimeOversampling, double maximumFreqOversampling)
+{
+	return Sampled_to_Spectrogram (me, effectiveAnalysisWidth, fmax, minimumTimeStep1, minimumFreqStep1, windowShape,
+		maximumTimeOversampling, maximumFreqOversampling);
+}
+
+Spectrogram LongSound_to_Spectrogram (LongSound me, double effectiveAnalysisWidth, double fmax,
+	double minimumTimeStep1, double minimumFreqStep1, enum kSound_to_Spectrogram_windowShape windowShape,
+	double maximumTimeOversampling, double maximumFreqOversampling)
+{
+	return Sampled_to_Spectrogram (me, effectiveAnalysisWidth, fmax, minimumTimeStep1, minimumFreqStep1, windowShape,
+		maximumTimeOversampling, maximumFreqOversampling);
+}
+
 Sound Spectrogram_to_Sound (Spectrogram me, double fsamp) {
 	try {
 		double dt = 1 / fsamp;
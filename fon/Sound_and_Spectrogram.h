@@ -20,6 +20,7 @@
  */
 
 #include "Sound.h"
+#include "LongSound.h"
 #include "Spectrogram.h"
 
 #include "Sound_and_Spectrogram_enums.h"
@@ -28,6 +29,11 @@ Spectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, doubl
 	double minimumTimeStep1, double minimumFreqStep1, enum kSound_to_Spectrogram_windowShape windowShape,
 	double maximumTimeOversampling, double maximumFreqOversampling);
 
+Spectrogram LongSound_to_Spectrogram (LongSound me, double effectiveAnalysisWidth, double fmax,
+	double minimumTimeStep1, double minimumFreqStep1, enum kSound_to_Spectrogram_windowShape windowShape,
+	double maximumTimeOversampling, double maximumFreqOversampling);
+/* The same as Sound_to_Spectrogram on the whole sound, but reads the LongSound in chunks. */
+
 Sound Spectrogram_to_Sound (Spectrogram me, double fsamp);
 
 /* End of Sound_and_Spectrogram.h */
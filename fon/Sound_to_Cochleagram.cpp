@@ -32,6 +32,8 @@
 #include "Sound_to_Cochleagram.h"
 #include "Sound_and_Spectrum.h"
 #include "Spectrum_to_Excitation.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 Cochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_window, double forwardMaskingTime) {
 	try {
@@ -81,6 +83,30 @@ Cochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_wind
 	}
 }
 
+/*
+ * The gammatones are applied as recursive filters (NUMgammatone), which give the same result as
+ * the convolution with the sampled impulse responses that EdB's model prescribes (50 periods long),
+ * without computing a Fourier transform of the whole sound for every filter.
+ * The filters are independent, so they are divided among threads;
+ * every thread has its own basilar-membrane buffer, long enough for the longest (lowest) gammatone.
+ */
+static long initGammatone (NUMgammatone gammatone, double midFrequency_Hertz, double samplingFrequency) {
+	double lengthOfGammatone_seconds = 50.0 / midFrequency_Hertz;   // 50 periods
+	long lengthOfGammatone_samples = (long) round (lengthOfGammatone_seconds * samplingFrequency);
+	/* EdB's alfa1: */
+	double latency = 1.95e-3 * pow (midFrequency_Hertz / 1000, -0.725) + 0.6e-3;
+	/* EdB's beta: */
+	double decayTime = 1e-3 * pow (midFrequency_Hertz / 1000, -0.663);
+	/* x^3 exp (-x) cos (omega t) with x = (t - latency) / decayTime: */
+	NUMgammatone_init (gammatone, 4, pow (decayTime, -3), 1 / decayTime, midFrequency_Hertz,
+		latency, lengthOfGammatone_samples, samplingFrequency);
+	return lengthOfGammatone_samples;
+}
+
+/*
+ * The finite impulse response itself, for checking the recursive filters against the convolution
+ * (Melder_debug 48; test/fon/cochleagramSpeed.praat).
+ */
 static Sound createGammatone (double midFrequency_Hertz, double samplingFrequency) {
 	double lengthOfGammatone_seconds = 50.0 / midFrequency_Hertz;   // 50 periods
 	long lengthOfGammatone_samples;
@@ -102,6 +128,142 @@ static Sound createGammatone (double midFrequency_Hertz, double samplingFrequenc
 	return gammatone.transfer();
 }
 
+Thing_define (Cochleagram_edb_Args, Thing) { public:
+	Sound sound;
+	Cochleagram cochleagram;
+	double dtime, dfreq;
+	int hasSynapse;
+	double replenishmentRate, lossRate, returnRate, reprocessingRate;
+	double *basil;   // [1..maximumLength], one per thread
+	bool isMainThread;
+	volatile long *next, *numberDone;
+	volatile int *cancelled;
+};
+
+Thing_implement (Cochleagram_edb_Args, Thing, 0);
+
+MelderThread_MUTEX (edbMutex);
+static bool edbMutex_inited;
+
+static MelderThread_RETURN_TYPE Cochleagram_edb_filter (Cochleagram_edb_Args me) {
+	Sound sound = my sound;
+	Cochleagram thee = my cochleagram;
+	const double dtime = my dtime, samplingFrequency = 1 / sound -> dx;
+	const long ntime = thy nx, nfreq = thy ny;
+	double *basil = my basil;
+	for (;;) {
+		MelderThread_LOCK (edbMutex);
+		long ifreq = ++ *my next;
+		MelderThread_UNLOCK (edbMutex);
+		if (ifreq > nfreq || *my cancelled) break;
+		double *response = thy z [ifreq];
+
+		/* Stage 3: basilar membrane filtering by gammatones. */
+		/* From oval window to basilar membrane response. */
+
+		double midFrequency_Bark = (ifreq - 0.5) * my dfreq;
+		double midFrequency_Hertz = Excitation_barkToHertz (midFrequency_Bark);
+		structNUMgammatone gammatone;
+		long lengthOfGammatone_samples = initGammatone (& gammatone, midFrequency_Hertz, samplingFrequency);
+		long basil_nx = sound -> nx + lengthOfGammatone_samples - 1;
+		double basil_x1 = sound -> x1 + 0.5 / samplingFrequency, basil_dx = sound -> dx;
+		if (Melder_debug == 48) {   // only on the main thread, because this can throw
+			autoSound gammatoneSound = createGammatone (midFrequency_Hertz, samplingFrequency);
+			autoSound convolved = Sounds_convolve (sound, gammatoneSound.peek(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
+			Melder_assert (convolved -> nx == basil_nx);
+			for (long itime = 1; itime <= basil_nx; itime ++)
+				basil [itime] = convolved -> z [1] [itime];
+		} else {
+			NUMgammatone_filter (& gammatone, sound -> z [1], sound -> nx, basil, basil_nx);
+		}
+
+		/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
+		/* From basilar membrane response to firing rate. */
+
+		if (my hasSynapse) {
+			double dt = sound -> dx;
+			double M = 1;   /* Maximum free transmitter. */
+			double A = 5, B = 300, g = 2000;   /* Determine permeability. */
+			double y = my replenishmentRate;          /* Meddis: 5.05 */
+			double l = my lossRate, r = my returnRate;   /* Meddis: 2500, 6580 */
+			double x = my reprocessingRate;           /* Meddis: 66.31 */
+			double h = 50000;   /* Convert cleft contents to firing rate. */
+			double gdt = 1 - exp (- g * dt), ydt = 1 - exp (- y * dt),
+					 ldt = (1 - exp (- (l + r) * dt)) * l / (l + r),
+					 rdt = (1 - exp (- (l + r) * dt)) * r / (l + r),
+					 xdt = 1 - exp (- x * dt);
+			double kt = g * A / (A + B);   /* Membrane permeability. */
+			double c = M * y * kt / (l * kt + y * (l + r));   /* Cleft contents. */
+			double q = c * (l + r) / kt;   /* Free transmitter. */
+			double w = c * r / x;   /* Reprocessing store. */
+			for (long itime = 1; itime <= basil_nx; itime ++) {
+				double splusA = basil [itime] * 10 + A;
+				double replenish = M > q ? ydt * (M - q) : 0;
+				double eject, loss, reuptake, reprocess;
+				kt = splusA > 0 ? gdt * splusA / (splusA + B) : 0;
+				eject = kt * q;
+				loss = ldt * c;
+				reuptake = rdt * c;
+				reprocess = xdt * w;
+				q = q + replenish - eject + reprocess;
+				c = c + eject - loss - reuptake;
+				w = w + reuptake - reprocess;
+				basil [itime] = h * c;
+			}
+		}
+
+		if (dtime == sound -> dx) {
+			for (long itime = 1; itime <= ntime; itime ++)
+				response [itime] = basil [itime];
+		} else {
+			double d = dtime / basil_dx / 2;
+			double factor = -6 / d / d;
+			double area = d * sqrt (NUMpi / 6);
+			double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+			for (long itime = 1; itime <= ntime; itime ++) {
+				double t1 = (itime - 1) * dtime, t2 = t1 + dtime, mean = 0;
+				/* The window samples, as in Matrix_getWindowSamplesX. */
+				long i1 = 1 + (long) ceil ((t1 - basil_x1) / basil_dx);
+				long i2 = 1 + (long) floor ((t2 - basil_x1) / basil_dx);
+				if (i1 < 1) i1 = 1;
+				if (i2 > basil_nx) i2 = basil_nx;
+				long n = i1 > i2 ? 0 : i2 - i1 + 1;
+				Melder_assert (n >= 1);
+				if (n <= 2) {
+					for (long isamp = i1; isamp <= i2; isamp ++)
+						mean += basil [isamp];
+					mean /= n;
+				} else {
+					double mu = floor ((i1 + i2) / 2.0);
+					long muint = mu, dint = d;
+					for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+						double y = 0;
+						if (isamp >= 1 && isamp <= basil_nx)
+							y = basil [isamp];
+						mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
+							(isamp - muint)) - expmin6);
+					}
+					mean /= area;
+				}
+				response [itime] = mean;
+			}
+		}
+		MelderThread_LOCK (edbMutex);
+		long numberOfFiltersDone = ++ *my numberDone;
+		MelderThread_UNLOCK (edbMutex);
+		if (my isMainThread) {
+			try {
+				Melder_progress ((double) numberOfFiltersDone / nfreq,
+					L"Cochleagram: filter ", Melder_integer (numberOfFiltersDone), L" out of ", Melder_integer (nfreq));
+			} catch (MelderError) {
+				*my cancelled = 1;
+				throw;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
 Cochleagram Sound_to_Cochleagram_edb
 	(Sound me, double dtime, double dfreq, int hasSynapse, double replenishmentRate,
 	 double lossRate, double returnRate, double reprocessingRate)
@@ -118,87 +280,41 @@ Cochleagram Sound_to_Cochleagram_edb
 		/* Stages 1 and 2: outer- and middle-ear filtering. */
 		/* From acoustic sound to oval window. */
 
+		long maximumLength = 1;
 		for (long ifreq = 1; ifreq <= nfreq; ifreq ++) {
-			double *response = thy z [ifreq];
-
-			/* Stage 3: basilar membrane filtering by gammatones. */
-			/* From oval window to basilar membrane response. */
-
-			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
-			double midFrequency_Hertz = Excitation_barkToHertz (midFrequency_Bark);
-			autoSound gammatone = createGammatone (midFrequency_Hertz, 1 / my dx);
-			autoSound basil = Sounds_convolve (me, gammatone.peek(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
-
-			/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
-			/* From basilar membrane response to firing rate. */
-
-			if (hasSynapse) {
-				double dt = my dx;
-				double M = 1;   /* Maximum free transmitter. */
-				double A = 5, B = 300, g = 2000;   /* Determine permeability. */
-				double y = replenishmentRate;          /* Meddis: 5.05 */
-				double l = lossRate, r = returnRate;   /* Meddis: 2500, 6580 */
-				double x = reprocessingRate;           /* Meddis: 66.31 */
-				double h = 50000;   /* Convert cleft contents to firing rate. */
-				double gdt = 1 - exp (- g * dt), ydt = 1 - exp (- y * dt),
-						 ldt = (1 - exp (- (l + r) * dt)) * l / (l + r),
-						 rdt = (1 - exp (- (l + r) * dt)) * r / (l + r),
-						 xdt = 1 - exp (- x * dt);
-				double kt = g * A / (A + B);   /* Membrane permeability. */
-				double c = M * y * kt / (l * kt + y * (l + r));   /* Cleft contents. */
-				double q = c * (l + r) / kt;   /* Free transmitter. */
-				double w = c * r / x;   /* Reprocessing store. */
-				for (long itime = 1; itime <= basil -> nx; itime ++) {
-					double splusA = basil -> z [1] [itime] * 10 + A;
-					double replenish = M > q ? ydt * (M - q) : 0;
-					double eject, loss, reuptake, reprocess;
-					kt = splusA > 0 ? gdt * splusA / (splusA + B) : 0;
-					eject = kt * q;
-					loss = ldt * c;
-					reuptake = rdt * c;
-					reprocess = xdt * w;
-					q = q + replenish - eject + reprocess;
-					c = c + eject - loss - reuptake;
-					w = w + reuptake - reprocess;
-					basil -> z [1] [itime] = h * c;
-				}
-			}
-			
-			if (dtime == my dx) {
-				for (long itime = 1; itime <= ntime; itime ++)
-					response [itime] = basil -> z [1] [itime];
-			} else {
-				double d = dtime / basil -> dx / 2;
-				double factor = -6 / d / d;
-				double area = d * sqrt (NUMpi / 6);
-				double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
-				for (long itime = 1; itime <= ntime; itime ++) {
-					double t1 = (itime - 1) * dtime, t2 = t1 + dtime, mean = 0;
-					long i1, i2;
-					long n = Matrix_getWindowSamplesX (basil.peek(), t1, t2, & i1, & i2);
-					Melder_assert (n >= 1);
-					if (n <= 2) {
-						for (long isamp = i1; isamp <= i2; isamp ++)
-							mean += basil -> z [1] [isamp];
-						mean /= n;
-					} else {
-						double mu = floor ((i1 + i2) / 2.0);
-						long muint = mu, dint = d;
-						for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
-							double y = 0;
-							if (isamp < 1 || isamp > basil -> nx)
-								Melder_casual ("isamp %ld", isamp);
-							else
-								y = basil -> z [1] [isamp];
-							mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
-								(isamp - muint)) - expmin6);
-						}
-						mean /= area;
-					}
-					response [itime] = mean;
-				}
-			}
+			structNUMgammatone gammatone;
+			long length = my nx + initGammatone (& gammatone, Excitation_barkToHertz ((ifreq - 0.5) * dfreq), 1 / my dx) - 1;
+			if (length > maximumLength) maximumLength = length;
+		}
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > nfreq) numberOfThreads = nfreq;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1 || Melder_debug == 48) numberOfThreads = 1;
+		if (! edbMutex_inited) { MelderThread_MUTEX_INIT (edbMutex); edbMutex_inited = true; }
+		autoMelderProgress progress (L"Cochleagram analysis...");
+		autoNUMmatrix <double> basil (1, numberOfThreads, 1, maximumLength);
+		autoCochleagram_edb_Args args [16];
+		volatile long next = 0, numberDone = 0;
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoCochleagram_edb_Args arg = Thing_new (Cochleagram_edb_Args);
+			arg -> sound = me;
+			arg -> cochleagram = thee.peek();
+			arg -> dtime = dtime;
+			arg -> dfreq = dfreq;
+			arg -> hasSynapse = hasSynapse;
+			arg -> replenishmentRate = replenishmentRate;
+			arg -> lossRate = lossRate;
+			arg -> returnRate = returnRate;
+			arg -> reprocessingRate = reprocessingRate;
+			arg -> basil = basil [ithread];
+			arg -> isMainThread = ithread == numberOfThreads;
+			arg -> next = & next;
+			arg -> numberDone = & numberDone;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1].reset (arg.transfer());
 		}
+		MelderThread_run (Cochleagram_edb_filter, args, numberOfThreads);
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": not converted to Cochleagram (edb).");
@@ -258,51 +258,60 @@ void Formant_sort (Formant me) {
 	}
 }
 
-static Formant Sound_to_Formant_any_inline (Sound me, double dt_in, int numberOfPoles,
-	double halfdt_window, int which, double preemphasisFrequency, double safetyMargin)
+struct structFormant_Analysis {
+	Formant formant;
+	int numberOfPoles, which;
+	long nsamp_window, halfnsamp_window;
+	double preemphasisFrequency, safetyMargin;
+	double *window, *frame, *cof;
+};
+
+/*
+ * Create the formant contour and the Gaussian window for a sound with the given sampling.
+ */
+static Formant Formant_createForAnalysis (struct structFormant_Analysis *me, double xmin, double xmax, long nx, double dx, double x1,
+	double dt_in, int numberOfPoles, double halfdt_window)
 {
 	double dt = dt_in > 0.0 ? dt_in : halfdt_window / 4.0;
-	double duration = my nx * my dx, t1;
+	double duration = nx * dx, t1;
 	double dt_window = 2.0 * halfdt_window;
 	long nFrames = 1 + (long) floor ((duration - dt_window) / dt);
-	long nsamp_window = (long) floor (dt_window / my dx), halfnsamp_window = nsamp_window / 2;
+	my nsamp_window = (long) floor (dt_window / dx), my halfnsamp_window = my nsamp_window / 2;
 
-	if (nsamp_window < numberOfPoles + 1)
+	if (my nsamp_window < numberOfPoles + 1)
 		Melder_throw ("Window too short.");
-	t1 = my x1 + 0.5 * (duration - my dx - (nFrames - 1) * dt);   // centre of first frame
+	t1 = x1 + 0.5 * (duration - dx - (nFrames - 1) * dt);   // centre of first frame
 	if (nFrames < 1) {
 		nFrames = 1;
-		t1 = my x1 + 0.5 * duration;
+		t1 = x1 + 0.5 * duration;
 		dt_window = duration;
-		nsamp_window = my nx;
+		my nsamp_window = nx;
 	}
-	autoFormant thee = Formant_create (my xmin, my xmax, nFrames, dt, t1, (numberOfPoles + 1) / 2);   // e.g. 11 poles -> maximally 6 formants
-	autoNUMvector <double> window (1, nsamp_window);
-	autoNUMvector <double> frame (1, nsamp_window);
-	autoNUMvector <double> cof (1, numberOfPoles);   // superfluous if which==2, but nobody uses that anyway
-
-	autoMelderProgress progress (L"Formant analysis...");
-
-	/* Pre-emphasis. */
-	Sound_preEmphasis (me, preemphasisFrequency);
+	return Formant_create (xmin, xmax, nFrames, dt, t1, (numberOfPoles + 1) / 2);   // e.g. 11 poles -> maximally 6 formants
+}
 
+static void Formant_Analysis_makeWindow (struct structFormant_Analysis *me) {
 	/* Gaussian window. */
-	for (long i = 1; i <= nsamp_window; i ++) {
-		double imid = 0.5 * (nsamp_window + 1), edge = exp (-12.0);
-		window [i] = (exp (-48.0 * (i - imid) * (i - imid) / (nsamp_window + 1) / (nsamp_window + 1)) - edge) / (1 - edge);
+	for (long i = 1; i <= my nsamp_window; i ++) {
+		double imid = 0.5 * (my nsamp_window + 1), edge = exp (-12.0);
+		my window [i] = (exp (-48.0 * (i - imid) * (i - imid) / (my nsamp_window + 1) / (my nsamp_window + 1)) - edge) / (1 - edge);
 	}
+}
 
-	for (long iframe = 1; iframe <= nFrames; iframe ++) {
-		double t = Sampled_indexToX (thee.peek(), iframe);
-		long leftSample = Sampled_xToLowIndex (me, t);
+static void Sound_into_Formant (struct structFormant_Analysis *me, Sound sound, long firstFrame, long lastFrame) {
+	Formant thee = my formant;
+	double *window = my window, *frame = my frame;
+	for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+		double t = Sampled_indexToX (thee, iframe);
+		long leftSample = Sampled_xToLowIndex (sound, t);
 		long rightSample = leftSample + 1;
-		long startSample = rightSample - halfnsamp_window;
-		long endSample = leftSample + halfnsamp_window;
+		long startSample = rightSample - my halfnsamp_window;
+		long endSample = leftSample + my halfnsamp_window;
 		double maximumIntensity = 0.0;
 		if (startSample < 1) startSample = 1;
-		if (endSample > my nx) endSample = my nx;
+		if (endSample > sound -> nx) endSample = sound -> nx;
 		for (long i = startSample; i <= endSample; i ++) {
-			double value = Sampled_getValueAtSample (me, i, Sound_LEVEL_MONO, 0);
+			double value = Sampled_getValueAtSample (sound, i, Sound_LEVEL_MONO, 0);
 			if (value * value > maximumIntensity) {
 				maximumIntensity = value * value;
 			}
@@ -313,19 +322,44 @@ static Formant Sound_to_Formant_any_inline (Sound me, double dt_in, int numberOf
 		if (maximumIntensity == 0.0) continue;   // Burg cannot stand all zeroes
 
 		/* Copy a pre-emphasized window to a frame. */
-		for (long j = 1, i = startSample; j <= nsamp_window; j ++)
-			frame [j] = Sampled_getValueAtSample (me, i ++, Sound_LEVEL_MONO, 0) * window [j];
+		for (long j = 1, i = startSample; j <= my nsamp_window; j ++)
+			frame [j] = Sampled_getValueAtSample (sound, i ++, Sound_LEVEL_MONO, 0) * window [j];
 
-		if (which == 1) {
-			burg (frame.peek(), endSample - startSample + 1, cof.peek(), numberOfPoles, & thy d_frames [iframe], 0.5 / my dx, safetyMargin);
-		} else if (which == 2) {
-			if (! splitLevinson (frame.peek(), endSample - startSample + 1, numberOfPoles, & thy d_frames [iframe], 0.5 / my dx)) {
+		if (my which == 1) {
+			burg (frame, endSample - startSample + 1, my cof, my numberOfPoles, & thy d_frames [iframe], 0.5 / sound -> dx, my safetyMargin);
+		} else if (my which == 2) {
+			if (! splitLevinson (frame, endSample - startSample + 1, my numberOfPoles, & thy d_frames [iframe], 0.5 / sound -> dx)) {
 				Melder_clearError ();
 				Melder_casual ("(Sound_to_Formant:) Analysis results of frame %ld will be wrong.", iframe);
 			}
 		}
-		Melder_progress ((double) iframe / (double) nFrames, L"Formant analysis: frame ", Melder_integer (iframe));
+		Melder_progress ((double) iframe / (double) thy nx, L"Formant analysis: frame ", Melder_integer (iframe));
 	}
+}
+
+static Formant Sound_to_Formant_any_inline (Sound me, double dt_in, int numberOfPoles,
+	double halfdt_window, int which, double preemphasisFrequency, double safetyMargin)
+{
+	struct structFormant_Analysis analysis = { 0 };
+	autoFormant thee = Formant_createForAnalysis (& analysis, my xmin, my xmax, my nx, my dx, my x1, dt_in, numberOfPoles, halfdt_window);
+	autoNUMvector <double> window (1, analysis.nsamp_window);
+	autoNUMvector <double> frame (1, analysis.nsamp_window);
+	autoNUMvector <double> cof (1, numberOfPoles);   // superfluous if which==2, but nobody uses that anyway
+	analysis.formant = thee.peek();
+	analysis.numberOfPoles = numberOfPoles;
+	analysis.which = which;
+	analysis.safetyMargin = safetyMargin;
+	analysis.window = window.peek();
+	analysis.frame = frame.peek();
+	analysis.cof = cof.peek();
+
+	autoMelderProgress progress (L"Formant analysis...");
+
+	/* Pre-emphasis. */
+	Sound_preEmphasis (me, preemphasisFrequency);
+
+	Formant_Analysis_makeWindow (& analysis);
+	Sound_into_Formant (& analysis, me, 1, thy nx);
 	Formant_sort (thee.peek());
 	return thee.transfer();
 }
@@ -344,6 +378,47 @@ Formant Sound_to_Formant_any (Sound me, double dt, int numberOfPoles, double max
 	return thee.transfer();
 }
 
+static void Sound_into_Formant_chunk (void *void_me, Sound part, long firstSample, long lastSample, long firstFrame, long lastFrame) {
+	struct structFormant_Analysis *me = (struct structFormant_Analysis *) void_me;
+	/*
+	 * Pre-emphasis as in Sound_preEmphasis. The first available sample of the part cannot be pre-emphasized,
+	 * but it lies outside the windows of the frames (unless it is the first sample of the sound, which is never pre-emphasized).
+	 */
+	double preEmphasis = exp (-2.0 * NUMpi * my preemphasisFrequency * part -> dx);
+	for (long channel = 1; channel <= part -> ny; channel ++) {
+		double *s = part -> z [channel];
+		for (long i = lastSample; i >= firstSample + 1; i --) s [i] -= preEmphasis * s [i - 1];
+	}
+	Sound_into_Formant (me, part, firstFrame, lastFrame);
+}
+
+Formant LongSound_to_Formant_any (LongSound me, double dt, int numberOfPoles, double maximumFrequency,
+	double halfdt_window, int which, double preemphasisFrequency, double safetyMargin)
+{
+	long nx;
+	double dx, x1;
+	LongSound_getAnalysisSampling (me, maximumFrequency * 2, & nx, & dx, & x1);
+	struct structFormant_Analysis analysis = { 0 };
+	autoFormant thee = Formant_createForAnalysis (& analysis, my xmin, my xmax, nx, dx, x1, dt, numberOfPoles, halfdt_window);
+	autoNUMvector <double> window (1, analysis.nsamp_window);
+	autoNUMvector <double> frame (1, analysis.nsamp_window);
+	autoNUMvector <double> cof (1, numberOfPoles);
+	analysis.formant = thee.peek();
+	analysis.numberOfPoles = numberOfPoles;
+	analysis.which = which;
+	analysis.preemphasisFrequency = preemphasisFrequency;
+	analysis.safetyMargin = safetyMargin;
+	analysis.window = window.peek();
+	analysis.frame = frame.peek();
+	analysis.cof = cof.peek();
+	Formant_Analysis_makeWindow (& analysis);
+
+	autoMelderProgress progress (L"Formant analysis...");
+	LongSound_analyseInChunks (me, maximumFrequency * 2, thee.peek(), (analysis.nsamp_window + 1) * dx, Sound_into_Formant_chunk, & analysis);
+	Formant_sort (thee.peek());
+	return thee.transfer();
+}
+
 Formant Sound_to_Formant_burg (Sound me, double dt, double nFormants, double maximumFrequency, double halfdt_window, double preemphasisFrequency) {
 	try {
 		return Sound_to_Formant_any (me, dt, (int) (2 * nFormants), maximumFrequency, halfdt_window, 1, preemphasisFrequency, 50.0);
@@ -368,4 +443,12 @@ Formant Sound_to_Formant_willems (Sound me, double dt, double nFormants, double
 	}
 }
 
+Formant LongSound_to_Formant_burg (LongSound me, double dt, double nFormants, double maximumFrequency, double halfdt_window, double preemphasisFrequency) {
+	try {
+		return LongSound_to_Formant_any (me, dt, (int) (2 * nFormants), maximumFrequency, halfdt_window, 1, preemphasisFrequency, 50.0);
+	} catch (MelderError) {
+		Melder_throw (me, ": formant analysis (Burg) not performed.");
+	}
+}
+
 /* End of file Sound_to_Formant.cpp */
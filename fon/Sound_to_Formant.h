@@ -18,6 +18,7 @@
  */
 
 #include "Sound.h"
+#include "LongSound.h"
 #include "Formant.h"
 
 Formant Sound_to_Formant_any (Sound me, double timeStep, int numberOfPoles, double maximumFrequency,
@@ -38,4 +39,15 @@ Formant Sound_to_Formant_keepAll (Sound me, double timeStep, double maximumNumbe
 Formant Sound_to_Formant_willems (Sound me, double timeStep, double numberOfFormants,
 	double maximumFormantFrequency, double windowLength, double preemphasisFrequency);
 
+Formant LongSound_to_Formant_any (LongSound me, double timeStep, int numberOfPoles, double maximumFrequency,
+	double halfdt_window, int which, double preemphasisFrequency, double safetyMargin);
+Formant LongSound_to_Formant_burg (LongSound me, double timeStep, double maximumNumberOfFormants,
+	double maximumFormantFrequency, double windowLength, double preemphasisFrequency);
+/*
+	The same as Sound_to_Formant_any and Sound_to_Formant_burg on the whole sound,
+	but reads the LongSound in chunks (see LongSound_analyseInChunks).
+	If the LongSound has to be resampled, this is done with Sound_resample_polyphase instead of Sound_resample,
+	so that the results are very close to, but not bit-identical with, those for the whole sound.
+*/
+
 /* End of file Sound_to_Formant.h */
@@ -33,67 +33,73 @@
  */
 
 #include "Sound_to_Intensity.h"
+#include "MelderThread.h"
 
-static Intensity Sound_to_Intensity_ (Sound me, double minimumPitch, double timeStep, int subtractMeanPressure) {
-	try {
-		/*
-		 * Preconditions.
-		 */
-		if (! NUMdefined (minimumPitch)) Melder_throw ("(Sound-to-Intensity:) Minimum pitch undefined.");
-		if (! NUMdefined (timeStep)) Melder_throw ("(Sound-to-Intensity:) Time step undefined.");
-		if (timeStep < 0.0) Melder_throw ("(Sound-to-Intensity:) Time step should be zero or positive instead of ", timeStep, ".");
-		if (my dx <= 0.0) Melder_throw ("(Sound-to-Intensity:) The Sound's time step should be positive.");
-		if (minimumPitch <= 0.0) Melder_throw ("(Sound-to-Intensity:) Minimum pitch should be positive.");
-		/*
-		 * Defaults.
-		 */
-		if (timeStep == 0.0) timeStep = 0.8 / minimumPitch;   // default: four times oversampling Hanning-wise
+/*
+ * Every intensity frame is a weighted sum over the samples within half a window of its centre,
+ * so frames can be computed in any order, by several threads at a time,
+ * and from any part of the sound that covers their windows (e.g. one chunk of a LongSound).
+ *
+ * The frames are not computed as a convolution with the window, nor from shared partial sums.
+ * With the standard window (6.4 periods) and time step (0.8 periods), every sample lies in only
+ * eight windows, so the direct sums take eight multiply-adds per sample and channel;
+ * a transform-based convolution would cost more per sample, and would also compute all the
+ * sample positions between the frames. The Kaiser weight of a sample differs from frame to frame,
+ * so only the mean could come from running sums; those would accumulate rounding errors over
+ * a whole recording, whereas every frame now gives the same bits as the single-frame computation.
+ */
+Thing_define (Intensity_Args, Thing) { public:
+	Sound sound;
+	Intensity intensity;
+	long firstFrame, lastFrame;
+	double *window;   // [-halfWindowSamples..halfWindowSamples]
+	long halfWindowSamples;
+	int subtractMeanPressure;
+	volatile long *next;
+};
 
-		double windowDuration = 6.4 / minimumPitch;
-		Melder_assert (windowDuration > 0.0);
-		double halfWindowDuration = 0.5 * windowDuration;
-		long halfWindowSamples = halfWindowDuration / my dx;
-		autoNUMvector <double> amplitude (- halfWindowSamples, halfWindowSamples);
-		autoNUMvector <double> window (- halfWindowSamples, halfWindowSamples);
+Thing_implement (Intensity_Args, Thing, 0);
 
-		for (long i = - halfWindowSamples; i <= halfWindowSamples; i ++) {
-			double x = i * my dx / halfWindowDuration, root = 1 - x * x;
-			window [i] = root <= 0.0 ? 0.0 : NUMbessel_i0_f ((2 * NUMpi * NUMpi + 0.5) * sqrt (root));
-		}
+MelderThread_MUTEX (intensityMutex);
+static bool intensityMutex_inited;
 
-		long numberOfFrames;
-		double thyFirstTime;
-		try {
-			Sampled_shortTermAnalysis (me, windowDuration, timeStep, & numberOfFrames, & thyFirstTime);
-		} catch (MelderError) {
-			Melder_throw ("The duration of the sound in an intensity analysis should be at least 6.4 divided by the minimum pitch (", minimumPitch, " Hz), "
-				"i.e. at least ", 6.4 / minimumPitch, " s, instead of ", my xmax - my xmin, " s.");
-		}
-		autoIntensity thee = Intensity_create (my xmin, my xmax, numberOfFrames, timeStep, thyFirstTime);
-		for (long iframe = 1; iframe <= numberOfFrames; iframe ++) {
-			double midTime = Sampled_indexToX (thee.peek(), iframe);
-			long midSample = Sampled_xToNearestIndex (me, midTime);
+#define Intensity_FRAMES_PER_BLOCK  100
+
+static MelderThread_RETURN_TYPE Intensity_computeFrames (Intensity_Args me) {
+	Sound sound = my sound;
+	Intensity thee = my intensity;
+	const long halfWindowSamples = my halfWindowSamples;
+	const long numberOfBlocks = (my lastFrame - my firstFrame) / Intensity_FRAMES_PER_BLOCK + 1;
+	const double *window = my window;
+	for (;;) {
+		MelderThread_LOCK (intensityMutex);
+		long iblock = ++ *my next;
+		MelderThread_UNLOCK (intensityMutex);
+		if (iblock > numberOfBlocks) break;
+		long fromFrame = my firstFrame + (iblock - 1) * Intensity_FRAMES_PER_BLOCK;
+		long toFrame = fromFrame + Intensity_FRAMES_PER_BLOCK - 1;
+		if (toFrame > my lastFrame) toFrame = my lastFrame;
+		for (long iframe = fromFrame; iframe <= toFrame; iframe ++) {
+			double midTime = Sampled_indexToX (thee, iframe);
+			long midSample = Sampled_xToNearestIndex (sound, midTime);
 			long leftSample = midSample - halfWindowSamples, rightSample = midSample + halfWindowSamples;
 			double sumxw = 0.0, sumw = 0.0, intensity;
 			if (leftSample < 1) leftSample = 1;
-			if (rightSample > my nx) rightSample = my nx;
+			if (rightSample > sound -> nx) rightSample = sound -> nx;
 
-			for (long channel = 1; channel <= my ny; channel ++) {
-				for (long i = leftSample; i <= rightSample; i ++) {
-					amplitude [i - midSample] = my z [channel] [i];
-				}
-				if (subtractMeanPressure) {
+			for (long channel = 1; channel <= sound -> ny; channel ++) {
+				const double *amplitude = sound -> z [channel];
+				double mean = 0.0;
+				if (my subtractMeanPressure) {
 					double sum = 0.0;
 					for (long i = leftSample; i <= rightSample; i ++) {
-						sum += amplitude [i - midSample];
-					}
-					double mean = sum / (rightSample - leftSample + 1);
-					for (long i = leftSample; i <= rightSample; i ++) {
-						amplitude [i - midSample] -= mean;
+						sum += amplitude [i];
 					}
+					mean = sum / (rightSample - leftSample + 1);
 				}
 				for (long i = leftSample; i <= rightSample; i ++) {
-					sumxw += amplitude [i - midSample] * amplitude [i - midSample] * window [i - midSample];
+					double a = amplitude [i] - mean;
+					sumxw += a * a * window [i - midSample];
 					sumw += window [i - midSample];
 				}
 			}
@@ -101,6 +107,83 @@ static Intensity Sound_to_Intensity_ (Sound me, double minimumPitch, double time
 			if (intensity != 0.0) intensity /= 4e-10;
 			thy z [1] [iframe] = intensity < 1e-30 ? -300 : 10 * log10 (intensity);
 		}
+	}
+	MelderThread_RETURN;
+}
+
+static void Intensity_computeFrames_threaded (Sound sound, Intensity thee, long firstFrame, long lastFrame,
+	double *window, long halfWindowSamples, int subtractMeanPressure)
+{
+	const long numberOfBlocks = (lastFrame - firstFrame) / Intensity_FRAMES_PER_BLOCK + 1;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfBlocks) numberOfThreads = numberOfBlocks;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	if (! intensityMutex_inited) { MelderThread_MUTEX_INIT (intensityMutex); intensityMutex_inited = true; }
+	autoIntensity_Args args [16];
+	volatile long next = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoIntensity_Args arg = Thing_new (Intensity_Args);
+		arg -> sound = sound;
+		arg -> intensity = thee;
+		arg -> firstFrame = firstFrame;
+		arg -> lastFrame = lastFrame;
+		arg -> window = window;
+		arg -> halfWindowSamples = halfWindowSamples;
+		arg -> subtractMeanPressure = subtractMeanPressure;
+		arg -> next = & next;
+		args [ithread - 1].reset (arg.transfer());
+	}
+	MelderThread_run (Intensity_computeFrames, args, numberOfThreads);
+}
+
+static void checkIntensityArguments (Sampled me, double minimumPitch, double timeStep) {
+	if (! NUMdefined (minimumPitch)) Melder_throw ("(Sound-to-Intensity:) Minimum pitch undefined.");
+	if (! NUMdefined (timeStep)) Melder_throw ("(Sound-to-Intensity:) Time step undefined.");
+	if (timeStep < 0.0) Melder_throw ("(Sound-to-Intensity:) Time step should be zero or positive instead of ", timeStep, ".");
+	if (my dx <= 0.0) Melder_throw ("(Sound-to-Intensity:) The Sound's time step should be positive.");
+	if (minimumPitch <= 0.0) Melder_throw ("(Sound-to-Intensity:) Minimum pitch should be positive.");
+}
+
+static Intensity Intensity_createForAnalysis (Sampled me, double minimumPitch, double timeStep, double windowDuration) {
+	long numberOfFrames;
+	double thyFirstTime;
+	try {
+		Sampled_shortTermAnalysis (me, windowDuration, timeStep, & numberOfFrames, & thyFirstTime);
+	} catch (MelderError) {
+		Melder_throw ("The duration of the sound in an intensity analysis should be at least 6.4 divided by the minimum pitch (", minimumPitch, " Hz), "
+			"i.e. at least ", 6.4 / minimumPitch, " s, instead of ", my xmax - my xmin, " s.");
+	}
+	return Intensity_create (my xmin, my xmax, numberOfFrames, timeStep, thyFirstTime);
+}
+
+static void makeIntensityWindow (double *window, long halfWindowSamples, double halfWindowDuration, double dx) {
+	for (long i = - halfWindowSamples; i <= halfWindowSamples; i ++) {
+		double x = i * dx / halfWindowDuration, root = 1 - x * x;
+		window [i] = root <= 0.0 ? 0.0 : NUMbessel_i0_f ((2 * NUMpi * NUMpi + 0.5) * sqrt (root));
+	}
+}
+
+static Intensity Sound_to_Intensity_ (Sound me, double minimumPitch, double timeStep, int subtractMeanPressure) {
+	try {
+		/*
+		 * Preconditions.
+		 */
+		checkIntensityArguments (me, minimumPitch, timeStep);
+		/*
+		 * Defaults.
+		 */
+		if (timeStep == 0.0) timeStep = 0.8 / minimumPitch;   // default: four times oversampling Hanning-wise
+
+		double windowDuration = 6.4 / minimumPitch;
+		Melder_assert (windowDuration > 0.0);
+		double halfWindowDuration = 0.5 * windowDuration;
+		long halfWindowSamples = halfWindowDuration / my dx;
+		autoNUMvector <double> window (- halfWindowSamples, halfWindowSamples);
+		makeIntensityWindow (window.peek(), halfWindowSamples, halfWindowDuration, my dx);
+
+		autoIntensity thee = Intensity_createForAnalysis (me, minimumPitch, timeStep, windowDuration);
+		Intensity_computeFrames_threaded (me, thee.peek(), 1, thy nx, window.peek(), halfWindowSamples, subtractMeanPressure);
 		return thee.transfer();
 	} catch (MelderError) {
 		Melder_throw (me, ": intensity analysis not performed.");
@@ -119,6 +202,39 @@ Intensity Sound_to_Intensity (Sound me, double minimumPitch, double timeStep, in
 	}
 }
 
+struct structIntensity_LongSoundClosure {
+	Intensity intensity;
+	double *window;
+	long halfWindowSamples;
+	int subtractMeanPressure;
+};
+
+static void Intensity_LongSound_analyseChunk (void *void_me, Sound part, long /* firstSample */, long /* lastSample */, long firstFrame, long lastFrame) {
+	struct structIntensity_LongSoundClosure *me = (struct structIntensity_LongSoundClosure *) void_me;
+	Intensity_computeFrames_threaded (part, my intensity, firstFrame, lastFrame, my window, my halfWindowSamples, my subtractMeanPressure);
+	Melder_progress ((double) lastFrame / my intensity -> nx,
+		L"Intensity: frame ", Melder_integer (lastFrame), L" out of ", Melder_integer (my intensity -> nx));
+}
+
+Intensity LongSound_to_Intensity (LongSound me, double minimumPitch, double timeStep, int subtractMeanPressure) {
+	try {
+		checkIntensityArguments (me, minimumPitch, timeStep);
+		if (timeStep == 0.0) timeStep = 0.8 / minimumPitch;
+		double windowDuration = 6.4 / minimumPitch;
+		double halfWindowDuration = 0.5 * windowDuration;
+		long halfWindowSamples = halfWindowDuration / my dx;
+		autoNUMvector <double> window (- halfWindowSamples, halfWindowSamples);
+		makeIntensityWindow (window.peek(), halfWindowSamples, halfWindowDuration, my dx);
+		autoIntensity thee = Intensity_createForAnalysis (me, minimumPitch, timeStep, windowDuration);
+		struct structIntensity_LongSoundClosure closure = { thee.peek(), window.peek(), halfWindowSamples, subtractMeanPressure };
+		autoMelderProgress progress (L"Intensity analysis...");
+		LongSound_analyseInChunks (me, 0.0, thee.peek(), halfWindowDuration, Intensity_LongSound_analyseChunk, & closure);
+		return thee.transfer();
+	} catch (MelderError) {
+		Melder_throw (me, ": intensity analysis not performed.");
+	}
+}
+
 IntensityTier Sound_to_IntensityTier (Sound me, double minimumPitch, double timeStep, int subtractMean) {
 	try {
 		autoIntensity intensity = Sound_to_Intensity (me, minimumPitch, timeStep, subtractMean);
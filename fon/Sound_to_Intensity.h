@@ -20,6 +20,7 @@
 #include "Sound.h"
 #include "Intensity.h"
 #include "IntensityTier.h"
+#include "LongSound.h"
 
 Intensity Sound_to_Intensity (Sound me, double minimumPitch, double timeStep, int subtractMean);
 /*
@@ -48,4 +49,10 @@ Intensity Sound_to_Intensity (Sound me, double minimumPitch, double timeStep, in
 
 IntensityTier Sound_to_IntensityTier (Sound me, double minimumPitch, double timeStep, int subtractMean);
 
+Intensity LongSound_to_Intensity (LongSound me, double minimumPitch, double timeStep, int subtractMean);
+/*
+	The same as Sound_to_Intensity on the whole sound, but reads the LongSound in chunks of about
+	the LongSound buffer size, so that the sound never has to be in memory as a whole.
+*/
+
 /* End of file Sound_to_Intensity.h */
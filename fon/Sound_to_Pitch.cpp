@@ -253,6 +253,7 @@ Thing_define (Sound_into_Pitch_Args, Thing) { public:
 	long nsamp_window, halfnsamp_window, maximumLag, nsampFFT, nsamp_period, halfnsamp_period, brent_ixmax, brent_depth;
 	double globalPeak, *window, *windowR;
 	bool isMainThread;
+	double progressOffset, progressScale;
 	volatile int *cancelled;
 };
 
@@ -264,7 +265,7 @@ static Sound_into_Pitch_Args Sound_into_Pitch_Args_create (Sound sound, Pitch pi
 	double dt_window, long nsamp_window, long halfnsamp_window, long maximumLag, long nsampFFT,
 	long nsamp_period, long halfnsamp_period, long brent_ixmax, long brent_depth,
 	double globalPeak, double *window, double *windowR,
-	bool isMainThread, volatile int *cancelled)
+	bool isMainThread, double progressOffset, double progressScale, volatile int *cancelled)
 {
 	autoSound_into_Pitch_Args me = Thing_new (Sound_into_Pitch_Args);
 	my sound = sound;
@@ -289,6 +290,8 @@ static Sound_into_Pitch_Args Sound_into_Pitch_Args_create (Sound sound, Pitch pi
 	my window = window;
 	my windowR = windowR;
 	my isMainThread = isMainThread;
+	my progressOffset = progressOffset;
+	my progressScale = progressScale;
 	my cancelled = cancelled;
 	return me.transfer();
 }
@@ -321,8 +324,8 @@ static MelderThread_RETURN_TYPE Sound_into_Pitch (Sound_into_Pitch_Args me)
 		double t = Sampled_indexToX (my pitch, iframe);
 		if (my isMainThread) {
 			try {
-				Melder_progress (0.1 + 0.8 * (iframe - my firstFrame) / (my lastFrame - my firstFrame),
-					L"Sound to Pitch: analysing ", Melder_integer (my lastFrame), L" frames");
+				Melder_progress (my progressOffset + my progressScale * (iframe - my firstFrame) / (my lastFrame - my firstFrame + 1.0),
+					L"Sound to Pitch: analysing ", Melder_integer (my pitch -> nx), L" frames");
 			} catch (MelderError) {
 				*my cancelled = 1;
 				throw;
@@ -341,7 +344,85 @@ static MelderThread_RETURN_TYPE Sound_into_Pitch (Sound_into_Pitch_Args me)
 	MelderThread_RETURN;
 }
 
-Pitch Sound_to_Pitch_any (Sound me,
+/*
+ * Analyse the frames firstFrame..lastFrame of the pitch contour my pitch, with the settings in 'me',
+ * divided over as many threads as are useful.
+ */
+static void Sound_into_Pitch_threaded (Sound sound, Sound_into_Pitch_Args me, long firstFrame, long lastFrame) {
+	long numberOfFrames = lastFrame - firstFrame + 1;
+	long numberOfFramesPerThread = 20;
+	int numberOfThreads = (numberOfFrames - 1) / numberOfFramesPerThread + 1;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	trace ("%d processors", (int) numberOfProcessors);
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreads + 1;
+
+	if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
+	autoSound_into_Pitch_Args args [16];
+	long fromFrame = firstFrame, toFrame = firstFrame + numberOfFramesPerThread - 1;
+	volatile int cancelled = 0;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		if (ithread == numberOfThreads) toFrame = lastFrame;
+		args [ithread - 1].reset (Sound_into_Pitch_Args_create (sound, my pitch,
+			fromFrame, toFrame, my minimumPitch, my maxnCandidates, my method,
+			my voicingThreshold, my octaveCost,
+			my dt_window, my nsamp_window, my halfnsamp_window, my maximumLag,
+			my nsampFFT, my nsamp_period, my halfnsamp_period, my brent_ixmax, my brent_depth,
+			my globalPeak, my window, my windowR,
+			ithread == numberOfThreads,
+			0.1 + 0.8 * (firstFrame - 1) / my pitch -> nx, 0.8 * numberOfFrames / my pitch -> nx, & cancelled));
+		fromFrame = toFrame + 1;
+		toFrame += numberOfFramesPerThread;
+	}
+	MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
+}
+
+static void Sound_into_Pitch_chunk (void *void_me, Sound part, long /* firstSample */, long /* lastSample */, long firstFrame, long lastFrame) {
+	iam (Sound_into_Pitch_Args);
+	Sound_into_Pitch_threaded (part, me, firstFrame, lastFrame);
+}
+
+/*
+ * The global peak, i.e. the largest absolute deviation of any sample from the mean of its channel,
+ * read in two passes over the LongSound, and computed in the same order as for a Sound.
+ */
+static double LongSound_getGlobalPeak (LongSound me) {
+	long samplesPerChunk = LongSound_getBufferSizePref_seconds () / my dx;
+	if (samplesPerChunk > my nx) samplesPerChunk = my nx;
+	autoNUMmatrix <double> buffer (1, my numberOfChannels, 1, samplesPerChunk);
+	autoNUMvector <double> mean (1, my numberOfChannels);
+	for (long firstSample = 1; firstSample <= my nx; firstSample += samplesPerChunk) {
+		long n = firstSample + samplesPerChunk - 1 <= my nx ? samplesPerChunk : my nx - firstSample + 1;
+		LongSound_readAudioToFloat (me, buffer.peek(), firstSample, n);
+		for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+			for (long i = 1; i <= n; i ++) {
+				mean [channel] += buffer [channel] [i];
+			}
+		}
+	}
+	for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+		mean [channel] /= my nx;
+	}
+	double globalPeak = 0.0;
+	for (long firstSample = 1; firstSample <= my nx; firstSample += samplesPerChunk) {
+		long n = firstSample + samplesPerChunk - 1 <= my nx ? samplesPerChunk : my nx - firstSample + 1;
+		LongSound_readAudioToFloat (me, buffer.peek(), firstSample, n);
+		for (long channel = 1; channel <= my numberOfChannels; channel ++) {
+			for (long i = 1; i <= n; i ++) {
+				double value = fabs (buffer [channel] [i] - mean [channel]);
+				if (value > globalPeak) globalPeak = value;
+			}
+		}
+	}
+	return globalPeak;
+}
+
+/*
+ * 'me' is a Sound or a LongSound.
+ */
+static Pitch Sampled_to_Pitch_any (Sampled me,
 	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
 	int method,
 	double silenceThreshold, double voicingThreshold,
@@ -445,16 +526,22 @@ Pitch Sound_to_Pitch_any (Sound me,
 		/*
 		 * Compute the global absolute peak for determination of silence threshold.
 		 */
-		globalPeak = 0.0;
-		for (long channel = 1; channel <= my ny; channel ++) {
-			double mean = 0.0;
-			for (long i = 1; i <= my nx; i ++) {
-				mean += my z [channel] [i];
-			}
-			mean /= my nx;
-			for (long i = 1; i <= my nx; i ++) {
-				double value = fabs (my z [channel] [i] - mean);
-				if (value > globalPeak) globalPeak = value;
+		bool isLongSound = Thing_member (me, classLongSound);
+		if (isLongSound) {
+			globalPeak = LongSound_getGlobalPeak ((LongSound) me);
+		} else {
+			Sound sound = (Sound) me;
+			globalPeak = 0.0;
+			for (long channel = 1; channel <= sound -> ny; channel ++) {
+				double mean = 0.0;
+				for (long i = 1; i <= sound -> nx; i ++) {
+					mean += sound -> z [channel] [i];
+				}
+				mean /= sound -> nx;
+				for (long i = 1; i <= sound -> nx; i ++) {
+					double value = fabs (sound -> z [channel] [i] - mean);
+					if (value > globalPeak) globalPeak = value;
+				}
 			}
 		}
 		if (globalPeak == 0.0) {
@@ -520,32 +607,22 @@ Pitch Sound_to_Pitch_any (Sound me,
 
 		autoMelderProgress progress (L"Sound to Pitch...");
 
-		long numberOfFramesPerThread = 20;
-		int numberOfThreads = (nFrames - 1) / numberOfFramesPerThread + 1;
-		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
-		trace ("%d processors", (int) numberOfProcessors);
-		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
-		if (numberOfThreads > 16) numberOfThreads = 16;
-		if (numberOfThreads < 1) numberOfThreads = 1;
-		numberOfFramesPerThread = (nFrames - 1) / numberOfThreads + 1;
-
-		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
-		autoSound_into_Pitch_Args args [16];
-		long firstFrame = 1, lastFrame = numberOfFramesPerThread;
-		volatile int cancelled = 0;
-		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
-			if (ithread == numberOfThreads) lastFrame = nFrames;
-			args [ithread - 1].reset (Sound_into_Pitch_Args_create (me, thee.peek(),
-				firstFrame, lastFrame, minimumPitch, maxnCandidates, method,
-				voicingThreshold, octaveCost,
-				dt_window, nsamp_window, halfnsamp_window, maximumLag,
-				nsampFFT, nsamp_period, halfnsamp_period, brent_ixmax, brent_depth,
-				globalPeak, window.peek(), windowR.peek(),
-				ithread == numberOfThreads, & cancelled));
-			firstFrame = lastFrame + 1;
-			lastFrame += numberOfFramesPerThread;
+		autoSound_into_Pitch_Args parameters = Sound_into_Pitch_Args_create (NULL, thee.peek(),
+			1, nFrames, minimumPitch, maxnCandidates, method,
+			voicingThreshold, octaveCost,
+			dt_window, nsamp_window, halfnsamp_window, maximumLag,
+			nsampFFT, nsamp_period, halfnsamp_period, brent_ixmax, brent_depth,
+			globalPeak, window.peek(), windowR.peek(), true, 0.1, 0.8, NULL);
+		if (isLongSound) {
+			/*
+			 * Every frame looks at most a longest period plus a window beyond its centre,
+			 * and the cross-correlation looks ahead by the maximum lag.
+			 */
+			double margin = 0.5 * (1.0 / minimumPitch + dt_window) + (maximumLag + nsamp_window + nsamp_period) * my dx;
+			LongSound_analyseInChunks ((LongSound) me, 0.0, thee.peek(), margin, Sound_into_Pitch_chunk, parameters.peek());
+		} else {
+			Sound_into_Pitch_threaded ((Sound) me, parameters.peek(), 1, nFrames);
 		}
-		MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
 
 		Melder_progress (0.95, L"Sound to Pitch: path finder");   // progress (0.95, L"Sound to Pitch: path finder");
 		Pitch_pathFinder (thee.peek(), silenceThreshold, voicingThreshold,
@@ -557,6 +634,31 @@ Pitch Sound_to_Pitch_any (Sound me,
 	}
 }
 
+Pitch Sound_to_Pitch_any (Sound me,
+	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
+	int method,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost, double ceiling)
+{
+	return Sampled_to_Pitch_any (me, dt, minimumPitch, periodsPerWindow, maxnCandidates, method,
+		silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost, ceiling);
+}
+
+Pitch LongSound_to_Pitch_any (LongSound me,
+	double dt, double minimumPitch, double periodsPerWindow, int maxnCandidates,
+	int method,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost, double ceiling)
+{
+	return Sampled_to_Pitch_any (me, dt, minimumPitch, periodsPerWindow, maxnCandidates, method,
+		silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost, ceiling);
+}
+
+Pitch LongSound_to_Pitch (LongSound me, double timeStep, double minimumPitch, double maximumPitch) {
+	return LongSound_to_Pitch_any (me, timeStep, minimumPitch,
+		3.0, 15, 0, 0.03, 0.45, 0.01, 0.35, 0.14, maximumPitch);
+}
+
 Pitch Sound_to_Pitch (Sound me, double timeStep, double minimumPitch, double maximumPitch) {
 	return Sound_to_Pitch_ac (me, timeStep, minimumPitch,
 		3.0, 15, FALSE, 0.03, 0.45, 0.01, 0.35, 0.14, maximumPitch);
@@ -18,6 +18,7 @@
  */
 
 #include "Sound.h"
+#include "LongSound.h"
 #include "Pitch.h"
 
 Pitch Sound_to_Pitch (Sound me, double timeStep,
@@ -85,4 +86,14 @@ Pitch Sound_to_Pitch_any (Sound me,
 		pitches above a certain value "voiceless".
 */
 
+Pitch LongSound_to_Pitch (LongSound me, double timeStep, double minimumPitch, double maximumPitch);
+Pitch LongSound_to_Pitch_any (LongSound me, double timeStep, double minimumPitch,
+	double periodsPerWindow, int maxnCandidates, int method,
+	double silenceThreshold, double voicingThreshold, double octaveCost,
+	double octaveJumpCost, double voicedUnvoicedCost, double maximumPitch);
+/*
+	The same as Sound_to_Pitch and Sound_to_Pitch_any on the whole sound,
+	but reads the LongSound in chunks (see LongSound_analyseInChunks).
+*/
+
 /* End of file Sound_to_Pitch.h */
@@ -303,43 +303,43 @@ Spectrum Spectrum_cepstralSmoothing (Spectrum me, double bandWidth) {
 	}
 }
 
-void Spectrum_passHannBand (Spectrum me, double fmin, double fmax0, double smooth) {
-	double fmax = fmax0 == 0.0 ? my xmax : fmax0;
+double Spectrum_passHannBand_factor (double frequency, double fmin, double fmax0, double smooth, double maximumFrequency) {
+	double fmax = fmax0 == 0.0 ? maximumFrequency : fmax0;
 	double f1 = fmin - smooth, f2 = fmin + smooth, f3 = fmax - smooth, f4 = fmax + smooth;
 	double halfpibysmooth = smooth != 0.0 ? NUMpi / (2 * smooth) : 0.0;
+	if (frequency < f1 || frequency > f4) return 0.0;
+	if (frequency < f2 && fmin > 0.0) return 0.5 - 0.5 * cos (halfpibysmooth * (frequency - f1));
+	if (frequency > f3 && fmax < maximumFrequency) return 0.5 + 0.5 * cos (halfpibysmooth * (frequency - f3));
+	return 1.0;
+}
+
+double Spectrum_stopHannBand_factor (double frequency, double fmin, double fmax0, double smooth, double maximumFrequency) {
+	double fmax = fmax0 == 0.0 ? maximumFrequency : fmax0;
+	double f1 = fmin - smooth, f2 = fmin + smooth, f3 = fmax - smooth, f4 = fmax + smooth;
+	double halfpibysmooth = smooth != 0.0 ? NUMpi / (2 * smooth) : 0.0;
+	if (frequency < f1 || frequency > f4) return 1.0;
+	if (frequency < f2 && fmin > 0.0) return 0.5 + 0.5 * cos (halfpibysmooth * (frequency - f1));
+	if (frequency > f3 && fmax < maximumFrequency) return 0.5 - 0.5 * cos (halfpibysmooth * (frequency - f3));
+	return 0.0;
+}
+
+void Spectrum_passHannBand (Spectrum me, double fmin, double fmax, double smooth) {
 	double *re = my z [1], *im = my z [2];
 	for (long i = 1; i <= my nx; i ++) {
 		double frequency = my x1 + (i - 1) * my dx;
-		if (frequency < f1 || frequency > f4) re [i] = im [i] = 0.0;
-		if (frequency < f2 && fmin > 0.0) {
-			double factor = 0.5 - 0.5 * cos (halfpibysmooth * (frequency - f1));
-			re [i] *= factor;
-			im [i] *= factor;
-		} else if (frequency > f3 && fmax < my xmax) {
-			double factor = 0.5 + 0.5 * cos (halfpibysmooth * (frequency - f3));
-			re [i] *= factor;
-			im [i] *= factor;
-		}
+		double factor = Spectrum_passHannBand_factor (frequency, fmin, fmax, smooth, my xmax);
+		re [i] *= factor;
+		im [i] *= factor;
 	}
 }
 
-void Spectrum_stopHannBand (Spectrum me, double fmin, double fmax0, double smooth) {
-	double fmax = fmax0 == 0.0 ? my xmax : fmax0;
-	double f1 = fmin - smooth, f2 = fmin + smooth, f3 = fmax - smooth, f4 = fmax + smooth;
-	double halfpibysmooth = smooth != 0.0 ? NUMpi / (2 * smooth) : 0.0;
+void Spectrum_stopHannBand (Spectrum me, double fmin, double fmax, double smooth) {
 	double *re = my z [1], *im = my z [2];
 	for (long i = 1; i <= my nx; i ++) {
 		double frequency = my x1 + (i - 1) * my dx;
-		if (frequency < f1 || frequency > f4) continue;
-		if (frequency < f2 && fmin > 0.0) {
-			double factor = 0.5 + 0.5 * cos (halfpibysmooth * (frequency - f1));
-			re [i] *= factor;
-			im [i] *= factor;
-		} else if (frequency > f3 && fmax < my xmax) {
-			double factor = 0.5 - 0.5 * cos (halfpibysmooth * (frequency - f3));
-			re [i] *= factor;
-			im [i] *= factor;
-		} else re [i] = im [i] = 0.0;
+		double factor = Spectrum_stopHannBand_factor (frequency, fmin, fmax, smooth, my xmax);
+		re [i] *= factor;
+		im [i] *= factor;
 	}
 }
 
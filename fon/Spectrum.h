@@ -102,6 +102,12 @@ Spectrum Spectrum_cepstralSmoothing (Spectrum me, double bandWidth);
 
 void Spectrum_passHannBand (Spectrum me, double fmin, double fmax, double smooth);
 void Spectrum_stopHannBand (Spectrum me, double fmin, double fmax, double smooth);
+double Spectrum_passHannBand_factor (double frequency, double fmin, double fmax, double smooth, double maximumFrequency);
+double Spectrum_stopHannBand_factor (double frequency, double fmin, double fmax, double smooth, double maximumFrequency);
+/*
+	The factors by which Spectrum_passHannBand and Spectrum_stopHannBand multiply
+	the value at `frequency` of a spectrum that runs up to `maximumFrequency`.
+*/
 
 void Spectrum_getNearestMaximum (Spectrum me, double frequency, double *frequencyOfMaximum, double *heightOfMaximum);
 
@@ -256,11 +256,212 @@ void PointProcess_Sound_getShimmer_multi (PointProcess me, Sound thee, double tm
 	}
 }
 
+/*
+ * The voice-report engine.
+ * All period and amplitude measures of a time window are computed from a single walk through the pulses:
+ * each period is validated once, each peak amplitude is measured in the Sound once,
+ * and the jitter and shimmer variants are accumulated side by side.
+ * The results are identical to those of the separate PointProcess_getJitter_XXX and PointProcess_Sound_getShimmer_XXX.
+ */
+typedef struct structVoiceMeasures {
+	long numberOfPulses, numberOfPeriods, numberOfVoiceBreaks;
+	double meanPeriod, stdevPeriod, durationOfVoiceBreaks;
+	double jitter_local, jitter_local_absolute, jitter_rap, jitter_ppq5, jitter_ddp;
+	double shimmer_local, shimmer_local_dB, shimmer_apq3, shimmer_apq5, shimmer_apq11, shimmer_dda;
+} *VoiceMeasures;
+
+static void PointProcess_Sound_getVoiceMeasures (PointProcess me, Sound thee, double tmin, double tmax,
+	double pmin, double pmax, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double *periods, double *peakTimes, double *peakValues, VoiceMeasures result)
+	/*
+	 * 'periods', 'peakTimes' and 'peakValues' are scratch buffers with at least my nt elements (base 1),
+	 * so that a batch of windows needs no allocation per window.
+	 */
+{
+	long imin, imax;
+	long numberOfPulses = PointProcess_getWindowPoints (me, tmin, tmax, & imin, & imax);
+	long numberOfIntervals = numberOfPulses - 1;
+	double *t = my t;
+	result -> numberOfPulses = numberOfPulses;
+	/*
+	 * Pass 1: period statistics and voice breaks, with PointProcess_isPeriod evaluated once per interval.
+	 */
+	long numberOfPeriods = 0, numberOfVoiceBreaks = 0;
+	double sum = 0.0, durationOfVoiceBreaks = 0.0;
+	bool previousPeriodVoiced = true;
+	for (long i = imin; i < imax; i ++) {
+		double interval = t [i + 1] - t [i];
+		if (PointProcess_isPeriod (me, i, pmin, pmax, maximumPeriodFactor)) {
+			periods [++ numberOfPeriods] = interval;
+			sum += interval;
+		}
+		if (i < imax - 1) {
+			if (interval > pmax) {
+				durationOfVoiceBreaks += interval;
+				if (previousPeriodVoiced) {
+					numberOfVoiceBreaks ++;
+					previousPeriodVoiced = false;
+				}
+			} else {
+				previousPeriodVoiced = true;
+			}
+		}
+	}
+	result -> numberOfPeriods = numberOfPeriods;
+	result -> numberOfVoiceBreaks = numberOfPulses > 1 ? numberOfVoiceBreaks : 0;
+	result -> durationOfVoiceBreaks = numberOfPulses > 1 ? durationOfVoiceBreaks : 0.0;
+	double meanPeriod = numberOfPeriods > 0 ? sum / numberOfPeriods : NUMundefined;
+	result -> meanPeriod = meanPeriod;
+	result -> stdevPeriod = NUMundefined;
+	if (numberOfPeriods >= 2) {
+		double sum2 = 0.0;
+		for (long iperiod = 1; iperiod <= numberOfPeriods; iperiod ++) {
+			double dperiod = periods [iperiod] - meanPeriod;
+			sum2 += dperiod * dperiod;
+		}
+		result -> stdevPeriod = sqrt (sum2 / (numberOfPeriods - 1));
+	}
+	/*
+	 * Pass 2: jitter and peak amplitudes.
+	 * The condition that the periods to the left and to the right of pulse i are in range and comparable
+	 * is shared by all jitter measures and by the peak extraction of PointProcess_Sound_to_AmplitudeTier_period;
+	 * 'run' counts how many consecutive pulses satisfy it, so that rap (3 periods) and ppq5 (5 periods) need no re-validation.
+	 */
+	long numberOfInvalidLocal = 0, numberOfInvalidRap = 0, numberOfInvalidPpq5 = 0, run = 0, numberOfPeaks = 0;
+	double sumLocal = 0.0, sumRap = 0.0, sumPpq5 = 0.0;
+	bool measureShimmer = numberOfPulses >= 3;
+	for (long i = imin + 1; i < imax; i ++) {
+		double p1 = t [i] - t [i - 1], p2 = t [i + 1] - t [i];
+		double intervalFactor = p1 > p2 ? p1 / p2 : p2 / p1;
+		bool valid = pmin == pmax || (p1 >= pmin && p1 <= pmax && p2 >= pmin && p2 <= pmax && intervalFactor <= maximumPeriodFactor);
+		run = valid ? run + 1 : 0;
+		if (valid) {
+			sumLocal += fabs (p1 - p2);
+		} else {
+			numberOfInvalidLocal ++;
+		}
+		if (i >= imin + 2) {
+			if (run >= 2) {
+				double p0 = t [i - 1] - t [i - 2];
+				sumRap += fabs (p1 - (p0 + p1 + p2) / 3.0);
+			} else {
+				numberOfInvalidRap ++;
+			}
+		}
+		if (i >= imin + 4) {
+			if (run >= 4) {
+				double
+					q1 = t [i - 3] - t [i - 4],
+					q2 = t [i - 2] - t [i - 3],
+					q3 = t [i - 1] - t [i - 2];
+				sumPpq5 += fabs (q3 - (q1 + q2 + q3 + p1 + p2) / 5.0);
+			} else {
+				numberOfInvalidPpq5 ++;
+			}
+		}
+		if (measureShimmer && valid) {
+			double peak = Sound_getHannWindowedRms (thee, t [i], 0.2 * p1, 0.2 * p2);
+			if (NUMdefined (peak) && peak > 0.0) {
+				numberOfPeaks ++;
+				peakTimes [numberOfPeaks] = t [i];
+				peakValues [numberOfPeaks] = peak;
+			}
+		}
+	}
+	long numberOfLocal = numberOfIntervals - numberOfInvalidLocal;
+	long numberOfRap = numberOfIntervals - numberOfInvalidRap;
+	long numberOfPpq5 = numberOfIntervals - numberOfInvalidPpq5;
+	result -> jitter_local_absolute = numberOfIntervals < 2 || numberOfLocal < 2 ? NUMundefined : sumLocal / (numberOfLocal - 1);
+	result -> jitter_local = numberOfIntervals < 2 || numberOfLocal < 2 ? NUMundefined : sumLocal / (numberOfLocal - 1) / meanPeriod;
+	result -> jitter_rap = numberOfIntervals < 3 || numberOfRap < 3 ? NUMundefined : sumRap / (numberOfRap - 2) / meanPeriod;
+	result -> jitter_ppq5 = numberOfIntervals < 5 || numberOfPpq5 < 5 ? NUMundefined : sumPpq5 / (numberOfPpq5 - 4) / meanPeriod;
+	result -> jitter_ddp = NUMdefined (result -> jitter_rap) ? 3.0 * result -> jitter_rap : NUMundefined;
+	/*
+	 * Pass 3: shimmer, from the peak amplitudes.
+	 * As for jitter, 'run' counts the consecutive peak pairs whose distance is in range and whose amplitudes are comparable.
+	 */
+	result -> shimmer_local = result -> shimmer_local_dB = result -> shimmer_apq3 =
+		result -> shimmer_apq5 = result -> shimmer_apq11 = result -> shimmer_dda = NUMundefined;
+	if (! measureShimmer) return;
+	long numberOfLocalPairs = 0, numberOfApq3 = 0, numberOfApq5 = 0, numberOfApq11 = 0;
+	double numeratorLocal = 0.0, sum_dB = 0.0, numeratorApq3 = 0.0, numeratorApq5 = 0.0, numeratorApq11 = 0.0;
+	double *a = peakValues;
+	run = 0;
+	for (long k = 2; k <= numberOfPeaks; k ++) {
+		double p = peakTimes [k] - peakTimes [k - 1];
+		double a1 = peakValues [k - 1], a2 = peakValues [k];
+		double amplitudeFactor = a1 > a2 ? a1 / a2 : a2 / a1;
+		bool valid = (pmin == pmax || (p >= pmin && p <= pmax)) && amplitudeFactor <= maximumAmplitudeFactor;
+		run = valid ? run + 1 : 0;
+		if (! valid) continue;
+		numeratorLocal += fabs (a1 - a2);
+		sum_dB += fabs (log10 (a1 / a2));
+		numberOfLocalPairs ++;
+		if (run >= 2) {   // centred on peak k - 1
+			double threePointAverage = (a [k - 2] + a [k - 1] + a [k]) / 3.0;
+			numeratorApq3 += fabs (a [k - 1] - threePointAverage);
+			numberOfApq3 ++;
+		}
+		if (run >= 4) {   // centred on peak k - 2
+			double fivePointAverage = (a [k - 4] + a [k - 3] + a [k - 2] + a [k - 1] + a [k]) / 5.0;
+			numeratorApq5 += fabs (a [k - 2] - fivePointAverage);
+			numberOfApq5 ++;
+		}
+		if (run >= 10) {   // centred on peak k - 5
+			double elevenPointAverage = (a [k - 10] + a [k - 9] + a [k - 8] + a [k - 7] + a [k - 6] + a [k - 5] +
+				a [k - 4] + a [k - 3] + a [k - 2] + a [k - 1] + a [k]) / 11.0;
+			numeratorApq11 += fabs (a [k - 5] - elevenPointAverage);
+			numberOfApq11 ++;
+		}
+	}
+	double denominator = 0.0;
+	for (long k = 1; k < numberOfPeaks; k ++) {
+		denominator += peakValues [k];
+	}
+	denominator /= numberOfPeaks - 1;
+	if (numberOfLocalPairs >= 1) {
+		result -> shimmer_local_dB = 20.0 * (sum_dB / numberOfLocalPairs);
+		if (denominator != 0.0) result -> shimmer_local = numeratorLocal / numberOfLocalPairs / denominator;
+	}
+	if (numberOfApq3 >= 1 && denominator != 0.0) {
+		result -> shimmer_apq3 = numeratorApq3 / numberOfApq3 / denominator;
+		result -> shimmer_dda = 3.0 * result -> shimmer_apq3;
+	}
+	if (numberOfApq5 >= 1 && denominator != 0.0) result -> shimmer_apq5 = numeratorApq5 / numberOfApq5 / denominator;
+	if (numberOfApq11 >= 1 && denominator != 0.0) result -> shimmer_apq11 = numeratorApq11 / numberOfApq11 / denominator;
+}
+
+static double Pitch_getFractionOfLocallyUnvoicedFrames (Pitch me, double tmin, double tmax,
+	double ceiling, double silenceThreshold, double voicingThreshold, long *numberOfUnvoicedFrames, long *numberOfFrames)
+{
+	long imin, imax, n = Sampled_getWindowSamples (me, tmin, tmax, & imin, & imax), nunvoiced = n;
+	for (long i = imin; i <= imax; i ++) {
+		Pitch_Frame frame = & my frame [i];
+		if (frame -> intensity >= silenceThreshold) {
+			for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
+				Pitch_Candidate cand = & frame -> candidate [icand];
+				if (cand -> frequency > 0.0 && cand -> frequency < ceiling && cand -> strength >= voicingThreshold) {
+					nunvoiced --;
+					break;   // next frame
+				}
+			}
+		}
+	}
+	if (numberOfUnvoicedFrames) *numberOfUnvoicedFrames = nunvoiced;
+	if (numberOfFrames) *numberOfFrames = n;
+	return n <= 0 ? NUMundefined : (double) nunvoiced / n;
+}
+
 void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProcess pulses, double tmin, double tmax,
 	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor, double silenceThreshold, double voicingThreshold)
 {
 	try {
 		if (tmin >= tmax) tmin = sound -> xmin, tmax = sound -> xmax;
+		double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
+		autoNUMvector <double> periods (1, pulses -> nt), peakTimes (1, pulses -> nt), peakValues (1, pulses -> nt);
+		struct structVoiceMeasures measures;
+		PointProcess_Sound_getVoiceMeasures (pulses, sound, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
+			periods.peek(), peakTimes.peek(), peakValues.peek(), & measures);
 		/*
 		 * Time domain. Should be preceded by something like "Time range of SELECTION:" or so.
 		 */
@@ -278,74 +479,41 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 		/*
 		 * Pulses statistics.
 		 */
-		double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
 		MelderInfo_writeLine (L"Pulses:");
-		MelderInfo_writeLine (L"   Number of pulses: ", Melder_integer (PointProcess_getWindowPoints (pulses, tmin, tmax, NULL, NULL)));
-		MelderInfo_writeLine (L"   Number of periods: ", Melder_integer (PointProcess_getNumberOfPeriods (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor)));
-		MelderInfo_writeLine (L"   Mean period: ", Melder_fixedExponent (PointProcess_getMeanPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -3, 6), L" seconds");
-		MelderInfo_writeLine (L"   Standard deviation of period: ", Melder_fixedExponent (PointProcess_getStdevPeriod (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -3, 6), L" seconds");
+		MelderInfo_writeLine (L"   Number of pulses: ", Melder_integer (measures.numberOfPulses));
+		MelderInfo_writeLine (L"   Number of periods: ", Melder_integer (measures.numberOfPeriods));
+		MelderInfo_writeLine (L"   Mean period: ", Melder_fixedExponent (measures.meanPeriod, -3, 6), L" seconds");
+		MelderInfo_writeLine (L"   Standard deviation of period: ", Melder_fixedExponent (measures.stdevPeriod, -3, 6), L" seconds");
 		/*
 		 * Voicing.
 		 */
-		long imin, imax, n = Sampled_getWindowSamples (pitch, tmin, tmax, & imin, & imax), nunvoiced = n;
-		for (long i = imin; i <= imax; i ++) {
-			Pitch_Frame frame = & pitch -> frame [i];
-			if (frame -> intensity >= silenceThreshold) {
-				for (long icand = 1; icand <= frame -> nCandidates; icand ++) {
-					Pitch_Candidate cand = & frame -> candidate [icand];
-					if (cand -> frequency > 0.0 && cand -> frequency < ceiling && cand -> strength >= voicingThreshold) {
-						nunvoiced --;
-						break;   // next frame
-					}
-				}
-			}
-		}
+		long nunvoiced, n;
+		double unvoicedFraction = Pitch_getFractionOfLocallyUnvoicedFrames (pitch, tmin, tmax, ceiling, silenceThreshold, voicingThreshold, & nunvoiced, & n);
 		MelderInfo_writeLine (L"Voicing:");
-		MelderInfo_write (L"   Fraction of locally unvoiced frames: ", Melder_percent (n <= 0 ? NUMundefined : (double) nunvoiced / n, 3));
+		MelderInfo_write (L"   Fraction of locally unvoiced frames: ", Melder_percent (unvoicedFraction, 3));
 		MelderInfo_writeLine (L"   (", Melder_integer (nunvoiced), L" / ", Melder_integer (n), L")");
-		n = PointProcess_getWindowPoints (pulses, tmin, tmax, & imin, & imax);
-		long numberOfVoiceBreaks = 0;
-		double durationOfVoiceBreaks = 0.0;
-		if (n > 1) {
-			bool previousPeriodVoiced = true;
-			for (long i = imin + 1; i < imax; i ++) {
-				double period = pulses -> t [i] - pulses -> t [i - 1];
-				if (period > pmax) {
-					durationOfVoiceBreaks += period;
-					if (previousPeriodVoiced) {
-						numberOfVoiceBreaks ++;
-						previousPeriodVoiced = false;
-					}
-				} else {
-					previousPeriodVoiced = true;
-				}
-			}
-		}
-		MelderInfo_writeLine (L"   Number of voice breaks: ", Melder_integer (numberOfVoiceBreaks));
-		MelderInfo_write (L"   Degree of voice breaks: ", Melder_percent (durationOfVoiceBreaks / (tmax - tmin), 3));
-		MelderInfo_writeLine (L"   (", Melder_fixed (durationOfVoiceBreaks, 6), L" seconds / ", Melder_fixed (tmax - tmin, 6), L" seconds)");
+		MelderInfo_writeLine (L"   Number of voice breaks: ", Melder_integer (measures.numberOfVoiceBreaks));
+		MelderInfo_write (L"   Degree of voice breaks: ", Melder_percent (measures.durationOfVoiceBreaks / (tmax - tmin), 3));
+		MelderInfo_writeLine (L"   (", Melder_fixed (measures.durationOfVoiceBreaks, 6), L" seconds / ", Melder_fixed (tmax - tmin, 6), L" seconds)");
 		/*
 		 * Jitter.
 		 */
-		double shimmerLocal, shimmerLocal_dB, apq3, apq5, apq11, dda;
 		MelderInfo_writeLine (L"Jitter:");
-		MelderInfo_writeLine (L"   Jitter (local): ", Melder_percent (PointProcess_getJitter_local (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (L"   Jitter (local, absolute): ", Melder_fixedExponent (PointProcess_getJitter_local_absolute (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), -6, 3), L" seconds");
-		MelderInfo_writeLine (L"   Jitter (rap): ", Melder_percent (PointProcess_getJitter_rap (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (L"   Jitter (ppq5): ", Melder_percent (PointProcess_getJitter_ppq5 (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
-		MelderInfo_writeLine (L"   Jitter (ddp): ", Melder_percent (PointProcess_getJitter_ddp (pulses, tmin, tmax, pmin, pmax, maximumPeriodFactor), 3));
+		MelderInfo_writeLine (L"   Jitter (local): ", Melder_percent (measures.jitter_local, 3));
+		MelderInfo_writeLine (L"   Jitter (local, absolute): ", Melder_fixedExponent (measures.jitter_local_absolute, -6, 3), L" seconds");
+		MelderInfo_writeLine (L"   Jitter (rap): ", Melder_percent (measures.jitter_rap, 3));
+		MelderInfo_writeLine (L"   Jitter (ppq5): ", Melder_percent (measures.jitter_ppq5, 3));
+		MelderInfo_writeLine (L"   Jitter (ddp): ", Melder_percent (measures.jitter_ddp, 3));
 		/*
 		 * Shimmer.
 		 */
-		PointProcess_Sound_getShimmer_multi (pulses, sound, tmin, tmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
-			& shimmerLocal, & shimmerLocal_dB, & apq3, & apq5, & apq11, & dda);
 		MelderInfo_writeLine (L"Shimmer:");
-		MelderInfo_writeLine (L"   Shimmer (local): ", Melder_percent (shimmerLocal, 3));
-		MelderInfo_writeLine (L"   Shimmer (local, dB): ", Melder_fixed (shimmerLocal_dB, 3), L" dB");
-		MelderInfo_writeLine (L"   Shimmer (apq3): ", Melder_percent (apq3, 3));
-		MelderInfo_writeLine (L"   Shimmer (apq5): ", Melder_percent (apq5, 3));
-		MelderInfo_writeLine (L"   Shimmer (apq11): ", Melder_percent (apq11, 3));
-		MelderInfo_writeLine (L"   Shimmer (dda): ", Melder_percent (dda, 3));
+		MelderInfo_writeLine (L"   Shimmer (local): ", Melder_percent (measures.shimmer_local, 3));
+		MelderInfo_writeLine (L"   Shimmer (local, dB): ", Melder_fixed (measures.shimmer_local_dB, 3), L" dB");
+		MelderInfo_writeLine (L"   Shimmer (apq3): ", Melder_percent (measures.shimmer_apq3, 3));
+		MelderInfo_writeLine (L"   Shimmer (apq5): ", Melder_percent (measures.shimmer_apq5, 3));
+		MelderInfo_writeLine (L"   Shimmer (apq11): ", Melder_percent (measures.shimmer_apq11, 3));
+		MelderInfo_writeLine (L"   Shimmer (dda): ", Melder_percent (measures.shimmer_dda, 3));
 		/*
 		 * Harmonicity.
 		 */
@@ -358,4 +526,97 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 	}
 }
 
+static Table voiceReportTable (Sound sound, Pitch pitch, PointProcess pulses,
+	long numberOfWindows, const double tmin [], const double tmax [], const wchar_t **labels,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor, double silenceThreshold, double voicingThreshold)
+{
+	autoTable thee = Table_createWithColumnNames (numberOfWindows, labels ?
+		L"tmin tmax label medianPitch meanPitch stdevPitch minPitch maxPitch pulses periods meanPeriod stdevPeriod "
+		"unvoicedFraction voiceBreaks degreeOfVoiceBreaks jitterLocal jitterLocalAbsolute jitterRap jitterPpq5 jitterDdp "
+		"shimmerLocal shimmerLocalDB shimmerApq3 shimmerApq5 shimmerApq11 shimmerDda meanAutocorrelation meanNHR meanHNR" :
+		L"tmin tmax medianPitch meanPitch stdevPitch minPitch maxPitch pulses periods meanPeriod stdevPeriod "
+		"unvoicedFraction voiceBreaks degreeOfVoiceBreaks jitterLocal jitterLocalAbsolute jitterRap jitterPpq5 jitterDdp "
+		"shimmerLocal shimmerLocalDB shimmerApq3 shimmerApq5 shimmerApq11 shimmerDda meanAutocorrelation meanNHR meanHNR");
+	double pmin = 0.8 / ceiling, pmax = 1.25 / floor;
+	/*
+	 * One set of scratch buffers for all windows.
+	 */
+	autoNUMvector <double> periods (1, pulses -> nt), peakTimes (1, pulses -> nt), peakValues (1, pulses -> nt);
+	for (long iwindow = 1; iwindow <= numberOfWindows; iwindow ++) {
+		double xmin = tmin [iwindow], xmax = tmax [iwindow];
+		if (xmin >= xmax) xmin = sound -> xmin, xmax = sound -> xmax;
+		struct structVoiceMeasures measures;
+		PointProcess_Sound_getVoiceMeasures (pulses, sound, xmin, xmax, pmin, pmax, maximumPeriodFactor, maximumAmplitudeFactor,
+			periods.peek(), peakTimes.peek(), peakValues.peek(), & measures);
+		long icol = 0;
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, xmin);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, xmax);
+		if (labels) Table_setStringValue (thee.peek(), iwindow, ++ icol, labels [iwindow]);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getQuantile (pitch, xmin, xmax, 0.50, kPitch_unit_HERTZ));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMean (pitch, xmin, xmax, kPitch_unit_HERTZ));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getStandardDeviation (pitch, xmin, xmax, kPitch_unit_HERTZ));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMinimum (pitch, xmin, xmax, kPitch_unit_HERTZ, 1));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMaximum (pitch, xmin, xmax, kPitch_unit_HERTZ, 1));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.numberOfPulses);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.numberOfPeriods);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.meanPeriod);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.stdevPeriod);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol,
+			Pitch_getFractionOfLocallyUnvoicedFrames (pitch, xmin, xmax, ceiling, silenceThreshold, voicingThreshold, NULL, NULL));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.numberOfVoiceBreaks);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.durationOfVoiceBreaks / (xmax - xmin));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.jitter_local);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.jitter_local_absolute);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.jitter_rap);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.jitter_ppq5);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.jitter_ddp);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_local);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_local_dB);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_apq3);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_apq5);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_apq11);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, measures.shimmer_dda);
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMeanStrength (pitch, xmin, xmax, Pitch_STRENGTH_UNIT_AUTOCORRELATION));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMeanStrength (pitch, xmin, xmax, Pitch_STRENGTH_UNIT_NOISE_HARMONICS_RATIO));
+		Table_setNumericValue (thee.peek(), iwindow, ++ icol, Pitch_getMeanStrength (pitch, xmin, xmax, Pitch_STRENGTH_UNIT_HARMONICS_NOISE_DB));
+	}
+	return thee.transfer();
+}
+
+Table Sound_Pitch_PointProcess_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses,
+	long numberOfWindows, const double tmin [], const double tmax [],
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor, double silenceThreshold, double voicingThreshold)
+{
+	try {
+		return voiceReportTable (sound, pitch, pulses, numberOfWindows, tmin, tmax, NULL,
+			floor, ceiling, maximumPeriodFactor, maximumAmplitudeFactor, silenceThreshold, voicingThreshold);
+	} catch (MelderError) {
+		Melder_throw (sound, " & ", pitch, " & ", pulses, ": voice report table not computed.");
+	}
+}
+
+Table Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses, TextGrid grid, long tierNumber,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor, double silenceThreshold, double voicingThreshold)
+{
+	try {
+		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (grid, tierNumber);
+		long numberOfIntervals = tier -> numberOfIntervals (), numberOfWindows = 0;
+		autoNUMvector <double> tmin (1, numberOfIntervals), tmax (1, numberOfIntervals);
+		autoNUMvector <const wchar_t *> labels (1, numberOfIntervals);
+		for (long iinterval = 1; iinterval <= numberOfIntervals; iinterval ++) {
+			TextInterval interval = tier -> interval (iinterval);
+			if (interval -> text != NULL && interval -> text [0] != '\0') {
+				numberOfWindows ++;
+				tmin [numberOfWindows] = interval -> xmin;
+				tmax [numberOfWindows] = interval -> xmax;
+				labels [numberOfWindows] = interval -> text;
+			}
+		}
+		return voiceReportTable (sound, pitch, pulses, numberOfWindows, tmin.peek(), tmax.peek(), labels.peek(),
+			floor, ceiling, maximumPeriodFactor, maximumAmplitudeFactor, silenceThreshold, voicingThreshold);
+	} catch (MelderError) {
+		Melder_throw (sound, " & ", pitch, " & ", pulses, " & ", grid, ": voice report table not computed.");
+	}
+}
+
 /* End of file VoiceAnalysis.cpp */
@@ -20,6 +20,8 @@
 #include "Sound.h"
 #include "PointProcess.h"
 #include "Pitch.h"
+#include "TextGrid.h"
+#include "Table.h"
 
 double PointProcess_getJitter_local (PointProcess me, double tmin, double tmax,
 	double minimumPeriod, double maximumPeriod, double maximumPeriodFactor);
@@ -53,4 +55,19 @@ void Sound_Pitch_PointProcess_voiceReport (Sound sound, Pitch pitch, PointProces
 	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
 	double silenceThreshold, double voicingThreshold);
 
+Table Sound_Pitch_PointProcess_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses,
+	long numberOfWindows, const double tmin [], const double tmax [],
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold);
+Table Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport (Sound sound, Pitch pitch, PointProcess pulses,
+	TextGrid grid, long tierNumber,
+	double floor, double ceiling, double maximumPeriodFactor, double maximumAmplitudeFactor,
+	double silenceThreshold, double voicingThreshold);
+/*
+	The measures of the voice report for each of the windows tmin [1..numberOfWindows] .. tmax [1..numberOfWindows],
+	or for each non-empty interval of the specified interval tier, one row per window.
+	The pulses are walked through only once per window for all jitter and shimmer measures together.
+	Percentages in the voice report appear as fractions in the table.
+*/
+
 /* End of file VoiceAnalysis.h */
@@ -947,6 +947,18 @@ MAN_BEGIN (L"Manipulation: Get resynthesis (overlap-add)", L"ppgb", 20070722)
 INTRO (L"A command to extract the sound from each selected @Manipulation object, resynthesized with the @@overlap-add@ method.")
 MAN_END
 
+MAN_BEGIN (L"Manipulation: Get resyntheses (overlap-add)", L"ppgb", 20150612)
+INTRO (L"A command to resynthesize many variants of one @Manipulation object at once with the @@overlap-add@ method, "
+	"for instance to create a continuum of stimuli for a perception experiment.")
+NORMAL (L"Select a Manipulation object together with any number of @PitchTier objects, "
+	"any number of @DurationTier objects, or both. Each selected tier replaces the corresponding tier of the Manipulation "
+	"for one variant; the Manipulation object itself is not changed. If you select both kinds of tiers, "
+	"the %n-th PitchTier goes together with the %n-th DurationTier, so you select equal numbers of them, "
+	"or a single tier of one kind that is used with every tier of the other kind.")
+NORMAL (L"Every resulting @Sound is the same as the one you would get from @@Manipulation: Get resynthesis (overlap-add)@ "
+	"after replacing the tiers, but the variants are computed together on all processors of your computer.")
+MAN_END
+
 MAN_BEGIN (L"Manipulation: Replace duration tier", L"ppgb", 20030216)
 INTRO (L"You can replace the duration tier that you see in your @Manipulation object "
 	"with a separate @DurationTier object, for instance one that you extracted from another Manipulation "
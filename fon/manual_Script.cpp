@@ -776,6 +776,11 @@ TAG (L"##randomGauss (%\\mu, %\\si)")
 DEFINITION (L"Gaussian random deviate with mean %\\mu and standard deviation %\\si")
 TAG (L"##randomPoisson (%mean)")
 DEFINITION (L"Poisson random deviate")
+TAG (L"##random_initializeWithSeedUnsafelyButPredictably (%seed)")
+DEFINITION (L"makes the random deviates from here on reproducible: the same %seed gives the same sequence, "
+	"in every thread (hence \"unsafely\": parallel computations draw the same numbers)")
+TAG (L"##random_initializeSafelyAndUnpredictably ()")
+DEFINITION (L"undoes the effect of the previous function: the random deviates become unpredictable again")
 TAG (L"##lnGamma (%x)")
 DEFINITION (L"logarithm of the \\Ga function")
 TAG (L"##gaussP (%z)")
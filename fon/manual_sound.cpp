@@ -1070,6 +1070,10 @@ ENTRY (L"The File menu")
 NORMAL (L"If your computer has little memory, a very long recorded sound can be too big to be copied to the list of objects. "
 	"Fortunately, the File menu contains commands to save the recording "
 	"to a sound file on disk, so that you will never have to lose your recording.")
+NORMAL (L"With ##Record to WAV file...# or ##Record to FLAC file...#, the SoundRecorder writes the sound to disk while you are recording, "
+	"so that the length of the recording is limited by the free space on your disk rather than by the recording buffer; "
+	"the recording buffer then still contains the first part of the sound, for playing and saving to the list. "
+	"If your computer cannot keep up, the SoundRecorder tells you afterwards how many drop-outs there were.")
 ENTRY (L"Sound pressure calibration")
 NORMAL (L"Your computer's sound-recording software returns integer values between -32768 and 32767. "
 	"Praat divides them by 32768 before putting them into a Sound object, "
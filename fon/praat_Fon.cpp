@@ -2478,6 +2478,33 @@ END
 
 DIRECT (Manipulation_replacePitchTier_help) Melder_help (L"Manipulation: Replace pitch tier"); END
 
+/***** MANIPULATION & PITCHTIER(S) & DURATIONTIER(S) *****/
+
+DIRECT (Manipulation_getResyntheses_overlapAdd)
+	Manipulation me = FIRST (Manipulation);
+	long numberOfPitchTiers = 0, numberOfDurationTiers = 0;
+	LOOP {
+		if (CLASS == classPitchTier) numberOfPitchTiers ++;
+		if (CLASS == classDurationTier) numberOfDurationTiers ++;
+	}
+	if (numberOfPitchTiers > 1 && numberOfDurationTiers > 1 && numberOfPitchTiers != numberOfDurationTiers)
+		Melder_throw ("Select as many pitch tiers as duration tiers, or a single one of either.");
+	long numberOfVariants = numberOfPitchTiers > numberOfDurationTiers ? numberOfPitchTiers : numberOfDurationTiers;
+	autoNUMvector <PitchTier> pitchTiers (1, numberOfVariants);
+	autoNUMvector <DurationTier> durationTiers (1, numberOfVariants);
+	long ipitch = 0, iduration = 0;
+	LOOP {
+		if (CLASS == classPitchTier) pitchTiers [++ ipitch] = (PitchTier) OBJECT;
+		if (CLASS == classDurationTier) durationTiers [++ iduration] = (DurationTier) OBJECT;
+	}
+	for (long ivariant = 2; ivariant <= numberOfVariants; ivariant ++) {
+		if (numberOfPitchTiers == 1) pitchTiers [ivariant] = pitchTiers [1];
+		if (numberOfDurationTiers == 1) durationTiers [ivariant] = durationTiers [1];
+	}
+	autoCollection thee = Manipulation_to_Sounds_overlapAdd (me, numberOfVariants, pitchTiers.peek(), durationTiers.peek());
+	praat_new (thee.transfer(), my name);
+END
+
 /***** MANIPULATION & POINTPROCESS *****/
 
 DIRECT (Manipulation_replacePulses)
@@ -5096,6 +5123,27 @@ DO
 	MelderInfo_close ();
 END
 
+/***** SOUND & PITCH & POINTPROCESS & TEXTGRID *****/
+
+FORM (Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport, L"Voice report table", L"Voice")
+	NATURAL (L"Tier number", L"1")
+	POSITIVE (L"left Pitch range (Hz)", L"75.0")
+	POSITIVE (L"right Pitch range (Hz)", L"600.0")
+	POSITIVE (L"Maximum period factor", L"1.3")
+	POSITIVE (L"Maximum amplitude factor", L"1.6")
+	REAL (L"Silence threshold", L"0.03")
+	REAL (L"Voicing threshold", L"0.45")
+	OK
+DO
+	TextGrid grid = FIRST (TextGrid);
+	autoTable thee = Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport (FIRST (Sound), FIRST (Pitch), FIRST (PointProcess),
+		grid, GET_INTEGER (L"Tier number"),
+		GET_REAL (L"left Pitch range"), GET_REAL (L"right Pitch range"),
+		GET_REAL (L"Maximum period factor"), GET_REAL (L"Maximum amplitude factor"),
+		GET_REAL (L"Silence threshold"), GET_REAL (L"Voicing threshold"));
+	praat_new (thee.transfer(), grid -> name, L"_voice");
+END
+
 /***** SOUND & POINTPROCESS & PITCHTIER & DURATIONTIER *****/
 
 FORM (Sound_Point_Pitch_Duration_to_Sound, L"To Sound", 0)
@@ -7115,7 +7163,9 @@ praat_addAction1 (classTransition, 0, L"Cast", 0, 0, 0);
 	praat_addAction2 (classManipulation, 1, classSound, 1, L"Replace original sound", 0, 0, DO_Manipulation_replaceOriginalSound);
 	praat_addAction2 (classManipulation, 1, classPointProcess, 1, L"Replace pulses", 0, 0, DO_Manipulation_replacePulses);
 	praat_addAction2 (classManipulation, 1, classPitchTier, 1, L"Replace pitch tier", 0, 0, DO_Manipulation_replacePitchTier);
+	praat_addAction2 (classManipulation, 1, classPitchTier, 0, L"Get resyntheses (overlap-add)", 0, 0, DO_Manipulation_getResyntheses_overlapAdd);
 	praat_addAction2 (classManipulation, 1, classDurationTier, 1, L"Replace duration tier", 0, 0, DO_Manipulation_replaceDurationTier);
+	praat_addAction2 (classManipulation, 1, classDurationTier, 0, L"Get resyntheses (overlap-add)", 0, 0, DO_Manipulation_getResyntheses_overlapAdd);
 	praat_addAction2 (classManipulation, 1, classTextTier, 1, L"To Manipulation", 0, 0, DO_Manipulation_TextTier_to_Manipulation);
 	praat_addAction2 (classMatrix, 1, classSound, 1, L"To ParamCurve", 0, 0, DO_Matrix_to_ParamCurve);
 	praat_addAction2 (classPhoto, 1, classMatrix, 1, L"Replace red", 0, 0, DO_Photo_Matrix_replaceRed);
@@ -7125,7 +7175,9 @@ praat_addAction1 (classTransition, 0, L"Cast", 0, 0, 0);
 	praat_addAction2 (classPitch, 1, classPitchTier, 1, L"Draw...", 0, 0, DO_PitchTier_Pitch_draw);
 	praat_addAction2 (classPitch, 1, classPitchTier, 1, L"To Pitch", 0, 0, DO_Pitch_PitchTier_to_Pitch);
 	praat_addAction2 (classPitch, 1, classPointProcess, 1, L"To PitchTier", 0, 0, DO_Pitch_PointProcess_to_PitchTier);
+	praat_addAction3 (classDurationTier, 0, classManipulation, 1, classPitchTier, 0, L"Get resyntheses (overlap-add)", 0, 0, DO_Manipulation_getResyntheses_overlapAdd);
 	praat_addAction3 (classPitch, 1, classPointProcess, 1, classSound, 1, L"Voice report...", 0, 0, DO_Sound_Pitch_PointProcess_voiceReport);
+	praat_addAction4 (classPitch, 1, classPointProcess, 1, classSound, 1, classTextGrid, 1, L"To Table (voice report)...", 0, 0, DO_Sound_Pitch_PointProcess_TextGrid_to_Table_voiceReport);
 	praat_addAction2 (classPitch, 1, classSound, 1, L"To PointProcess (cc)", 0, 0, DO_Sound_Pitch_to_PointProcess_cc);
 	praat_addAction2 (classPitch, 1, classSound, 1, L"To PointProcess (peaks)...", 0, 0, DO_Sound_Pitch_to_PointProcess_peaks);
 	praat_addAction2 (classPitch, 1, classSound, 1, L"To Manipulation", 0, 0, DO_Sound_Pitch_to_Manipulation);
@@ -171,6 +171,67 @@ DO
 	}
 END2 }
 
+FORM (LongSound_to_Formant_burg, L"LongSound: To Formant (Burg method)", L"Sound: To Formant (burg)...") {
+	REAL (L"Time step (s)", L"0.0 (= auto)")
+	POSITIVE (L"Max. number of formants", L"5")
+	REAL (L"Maximum formant (Hz)", L"5500 (= adult female)")
+	POSITIVE (L"Window length (s)", L"0.025")
+	POSITIVE (L"Pre-emphasis from (Hz)", L"50")
+	OK2
+DO
+	LOOP {
+		iam (LongSound);
+		autoFormant thee = LongSound_to_Formant_burg (me, GET_REAL (L"Time step"),
+			GET_REAL (L"Max. number of formants"), GET_REAL (L"Maximum formant"),
+			GET_REAL (L"Window length"), GET_REAL (L"Pre-emphasis from"));
+		praat_new (thee.transfer(), my name);
+	}
+END2 }
+
+FORM (LongSound_to_Intensity, L"LongSound: To Intensity", L"Sound: To Intensity...") {
+	POSITIVE (L"Minimum pitch (Hz)", L"100")
+	REAL (L"Time step (s)", L"0.0 (= auto)")
+	BOOLEAN (L"Subtract mean", 1)
+	OK2
+DO
+	LOOP {
+		iam (LongSound);
+		autoIntensity thee = LongSound_to_Intensity (me,
+			GET_REAL (L"Minimum pitch"), GET_REAL (L"Time step"), GET_INTEGER (L"Subtract mean"));
+		praat_new (thee.transfer(), my name);
+	}
+END2 }
+
+FORM (LongSound_to_Pitch, L"LongSound: To Pitch", L"Sound: To Pitch...") {
+	REAL (L"Time step (s)", L"0.0 (= auto)")
+	POSITIVE (L"Pitch floor (Hz)", L"75.0")
+	POSITIVE (L"Pitch ceiling (Hz)", L"600.0")
+	OK2
+DO
+	LOOP {
+		iam (LongSound);
+		autoPitch thee = LongSound_to_Pitch (me, GET_REAL (L"Time step"), GET_REAL (L"Pitch floor"), GET_REAL (L"Pitch ceiling"));
+		praat_new (thee.transfer(), my name);
+	}
+END2 }
+
+FORM (LongSound_to_Spectrogram, L"LongSound: To Spectrogram", L"Sound: To Spectrogram...") {
+	POSITIVE (L"Window length (s)", L"0.005")
+	POSITIVE (L"Maximum frequency (Hz)", L"5000")
+	POSITIVE (L"Time step (s)", L"0.002")
+	POSITIVE (L"Frequency step (Hz)", L"20")
+	RADIO_ENUM (L"Window shape", kSound_to_Spectrogram_windowShape, DEFAULT)
+	OK2
+DO
+	LOOP {
+		iam (LongSound);
+		autoSpectrogram thee = LongSound_to_Spectrogram (me, GET_REAL (L"Window length"),
+			GET_REAL (L"Maximum frequency"), GET_REAL (L"Time step"),
+			GET_REAL (L"Frequency step"), GET_ENUM (kSound_to_Spectrogram_windowShape, L"Window shape"), 8.0, 8.0);
+		praat_new (thee.transfer(), my name);
+	}
+END2 }
+
 DIRECT2 (LongSound_view) {
 	if (theCurrentPraatApplication -> batch) Melder_throw ("Cannot view or edit a LongSound from batch.");
 	LOOP {
@@ -1467,6 +1528,19 @@ DO
 	}
 END2 }
 
+FORM (Sound_resample_polyphase, L"Sound: Resample (polyphase)", L"Sound: Resample...") {
+	POSITIVE (L"New sampling frequency (Hz)", L"10000")
+	NATURAL (L"Precision (samples)", L"50")
+	OK2
+DO
+	double samplingFrequency = GET_REAL (L"New sampling frequency");
+	LOOP {
+		iam (Sound);
+		autoSound thee = Sound_resample_polyphase (me, samplingFrequency, GET_INTEGER (L"Precision"));
+		praat_new (thee.transfer(), my name, L"_", Melder_integer ((long) round (samplingFrequency)));
+	}
+END2 }
+
 DIRECT2 (Sound_reverse) {
 	LOOP {
 		iam (Sound);
@@ -2364,6 +2438,11 @@ void praat_uvafon_Sound_init (void) {
 		praat_addAction1 (classLongSound, 0, L"Annotation tutorial", 0, 1, DO_AnnotationTutorial);
 		praat_addAction1 (classLongSound, 0, L"-- to text grid --", 0, 1, 0);
 		praat_addAction1 (classLongSound, 0, L"To TextGrid...", 0, 1, DO_LongSound_to_TextGrid);
+	praat_addAction1 (classLongSound, 0, L"Analyse -", 0, 0, 0);
+		praat_addAction1 (classLongSound, 0, L"To Pitch...", 0, 1, DO_LongSound_to_Pitch);
+		praat_addAction1 (classLongSound, 0, L"To Intensity...", 0, 1, DO_LongSound_to_Intensity);
+		praat_addAction1 (classLongSound, 0, L"To Formant (burg)...", 0, 1, DO_LongSound_to_Formant_burg);
+		praat_addAction1 (classLongSound, 0, L"To Spectrogram...", 0, 1, DO_LongSound_to_Spectrogram);
 	praat_addAction1 (classLongSound, 0, L"Convert to Sound", 0, 0, 0);
 	praat_addAction1 (classLongSound, 0, L"Extract part...", 0, 0, DO_LongSound_extractPart);
 	praat_addAction1 (classLongSound, 0, L"Concatenate?", 0, 0, DO_LongSound_concatenate);
@@ -2564,6 +2643,7 @@ void praat_uvafon_Sound_init (void) {
 		praat_addAction1 (classSound, 0, L"Extract part...", 0, 1, DO_Sound_extractPart);
 		praat_addAction1 (classSound, 0, L"Extract part for overlap...", 0, 1, DO_Sound_extractPartForOverlap);
 		praat_addAction1 (classSound, 0, L"Resample...", 0, 1, DO_Sound_resample);
+		praat_addAction1 (classSound, 0, L"Resample (polyphase)...", 0, 1, DO_Sound_resample_polyphase);
 		praat_addAction1 (classSound, 0, L"-- enhance --", 0, 1, 0);
 		praat_addAction1 (classSound, 0, L"Lengthen (overlap-add)...", 0, 1, DO_Sound_lengthen_overlapAdd);
 		praat_addAction1 (classSound, 0, L"Lengthen (PSOLA)...", 0, praat_DEPTH_1 + praat_HIDDEN, DO_Sound_lengthen_overlapAdd);
@@ -329,6 +329,9 @@ int NUMrotationsPointInPolygon
 /********** Random numbers (NUMrandom.cpp) **********/
 
 void NUMrandom_init ();   // automatically called by NUMinit ();
+void NUMrandom_initializeWithSeedUnsafelyButPredictably (uint64_t seed);
+	/* Every thread gets the same reproducible sequence, e.g. for comparing a single-threaded and a multi-threaded algorithm. */
+void NUMrandom_initializeSafelyAndUnpredictably ();   // back to independent unpredictable sequences, as after NUMrandom_init ()
 
 double NUMrandomFraction ();
 double NUMrandomFraction_mt (int threadNumber);
@@ -191,6 +191,20 @@ void NUMrandom_init () {
 	theInited = true;
 }
 
+void NUMrandom_initializeWithSeedUnsafelyButPredictably (uint64_t seed) {
+	for (int threadNumber = 0; threadNumber <= 16; threadNumber ++) {
+		states [threadNumber]. init_genrand64 (seed);   // leaves index at NN, so that the first call generates the array
+		states [threadNumber]. secondAvailable = FALSE;
+	}
+	theInited = true;
+}
+
+void NUMrandom_initializeSafelyAndUnpredictably () {
+	for (int threadNumber = 0; threadNumber <= 16; threadNumber ++)
+		states [threadNumber]. secondAvailable = FALSE;
+	NUMrandom_init ();
+}
+
 /* Throughout the years, several versions for "zero or magic" have been proposed. Choose the fastest. */
 
 #define ZERO_OR_MAGIC_VERSION  3
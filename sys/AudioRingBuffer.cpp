@@ -0,0 +1,376 @@
+/* AudioRingBuffer.cpp
+ *
+ * Copyright (C) 2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "AudioRingBuffer.h"
+#include "flac_FLAC_stream_encoder.h"
+#if ! USE_WINTHREADS
+	#include <unistd.h>
+#endif
+
+#define AudioStreamWriter_CHUNK_SIZE  4096
+#define AudioStreamWriter_LATEST_FRAMES_SIZE  4096
+
+/********** class AudioRingBuffer **********/
+
+Thing_implement (AudioRingBuffer, Thing, 0);
+
+void structAudioRingBuffer :: v_destroy () {
+	Melder_free (samples);
+	AudioRingBuffer_Parent :: v_destroy ();
+}
+
+AudioRingBuffer AudioRingBuffer_create (int numberOfChannels, long minimumNumberOfFrames) {
+	try {
+		if (numberOfChannels < 1)
+			Melder_throw ("The number of channels should be at least 1.");
+		if (minimumNumberOfFrames < 1 || minimumNumberOfFrames > 0x40000000 / numberOfChannels)
+			Melder_throw ("Cannot create a ring buffer of ", minimumNumberOfFrames, " frames.");
+		autoAudioRingBuffer me = Thing_new (AudioRingBuffer);
+		my numberOfChannels = numberOfChannels;
+		my capacity = 1;
+		while (my capacity < (unsigned long) minimumNumberOfFrames) my capacity *= 2;
+		my mask = my capacity - 1;
+		my samples = Melder_calloc (short, my capacity * numberOfChannels);
+		my writePosition = 0;
+		my readPosition = 0;
+		my numberOfDroppedFrames = 0;
+		my numberOfDropouts = 0;
+		my closed = false;
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw ("AudioRingBuffer not created.");
+	}
+}
+
+long AudioRingBuffer_write (AudioRingBuffer me, const short *frames, long numberOfFrames) {
+	unsigned long writePosition = my writePosition.load (std::memory_order_relaxed);   // only we change it
+	unsigned long readPosition = my readPosition.load (std::memory_order_acquire);   // the consumer has finished with everything before this
+	unsigned long numberOfFreeFrames = my capacity - (writePosition - readPosition);
+	long numberOfFramesToCopy = numberOfFrames;
+	if ((unsigned long) numberOfFrames > numberOfFreeFrames) {
+		numberOfFramesToCopy = numberOfFreeFrames;
+		my numberOfDroppedFrames += numberOfFrames - numberOfFramesToCopy;
+		if (! my producerWasDropping) my numberOfDropouts ++;
+		my producerWasDropping = true;
+	} else {
+		my producerWasDropping = false;
+	}
+	unsigned long start = writePosition & my mask;
+	unsigned long numberOfFramesBeforeWrap = my capacity - start;
+	if ((unsigned long) numberOfFramesToCopy <= numberOfFramesBeforeWrap) {
+		memcpy (my samples + start * my numberOfChannels, frames, numberOfFramesToCopy * my numberOfChannels * sizeof (short));
+	} else {
+		memcpy (my samples + start * my numberOfChannels, frames, numberOfFramesBeforeWrap * my numberOfChannels * sizeof (short));
+		memcpy (my samples, frames + numberOfFramesBeforeWrap * my numberOfChannels,
+			(numberOfFramesToCopy - numberOfFramesBeforeWrap) * my numberOfChannels * sizeof (short));
+	}
+	my writePosition.store (writePosition + numberOfFramesToCopy, std::memory_order_release);   // publish the frames
+	return numberOfFramesToCopy;
+}
+
+void AudioRingBuffer_countDropout (AudioRingBuffer me) {
+	my numberOfDropouts ++;
+}
+
+bool AudioRingBuffer_isClosed (AudioRingBuffer me) {
+	return my closed.load (std::memory_order_acquire);
+}
+
+long AudioRingBuffer_getNumberOfReadableFrames (AudioRingBuffer me) {
+	return (long) (my writePosition.load (std::memory_order_acquire) - my readPosition.load (std::memory_order_relaxed));
+}
+
+long AudioRingBuffer_read (AudioRingBuffer me, short *frames, long maximumNumberOfFrames) {
+	unsigned long readPosition = my readPosition.load (std::memory_order_relaxed);   // only we change it
+	unsigned long writePosition = my writePosition.load (std::memory_order_acquire);   // the producer has finished with everything before this
+	long numberOfFramesToCopy = (long) (writePosition - readPosition);
+	if (numberOfFramesToCopy > maximumNumberOfFrames) numberOfFramesToCopy = maximumNumberOfFrames;
+	if (numberOfFramesToCopy <= 0) return 0;
+	unsigned long start = readPosition & my mask;
+	unsigned long numberOfFramesBeforeWrap = my capacity - start;
+	if ((unsigned long) numberOfFramesToCopy <= numberOfFramesBeforeWrap) {
+		memcpy (frames, my samples + start * my numberOfChannels, numberOfFramesToCopy * my numberOfChannels * sizeof (short));
+	} else {
+		memcpy (frames, my samples + start * my numberOfChannels, numberOfFramesBeforeWrap * my numberOfChannels * sizeof (short));
+		memcpy (frames + numberOfFramesBeforeWrap * my numberOfChannels, my samples,
+			(numberOfFramesToCopy - numberOfFramesBeforeWrap) * my numberOfChannels * sizeof (short));
+	}
+	my readPosition.store (readPosition + numberOfFramesToCopy, std::memory_order_release);   // give the space back to the producer
+	return numberOfFramesToCopy;
+}
+
+void AudioRingBuffer_close (AudioRingBuffer me) {
+	my closed.store (true, std::memory_order_release);
+}
+
+/********** class AudioStreamWriter **********/
+
+MelderThread_MUTEX (latestFramesMutex);
+static bool latestFramesMutex_inited = false;
+
+Thing_implement (AudioStreamWriter, Thing, 0);
+
+void structAudioStreamWriter :: v_destroy () {
+	if (running) {
+		stopRequested = true;
+		#if USE_WINTHREADS
+			WaitForSingleObject (thread, INFINITE);
+			CloseHandle (thread);
+		#elif USE_PTHREADS
+			pthread_join (thread, NULL);
+		#elif USE_CPPTHREADS
+			thread -> join ();
+			delete thread;
+		#endif
+		running = false;
+	}
+	if (writingToFile) MelderFile_close_nothrow (& file);
+	Melder_free (chunk);
+	Melder_free (bytes);
+	Melder_free (flacSamples);
+	Melder_free (latestFrames);
+	AudioStreamWriter_Parent :: v_destroy ();
+}
+
+AudioStreamWriter AudioStreamWriter_create (AudioRingBuffer ringBuffer, short *memory, long memorySize) {
+	try {
+		if (! latestFramesMutex_inited) {
+			MelderThread_MUTEX_INIT (latestFramesMutex);
+			latestFramesMutex_inited = true;
+		}
+		autoAudioStreamWriter me = Thing_new (AudioStreamWriter);
+		my ringBuffer = ringBuffer;
+		my numberOfChannels = ringBuffer -> numberOfChannels;
+		my chunkSize = AudioStreamWriter_CHUNK_SIZE;
+		my chunk = Melder_calloc (short, my chunkSize * my numberOfChannels);
+		my bytes = Melder_calloc (unsigned char, my chunkSize * my numberOfChannels * 2);
+		my flacSamples = Melder_calloc (int32, my chunkSize * my numberOfChannels);
+		my memory = memory;
+		my memorySize = memory ? memorySize : 0;
+		my numberOfFramesInMemory = 0;
+		my latestFramesSize = AudioStreamWriter_LATEST_FRAMES_SIZE;
+		my latestFrames = Melder_calloc (short, my latestFramesSize * my numberOfChannels);
+		my fileFailed = false;
+		my stopRequested = false;
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw ("AudioStreamWriter not created.");
+	}
+}
+
+void AudioStreamWriter_openFile (AudioStreamWriter me, MelderFile file, int audioFileType, long sampleRate) {
+	try {
+		Melder_assert (! my running && ! my writingToFile);
+		MelderFile_copy (file, & my file);
+		MelderFile_create (& my file);
+		try {
+			/*
+			 * The number of samples is not known yet. FLAC fills it in when the encoder finishes;
+			 * for the other types, AudioStreamWriter_stop () rewrites the header, which has a fixed size.
+			 */
+			MelderFile_writeAudioFileHeader (& my file, audioFileType, sampleRate, 0, my numberOfChannels, 16);
+		} catch (MelderError) {
+			MelderFile_close_nothrow (& my file);
+			throw;
+		}
+		my audioFileType = audioFileType;
+		my encoding = Melder_defaultAudioFileEncoding (audioFileType, 16);
+		my sampleRate = sampleRate;
+		my writingToFile = true;
+		my numberOfFramesInFile = 0;
+		int64 maximumNumberOfBytes =
+			audioFileType == Melder_FLAC ? INT54_MAX :
+			audioFileType == Melder_WAV ? (int64) UINT32_MAX - 1024 :   // the RIFF chunk size is an unsigned 32-bit number
+			(int64) INT32_MAX - 1024;   // the other headers have signed 32-bit sizes
+		my maximumNumberOfFramesInFile = maximumNumberOfBytes / (2 * my numberOfChannels);
+	} catch (MelderError) {
+		Melder_throw ("Cannot stream audio to ", & my file, ".");
+	}
+}
+
+/*
+ * Writes the first numberOfFrames frames of the chunk to the file.
+ * This runs in the background thread, so it cannot throw or use the error buffer;
+ * it returns false if not all frames could be written.
+ */
+static bool AudioStreamWriter_writeChunkToFile (AudioStreamWriter me, long numberOfFrames) {
+	long numberOfSamples = numberOfFrames * my numberOfChannels;
+	switch (my encoding) {
+		case Melder_LINEAR_16_BIG_ENDIAN: {
+			for (long i = 0; i < numberOfSamples; i ++) {
+				unsigned short sample = (unsigned short) my chunk [i];
+				my bytes [2 * i] = (unsigned char) (sample >> 8);
+				my bytes [2 * i + 1] = (unsigned char) (sample & 0xFF);
+			}
+		} break;
+		case Melder_LINEAR_16_LITTLE_ENDIAN: {
+			for (long i = 0; i < numberOfSamples; i ++) {
+				unsigned short sample = (unsigned short) my chunk [i];
+				my bytes [2 * i] = (unsigned char) (sample & 0xFF);
+				my bytes [2 * i + 1] = (unsigned char) (sample >> 8);
+			}
+		} break;
+		case Melder_FLAC_COMPRESSION_16: {
+			if (! my file. flacEncoder) return false;
+			for (long i = 0; i < numberOfSamples; i ++)
+				my flacSamples [i] = my chunk [i];
+			return FLAC__stream_encoder_process_interleaved (my file. flacEncoder, (const FLAC__int32 *) my flacSamples, numberOfFrames);
+		}
+		default: return false;
+	}
+	size_t numberOfBytes = (size_t) numberOfSamples * 2;
+	return fwrite (my bytes, 1, numberOfBytes, my file. filePointer) == numberOfBytes;
+}
+
+static void AudioStreamWriter_consume (AudioStreamWriter me, long numberOfFrames) {
+	long numberOfFramesInMemory = my numberOfFramesInMemory.load (std::memory_order_relaxed);
+	if (numberOfFramesInMemory < my memorySize) {
+		long numberOfFramesToCopy = my memorySize - numberOfFramesInMemory;
+		if (numberOfFramesToCopy > numberOfFrames) numberOfFramesToCopy = numberOfFrames;
+		memcpy (my memory + numberOfFramesInMemory * my numberOfChannels, my chunk, numberOfFramesToCopy * my numberOfChannels * sizeof (short));
+		my numberOfFramesInMemory.store (numberOfFramesInMemory + numberOfFramesToCopy, std::memory_order_release);
+	}
+	if (my writingToFile && ! my fileFailed) {
+		int64 numberOfFramesToWrite = my maximumNumberOfFramesInFile - my numberOfFramesInFile;
+		if (numberOfFramesToWrite > numberOfFrames) numberOfFramesToWrite = numberOfFrames;
+		if (AudioStreamWriter_writeChunkToFile (me, (long) numberOfFramesToWrite)) {
+			my numberOfFramesInFile += numberOfFramesToWrite;
+		} else {
+			my fileFailed = true;   // probably a full disk; AudioStreamWriter_stop () will report this
+		}
+	}
+	/*
+	 * Keep the most recent frames for metering.
+	 */
+	long numberOfNewLatestFrames = numberOfFrames < my latestFramesSize ? numberOfFrames : my latestFramesSize;
+	MelderThread_LOCK (latestFramesMutex);
+	long numberOfOldLatestFramesToKeep = my latestFramesSize - numberOfNewLatestFrames;
+	if (numberOfOldLatestFramesToKeep > my numberOfLatestFrames) numberOfOldLatestFramesToKeep = my numberOfLatestFrames;
+	memmove (my latestFrames, my latestFrames + (my numberOfLatestFrames - numberOfOldLatestFramesToKeep) * my numberOfChannels,
+		numberOfOldLatestFramesToKeep * my numberOfChannels * sizeof (short));
+	memcpy (my latestFrames + numberOfOldLatestFramesToKeep * my numberOfChannels,
+		my chunk + (numberOfFrames - numberOfNewLatestFrames) * my numberOfChannels,
+		numberOfNewLatestFrames * my numberOfChannels * sizeof (short));
+	my numberOfLatestFrames = numberOfOldLatestFramesToKeep + numberOfNewLatestFrames;
+	MelderThread_UNLOCK (latestFramesMutex);
+	/*
+	 * Tell the producer when nothing will be kept any longer.
+	 */
+	bool memoryIsFull = my numberOfFramesInMemory.load (std::memory_order_relaxed) >= my memorySize;
+	bool fileIsFull = ! my writingToFile || my fileFailed || my numberOfFramesInFile >= my maximumNumberOfFramesInFile;
+	if (memoryIsFull && fileIsFull)
+		AudioRingBuffer_close (my ringBuffer);
+}
+
+long AudioStreamWriter_drain (AudioStreamWriter me) {
+	long numberOfFramesDrained = 0;
+	for (;;) {
+		long numberOfFrames = AudioRingBuffer_read (my ringBuffer, my chunk, my chunkSize);
+		if (numberOfFrames == 0) break;
+		AudioStreamWriter_consume (me, numberOfFrames);
+		numberOfFramesDrained += numberOfFrames;
+	}
+	return numberOfFramesDrained;
+}
+
+static MelderThread_RETURN_TYPE AudioStreamWriter_threadFunction (void *void_me) {
+	iam (AudioStreamWriter);
+	while (! my stopRequested.load (std::memory_order_acquire)) {
+		if (AudioStreamWriter_drain (me) == 0) {
+			/*
+			 * The producer cannot wake us up without locking, so we poll.
+			 * Five milliseconds is far less than any ring buffer we create.
+			 */
+			#if USE_WINTHREADS
+				Sleep (5);
+			#else
+				usleep (5000);
+			#endif
+		}
+	}
+	AudioStreamWriter_drain (me);   // the frames that came in after the last poll
+	MelderThread_RETURN
+}
+
+void AudioStreamWriter_start (AudioStreamWriter me) {
+	Melder_assert (! my running);
+	my stopRequested = false;
+	#if USE_WINTHREADS
+		my thread = CreateThread (NULL, 0, AudioStreamWriter_threadFunction, (void *) me, 0, NULL);
+		if (my thread == NULL)
+			Melder_throw ("Cannot start the audio writing thread.");
+	#elif USE_PTHREADS
+		if (pthread_create (& my thread, NULL, AudioStreamWriter_threadFunction, (void *) me) != 0)
+			Melder_throw ("Cannot start the audio writing thread.");
+	#elif USE_CPPTHREADS
+		my thread = new std::thread (AudioStreamWriter_threadFunction, (void *) me);
+	#else
+		return;   // no threads: the owner drains
+	#endif
+	my running = true;
+}
+
+void AudioStreamWriter_stop (AudioStreamWriter me) {
+	if (my running) {
+		my stopRequested.store (true, std::memory_order_release);
+		#if USE_WINTHREADS
+			WaitForSingleObject (my thread, INFINITE);
+			CloseHandle (my thread);
+		#elif USE_PTHREADS
+			pthread_join (my thread, NULL);
+		#elif USE_CPPTHREADS
+			my thread -> join ();
+			delete my thread;
+		#endif
+		my running = false;
+	}
+	AudioStreamWriter_drain (me);
+	AudioRingBuffer_close (my ringBuffer);
+	if (my writingToFile) {
+		my writingToFile = false;
+		try {
+			if (my fileFailed)
+				Melder_throw ("Only ", my numberOfFramesInFile, " frames could be written.");
+			MelderFile_writeAudioFileTrailer (& my file, my audioFileType, my sampleRate, (long) my numberOfFramesInFile, my numberOfChannels, 16);
+			if (my audioFileType != Melder_FLAC) {
+				fseek (my file. filePointer, 0, SEEK_SET);
+				MelderFile_writeAudioFileHeader (& my file, my audioFileType, my sampleRate, (long) my numberOfFramesInFile, my numberOfChannels, 16);
+			}
+			MelderFile_close (& my file);
+		} catch (MelderError) {
+			MelderFile_close_nothrow (& my file);
+			Melder_throw ("Audio stream to ", & my file, " not completed.");
+		}
+	}
+}
+
+long AudioStreamWriter_getNumberOfFramesInMemory (AudioStreamWriter me) {
+	return my numberOfFramesInMemory.load (std::memory_order_acquire);
+}
+
+long AudioStreamWriter_getLatestFrames (AudioStreamWriter me, short *frames, long maximumNumberOfFrames) {
+	MelderThread_LOCK (latestFramesMutex);
+	long numberOfFrames = my numberOfLatestFrames < maximumNumberOfFrames ? my numberOfLatestFrames : maximumNumberOfFrames;
+	memcpy (frames, my latestFrames + (my numberOfLatestFrames - numberOfFrames) * my numberOfChannels,
+		numberOfFrames * my numberOfChannels * sizeof (short));
+	MelderThread_UNLOCK (latestFramesMutex);
+	return numberOfFrames;
+}
+
+/* End of file AudioRingBuffer.cpp */
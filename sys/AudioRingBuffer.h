@@ -0,0 +1,118 @@
+#ifndef _AudioRingBuffer_h_
+#define _AudioRingBuffer_h_
+/* AudioRingBuffer.h
+ *
+ * Copyright (C) 2015 Paul Boersma
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MelderThread.h"
+#include <atomic>
+
+/*
+ * A single-producer/single-consumer queue of interleaved 16-bit sample frames.
+ *
+ * The producer is typically an audio input callback, which may be called at interrupt time;
+ * on the producer side, nothing locks, allocates or throws.
+ * The positions count frames since the creation of the buffer; the producer changes only writePosition,
+ * the consumer changes only readPosition, and both wrap around harmlessly because they are unsigned.
+ */
+Thing_define (AudioRingBuffer, Thing) {
+	int numberOfChannels;
+	unsigned long capacity, mask;   // in frames; the capacity is a power of two
+	short *samples;
+	std::atomic <unsigned long> writePosition, readPosition;
+	std::atomic <long> numberOfDroppedFrames, numberOfDropouts;
+	std::atomic <bool> closed;   // set by the consumer when it will not accept any more frames
+	bool producerWasDropping;   // producer only
+
+	void v_destroy ()
+		override;
+};
+
+AudioRingBuffer AudioRingBuffer_create (int numberOfChannels, long minimumNumberOfFrames);
+
+/* Producer side. */
+long AudioRingBuffer_write (AudioRingBuffer me, const short *frames, long numberOfFrames);
+	/*
+	 * Copies as many frames as fit, and counts the rest as dropped;
+	 * a run of consecutive overfull writes counts as a single drop-out.
+	 * Returns the number of frames copied.
+	 */
+void AudioRingBuffer_countDropout (AudioRingBuffer me);
+	/* For drop-outs that the audio driver reports. */
+bool AudioRingBuffer_isClosed (AudioRingBuffer me);
+
+/* Consumer side. */
+long AudioRingBuffer_read (AudioRingBuffer me, short *frames, long maximumNumberOfFrames);
+	/* Returns the number of frames copied into 'frames'. */
+long AudioRingBuffer_getNumberOfReadableFrames (AudioRingBuffer me);
+void AudioRingBuffer_close (AudioRingBuffer me);
+
+/*
+ * The consumer of an AudioRingBuffer: moves the frames into memory (up to a fixed capacity)
+ * and/or streams them into an audio file (so that the length of a recording is bounded by the disk, not by RAM),
+ * and keeps the most recent frames available for metering.
+ * The memory buffer and the ring buffer are not owned by the writer.
+ * After AudioStreamWriter_start (), the draining is done by a background thread;
+ * without start (), the owner calls AudioStreamWriter_drain () itself.
+ */
+Thing_define (AudioStreamWriter, Thing) {
+	AudioRingBuffer ringBuffer;
+	int numberOfChannels;
+	short *chunk;
+	long chunkSize;   // in frames
+	short *memory;
+	long memorySize;   // in frames
+	std::atomic <long> numberOfFramesInMemory;
+	structMelderFile file;
+	int audioFileType, encoding;
+	long sampleRate;
+	bool writingToFile;
+	int64 numberOfFramesInFile, maximumNumberOfFramesInFile;
+	unsigned char *bytes;   // a chunk in the byte order of the file
+	int32 *flacSamples;   // a chunk for the FLAC encoder
+	std::atomic <bool> fileFailed;   // set by the thread, which cannot throw; reported by AudioStreamWriter_stop ()
+	short *latestFrames;
+	long latestFramesSize, numberOfLatestFrames;   // protected by a mutex
+	std::atomic <bool> stopRequested;
+	bool running;
+	#if USE_WINTHREADS
+		HANDLE thread;
+	#elif USE_PTHREADS
+		pthread_t thread;
+	#elif USE_CPPTHREADS
+		std::thread *thread;
+	#endif
+
+	void v_destroy ()
+		override;
+};
+
+AudioStreamWriter AudioStreamWriter_create (AudioRingBuffer ringBuffer, short *memory, long memorySize);
+void AudioStreamWriter_openFile (AudioStreamWriter me, MelderFile file, int audioFileType, long sampleRate);
+	/* Melder_WAV, Melder_AIFF, Melder_AIFC, Melder_NEXT_SUN, Melder_NIST or Melder_FLAC; 16 bits. */
+void AudioStreamWriter_start (AudioStreamWriter me);
+long AudioStreamWriter_drain (AudioStreamWriter me);
+	/* Moves all readable frames out of the ring buffer; returns their number. */
+void AudioStreamWriter_stop (AudioStreamWriter me);
+	/* Waits for the background thread to move the last frames, then completes and closes the file, if any. */
+long AudioStreamWriter_getNumberOfFramesInMemory (AudioStreamWriter me);
+long AudioStreamWriter_getLatestFrames (AudioStreamWriter me, short *frames, long maximumNumberOfFrames);
+	/* For meters: copies the most recently drained frames; safe to call from the GUI while the thread runs. */
+
+#endif
+/* End of file AudioRingBuffer.h */
@@ -423,6 +423,70 @@ void SortedSet_init (SortedSet me, ClassInfo itemClass, long initialCapacity) {
 	Sorted_init (me, itemClass, initialCapacity);
 }
 
+void SortedSet_addItems (SortedSet me, long numberOfItems, Any items []) {
+	if (numberOfItems <= 0) return;
+	Data_CompareFunction compare = my v_getCompareFunction ();
+	Any *sorted = NULL, *scratch = NULL, *merged = NULL;
+	try {
+		/*
+		 * Create without change.
+		 */
+		sorted = Melder_malloc (Any, numberOfItems);
+		scratch = Melder_malloc (Any, numberOfItems);
+		merged = Melder_malloc (Any, my size + numberOfItems > my _capacity ? my size + numberOfItems : my _capacity);
+	} catch (MelderError) {
+		Melder_free (sorted);
+		Melder_free (scratch);
+		if (! my _dontOwnItems)
+			for (long i = 1; i <= numberOfItems; i ++) forget (((Thing *) items) [i]);
+		Melder_throw (me, ": items not added.");
+	}
+	/*
+	 * Change without error.
+	 *
+	 * A bottom-up merge sort of the new items, which is stable, so that of several equal new items
+	 * the first one survives, as with repeated calls to Collection_addItem ().
+	 */
+	for (long i = 0; i < numberOfItems; i ++) sorted [i] = items [i + 1];
+	for (long width = 1; width < numberOfItems; width *= 2) {
+		for (long left = 0; left < numberOfItems; left += 2 * width) {
+			long mid = left + width < numberOfItems ? left + width : numberOfItems;
+			long right = left + 2 * width < numberOfItems ? left + 2 * width : numberOfItems;
+			long i = left, j = mid, k = left;
+			while (i < mid && j < right) scratch [k ++] = compare (sorted [j], sorted [i]) < 0 ? sorted [j ++] : sorted [i ++];
+			while (i < mid) scratch [k ++] = sorted [i ++];
+			while (j < right) scratch [k ++] = sorted [j ++];
+		}
+		Any *swap = sorted; sorted = scratch; scratch = swap;
+	}
+	/*
+	 * Merge with the existing items; an item that is equal to an existing item, or to the previous new item, is refused.
+	 */
+	long i = 1, j = 0, k = 0;
+	while (i <= my size || j < numberOfItems) {
+		if (j >= numberOfItems || (i <= my size && compare (my item [i], sorted [j]) <= 0)) {
+			if (j < numberOfItems && compare (my item [i], sorted [j]) == 0) {
+				if (! my _dontOwnItems) forget (((Thing *) sorted) [j]);
+				j ++;
+				continue;
+			}
+			merged [k ++] = my item [i ++];
+		} else if (k > 0 && compare (merged [k - 1], sorted [j]) == 0) {
+			if (! my _dontOwnItems) forget (((Thing *) sorted) [j]);
+			j ++;
+		} else {
+			merged [k ++] = sorted [j ++];
+		}
+	}
+	Melder_free (sorted);
+	Melder_free (scratch);
+	Any *oldItems = my item + 1;
+	Melder_free (oldItems);
+	my item = merged - 1;
+	if (my size + numberOfItems > my _capacity) my _capacity = my size + numberOfItems;
+	my size = k;
+}
+
 /********** class SortedSetOfInt **********/
 
 Thing_implement (SortedSetOfInt, SortedSet, 0);
@@ -251,6 +251,20 @@ void SortedSet_init (SortedSet me, ClassInfo itemClass, long initialCapacity);
 	Collections_merge (SortedSet) yields a SortedSet that is the union of the two sources.
 */
 
+void SortedSet_addItems (SortedSet me, long numberOfItems, Any items []);
+/*
+	Function:
+		add items [1..numberOfItems], in any order, with the same result as
+		calling Collection_addItem () for each of them in turn:
+		an item that equals an item already in the set, or an earlier item in the array, is refused
+		(and disposed of, unless dontOwnItems is on).
+	Efficiency:
+		the new items are sorted and then merged with the existing items in a single pass,
+		so that adding m items to a set of n items takes O (n + m log m) time instead of O (n m).
+	When calling this function, you transfer ownership of all the items to the SortedSet,
+	also if an error occurs.
+*/
+
 /********** class SortedSetOfInt **********/
 
 Thing_define (SortedSetOfInt, SortedSet) {
@@ -137,6 +137,7 @@ enum { GEENSYMBOOL_,
 		DEMO_CLICKED_, DEMO_X_, DEMO_Y_, DEMO_KEY_PRESSED_, DEMO_KEY_,
 		DEMO_SHIFT_KEY_PRESSED_, DEMO_COMMAND_KEY_PRESSED_, DEMO_OPTION_KEY_PRESSED_, DEMO_EXTRA_CONTROL_KEY_PRESSED_,
 		ZERO_NUMAR_, LINEAR_NUMAR_, RANDOM_UNIFORM_NUMAR_, RANDOM_INTEGER_NUMAR_, RANDOM_GAUSS_NUMAR_,
+		RANDOM_INITIALIZE_WITH_SEED_UNSAFELY_BUT_PREDICTABLY_, RANDOM_INITIALIZE_SAFELY_AND_UNPREDICTABLY_,
 		NUMBER_OF_ROWS_, NUMBER_OF_COLUMNS_, EDITOR_,
 	#define HIGH_FUNCTION_N  EDITOR_
 
@@ -234,6 +235,7 @@ static const char32 *Formula_instructionNames [1 + hoogsteSymbool] = { U"",
 	U"demoClicked", U"demoX", U"demoY", U"demoKeyPressed", U"demoKey$",
 	U"demoShiftKeyPressed", U"demoCommandKeyPressed", U"demoOptionKeyPressed", U"demoExtraControlKeyPressed",
 	U"zero#", U"linear#", U"randomUniform#", U"randomInteger#", U"randomGauss#",
+	U"random_initializeWithSeedUnsafelyButPredictably", U"random_initializeSafelyAndUnpredictably",
 	U"numberOfRows", U"numberOfColumns", U"editor",
 
 	U"length", U"number", U"fileReadable",	U"deleteFile", U"createDirectory", U"variableExists",
@@ -2869,6 +2871,23 @@ static void do_imax (void) {
 	}
 	pushNumber (result);
 }
+static void do_random_initializeWithSeedUnsafelyButPredictably (void) {
+	Stackel n = pop;
+	if (n -> number != 1)
+		Melder_throw ("The function \"random_initializeWithSeedUnsafelyButPredictably\" requires one argument (the seed), not ", n -> number, ".");
+	Stackel seed = pop;
+	if (seed -> which != Stackel_NUMBER || seed -> number == NUMundefined || seed -> number < 0.0)
+		Melder_throw ("The function \"random_initializeWithSeedUnsafelyButPredictably\" requires a non-negative number, not ", Stackel_whichText (seed), ".");
+	NUMrandom_initializeWithSeedUnsafelyButPredictably ((uint64_t) seed -> number);
+	pushNumber (1);
+}
+static void do_random_initializeSafelyAndUnpredictably (void) {
+	Stackel n = pop;
+	if (n -> number != 0)
+		Melder_throw ("The function \"random_initializeSafelyAndUnpredictably\" requires no arguments, not ", n -> number, ".");
+	NUMrandom_initializeSafelyAndUnpredictably ();
+	pushNumber (1);
+}
 static void do_zeroNumar (void) {
 	Stackel n = pop;
 	Melder_assert (n -> which == Stackel_NUMBER);
@@ -4833,6 +4852,8 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 } break; case RANDOM_UNIFORM_NUMAR_: { do_function_dd_d_numar (NUMrandomUniform);
 } break; case RANDOM_INTEGER_NUMAR_: { do_function_ll_l_numar (NUMrandomInteger);
 } break; case RANDOM_GAUSS_NUMAR_: { do_function_dd_d_numar (NUMrandomGauss);
+} break; case RANDOM_INITIALIZE_WITH_SEED_UNSAFELY_BUT_PREDICTABLY_: { do_random_initializeWithSeedUnsafelyButPredictably ();
+} break; case RANDOM_INITIALIZE_SAFELY_AND_UNPREDICTABLY_: { do_random_initializeSafelyAndUnpredictably ();
 } break; case NUMBER_OF_ROWS_: { do_numberOfRows ();
 } break; case NUMBER_OF_COLUMNS_: { do_numberOfColumns ();
 } break; case EDITOR_: { do_editor ();
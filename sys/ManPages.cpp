@@ -35,6 +35,7 @@ static int isSingleWordCharacter (int c) {
 }
 
 static long lookUp_unsorted (ManPages me, const wchar_t *title);
+static void destroySearchIndex (ManPages me);
 
 void structManPages :: v_destroy () {
 	if (dynamic && pages) {
@@ -58,6 +59,7 @@ void structManPages :: v_destroy () {
 		for (long ipage = 1; ipage <= pages -> size; ipage ++) {
 			Melder_free (titles [ipage]);
 		}
+	destroySearchIndex (this);
 	forget (pages);
 	NUMvector_free <const wchar_t *> (titles, 1);
 	ManPages_Parent :: v_destroy ();
@@ -258,6 +260,7 @@ void ManPages_addPage (ManPages me, const wchar_t *title, const wchar_t *author,
 	page -> author = author;
 	page -> date = date;
 	Collection_addItem (my pages, page.transfer());
+	destroySearchIndex (me);   // it does not know the new page
 }
 
 static int pageCompare (const void *first, const void *second) {
@@ -446,6 +449,244 @@ const wchar_t **ManPages_getTitles (ManPages me, long *numberOfTitles) {
 	return my titles;
 }
 
+/********** SEARCHING **********/
+
+typedef struct { const wchar_t *word; long paragraph; } structSearchEntry;
+
+static int compareSearchEntries (const void *first, const void *second) {
+	const structSearchEntry *me = (const structSearchEntry *) first, *thee = (const structSearchEntry *) second;
+	int result = wcscmp (my word, thy word);
+	if (result != 0) return result;
+	return my paragraph < thy paragraph ? -1 : my paragraph > thy paragraph ? 1 : 0;
+}
+
+static void destroySearchIndex (ManPages me) {
+	if (my searchWords)
+		for (long iword = 1; iword <= my numberOfSearchWords; iword ++)
+			Melder_free (my searchWords [iword]);
+	if (my lowerCaseTitles)
+		for (long ipage = 1; ipage <= my numberOfSearchPages; ipage ++)
+			Melder_free (my lowerCaseTitles [ipage]);
+	NUMvector_free <wchar_t *> (my searchWords, 1);
+	NUMvector_free <wchar_t *> (my lowerCaseTitles, 1);
+	NUMvector_free <long> (my firstSearchPosting, 1);
+	NUMvector_free <long> (my searchPostingParagraph, 1);
+	NUMvector_free <long> (my searchPostingCount, 1);
+	NUMvector_free <long> (my pageOfSearchParagraph, 1);
+	my searchWords = my lowerCaseTitles = NULL;
+	my firstSearchPosting = my searchPostingParagraph = my searchPostingCount = my pageOfSearchParagraph = NULL;
+	my numberOfSearchPages = my numberOfSearchWords = my numberOfSearchParagraphs = 0;
+}
+
+static void buildSearchIndex (ManPages me) {
+	if (! my ground) grind (me);
+	long numberOfPages = my pages -> size;
+	/*
+	 * Count the paragraphs and characters.
+	 */
+	long numberOfParagraphs = 0, numberOfCharacters = 0;
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+		ManPage page = (ManPage) my pages -> item [ipage];
+		for (ManPage_Paragraph par = page -> paragraphs; par -> type; par ++) {
+			numberOfParagraphs ++;
+			if (par -> text) numberOfCharacters += wcslen (par -> text) + 1;
+		}
+	}
+	/*
+	 * Copy all paragraph texts into one lower-case buffer, with a null character after every word,
+	 * so that every word in the buffer is a string.
+	 */
+	autoNUMvector <wchar_t> buffer ((long) 0, numberOfCharacters);
+	autoNUMvector <long> pageOfParagraph (1, numberOfParagraphs);
+	long numberOfEntries = 0, iparagraph = 0;
+	wchar_t *to = & buffer [0];
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+		ManPage page = (ManPage) my pages -> item [ipage];
+		for (ManPage_Paragraph par = page -> paragraphs; par -> type; par ++) {
+			pageOfParagraph [++ iparagraph] = ipage;
+			if (! par -> text) continue;
+			bool inWord = false;
+			for (const wchar_t *from = par -> text; *from != '\0'; from ++) {
+				if (*from == ' ' || *from == '\n') {
+					if (inWord) *to ++ = '\0', inWord = false;
+				} else {
+					if (! inWord) numberOfEntries ++, inWord = true;
+					*to ++ = tolower (*from);
+				}
+			}
+			if (inWord) *to ++ = '\0';
+		}
+	}
+	/*
+	 * One entry per word occurrence, sorted by word and paragraph.
+	 */
+	autoNUMvector <structSearchEntry> entries (1, numberOfEntries);
+	long ientry = 0;
+	const wchar_t *word = & buffer [0];
+	iparagraph = 0;
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+		ManPage page = (ManPage) my pages -> item [ipage];
+		for (ManPage_Paragraph par = page -> paragraphs; par -> type; par ++) {
+			iparagraph ++;
+			if (! par -> text) continue;
+			bool inWord = false;
+			for (const wchar_t *from = par -> text; *from != '\0'; from ++) {
+				bool isSeparator = *from == ' ' || *from == '\n';
+				if (! isSeparator && ! inWord) {
+					entries [++ ientry]. word = word;
+					entries [ientry]. paragraph = iparagraph;
+					word += wcslen (word) + 1;
+				}
+				inWord = ! isSeparator;
+			}
+		}
+	}
+	Melder_assert (ientry == numberOfEntries);
+	if (numberOfEntries > 0)
+		qsort (& entries [1], numberOfEntries, sizeof (structSearchEntry), compareSearchEntries);
+	/*
+	 * Collapse the entries into distinct words with their postings.
+	 */
+	long numberOfWords = 0, numberOfPostings = 0;
+	for (ientry = 1; ientry <= numberOfEntries; ientry ++) {
+		bool newWord = ientry == 1 || ! wcsequ (entries [ientry]. word, entries [ientry - 1]. word);
+		if (newWord) numberOfWords ++;
+		if (newWord || entries [ientry]. paragraph != entries [ientry - 1]. paragraph) numberOfPostings ++;
+	}
+	autoNUMvector <wchar_t *> words (1, numberOfWords);
+	autoNUMvector <long> firstPosting (1, numberOfWords + 1);
+	autoNUMvector <long> postingParagraph (1, numberOfPostings);
+	autoNUMvector <long> postingCount (1, numberOfPostings);
+	long iword = 0, iposting = 0;
+	try {
+		for (ientry = 1; ientry <= numberOfEntries; ientry ++) {
+			bool newWord = ientry == 1 || ! wcsequ (entries [ientry]. word, entries [ientry - 1]. word);
+			if (newWord) {
+				words [++ iword] = Melder_wcsdup (entries [ientry]. word);
+				firstPosting [iword] = iposting + 1;
+			}
+			if (newWord || entries [ientry]. paragraph != entries [ientry - 1]. paragraph) {
+				postingParagraph [++ iposting] = entries [ientry]. paragraph;
+				postingCount [iposting] = 0;
+			}
+			postingCount [iposting] ++;
+		}
+		firstPosting [numberOfWords + 1] = numberOfPostings + 1;
+		autoNUMvector <wchar_t *> lowerCaseTitles (1, numberOfPages);
+		try {
+			for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+				ManPage page = (ManPage) my pages -> item [ipage];
+				lowerCaseTitles [ipage] = Melder_wcsdup (page -> title);
+				for (wchar_t *p = lowerCaseTitles [ipage]; *p != '\0'; p ++) *p = tolower (*p);
+			}
+		} catch (MelderError) {
+			for (long ipage = 1; ipage <= numberOfPages; ipage ++) Melder_free (lowerCaseTitles [ipage]);
+			throw;
+		}
+		my lowerCaseTitles = lowerCaseTitles.transfer();
+	} catch (MelderError) {
+		for (iword = 1; iword <= numberOfWords; iword ++) Melder_free (words [iword]);
+		Melder_throw (me, ": search index not built.");
+	}
+	my numberOfSearchPages = numberOfPages;
+	my numberOfSearchWords = numberOfWords;
+	my numberOfSearchParagraphs = numberOfParagraphs;
+	my searchWords = words.transfer();
+	my firstSearchPosting = firstPosting.transfer();
+	my searchPostingParagraph = postingParagraph.transfer();
+	my searchPostingCount = postingCount.transfer();
+	my pageOfSearchParagraph = pageOfParagraph.transfer();
+}
+
+static long countOccurrences (const wchar_t *token, long tokenLength, const wchar_t *word) {
+	long count = 0;
+	for (const wchar_t *p = wcsstr (word, token); p != NULL; p = wcsstr (p + tokenLength, token))
+		count ++;
+	return count;
+}
+
+void ManPages_searchToken (ManPages me, const wchar_t *token, double goodnessOfMatch []) {
+	if (! token [0]) return;   // an empty token matches everything with goodness 1
+	if (! my firstSearchPosting) buildSearchIndex (me);
+	long numberOfPages = my numberOfSearchPages, tokenLength = wcslen (token);
+	Melder_assert (numberOfPages == my pages -> size);
+	autoNUMvector <double> goodness (1, numberOfPages);
+	autoNUMvector <long> occurrences (1, my numberOfSearchParagraphs);
+	autoNUMvector <long> touchedParagraphs (1, my numberOfSearchParagraphs);
+	/*
+	 * Try to find a match in the titles.
+	 */
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+		if (wcsstr (my lowerCaseTitles [ipage], token)) {
+			goodness [ipage] += 300.0;   // lots of points for a match in the title!
+			if (wcsequ (my lowerCaseTitles [ipage], token))
+				goodness [ipage] += 10000.0;   // even more points for an exact match!
+		}
+	}
+	/*
+	 * Try to find a match in the paragraphs, by looking for the token in every distinct word.
+	 * A token contains no spaces or newlines, so every occurrence of it lies within a single word.
+	 */
+	long numberOfTouchedParagraphs = 0;
+	for (long iword = 1; iword <= my numberOfSearchWords; iword ++) {
+		long count = countOccurrences (token, tokenLength, my searchWords [iword]);
+		if (count == 0) continue;
+		for (long iposting = my firstSearchPosting [iword]; iposting < my firstSearchPosting [iword + 1]; iposting ++) {
+			long iparagraph = my searchPostingParagraph [iposting];
+			if (occurrences [iparagraph] == 0) touchedParagraphs [++ numberOfTouchedParagraphs] = iparagraph;
+			occurrences [iparagraph] += count * my searchPostingCount [iposting];
+		}
+	}
+	for (long itouched = 1; itouched <= numberOfTouchedParagraphs; itouched ++) {
+		long iparagraph = touchedParagraphs [itouched];
+		long ipage = my pageOfSearchParagraph [iparagraph];
+		goodness [ipage] += 10.0;   // ten points for every paragraph with a match!
+		if (occurrences [iparagraph] > 1)
+			goodness [ipage] += 1.0;   // one point for every second occurrence in a paragraph!
+	}
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++)
+		goodnessOfMatch [ipage] *= goodness [ipage];
+}
+
+long ManPages_search (ManPages me, const wchar_t *query, long maximumNumberOfMatches, long matches []) {
+	long numberOfPages = my pages -> size;
+	autostring searchText = Melder_wcsdup (query);
+	for (wchar_t *p = & searchText [0]; *p != '\0'; p ++) {
+		if (*p == '\n') *p = ' ';
+		*p = tolower (*p);
+	}
+	autoNUMvector <double> goodnessOfMatch (1, numberOfPages);
+	for (long ipage = 1; ipage <= numberOfPages; ipage ++)
+		goodnessOfMatch [ipage] = 1.0;
+	wchar_t *token = searchText.peek();
+	for (;;) {
+		wchar_t *space = wcschr (token, ' ');
+		if (space) *space = '\0';
+		ManPages_searchToken (me, token, goodnessOfMatch.peek());
+		if (! space) break;
+		*space = ' ';   // restore
+		token = space + 1;
+	}
+	/*
+	 * Find the best matches.
+	 */
+	long numberOfMatches = 0;
+	for (long imatch = 1; imatch <= maximumNumberOfMatches; imatch ++) {
+		long imax = 0;
+		double max = 0.0;
+		for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
+			if (goodnessOfMatch [ipage] > max) {
+				max = goodnessOfMatch [ipage];
+				imax = ipage;
+			}
+		}
+		if (! imax) break;
+		matches [++ numberOfMatches] = imax;
+		goodnessOfMatch [imax] = 0.0;   // skip next time
+	}
+	return numberOfMatches;
+}
+
 static struct stylesInfo {
 	const wchar_t *htmlIn, *htmlOut;
 } stylesInfo [] = {
@@ -28,6 +28,17 @@ Thing_define (ManPages, Data) {
 	int ground, dynamic, executable;
 	structMelderDir rootDirectory;
 
+	/*
+	 * The search index, built at the first search and discarded when a page is added:
+	 * for every distinct lower-case word (text between spaces or newlines) in the paragraphs,
+	 * the paragraphs that contain it and how often.
+	 */
+	long numberOfSearchPages, numberOfSearchWords, numberOfSearchParagraphs;
+	wchar_t **searchWords, **lowerCaseTitles;   // lowerCaseTitles [1..numberOfSearchPages]
+	long *firstSearchPosting;   // [1..numberOfSearchWords + 1]
+	long *searchPostingParagraph, *searchPostingCount;
+	long *pageOfSearchParagraph;   // [1..numberOfSearchParagraphs]
+
 	void v_destroy ()
 		override;
 	void v_readText (MelderReadText text)
@@ -45,6 +56,22 @@ void ManPages_addPage (ManPages me, const wchar_t *title, const wchar_t *author,
 
 long ManPages_lookUp (ManPages me, const wchar_t *title);
 
+void ManPages_searchToken (ManPages me, const wchar_t *token, double goodnessOfMatch []);
+/*
+	Multiplies goodnessOfMatch [1..my pages -> size] by how well each page matches the lower-case token,
+	which should not contain spaces or newlines:
+	300 points for a match in the title (and 10000 more if the title equals the token),
+	10 points for every paragraph that contains the token, and 1 more if it contains the token twice.
+	An empty token matches every page with goodness 1.
+*/
+
+long ManPages_search (ManPages me, const wchar_t *query, long maximumNumberOfMatches, long matches []);
+/*
+	Puts the best matches to the space-separated tokens of the query into matches [1..maximumNumberOfMatches],
+	best first, and returns how many pages match at all (at most maximumNumberOfMatches).
+	The goodness of a page is the product of its goodnesses for the lower-cased tokens.
+*/
+
 void ManPages_writeOneToHtmlFile (ManPages me, long ipage, MelderFile file);
 void ManPages_writeAllToHtmlDir (ManPages me, const wchar_t *dirPath);
 
@@ -275,85 +275,9 @@ static void menu_cb_printRange (EDITOR_ARGS) {
 
 /********** SEARCHING **********/
 
-static double *goodnessOfMatch;
-
-static double searchToken (ManPages me, long ipage, wchar_t *token) {
-	double goodness = 0.0;
-	ManPage page = (ManPage) my pages -> item [ipage];
-	struct structManPage_Paragraph *par = & page -> paragraphs [0];
-	if (! token [0]) return 1.0;
-	/*
-	 * Try to find a match in the title, case insensitively.
-	 */
-	static MelderString buffer = { 0 };
-	MelderString_copy (& buffer, page -> title);
-	for (wchar_t *p = & buffer.string [0]; *p != '\0'; p ++) *p = tolower (*p);
-	if (wcsstr (buffer.string, token)) {
-		goodness += 300.0;   /* Lots of points for a match in the title! */
-		if (wcsequ (buffer.string, token))
-			goodness += 10000.0;   /* Even more points for an exact match! */
-	}
-	/*
-	 * Try to find a match in the paragraphs, case-insensitively.
-	 */
-	while (par -> type) {
-		if (par -> text) {
-			wchar_t *ptoken;
-			MelderString_copy (& buffer, par -> text);
-			for (wchar_t *p = & buffer.string [0]; *p != '\0'; p ++) *p = tolower (*p);
-			ptoken = wcsstr (buffer.string, token);
-			if (ptoken) {
-				goodness += 10.0;   /* Ten points for every paragraph with a match! */
-				if (wcsstr (ptoken + wcslen (token), token)) {
-					goodness += 1.0;   /* One point for every second occurrence in a paragraph! */
-				}
-			}
-		}
-		par ++;
-	}
-	return goodness;
-}
-
 static void search (Manual me, const wchar_t *query) {
 	ManPages manPages = (ManPages) my data;
-	long numberOfPages = manPages -> pages -> size;
-	static MelderString searchText = { 0 };
-	MelderString_copy (& searchText, query);
-	for (wchar_t *p = & searchText.string [0]; *p != '\0'; p ++) {
-		if (*p == '\n') *p = ' ';
-		*p = tolower (*p);
-	}
-	if (! goodnessOfMatch)
-		goodnessOfMatch = NUMvector <double> (1, numberOfPages);
-	for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
-		wchar_t *token = searchText.string;
-		goodnessOfMatch [ipage] = 1.0;
-		for (;;) {
-			wchar_t *space = wcschr (token, ' ');
-			if (space) *space = '\0';
-			goodnessOfMatch [ipage] *= searchToken (manPages, ipage, token);
-			if (! space) break;
-			*space = ' ';   // restore
-			token = space + 1;
-		}
-	}
-	/*
-	 * Find the 20 best matches.
-	 */
-	my numberOfMatches = 0;
-	for (long imatch = 1; imatch <= 20; imatch ++) {
-		long imax = 0;
-		double max = 0.0;
-		for (long ipage = 1; ipage <= numberOfPages; ipage ++) {
-			if (goodnessOfMatch [ipage] > max) {
-				max = goodnessOfMatch [ipage];
-				imax = ipage;
-			}
-		}
-		if (! imax) break;
-		my matches [++ my numberOfMatches] = imax;
-		goodnessOfMatch [imax] = 0.0;   // skip next time
-	}
+	my numberOfMatches = ManPages_search (manPages, query, 20, my matches);
 	HyperPage_goToPage_i (me, SEARCH_PAGE);
 }
 
@@ -74,6 +74,8 @@ the behaviour of that program changes in the following way:
 45: tracing structMatrix :: read ()
 46: trace GTK parent sizes in _GuiObject_position ()
 47: force resampling in OTGrammar RIP
+48: Cochleagram (edb) and SPINET: convolve with the gammatone impulse responses instead of recursive filtering, on one thread
+49: FFNet learning: one pattern at a time instead of in blocks
 900: use DG Meta Serif Science instead of Palatino
 1264: Mac: Sound_recordFixedTime uses microphone "FW Solo (1264)"
 
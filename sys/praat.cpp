@@ -1033,6 +1033,7 @@ void praat_setStandAloneScriptText (char32 *text) {
 
 void praat_init (const char *title, unsigned int argc, char **argv) {
 	static char truncatedTitle [300];   // static because praatP.title will point into it
+	praatP. startUpTime = Melder_clock ();
 	#if defined (UNIX)
 		setlocale (LC_ALL, "C");
 		setenv ("PULSE_LATENCY_MSEC", "1", 0);   // Rafael Laboissiere, August 2014
@@ -1534,6 +1535,7 @@ void praat_run (void) {
 	if (sizeof (off_t) < 8)
 		Melder_fatal ("sizeof(off_t) is less than 8. Compile Praat with -D_FILE_OFFSET_BITS=64.");
 
+	praatP. startUpTime = Melder_clock () - praatP. startUpTime;
 	if (Melder_batch) {
 		if (thePraatStandAloneScriptText != NULL) {
 			try {
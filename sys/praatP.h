@@ -168,6 +168,7 @@ extern struct PraatP {
 	GuiWindow menuBar;
 	int phase;
 	Editor editor;   // scripting environment
+	double startUpTime;   // seconds between the start of praat_init and the end of the registration of all commands
 } praatP;
 
 struct autoPraatBackground {
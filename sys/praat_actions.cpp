@@ -34,6 +34,81 @@ static GuiMenuItem praat_writeMenuSeparator;
 static GuiForm praat_form;
 static bool actionsInvisible = false;
 
+/*
+ * Two indexes into theActions, so that the look-ups do not have to compare every action:
+ * one by title, for praat_doAction, and one by selection (the class tuple) and title, for lookUpMatchingAction.
+ * Each chain lists the actions with the same hash code, in the order of theActions, so that the first match still wins.
+ * An action appended at the end is added to the indexes directly; any other insertion, a removal, or sorting
+ * moves positions, so it only marks the indexes as invalid, and they are rebuilt at the next look-up.
+ * Most actions are appended, so registration rebuilds the indexes only after the few insertions with an 'after'.
+ */
+#define praat_ACTION_HASH_SIZE  4096
+typedef struct structActionIndex {
+	long heads [praat_ACTION_HASH_SIZE];
+	long *next;   // [1..praat_MAXNUM_LOOSE_COMMANDS]
+} *ActionIndex;
+static struct structActionIndex theTitleIndex, theSelectionIndex;
+static bool theActionIndexesAreValid = true;
+
+static unsigned long hashTitle (const wchar_t *title) {
+	unsigned long hash = 2166136261UL;   // FNV-1a
+	for (const wchar_t *p = title; *p != L'\0'; p ++)
+		hash = (hash ^ (unsigned long) *p) * 16777619UL;
+	return hash;
+}
+
+static unsigned long hashSelection (ClassInfo class1, ClassInfo class2, ClassInfo class3, ClassInfo class4, const wchar_t *title) {
+	unsigned long hash = hashTitle (title);
+	ClassInfo classes [4] = { class1, class2, class3, class4 };
+	for (int i = 0; i < 4; i ++)
+		hash = (hash ^ (unsigned long) ((uintptr_t) classes [i] >> 4)) * 16777619UL;
+	return hash;
+}
+
+static void ActionIndex_insert (ActionIndex me, unsigned long hash, long position) {
+	long *link = & my heads [hash & (praat_ACTION_HASH_SIZE - 1)];
+	while (*link != 0 && *link < position) link = & my next [*link];
+	my next [position] = *link;
+	*link = position;
+}
+
+static void actionInserted (long position) {
+	/*
+	 * Call this after theActions [position] has been filled in and the later actions have moved up.
+	 */
+	if (! theActionIndexesAreValid) return;
+	if (position < theNumberOfActions) {   // the later actions have new positions
+		theActionIndexesAreValid = false;
+		return;
+	}
+	praat_Command action = & theActions [position];
+	theTitleIndex. next [position] = theSelectionIndex. next [position] = 0;
+	if (! action -> title) return;   // a separator
+	ActionIndex_insert (& theTitleIndex, hashTitle (action -> title), position);
+	ActionIndex_insert (& theSelectionIndex, hashSelection (action -> class1, action -> class2, action -> class3, action -> class4, action -> title), position);
+}
+
+static void actionsMoved () {
+	/*
+	 * Call this after actions have been removed or sorted.
+	 */
+	theActionIndexesAreValid = false;
+}
+
+static void rebuildActionIndexesIfNeeded () {
+	if (theActionIndexesAreValid) return;
+	for (long i = 0; i < praat_ACTION_HASH_SIZE; i ++)
+		theTitleIndex. heads [i] = theSelectionIndex. heads [i] = 0;
+	for (long position = theNumberOfActions; position >= 1; position --) {   // backwards, so that every insertion is at the head of its chain
+		praat_Command action = & theActions [position];
+		theTitleIndex. next [position] = theSelectionIndex. next [position] = 0;
+		if (! action -> title) continue;
+		ActionIndex_insert (& theTitleIndex, hashTitle (action -> title), position);
+		ActionIndex_insert (& theSelectionIndex, hashSelection (action -> class1, action -> class2, action -> class3, action -> class4, action -> title), position);
+	}
+	theActionIndexesAreValid = true;
+}
+
 static void fixSelectionSpecification (ClassInfo *class1, int *n1, ClassInfo *class2, int *n2, ClassInfo *class3, int *n3) {
 /*
  * Function:
@@ -75,10 +150,13 @@ static long lookUpMatchingAction (ClassInfo class1, ClassInfo class2, ClassInfo
  * Precondition:
  *	class1, class2, and class3 must be in sorted order.
  */
-	for (long i = 1; i <= theNumberOfActions; i ++)
+	if (! title) return 0;
+	rebuildActionIndexesIfNeeded ();
+	unsigned long hash = hashSelection (class1, class2, class3, class4, title);
+	for (long i = theSelectionIndex. heads [hash & (praat_ACTION_HASH_SIZE - 1)]; i != 0; i = theSelectionIndex. next [i])
 		if (class1 == theActions [i]. class1 && class2 == theActions [i]. class2 &&
 		    class3 == theActions [i]. class3 && class4 == theActions [i]. class4 &&
-		    title && theActions [i]. title && wcsequ (theActions [i]. title, title)) return i;
+		    wcsequ (theActions [i]. title, title)) return i;
 	return 0;   /* Not found. */
 }
 
@@ -170,6 +248,7 @@ void praat_addAction4 (ClassInfo class1, int n1, ClassInfo class2, int n2, Class
 		theActions [position]. hidden = hidden;
 		theActions [position]. unhidable = unhidable;
 		theActions [position]. attractive = attractive;
+		actionInserted (position);
 	} catch (MelderError) {
 		Melder_flushError (NULL);
 	}
@@ -257,6 +336,7 @@ void praat_addActionScript (const wchar_t *className1, int n1, const wchar_t *cl
 		if (found) {
 			theNumberOfActions --;
 			for (long i = found; i <= theNumberOfActions; i ++) theActions [i] = theActions [i + 1];
+			actionsMoved ();
 		}
 
 		/*
@@ -313,6 +393,7 @@ void praat_addActionScript (const wchar_t *className1, int n1, const wchar_t *cl
 			static long uniqueID = 0;
 			theActions [position]. uniqueID = ++ uniqueID;
 		}
+		actionInserted (position);
 		updateDynamicMenu ();
 	} catch (MelderError) {
 		Melder_throw ("Praat: script action not added.");
@@ -333,6 +414,7 @@ void praat_removeAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, c
 		Melder_free (theActions [found]. title);
 		theNumberOfActions --;
 		for (long i = found; i <= theNumberOfActions; i ++) theActions [i] = theActions [i + 1];
+		actionsMoved ();
 	} catch (MelderError) {
 		Melder_throw ("Praat: action not removed.");
 	}
@@ -467,6 +549,7 @@ void praat_sortActions (void) {
 	for (long i = 1; i <= theNumberOfActions; i ++)
 		theActions [i]. sortingTail = i;
 	qsort (& theActions [1], theNumberOfActions, sizeof (struct structPraat_Command), compareActions);
+	actionsMoved ();
 }
 
 static const wchar_t *numberString (int number) {
@@ -703,6 +786,8 @@ void praat_actions_createWriteMenu (GuiWindow window) {
 
 void praat_actions_init (void) {
 	theActions = Melder_calloc_f (struct structPraat_Command, 1 + praat_MAXNUM_LOOSE_COMMANDS);
+	theTitleIndex. next = Melder_calloc_f (long, 1 + praat_MAXNUM_LOOSE_COMMANDS);
+	theSelectionIndex. next = Melder_calloc_f (long, 1 + praat_MAXNUM_LOOSE_COMMANDS);
 }
 
 void praat_actions_createDynamicMenu (GuiWindow window) {
@@ -741,18 +826,23 @@ void praat_saveAddedActions (MelderString *buffer) {
 	}
 }
 
+static long lookUpExecutableAction (const wchar_t *command) {
+	rebuildActionIndexesIfNeeded ();
+	for (long i = theTitleIndex. heads [hashTitle (command) & (praat_ACTION_HASH_SIZE - 1)]; i != 0; i = theTitleIndex. next [i])
+		if (theActions [i]. executable && wcsequ (theActions [i]. title, command)) return i;
+	return 0;   /* Not found. */
+}
+
 int praat_doAction (const wchar_t *command, const wchar_t *arguments, Interpreter interpreter) {
-	long i = 1;
-	while (i <= theNumberOfActions && (! theActions [i]. executable || wcscmp (theActions [i]. title, command))) i ++;
-	if (i > theNumberOfActions) return 0;   /* Not found. */
+	long i = lookUpExecutableAction (command);
+	if (i == 0) return 0;   /* Not found. */
 	theActions [i]. callback (NULL, 0, NULL, arguments, interpreter, command, false, NULL);
 	return 1;
 }
 
 int praat_doAction (const wchar_t *command, int narg, Stackel args, Interpreter interpreter) {
-	long i = 1;
-	while (i <= theNumberOfActions && (! theActions [i]. executable || wcscmp (theActions [i]. title, command))) i ++;
-	if (i > theNumberOfActions) return 0;   /* Not found. */
+	long i = lookUpExecutableAction (command);
+	if (i == 0) return 0;   /* Not found. */
 	theActions [i]. callback (NULL, narg, args, NULL, interpreter, command, false, NULL);
 	return 1;
 }
@@ -473,6 +473,24 @@ DO
 	}
 END2 }
 
+FORM (ManPages_search, L"ManPages: Search", 0) {
+	LABEL (L"", L"Search for strings (separate with spaces):")
+	TEXTFIELD (L"query", L"")
+	OK2
+DO
+	LOOP {
+		iam (ManPages);
+		long matches [1 + 20];
+		long numberOfMatches = ManPages_search (me, GET_STRING (L"query"), 20, matches);
+		MelderInfo_open ();
+		for (long imatch = 1; imatch <= numberOfMatches; imatch ++) {
+			ManPage page = static_cast<ManPage> (my pages -> item [matches [imatch]]);
+			MelderInfo_writeLine (page -> title);
+		}
+		MelderInfo_close ();
+	}
+END2 }
+
 DIRECT2 (ManPages_view) {
 	LOOP {
 		iam (ManPages);
@@ -680,6 +698,7 @@ void praat_addMenus (GuiWindow window) {
 
 	praat_addAction1 (classManPages, 1, L"Save to HTML directory...", 0, 0, DO_ManPages_saveToHtmlDirectory);
 	praat_addAction1 (classManPages, 1, L"View", 0, 0, DO_ManPages_view);
+	praat_addAction1 (classManPages, 1, L"Search...", 0, praat_HIDDEN, DO_ManPages_search);
 }
 
 void praat_addMenus2 (void) {
@@ -136,6 +136,7 @@ void praat_reportMemoryUse () {
 	MelderInfo_writeLine (L"   Total memory use: ", Melder_bigInteger (statistics.memory + Melder_allocationSize ()), L" bytes");
 	MelderInfo_writeLine (L"\nNumber of fixed menu commands: ", Melder_integer (praat_getNumberOfMenuCommands ()));
 	MelderInfo_writeLine (L"Number of dynamic menu commands: ", Melder_integer (praat_getNumberOfActions ()));
+	MelderInfo_writeLine (L"Start-up time: ", Melder_fixed (praatP. startUpTime, 3), L" seconds");
 	MelderInfo_close ();
 }
 